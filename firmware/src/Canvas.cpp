@@ -0,0 +1,149 @@
+/*
+ * File:   Canvas.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 8:35 AM
+ */
+
+#include "Canvas.h"
+
+template <typename T> static inline void Swap(T &a, T &b) {T t = a; a = b; b = t;}
+
+void Canvas::DrawHLine(int32_t x0, int32_t x1, int32_t y, uint16_t color)
+{
+    if (x0 > x1)
+        Swap(x0, x1);
+    if (y < 0 || y >= _height || x1 < 0 || x0 >= _width)
+        return;
+    if (x0 < 0)
+        x0 = 0;
+    if (x1 >= _width)
+        x1 = _width - 1;
+
+    uint16_t *p = _pixels + y * _width + x0;
+    for (int32_t x = x0; x <= x1; ++x)
+        *p++ = color;
+}
+
+void Canvas::DrawVLine(int32_t x, int32_t y0, int32_t y1, uint16_t color)
+{
+    if (y0 > y1)
+        Swap(y0, y1);
+    if (x < 0 || x >= _width || y1 < 0 || y0 >= _height)
+        return;
+    if (y0 < 0)
+        y0 = 0;
+    if (y1 >= _height)
+        y1 = _height - 1;
+
+    uint16_t *p = _pixels + y0 * _width + x;
+    for (int32_t y = y0; y <= y1; ++y, p += _width)
+        *p = color;
+}
+
+/******************************************************************************
+FUNCTION DrawLine -- draw a line, including both end points
+DESCRIPTION
+    Horizontal and vertical lines (all the square wave and caliper painters
+    ever draw) get straight fills. Anything else is plain Bresenham with
+    per-pixel clipping, which is fine for the few diagonals we draw.
+******************************************************************************/
+void Canvas::DrawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint16_t color)
+{
+    if (y0 == y1)
+    {
+        DrawHLine(x0, x1, y0, color);
+        return;
+    }
+    if (x0 == x1)
+    {
+        DrawVLine(x0, y0, y1, color);
+        return;
+    }
+
+    int32_t dx = x1 > x0 ? x1 - x0 : x0 - x1;
+    int32_t dy = y1 > y0 ? y0 - y1 : y1 - y0;
+    int32_t sx = x1 > x0 ? 1 : -1;
+    int32_t sy = y1 > y0 ? 1 : -1;
+    int32_t err = dx + dy;
+
+    for (;;)
+    {
+        SetPixel(x0, y0, color);
+        if (x0 == x1 && y0 == y1)
+            break;
+        int32_t e2 = err * 2;
+        if (e2 >= dy)
+        {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx)
+        {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+void Canvas::DrawRect(int32_t x, int32_t y, int32_t width, int32_t height, uint16_t color)
+{
+    if (width <= 0 || height <= 0)
+        return;
+    DrawHLine(x, x + width - 1, y, color);
+    DrawHLine(x, x + width - 1, y + height - 1, color);
+    DrawVLine(x, y, y + height - 1, color);
+    DrawVLine(x + width - 1, y, y + height - 1, color);
+}
+
+void Canvas::FillRect(int32_t x, int32_t y, int32_t width, int32_t height, uint16_t color)
+{
+    // Clip to the canvas
+    if (x < 0)
+    {
+        width += x;
+        x = 0;
+    }
+    if (y < 0)
+    {
+        height += y;
+        y = 0;
+    }
+    if (x + width > _width)
+        width = _width - x;
+    if (y + height > _height)
+        height = _height - y;
+    if (width <= 0 || height <= 0)
+        return;
+
+    for (int32_t row = y; row < y + height; ++row)
+    {
+        uint16_t *p = _pixels + row * _width + x;
+        for (int32_t col = 0; col < width; ++col)
+            *p++ = color;
+    }
+}
+
+/******************************************************************************
+FUNCTION DrawGlyph -- draw the set pixels of a 1bpp glyph
+DESCRIPTION
+    The glyph is stored a row at a time, most significant bit first, with
+    each row padded out to a whole byte. Clear bits are left alone so the
+    glyph draws over whatever is already on the canvas.
+******************************************************************************/
+void Canvas::DrawGlyph(int32_t x, int32_t y, const uint8_t *bits, int32_t width, int32_t height, uint16_t color)
+{
+    int32_t stride = (width + 7) / 8;
+    for (int32_t row = 0; row < height; ++row, bits += stride)
+    {
+        int32_t py = y + row;
+        if (py < 0 || py >= _height)
+            continue;
+        for (int32_t col = 0; col < width; ++col)
+        {
+            if (bits[col >> 3] & (0x80 >> (col & 7)))
+                SetPixel(x + col, py, color);
+        }
+    }
+}
+
@@ -0,0 +1,56 @@
+/*
+ * File:   Canvas.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 8:35 AM
+ */
+
+#ifndef CANVAS_H
+#define	CANVAS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/******************************************************************************
+CLASS Canvas -- off-screen RGB565 drawing surface
+DESCRIPTION
+    Canvas rasterizes lines, rectangles and 1bpp glyphs into a caller-supplied
+    block of RGB565 pixels, so a painter can build its whole surface in RAM
+    and hand it to the display in one copy instead of one HAL call per
+    primitive. All coordinates are relative to the canvas and everything is
+    clipped to it. There's no dependence on the graphics library, so this
+    builds on the host too.
+******************************************************************************/
+class Canvas
+{
+public:
+    Canvas() : _pixels(NULL), _width(0), _height(0) {}
+    Canvas(uint16_t *pixels, int32_t width, int32_t height) :
+        _pixels(pixels), _width(width), _height(height) {}
+
+    uint16_t *Pixels() const {return _pixels;}
+    int32_t Width() const {return _width;}
+    int32_t Height() const {return _height;}
+
+    void Clear(uint16_t color) {FillRect(0, 0, _width, _height, color);}
+    void SetPixel(int32_t x, int32_t y, uint16_t color)
+    {
+        if (x >= 0 && x < _width && y >= 0 && y < _height)
+            _pixels[y * _width + x] = color;
+    }
+
+    void DrawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint16_t color);
+    void DrawRect(int32_t x, int32_t y, int32_t width, int32_t height, uint16_t color);
+    void FillRect(int32_t x, int32_t y, int32_t width, int32_t height, uint16_t color);
+    void DrawGlyph(int32_t x, int32_t y, const uint8_t *bits, int32_t width, int32_t height, uint16_t color);
+
+private:
+    void DrawHLine(int32_t x0, int32_t x1, int32_t y, uint16_t color);
+    void DrawVLine(int32_t x, int32_t y0, int32_t y1, uint16_t color);
+
+    uint16_t *_pixels;
+    int32_t _width, _height;
+};
+
+#endif	/* CANVAS_H */
+
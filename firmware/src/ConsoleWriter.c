@@ -0,0 +1,168 @@
+/*
+ * File:   ConsoleWriter.c
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:20 AM
+ */
+
+#include <string.h>
+#include "ConsoleWriter.h"
+
+#define RING_MASK (CONSOLE_WRITER_RING_SIZE - 1)
+
+#if CONSOLE_WRITER_RING_SIZE & RING_MASK
+#error CONSOLE_WRITER_RING_SIZE must be a power of 2
+#endif
+
+// Keeps the compiler from moving the copy past the index that publishes it
+#define BARRIER() __asm__ __volatile__("" ::: "memory")
+
+void ConsoleWriterInit(ConsoleWriter *writer, const ConsoleTransport *transport,
+    char *buffer0, char *buffer1, size_t bufferSize)
+{
+    memset(writer, 0, sizeof(*writer));
+    writer->transport = transport;
+    writer->buffers[0] = buffer0;
+    writer->buffers[1] = buffer1;
+    writer->bufferSize = bufferSize;
+}
+
+void ConsoleWriterReset(ConsoleWriter *writer)
+{
+    uint32_t state = writer->transport->lock(writer->transport->context);
+    writer->head = writer->tail = 0;
+    writer->filled = 0;
+    writer->sending = false;
+    writer->transport->unlock(state, writer->transport->context);
+}
+
+size_t ConsoleWriterSpace(const ConsoleWriter *writer)
+{
+    return (writer->head - writer->tail - 1) & RING_MASK;
+}
+
+bool ConsoleWriterIsEmpty(const ConsoleWriter *writer)
+{
+    return writer->head == writer->tail && writer->filled == 0;
+}
+
+// Move what's in the ring into the spare buffer, as far as it'll go
+static void Fill(ConsoleWriter *writer)
+{
+    size_t head = writer->head;
+    size_t tail = writer->tail;
+    BARRIER();
+    char *buffer = writer->buffers[writer->spare];
+    size_t filled = writer->filled;
+    while (head != tail && filled < writer->bufferSize)
+    {
+        size_t count = (tail > head ? tail : CONSOLE_WRITER_RING_SIZE) - head;
+        if (count > writer->bufferSize - filled)
+            count = writer->bufferSize - filled;
+        memcpy(buffer + filled, writer->ring + head, count);
+        filled += count;
+        head = (head + count) & RING_MASK;
+    }
+    writer->filled = filled;
+    BARRIER();
+    writer->head = head;
+}
+
+// Send the spare buffer if nothing's going out
+static void Send(ConsoleWriter *writer)
+{
+    if (writer->sending || writer->filled == 0)
+        return;
+
+    int buffer = writer->spare;
+    size_t length = writer->filled;
+    writer->sending = true;
+    writer->spare = buffer ^ 1;
+    writer->filled = 0;
+    if (writer->transport->send(writer->buffers[buffer], length, writer->transport->context))
+    {
+        ++writer->transfers;
+        writer->bytesSent += length;
+    }
+    else
+    {
+        // Try again from the next poll
+        writer->sending = false;
+        writer->spare = buffer;
+        writer->filled = length;
+    }
+}
+
+static void Start(ConsoleWriter *writer)
+{
+    uint32_t state = writer->transport->lock(writer->transport->context);
+    if (!writer->sending)
+    {
+        Fill(writer);
+        Send(writer);
+        Fill(writer);
+    }
+    writer->transport->unlock(state, writer->transport->context);
+}
+
+size_t ConsoleWriterWrite(ConsoleWriter *writer, const char *data, size_t length)
+{
+    size_t tail = writer->tail;
+    size_t space = ConsoleWriterSpace(writer);
+    if (length > space)
+    {
+        length = space;
+        writer->starved = true;
+    }
+    if (length == 0)
+        return 0;
+
+    size_t first = CONSOLE_WRITER_RING_SIZE - tail;
+    if (first > length)
+        first = length;
+    memcpy(writer->ring + tail, data, first);
+    memcpy(writer->ring, data + first, length - first);
+    BARRIER();
+    writer->tail = (tail + length) & RING_MASK;
+
+    // If a transfer's out, its completion picks this up
+    if (!writer->sending)
+        Start(writer);
+    return length;
+}
+
+/******************************************************************************
+FUNCTION ConsoleWriterComplete -- the transfer that was out is done
+DESCRIPTION
+    Whatever's been written since the spare buffer was filled is added to
+    it, and it goes out at once. Then the ring is emptied into the buffer
+    just freed, so it's ready for next time.
+******************************************************************************/
+void ConsoleWriterComplete(ConsoleWriter *writer)
+{
+    writer->sending = false;
+    Fill(writer);
+    Send(writer);
+    Fill(writer);
+}
+
+void ConsoleWriterPoll(ConsoleWriter *writer)
+{
+    if (!writer->sending && !ConsoleWriterIsEmpty(writer))
+        Start(writer);
+
+    if (writer->starved && ConsoleWriterSpace(writer) >= writer->spaceThreshold)
+    {
+        writer->starved = false;
+        if (writer->spaceCallback)
+            (*writer->spaceCallback)(ConsoleWriterSpace(writer), writer->spaceContext);
+    }
+}
+
+void ConsoleWriterSetSpaceCallback(ConsoleWriter *writer,
+    void (*callback)(size_t space, void *context), void *context, size_t threshold)
+{
+    writer->spaceCallback = callback;
+    writer->spaceContext = context;
+    writer->spaceThreshold = threshold < CONSOLE_WRITER_RING_SIZE ? threshold : CONSOLE_WRITER_RING_SIZE - 1;
+}
@@ -0,0 +1,107 @@
+/*
+ * File:   ConsoleWriter.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:20 AM
+ */
+
+#ifndef CONSOLEWRITER_H
+#define	CONSOLEWRITER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/******************************************************************************
+Console writer -- double buffered writes to a transport like USB CDC
+DESCRIPTION
+    Writers copy spans into a ring. The transport sends from one of two
+    transfer buffers while the other is filled from the ring. When a
+    transfer completes, the next one goes out straight away from the
+    completion handler (an ISR for USB), and the ring is emptied into the
+    buffer just freed. So output keeps moving without the main loop, and a
+    writer waiting for space in the ring can't hang the way it would if
+    only the main loop started transfers.
+
+    The ring has one producer (the writers, in the main loop) and one
+    consumer (whatever holds the transport's lock), so writing doesn't lock.
+    Starting a transfer from the main loop takes the lock, which keeps the
+    completion handler out.
+
+    A writer that doesn't want to block uses ConsoleWriterWrite(), which
+    takes what fits. If it came up short, the space callback runs from
+    ConsoleWriterPoll() once there's room again.
+
+    Nothing here knows about USB, so it builds on the host.
+******************************************************************************/
+
+#define CONSOLE_WRITER_RING_SIZE 4096
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct
+{
+    // Start sending a buffer. Returns false if the transfer couldn't start.
+    bool (*send)(const char *buffer, size_t length, void *context);
+    // Keep the completion handler out until unlock
+    uint32_t (*lock)(void *context);
+    void (*unlock)(uint32_t state, void *context);
+    void *context;
+} ConsoleTransport;
+
+typedef struct
+{
+    char ring[CONSOLE_WRITER_RING_SIZE];
+    volatile size_t head, tail;     // The consumer moves head, the writers tail
+
+    const ConsoleTransport *transport;
+    char *buffers[2];
+    size_t bufferSize;
+    volatile size_t filled;         // Bytes waiting in buffers[spare]
+    volatile int spare;             // The buffer being filled
+    volatile bool sending;          // The other one is out
+
+    void (*spaceCallback)(size_t space, void *context);
+    void *spaceContext;
+    size_t spaceThreshold;
+    volatile bool starved;          // A write came up short
+
+    // Totals, for measuring throughput
+    uint32_t transfers;
+    uint64_t bytesSent;
+} ConsoleWriter;
+
+// The buffers are what the transport sends from, e.g. coherent memory for
+// USB DMA
+void ConsoleWriterInit(ConsoleWriter *writer, const ConsoleTransport *transport,
+    char *buffer0, char *buffer1, size_t bufferSize);
+// Drop everything, e.g. when the transport goes away
+void ConsoleWriterReset(ConsoleWriter *writer);
+
+// Takes as much as fits and returns how much that was
+size_t ConsoleWriterWrite(ConsoleWriter *writer, const char *data, size_t length);
+// Free space in the ring
+size_t ConsoleWriterSpace(const ConsoleWriter *writer);
+// Everything written has been handed to the transport
+bool ConsoleWriterIsEmpty(const ConsoleWriter *writer);
+
+// Call when a transfer completes, with the lock held or from the
+// completion handler
+void ConsoleWriterComplete(ConsoleWriter *writer);
+// Call from the main loop: starts a transfer if there isn't one and runs
+// the space callback
+void ConsoleWriterPoll(ConsoleWriter *writer);
+
+// Run callback once there are threshold bytes free after a write came up
+// short
+void ConsoleWriterSetSpaceCallback(ConsoleWriter *writer,
+    void (*callback)(size_t space, void *context), void *context, size_t threshold);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* CONSOLEWRITER_H */
@@ -43,14 +43,12 @@ void _putchar(char character)
 
 void _mon_write(const char *s, unsigned int count)
 {
-    while (count--)
-        CONSOLE_Write(*s++);
+    CONSOLE_WriteSpan(s, count);
 }
 
 void _mon_puts(const char * s)
 {
-    while (*s)
-        CONSOLE_Write(*s++);
+    CONSOLE_WriteSpan(s, strlen(s));
 }
 
 /*static int ToErrno(SYS_FS_ERROR err)
@@ -211,11 +209,7 @@ int write(int handle, void *buffer, size_t nbyte)
     switch (handle)
     {
         case 1 :
-            while (nbyte--)
-            {
-                CONSOLE_Write(*cbuffer++);
-                ++written;
-            }
+            written = (int) CONSOLE_WriteSpan(cbuffer, nbyte);
             break;
             
         default :
@@ -51,8 +51,7 @@ DMA::~DMA()
 }
 
 Implement_InterruptHandler(_DMA0_VECTOR, DMAInt[0].dma)
-Implement_InterruptHandler(_DMA1_VECTOR, DMAInt[1].dma)
-Implement_InterruptHandler(_DMA2_VECTOR, DMAInt[2].dma)
+// DMA 1 and 2 are bound directly to ToolLogicAnalyzer, which samples with them
 Implement_InterruptHandler(_DMA3_VECTOR, DMAInt[3].dma)
 Implement_InterruptHandler(_DMA4_VECTOR, DMAInt[4].dma)
 Implement_InterruptHandler(_DMA5_VECTOR, DMAInt[5].dma)
@@ -0,0 +1,112 @@
+/* 
+ * File:   DisplayStats.cpp
+ * Author: Bob
+ * 
+ * Created on October 19, 2026, 8:30 AM
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "Utility.h"
+#include "DisplayStats.h"
+
+static DisplayProbeStats stats[DisplayProbeCount];
+
+static const char *probeNames[DisplayProbeCount] = 
+{
+    "Frame", "DrawSurface", "Painter", "SPI write", "SPI wait", "SPI DMA"
+};
+
+extern "C" int DisplayStatsBucket(uint32_t us)
+{
+    int bucket = us ? 32 - __builtin_clz(us) : 0;
+    return bucket < DISPLAY_STATS_BUCKETS ? bucket : DISPLAY_STATS_BUCKETS - 1;
+}
+
+// Called from the LCD DMA's ISR as well as the main loop
+extern "C" void DisplayStatsAdd(DisplayProbe probe, uint32_t ticks)
+{
+    DisableInterrupts di;
+    DisplayProbeStats &s = stats[probe];
+    s.frameTicks += ticks;
+    ++s.frameCalls;
+}
+
+extern "C" void DisplayStatsEndFrame(uint32_t ticksPerUs)
+{
+    DisableInterrupts di;
+    
+    // LibAria_Tasks() runs on every pass through the main loop. If nothing
+    // else was timed, nothing was drawn, so don't count it as a frame.
+    bool drew = false;
+    for (int probe = DisplayProbeFrame + 1; probe < DisplayProbeCount; ++probe)
+        drew |= stats[probe].frameCalls != 0;
+    if (!drew)
+    {
+        stats[DisplayProbeFrame].frameTicks = 0;
+        stats[DisplayProbeFrame].frameCalls = 0;
+        return;
+    }
+    
+    for (auto &s : stats)
+    {
+        if (s.frameCalls)
+        {
+            ++s.frames;
+            s.calls += s.frameCalls;
+            s.totalTicks += s.frameTicks;
+            if (s.frameTicks > s.maxFrameTicks)
+                s.maxFrameTicks = s.frameTicks;
+            ++s.histogram[DisplayStatsBucket(s.frameTicks / ticksPerUs)];
+            s.frameTicks = 0;
+            s.frameCalls = 0;
+        }
+    }
+}
+
+extern "C" void DisplayStatsReset()
+{
+    DisableInterrupts di;
+    memset(stats, 0, sizeof(stats));
+}
+
+extern "C" const DisplayProbeStats *DisplayStatsGet(DisplayProbe probe)
+{
+    return &stats[probe];
+}
+
+// The probe's copied with interrupts off, and printed after they're back on,
+// since the console needs its interrupts to go anywhere
+extern "C" int DisplayStatsDump(int probe, uint32_t ticksPerUs)
+{
+#ifdef DISPLAY_STATS
+    if (probe == 0)
+        printf("\r\nDisplay timing (per frame)\r\n");
+    
+    DisplayProbeStats s;
+    {
+        DisableInterrupts di;
+        s = stats[probe];
+    }
+    if (s.frames)
+    {
+        printf("%s: %u frames, %u calls, avg %uus, max %uus\r\n", probeNames[probe], 
+            s.frames, s.calls, uint32_t(s.totalTicks / s.frames / ticksPerUs), s.maxFrameTicks / ticksPerUs);
+        for (int i = 0; i < DISPLAY_STATS_BUCKETS; ++i)
+        {
+            if (s.histogram[i] && i == DISPLAY_STATS_BUCKETS - 1)
+                printf(" >=%uus:%u", 1u << (i - 1), s.histogram[i]);
+            else if (s.histogram[i])
+                printf(" <%uus:%u", 1u << i, s.histogram[i]);
+        }
+        printf("\r\n");
+    }
+    else
+        printf("%s: no frames\r\n", probeNames[probe]);
+    
+    return ++probe < DisplayProbeCount ? probe : -1;
+#else
+    printf("\r\nDisplay timing isn't compiled in (see DISPLAY_STATS)\r\n");
+    return -1;
+#endif
+}
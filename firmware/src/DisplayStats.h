@@ -0,0 +1,91 @@
+/* 
+ * File:   DisplayStats.h
+ * Author: Bob
+ *
+ * Timing statistics for the display stack. Probes accumulate core timer
+ * ticks during a frame; at the end of the frame each probe's total goes into
+ * a histogram. The histograms are dumped over the USB console from the
+ * Utility tool. Probes run in the main loop and in the LCD DMA's ISR, so
+ * each update is made with interrupts off. The times and the timer's rate
+ * are passed in, so the rest builds on the host.
+ * 
+ * Created on October 19, 2026, 8:30 AM
+ */
+
+#ifndef DISPLAYSTATS_H
+#define	DISPLAYSTATS_H
+
+#include <stdint.h>
+#include "device.h"
+
+// Uncomment to compile the probes in. They cost a core timer read at each
+// end of every timed scope.
+//#define DISPLAY_STATS
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef enum
+{
+    DisplayProbeFrame,          // All of LibAria_Tasks()
+    DisplayProbeDrawSurface,    // SurfaceWrapper::DrawSurfaceCallback()
+    DisplayProbePainter,        // Each SurfacePainter::OnDraw()
+    DisplayProbeSPIWrite,       // GFX_Disp_Intf_Write() and GFX_Disp_Intf_WriteCommandParm()
+    DisplayProbeSPIWait,        // Blocked waiting for the SPI or the DMA
+    DisplayProbeSPIDMA,         // Each DMA transfer to the LCD
+    DisplayProbeCount
+} DisplayProbe;
+
+// Histogram bucket n counts frames where the probe took [2^(n-1), 2^n) us.
+// Bucket 0 is < 1us; the last bucket also gets everything longer.
+#define DISPLAY_STATS_BUCKETS 16
+
+typedef struct
+{
+    uint32_t frameTicks;    // Accumulated during the current frame
+    uint32_t frameCalls;
+    uint32_t frames;        // Frames in which the probe ran
+    uint32_t calls;
+    uint64_t totalTicks;
+    uint32_t maxFrameTicks;
+    uint32_t histogram[DISPLAY_STATS_BUCKETS];
+} DisplayProbeStats;
+
+static inline uint32_t DisplayStatsNow() {return _CP0_GET_COUNT();}
+
+void DisplayStatsAdd(DisplayProbe probe, uint32_t ticks);
+void DisplayStatsEndFrame(uint32_t ticksPerUs);
+void DisplayStatsReset();
+const DisplayProbeStats *DisplayStatsGet(DisplayProbe probe);
+// Histogram bucket for a probe that took us microseconds in a frame
+int DisplayStatsBucket(uint32_t us);
+// Prints one probe to the console. Returns the next probe to print, or -1
+// after the last one.
+int DisplayStatsDump(int probe, uint32_t ticksPerUs);
+
+#ifdef __cplusplus
+}
+
+// Times the enclosing scope
+class DisplayStatsTimer
+{
+public:
+#ifdef DISPLAY_STATS
+    DisplayStatsTimer(DisplayProbe probe) : _probe(probe), _start(DisplayStatsNow()) {}
+    ~DisplayStatsTimer() {DisplayStatsAdd(_probe, DisplayStatsNow() - _start);}
+    
+private:
+    DisplayProbe _probe;
+    uint32_t _start;
+#else
+    DisplayStatsTimer(DisplayProbe) {}
+#endif
+    
+    DisplayStatsTimer(const DisplayStatsTimer &orig);
+};
+
+#endif
+
+#endif	/* DISPLAYSTATS_H */
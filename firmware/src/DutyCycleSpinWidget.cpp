@@ -10,6 +10,7 @@ extern "C"
 #include "definitions.h"
 }
 #include "Utility.h"
+#include "Format.h"
 #include "DutyCycleSpinWidget.h"
 
 std::string DutyCycleSpinWidget::ToString(int cursorPos) const
@@ -20,9 +21,9 @@ std::string DutyCycleSpinWidget::ToString(int cursorPos) const
     {
         if (_show.ShowDutyCycle)
         {
-            int len = sprintf(buf, "%3d.%02d%%", int(*_duty * 100), int(*_duty * 10000) % 100);
+            char *p = FormatPercent(buf);
             if (_show.ShowDutyCycle)
-                strcpy(buf + len, "/");
+                FormatText(p, "/");
         }
         s = buf;
         if (_show.ShowPulseWidth)
@@ -33,8 +34,8 @@ std::string DutyCycleSpinWidget::ToString(int cursorPos) const
         int rightmostDigit;
         if (_editMode == Percentage)
         {
-            int len = sprintf(buf, "%3d.%02d%%", int(*_duty * 100), int(*_duty * 10000) % 100);
-            rightmostDigit = len - 2;
+            char *p = FormatPercent(buf);
+            rightmostDigit = int(p - buf) - 2;
             s = buf;
         }
         else
@@ -44,12 +45,12 @@ std::string DutyCycleSpinWidget::ToString(int cursorPos) const
                 pulseWidth = *_duty / _freq;
             else
                 pulseWidth = 0;
-            int len = sprintf(buf, "%02u.%03u %03u %03u s", 
-                    int(pulseWidth),
-                    int(pulseWidth * 1000 % 1000),
-                    int(pulseWidth * 1000000 % 1000),
-                    int(pulseWidth * 1000000000 % 1000));
-            rightmostDigit = len - 3;
+            char *p = FormatUnsigned(buf, int(pulseWidth), 2);
+            p = FormatUnsigned(FormatText(p, "."), int(pulseWidth * 1000 % 1000), 3);
+            p = FormatUnsigned(FormatText(p, " "), int(pulseWidth * 1000000 % 1000), 3);
+            p = FormatUnsigned(FormatText(p, " "), int(pulseWidth * 1000000000 % 1000), 3);
+            p = FormatText(p, " s");
+            rightmostDigit = int(p - buf) - 3;
             s = buf;
         }
         int strPos = rightmostDigit;
@@ -65,6 +66,13 @@ std::string DutyCycleSpinWidget::ToString(int cursorPos) const
     return s;
 }
 
+char *DutyCycleSpinWidget::FormatPercent(char *p) const
+{
+    p = FormatInt(p, int(*_duty * 100), 3);
+    p = FormatInt(FormatText(p, "."), int(*_duty * 10000) % 100, 2, '0');
+    return FormatText(p, "%");
+}
+
 void DutyCycleSpinWidget::Increment(int cursorPos, bool increment)
 {
     if (_editMode == Percentage)
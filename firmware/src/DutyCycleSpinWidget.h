@@ -39,6 +39,9 @@ private:
     EditMode _editMode;
     Show _show;
     
+    // "ddd.dd%"
+    char *FormatPercent(char *p) const;
+    
     DutyCycleSpinWidget(const DutyCycleSpinWidget& orig);
 };
 
@@ -67,24 +67,65 @@ GFX_Result __wrap_GFXU_DrawImageRLEInternal(GFXU_ImageAsset* img,
 }
 
 
+// Aria's RLE stream is a two-byte header (bytes per run length, bytes per
+// value) followed by (length, value) pairs, both stored little endian.
+// getRLEDataAtIndex() re-reads the run for every pixel. We walk the runs
+// once instead and copy whole runs into the line buffer.
+typedef struct
+{
+    const uint8_t *next;        // The next (length, value) pair
+    uint8_t lengthSize, valueSize;
+    uint32_t runEnd;            // Pixel index just past the current run
+    uint32_t max;               // Number of pixels in the image
+    uint32_t value;             // The current run's value
+} RLECursor;
+
+static inline uint32_t ReadLittleEndian(const uint8_t *p, uint8_t size)
+{
+    uint32_t val = 0;
+    while (size--)
+        val = (val << 8) | p[size];
+    return val;
+}
+
+static void RLECursorNextRun(RLECursor *cursor)
+{
+    cursor->runEnd += ReadLittleEndian(cursor->next, cursor->lengthSize);
+    cursor->value = ReadLittleEndian(cursor->next + cursor->lengthSize, cursor->valueSize);
+    cursor->next += cursor->lengthSize + cursor->valueSize;
+}
+
+static void RLECursorInitialize(RLECursor *cursor, const uint8_t *data, uint32_t max)
+{
+    cursor->lengthSize = data[0];
+    cursor->valueSize = data[1];
+    cursor->next = data + 2;
+    cursor->runEnd = 0;
+    cursor->max = max;
+    RLECursorNextRun(cursor);
+}
+
+// Move forward to the run that contains idx. Rows are drawn top to bottom,
+// so we never need to go backward.
+static void RLECursorSeek(RLECursor *cursor, uint32_t idx)
+{
+    while (idx >= cursor->runEnd && cursor->runEnd < cursor->max)
+        RLECursorNextRun(cursor);
+}
+
 GFX_Result drawColorImage(GFXU_ImageAsset* img,
     int32_t src_x, int32_t src_y, int32_t src_width, int32_t src_height, int32_t dest_x, int32_t dest_y)
 {
     GFX_Context* context = GFX_ActiveContext();
     GFX_Point dest_point;
-    GFX_Color color;
     uint8_t pixelLine[src_width * 2], *pp;
-    uint32_t lastBlock = 0;
-    uint32_t lastOffset = 0;
     GFX_ColorMode layerMode;
+    RLECursor cursor;
     
     uint32_t idx;
 
     int32_t row;
-    int32_t col;
-    
-    // Only support one color mode for now
-    if (img->colorMode != GFX_COLOR_MODE_RGB_565) __builtin_software_breakpoint();
+    int32_t remaining, count;
     
     dest_point.x = dest_x;
     dest_point.y = dest_y;
@@ -103,21 +144,42 @@ GFX_Result drawColorImage(GFXU_ImageAsset* img,
         GFX_Set(GFXF_DRAW_MASK_ENABLE, GFX_FALSE);
     }
     
+    RLECursorInitialize(&cursor, img->header.dataAddress, img->width * img->height);
+    
     for(row = 0; row < src_height; row++)
     {
+        idx = src_x + ((src_y + row) * img->width);
         pp = pixelLine;
-        for(col = 0; col < src_width; col++)
+        remaining = src_width;
+        while (remaining)
         {
-            idx = src_x + col + ((src_y + row) * img->width);
+            RLECursorSeek(&cursor, idx);
+            
+            // How much of this run is on this row? If we ran off the end of
+            // the data, pad the row with 0, as getRLEDataAtIndex() does.
+            // The LCD is RGB565. Convert the run's value once for the whole run.
+            uint16_t color = 0;
+            if (cursor.runEnd > idx)
+            {
+                count = cursor.runEnd - idx;
+                color = img->colorMode == GFX_COLOR_MODE_RGB_565 ? 
+                    (uint16_t) cursor.value : 
+                    (uint16_t) GFX_ColorConvert(img->colorMode, GFX_COLOR_MODE_RGB_565, cursor.value);
+            }
+            else
+                count = remaining;
+            if (count > remaining)
+                count = remaining;
             
-            // get the RLE data of the index
-            color = (uint16_t) getRLEDataAtIndex(img->header.dataAddress,
-                                      img->width * img->height,
-                                      idx,
-                                      &lastBlock,
-                                      &lastOffset);
-            *pp++ = (uint8_t) (color >> 8);
-            *pp++ = (uint8_t) (color);
+            uint8_t hi = (uint8_t) (color >> 8), lo = (uint8_t) color;
+            
+            idx += count;
+            remaining -= count;
+            while (count--)
+            {
+                *pp++ = hi;
+                *pp++ = lo;
+            }
         }
 
         ILI9488_Intf_WritePixels((ILI9488_DRV *) context->driver_data,
@@ -126,4 +188,3 @@ GFX_Result drawColorImage(GFXU_ImageAsset* img,
     
     return GFX_SUCCESS;
 }
-
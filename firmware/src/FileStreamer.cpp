@@ -0,0 +1,55 @@
+/*
+ * File:   FileStreamer.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 10:55 AM
+ */
+
+#include "FileStreamer.h"
+
+FileStreamer::FileStreamer(char *buffer0, char *buffer1, size_t blockSize) :
+    _buffers{buffer0, buffer1}, _blockSize(blockSize)
+{
+    Reset();
+}
+
+void FileStreamer::Reset()
+{
+    _size[0] = _size[1] = 0;
+    _readBlock = _sendBlock = 0;
+    _sending = false;
+}
+
+bool FileStreamer::Fill(ReadFunction read, void *context)
+{
+    while (_size[_readBlock] == 0)
+    {
+        const char *data = _buffers[_readBlock];
+        size_t bytes = read(data, _buffers[_readBlock], _blockSize, context);
+        if (bytes == 0)
+            return false;
+        _data[_readBlock] = data;
+        _size[_readBlock] = bytes;
+        _readBlock ^= 1;
+    }
+    return true;
+}
+
+bool FileStreamer::Next(const char *&data, size_t &size)
+{
+    if (_sending || _size[_sendBlock] == 0)
+        return false;
+    data = _data[_sendBlock];
+    size = _size[_sendBlock];
+    _sending = true;
+    return true;
+}
+
+void FileStreamer::Sent()
+{
+    if (!_sending)
+        return;
+    _size[_sendBlock] = 0;
+    _sendBlock ^= 1;
+    _sending = false;
+}
@@ -0,0 +1,58 @@
+/*
+ * File:   FileStreamer.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 10:55 AM
+ */
+
+#ifndef FILESTREAMER_H
+#define	FILESTREAMER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/******************************************************************************
+CLASS FileStreamer -- the two blocks a file is sent out of
+DESCRIPTION
+    One block is sent in the background while the other is filled, and they
+    go out in the order they were filled. A block is either a pointer into
+    memory the file already sits in (the flash disk) or one of the two
+    buffers given here, read into.
+
+    The caller fills with Fill() whenever it likes, tells us with Sent() when
+    the block being sent is done, and starts whatever Next() hands back.
+
+    Nothing here knows about the PIC32 or SYS_FS, so it builds on the host.
+******************************************************************************/
+
+class FileStreamer
+{
+public:
+    // Set data to the next piece of the file, at most bytes long. buffer is
+    // there to read into if the piece has to be copied. Returns the size;
+    // 0 at the end of the file or on an error.
+    typedef size_t (*ReadFunction)(const char *&data, char *buffer, size_t bytes, void *context);
+
+    FileStreamer(char *buffer0, char *buffer1, size_t blockSize);
+
+    void Reset();
+    // Fill the free blocks. Returns false once read has run out.
+    bool Fill(ReadFunction read, void *context);
+    // The block to send next, if there is one and nothing is being sent
+    bool Next(const char *&data, size_t &size);
+    // The block from Next() has gone
+    void Sent();
+
+    bool Sending() const {return _sending;}
+    size_t BlockSize() const {return _blockSize;}
+
+private:
+    char *_buffers[2];
+    size_t _blockSize;
+    const char *_data[2];
+    size_t _size[2];
+    int _readBlock, _sendBlock;
+    bool _sending;
+};
+
+#endif	/* FILESTREAMER_H */
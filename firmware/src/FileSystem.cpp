@@ -29,3 +29,23 @@ MountDrive::~MountDrive()
         SYS_FS_Unmount(Name());
     --_mountCount;
 }
+
+volatile int LockDrive::_lockCount;
+
+LockDrive::LockDrive()
+{
+    DisableInterrupts di;
+    ++_lockCount;
+}
+
+LockDrive::~LockDrive()
+{
+    DisableInterrupts di;
+    --_lockCount;
+}
+
+// The USB MSD driver's media attached check (see usb_device_init_data.c)
+extern "C" bool DiskIsAttached(const DRV_HANDLE handle)
+{
+    return !LockDrive::Locked() && DRV_MEMORY_IsAttached(handle);
+}
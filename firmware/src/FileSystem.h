@@ -20,5 +20,25 @@ private:
     static int _mountCount;
 };
 
+/******************************************************************************
+CLASS LockDrive -- keep USB off the internal drive
+DESCRIPTION
+    While one of these exists, the USB mass storage driver is told the drive
+    isn't there, so the host can't write the image while we read it in place
+    (see FlashFile). Each new command from the host checks, so a write the
+    host had already started still finishes.
+******************************************************************************/
+class LockDrive
+{
+public:
+    LockDrive();
+    ~LockDrive();
+    
+    static bool Locked() {return _lockCount != 0;}
+    
+private:
+    static volatile int _lockCount;
+};
+
 #endif	/* FILESYSTEM_H */
 
@@ -0,0 +1,207 @@
+/*
+ * File:   FlashFile.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 8:40 AM
+ */
+
+#include <string.h>
+#include <ctype.h>
+#include "FlashFile.h"
+
+#define DIR_ENTRY_SIZE      32
+#define ATTR_VOLUME_ID      0x08
+#define ATTR_DIRECTORY      0x10
+#define ATTR_LONG_NAME      0x0f
+#define ENTRY_DELETED       0xe5
+
+static inline uint32_t Get16(const uint8_t *p) {return p[0] | (p[1] << 8);}
+static inline uint32_t Get32(const uint8_t *p) {return Get16(p) | (Get16(p + 2) << 16);}
+
+// Convert "name.ext" to the space-padded, upper case 11 character form used
+// in directory entries. Returns false if it isn't a valid 8.3 name.
+static bool MakeShortName(const char *name, char shortName[11])
+{
+    memset(shortName, ' ', 11);
+    int i = 0;
+    for (; *name && *name != '.'; ++name)
+    {
+        if (i == 8)
+            return false;
+        shortName[i++] = toupper(*name);
+    }
+    if (i == 0)
+        return false;
+    if (*name == '.')
+    {
+        ++name;
+        for (i = 8; *name; ++name)
+        {
+            if (i == 11)
+                return false;
+            shortName[i++] = toupper(*name);
+        }
+    }
+    return true;
+}
+
+/******************************************************************************
+FUNCTION GetLayout -- work out where everything is from the boot sector
+RETURNS
+    false if the image doesn't hold a FAT12 or FAT16 file system we can read
+******************************************************************************/
+bool FlashFile::GetLayout(Layout &layout) const
+{
+    if (_imageSize < 512 || _image[510] != 0x55 || _image[511] != 0xaa)
+        return false;
+
+    uint32_t bytesPerSector = Get16(_image + 11);
+    uint32_t sectorsPerCluster = _image[13];
+    uint32_t reservedSectors = Get16(_image + 14);
+    uint32_t fats = _image[16];
+    uint32_t totalSectors = Get16(_image + 19);
+    if (totalSectors == 0)
+        totalSectors = Get32(_image + 32);
+    uint32_t sectorsPerFAT = Get16(_image + 22);
+    if (bytesPerSector == 0 || sectorsPerCluster == 0 || fats == 0 || sectorsPerFAT == 0)
+        return false;
+
+    layout.bytesPerCluster = bytesPerSector * sectorsPerCluster;
+    layout.rootEntries = Get16(_image + 17);
+    layout.fatOffset = reservedSectors * bytesPerSector;
+    layout.rootOffset = layout.fatOffset + fats * sectorsPerFAT * bytesPerSector;
+    uint32_t rootBytes = layout.rootEntries * DIR_ENTRY_SIZE;
+    layout.dataOffset = layout.rootOffset +
+        (rootBytes + bytesPerSector - 1) / bytesPerSector * bytesPerSector;
+
+    // The image may be smaller than the volume claims; only what's really
+    // there is usable
+    uint32_t volumeBytes = totalSectors * bytesPerSector;
+    if (volumeBytes > _imageSize)
+        volumeBytes = _imageSize;
+    if (layout.dataOffset >= volumeBytes)
+        return false;
+    layout.clusterCount = (volumeBytes - layout.dataOffset) / layout.bytesPerCluster;
+
+    // The cluster count alone decides the FAT type
+    if (layout.clusterCount >= 65525)
+        return false;
+    layout.fat16 = layout.clusterCount >= 4085;
+    return true;
+}
+
+/******************************************************************************
+FUNCTION NextCluster -- look up a cluster's successor in the first FAT
+RETURNS
+    The next cluster number, or 0 at the end of the chain (or if the entry
+    isn't a valid link)
+******************************************************************************/
+uint32_t FlashFile::NextCluster(const Layout &layout, uint32_t cluster) const
+{
+    uint32_t next;
+    if (layout.fat16)
+    {
+        next = Get16(_image + layout.fatOffset + cluster * 2);
+    }
+    else
+    {
+        // FAT12 entries are 12 bits, packed two to three bytes
+        next = Get16(_image + layout.fatOffset + cluster + cluster / 2);
+        next = (cluster & 1) ? next >> 4 : next & 0xfff;
+    }
+
+    // Data clusters run from 2; everything above that is bad or end of chain
+    if (next < 2 || next >= layout.clusterCount + 2)
+        return 0;
+    return next;
+}
+
+/******************************************************************************
+FUNCTION FollowChain -- turn a cluster chain into spans of the image
+RETURNS
+    false if the chain ends before the file does, or loops
+******************************************************************************/
+bool FlashFile::FollowChain(const Layout &layout, uint32_t cluster, uint32_t size)
+{
+    uint32_t remaining = size;
+    while (remaining)
+    {
+        if (cluster < 2 || cluster >= layout.clusterCount + 2)
+            return false;
+
+        const uint8_t *data = _image + layout.dataOffset + (cluster - 2) * layout.bytesPerCluster;
+        uint32_t bytes = remaining < layout.bytesPerCluster ? remaining : layout.bytesPerCluster;
+
+        // A chain that comes back to a cluster it's had loops. Files are
+        // rarely in more than a few spans, so looking through them is cheap.
+        for (const FlashSpan &span : _spans)
+            if (data >= span.data && data < span.data + span.size)
+                return false;
+
+        // Extend the last span if this cluster follows on from it
+        if (!_spans.empty() && _spans.back().data + _spans.back().size == data)
+            _spans.back().size += bytes;
+        else
+            _spans.push_back({data, bytes});
+
+        remaining -= bytes;
+        if (remaining)
+            cluster = NextCluster(layout, cluster);
+    }
+    return true;
+}
+
+bool FlashFile::Open(const char *name)
+{
+    Close();
+
+    Layout layout;
+    char shortName[11];
+    if (!GetLayout(layout) || !MakeShortName(name, shortName))
+        return false;
+
+    for (uint32_t i = 0; i < layout.rootEntries; ++i)
+    {
+        const uint8_t *entry = _image + layout.rootOffset + i * DIR_ENTRY_SIZE;
+        // A zero marks the end of the directory
+        if (entry[0] == 0)
+            break;
+        if (entry[0] == ENTRY_DELETED || entry[11] == ATTR_LONG_NAME ||
+                (entry[11] & (ATTR_VOLUME_ID | ATTR_DIRECTORY)))
+            continue;
+        if (memcmp(entry, shortName, sizeof(shortName)) != 0)
+            continue;
+
+        uint32_t size = Get32(entry + 28);
+        if (layout.dataOffset + (uint64_t) size > _imageSize)
+            return false;
+        // An empty file has no clusters. Give it an empty span so it still
+        // counts as open.
+        if (size == 0)
+        {
+            _spans.push_back({_image + layout.dataOffset, 0});
+            return true;
+        }
+        if (!FollowChain(layout, Get16(entry + 26), size))
+        {
+            Close();
+            return false;
+        }
+        _size = size;
+        return true;
+    }
+    return false;
+}
+
+bool FlashFile::NextSpan(FlashSpan &span)
+{
+    // Skip the placeholder span of an empty file
+    while (_nextSpan < _spans.size())
+    {
+        span = _spans[_nextSpan++];
+        if (span.size)
+            return true;
+    }
+    return false;
+}
+
@@ -0,0 +1,71 @@
+/*
+ * File:   FlashFile.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 8:40 AM
+ */
+
+#ifndef FLASHFILE_H
+#define	FLASHFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+struct FlashSpan
+{
+    const uint8_t *data;
+    size_t size;
+};
+
+/******************************************************************************
+CLASS FlashFile -- read-only, zero-copy access to a file in a FAT disk image
+DESCRIPTION
+    The file system lives in program flash, so a file's bytes can be read in
+    place. Open() looks the file up in the root directory and follows its
+    cluster chain once, merging runs of consecutive clusters into spans of
+    the image. NextSpan() then hands out pointers straight into the image.
+
+    Only FAT12 and FAT16 images and 8.3 names in the root directory are
+    handled; anything else makes Open() fail so the caller can fall back on
+    SYS_FS. Nothing here knows about the PIC32, so it builds on the host.
+    Don't use it while the image may be written: on the PIC32, read the
+    uncached (KVA1) image and hold a LockDrive to keep USB off it.
+******************************************************************************/
+class FlashFile
+{
+public:
+    FlashFile(const uint8_t *image, size_t imageSize) :
+        _image(image), _imageSize(imageSize), _size(0), _nextSpan(0) {}
+
+    bool Open(const char *name);
+    void Close() {_spans.clear(); _size = 0; _nextSpan = 0;}
+    bool IsOpen() const {return !_spans.empty();}
+
+    size_t Size() const {return _size;}
+    void Rewind() {_nextSpan = 0;}
+    bool NextSpan(FlashSpan &span);
+
+private:
+    struct Layout
+    {
+        uint32_t bytesPerCluster;
+        uint32_t fatOffset, rootOffset, dataOffset;
+        uint32_t rootEntries;
+        uint32_t clusterCount;
+        bool fat16;
+    };
+
+    bool GetLayout(Layout &layout) const;
+    uint32_t NextCluster(const Layout &layout, uint32_t cluster) const;
+    bool FollowChain(const Layout &layout, uint32_t cluster, uint32_t size);
+
+    const uint8_t *_image;
+    size_t _imageSize;
+    std::vector<FlashSpan> _spans;
+    size_t _size;
+    size_t _nextSpan;
+};
+
+#endif	/* FLASHFILE_H */
+
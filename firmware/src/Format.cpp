@@ -0,0 +1,199 @@
+/*
+ * File:   Format.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:35 AM
+ */
+
+#include "Format.h"
+
+static const char digitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/******************************************************************************
+FUNCTION Digits -- write a number's digits, backwards
+DESCRIPTION
+    Writes the digits so they end just before end, and returns where they
+    start. value 0 is one digit.
+******************************************************************************/
+static char *Digits(char *end, uint32_t value)
+{
+    while (value >= 100)
+    {
+        const char *pair = &digitPairs[(value % 100) * 2];
+        value /= 100;
+        *--end = pair[1];
+        *--end = pair[0];
+    }
+    if (value >= 10)
+    {
+        *--end = digitPairs[value * 2 + 1];
+        *--end = digitPairs[value * 2];
+    }
+    else
+        *--end = char('0' + value);
+    return end;
+}
+
+// Copy what Digits made, after padding it out to width
+static char *Pad(char *p, const char *digits, const char *end, int width, char pad)
+{
+    for (int n = width - int(end - digits); n > 0; --n)
+        *p++ = pad;
+    while (digits < end)
+        *p++ = *digits++;
+    *p = 0;
+    return p;
+}
+
+char *FormatUnsigned(char *p, uint32_t value, int width, char pad)
+{
+    char buf[10];
+    char *end = buf + sizeof(buf);
+    return Pad(p, Digits(end, value), end, width, pad);
+}
+
+char *FormatInt(char *p, int32_t value, int width, char pad)
+{
+    if (value >= 0)
+        return FormatUnsigned(p, uint32_t(value), width, pad);
+
+    char buf[11];
+    char *end = buf + sizeof(buf);
+    char *digits = Digits(end, -uint32_t(value));
+    if (pad == '0')
+    {
+        *p++ = '-';
+        return Pad(p, digits, end, width - 1, pad);
+    }
+    *--digits = '-';
+    return Pad(p, digits, end, width, pad);
+}
+
+/******************************************************************************
+FUNCTION FormatFixed -- write a fixed to some decimal places
+DESCRIPTION
+    The whole part is one 64-bit division, and everything after that's
+    32-bit. A fixed's whole part can be bigger than 32 bits, so that's
+    written as two numbers.
+******************************************************************************/
+char *FormatFixed(char *p, fixed value, int decimals)
+{
+    static const uint32_t pow10[] = {1, 10, 100, 1000, 10000, 100000,
+        1000000, 10000000, 100000000, 1000000000};
+    const uint32_t scale = uint32_t(fixed::scale);
+    if (decimals < 0)
+        decimals = 0;
+    else if (decimals > fixed::fraction_digits)
+        decimals = fixed::fraction_digits;
+
+    int64_t raw = value.raw();
+    if (raw < 0)
+        *p++ = '-';
+    uint64_t magnitude = raw < 0 ? -uint64_t(raw) : uint64_t(raw);
+
+    // Round at the last place kept
+    magnitude += scale / pow10[decimals] / 2;
+    uint64_t whole = magnitude / scale;
+    uint32_t fraction = uint32_t(magnitude - whole * scale) / (scale / pow10[decimals]);
+
+    if (whole >= 1000000000)
+    {
+        p = FormatUnsigned(p, uint32_t(whole / 1000000000));
+        p = FormatUnsigned(p, uint32_t(whole % 1000000000), 9);
+    }
+    else
+        p = FormatUnsigned(p, uint32_t(whole));
+    if (decimals == 0)
+        return p;
+    *p++ = '.';
+    return FormatUnsigned(p, fraction, decimals);
+}
+
+/******************************************************************************
+FUNCTION FormatEngineering -- write a fixed with an SI prefix
+DESCRIPTION
+    The prefix is chosen from the number's top digit, so there are one to
+    three digits before the point. The number's rounded once, to digits
+    figures, all in integers. If that carries into another digit, as
+    999.9999 does, it's moved along a place, and into the next prefix up
+    if there are then four digits before the point.
+******************************************************************************/
+char *FormatEngineering(char *p, fixed value, int digits, const char *units)
+{
+    // Micro is UTF8_MU
+    static const char *const prefixes[] = {"n", "\xCE\xBC", "m", "", "k", "M", "G"};
+    if (digits < 3)
+        digits = 3;
+    else if (digits > 9)
+        digits = 9;
+
+    int64_t raw = value.raw();
+    if (raw < 0)
+        *p++ = '-';
+    uint64_t magnitude = raw < 0 ? -uint64_t(raw) : uint64_t(raw);
+    if (magnitude == 0)
+        return FormatText(FormatText(p, "0 "), units);
+
+    // The top digit is worth 10^exponent, -9 to 9
+    int places = 1;
+    for (uint64_t t = magnitude; t >= 10; t /= 10)
+        ++places;
+    int exponent = places - 1 - fixed::fraction_digits;
+    int group = exponent >= 0 ? exponent / 3 * 3 : -((2 - exponent) / 3 * 3);
+    int wholeDigits = exponent - group + 1;
+
+    uint64_t figures = magnitude;
+    for (int i = places; i < digits; ++i)
+        figures *= 10;
+    if (places > digits)
+    {
+        uint64_t divisor = 1;
+        for (int i = digits; i < places; ++i)
+            divisor *= 10;
+        figures = (figures + divisor / 2) / divisor;
+    }
+    uint32_t limit = 1;
+    for (int i = 0; i < digits; ++i)
+        limit *= 10;
+    if (figures >= limit)
+    {
+        figures /= 10;
+        if (++wholeDigits > 3)
+        {
+            wholeDigits = 1;
+            group += 3;
+        }
+    }
+
+    int decimals = digits - wholeDigits;
+    uint32_t scale = 1;
+    for (int i = 0; i < decimals; ++i)
+        scale *= 10;
+    p = FormatUnsigned(p, uint32_t(figures / scale));
+    if (decimals)
+    {
+        *p++ = '.';
+        p = FormatUnsigned(p, uint32_t(figures % scale), decimals);
+    }
+    *p++ = ' ';
+    p = FormatText(p, prefixes[group / 3 + 3]);
+    return FormatText(p, units);
+}
+
+char *FormatText(char *p, const char *text)
+{
+    while (*text)
+        *p++ = *text++;
+    *p = 0;
+    return p;
+}
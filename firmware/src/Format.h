@@ -0,0 +1,50 @@
+/*
+ * File:   Format.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:35 AM
+ */
+
+#ifndef FORMAT_H
+#define	FORMAT_H
+
+#include <stdint.h>
+#include "fixed.h"
+
+/******************************************************************************
+Format -- numbers to text without printf
+DESCRIPTION
+    sprintf has to parse its format string on every call, and takes its
+    arguments through va_args, which is most of its time for the short
+    status texts and spinner fields the tools format. These do one thing
+    each. Digits are made two at a time from a table, so a 32-bit number
+    costs at most five divisions by 100, which the compiler turns into
+    multiplies.
+
+    Each writes at p, adds a NUL, and returns a pointer to the NUL, so they
+    chain, like this for "%03u.%02u Hz":
+
+        char *p = FormatUnsigned(buf, whole, 3);
+        p = FormatText(p, ".");
+        p = FormatUnsigned(p, hundredths, 2);
+        FormatText(p, " Hz");
+
+    A width is a minimum, as in printf: bigger numbers aren't cut off.
+
+    Nothing here knows about the PIC32, so it builds on the host.
+******************************************************************************/
+
+// Decimal, padded on the left with pad to at least width characters
+char *FormatUnsigned(char *p, uint32_t value, int width = 0, char pad = '0');
+// Decimal with a - if it's negative. With '0' padding the - comes first,
+// as with %05d.
+char *FormatInt(char *p, int32_t value, int width = 0, char pad = ' ');
+// Decimal with decimals places after the point (at most 9), rounded to
+// nearest, as with %.*f
+char *FormatFixed(char *p, fixed value, int decimals);
+// To digits significant figures (3 to 9) with an SI prefix from n to G,
+// then units, as eng() does: "1.000000 kHz"
+char *FormatEngineering(char *p, fixed value, int digits, const char *units);
+char *FormatText(char *p, const char *text);
+
+#endif	/* FORMAT_H */
@@ -10,6 +10,7 @@ extern "C"
 #include "definitions.h"
 }
 #include "Utility.h"
+#include "Format.h"
 #include "FrequencyPeriodSpinWidget.h"
 
 std::string FrequencyPeriodSpinWidget::ToString(int cursorPos) const
@@ -37,23 +38,23 @@ std::string FrequencyPeriodSpinWidget::ToString(int cursorPos) const
         int rightmostDigit;
         if (_editMode == Frequency)
         {
-            int len = sprintf(buf, "%03u,%03u,%03u.%02u Hz", 
-                    int(*_freq / 1000000),
-                    int(*_freq / 1000 % 1000),
-                    int(*_freq % 1000),
-                    int(*_freq % 1 * 100));
-            rightmostDigit = len - 4;
+            char *p = FormatUnsigned(buf, int(*_freq / 1000000), 3);
+            p = FormatUnsigned(FormatText(p, ","), int(*_freq / 1000 % 1000), 3);
+            p = FormatUnsigned(FormatText(p, ","), int(*_freq % 1000), 3);
+            p = FormatUnsigned(FormatText(p, "."), int(*_freq % 1 * 100), 2);
+            p = FormatText(p, " Hz");
+            rightmostDigit = int(p - buf) - 4;
             s = buf;
         }
         else
         {
             fixed period = 1 / *_freq;
-            int len = sprintf(buf, "%02u.%03u %03u %03u s", 
-                    int(period),
-                    int(period * 1000 % 1000),
-                    int(period * 1000000 % 1000),
-                    int(period * 1000000000 % 1000));
-            rightmostDigit = len - 3;
+            char *p = FormatUnsigned(buf, int(period), 2);
+            p = FormatUnsigned(FormatText(p, "."), int(period * 1000 % 1000), 3);
+            p = FormatUnsigned(FormatText(p, " "), int(period * 1000000 % 1000), 3);
+            p = FormatUnsigned(FormatText(p, " "), int(period * 1000000000 % 1000), 3);
+            p = FormatText(p, " s");
+            rightmostDigit = int(p - buf) - 3;
             s = buf;
         }
         int strPos = rightmostDigit;
@@ -6,6 +6,7 @@
  */
 
 #include "Utility.h"
+#include "Format.h"
 #include "GPSCoordSpinWidget.h"
 
 std::string GPSCoordSpinWidget::ToString(int cursorPos) const
@@ -16,18 +17,15 @@ std::string GPSCoordSpinWidget::ToString(int cursorPos) const
         posVal = -posVal;
     int32_t deg = posVal / 10000;
     int32_t frac = posVal % 10000;
-    // For some reason, sprintf is crashing when we pass it a width field on %d.
-    // So we manually do the field width here
     if (*_coord == 0)
         *b++ = ' ';
     else if (*_coord < 0)
         *b++ = '-';
     else
         *b++ = '+';
-    b += LeadingChars(b, deg, _latLong == Latitude ? 10 : 100, (cursorPos < 0) ? ' ' : '0');
-    b += sprintf(b, "%d.", deg);
-    b += LeadingChars(b, frac, 1000, '0');
-    sprintf(b, "%d" UTF8_DEGREES, frac);
+    b = FormatUnsigned(b, deg, _latLong == Latitude ? 2 : 3, (cursorPos < 0) ? ' ' : '0');
+    b = FormatUnsigned(FormatText(b, "."), frac, 4);
+    FormatText(b, UTF8_DEGREES);
     
     if (cursorPos != -1)
     {
@@ -69,16 +67,4 @@ void GPSCoordSpinWidget::Increment(int cursorPos, bool increment)
             newValue = -*_coord;
     }
     *_coord = newValue;
-}
-
-int GPSCoordSpinWidget::LeadingChars(char *b, int32_t val, int place, char leadingChar)
-{
-    int cnt = 0;
-    while (val < place && place >= 10)
-    {
-        *b++ = leadingChar;
-        place /= 10;
-        ++cnt;
-    }
-    return cnt;
 }
\ No newline at end of file
@@ -27,8 +27,6 @@ public:
 private:
     int32_t *_coord;
     Coord _latLong;
-    
-    static int LeadingChars(char *b, int32_t val, int place, char leadingChar);
 
     GPSCoordSpinWidget(const GPSCoordSpinWidget& orig);
 };
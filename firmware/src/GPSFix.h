@@ -0,0 +1,35 @@
+/*
+ * File:   GPSFix.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 8:50 AM
+ */
+
+#ifndef GPSFIX_H
+#define	GPSFIX_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Everything the simulated receiver reports for one fix. The NMEA sentences
+// and the UBX messages are both built from this.
+struct GPSFix
+{
+    time_t time;                // UTC
+    uint16_t ms;                // Milliseconds into the second
+    // The date of time, kept up to date along with it
+    uint16_t year;
+    uint8_t month, day;
+    
+    int32_t latitude, longitude;    // 1/10000ths of a degree
+    int32_t altitude;           // Above mean sea level, mm
+    int32_t geoidSeparation;    // Mean sea level above the ellipsoid, mm
+    uint32_t speed;             // Over the ground, mm/s
+    uint16_t course;            // Tenths of a degree from true north
+    
+    uint8_t satellites;
+    uint16_t hdop, pdop;        // Hundredths
+};
+
+#endif	/* GPSFIX_H */
+
@@ -61,6 +61,21 @@ void GPSPane::SetTime(time_t newTime)
         _timeWidget.UpdateText();
 }
 
+void GPSPane::SetLocation(int32_t latitude, int32_t longitude)
+{
+    if (latitude != _latitude)
+    {
+        _latitude = latitude;
+        _latWidget.UpdateText();
+    }
+    if (longitude != _longitude)
+    {
+        _longitude = longitude;
+        _longWidget.UpdateText();
+    }
+    Update();
+}
+
 laWidget *GPSPane::GetWidget() const
 {
     return GPSPanel;
@@ -46,6 +46,8 @@ public:
     }
     
     void SetTime(time_t newTime);
+    // Move to a new location without editing, e.g. when playing a track
+    void SetLocation(int32_t latitude, int32_t longitude);
     
     time_t GetTime() const {return _time;}
     int32_t GetLatitude() const {return _latitude;}
@@ -55,6 +57,7 @@ public:
     void ShowTerminal();
     
     void SetOutputText(const std::string &text) {_terminal.SetText(text.c_str(), text.size());}
+    void SetOutputText(const char *text, size_t size) {_terminal.SetText(text, size);}
     
 protected:
     virtual laWidget *GetWidget() const;
@@ -0,0 +1,142 @@
+/*
+ * File:   HeapTelemetry.c
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:30 AM
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "HeapTelemetry.h"
+
+#define LIVE 0xa10c
+#define FREED 0xf4ee
+
+void HeapTelemetryInit(HeapTelemetry *t)
+{
+    memset(t, 0, sizeof(*t));
+}
+
+static int FindSite(HeapTelemetry *t, uintptr_t address)
+{
+    // Code addresses are word aligned
+    uint32_t hash = (uint32_t) (address >> 2) * 2654435761u;
+    int slot = (int) (hash >> 26);      // HEAP_TELEMETRY_SITES is 2^6
+    for (int i = 0; i < HEAP_TELEMETRY_PROBES; ++i)
+    {
+        // Slot 0 is everything else
+        if (slot == 0)
+            slot = 1;
+        HeapSite *site = &t->sites[slot];
+        if (site->address == address)
+            return slot;
+        if (site->address == 0)
+        {
+            site->address = address;
+            return slot;
+        }
+        slot = (slot + 1) & (HEAP_TELEMETRY_SITES - 1);
+    }
+    return 0;
+}
+
+void HeapTelemetryAlloc(HeapTelemetry *t, HeapTelemetryHeader *h, size_t size, uintptr_t site, size_t blockSize)
+{
+    int slot = FindSite(t, site);
+    HeapSite *s = &t->sites[slot];
+    h->size = (uint32_t) size;
+    h->site = (uint16_t) slot;
+    h->check = LIVE;
+
+    ++s->allocs;
+    ++s->liveCount;
+    s->liveBytes += (uint32_t) size;
+    if (s->liveBytes > s->peakBytes)
+        s->peakBytes = s->liveBytes;
+
+    ++t->liveCount;
+    t->liveBytes += (uint32_t) size;
+    t->blockBytes += (uint32_t) blockSize;
+    if (t->liveBytes > t->peakBytes)
+        t->peakBytes = t->liveBytes;
+}
+
+bool HeapTelemetryFree(HeapTelemetry *t, HeapTelemetryHeader *h, size_t blockSize)
+{
+    if (h->check != LIVE || h->site >= HEAP_TELEMETRY_SITES)
+    {
+        ++t->badFrees;
+        return false;
+    }
+    h->check = FREED;
+
+    HeapSite *s = &t->sites[h->site];
+    ++s->frees;
+    --s->liveCount;
+    s->liveBytes -= h->size;
+
+    --t->liveCount;
+    t->liveBytes -= h->size;
+    t->blockBytes -= (uint32_t) blockSize;
+    return true;
+}
+
+void HeapTelemetryCheckpoint(HeapTelemetry *t)
+{
+    for (int i = 0; i < HEAP_TELEMETRY_SITES; ++i)
+    {
+        const HeapSite *s = &t->sites[i];
+        t->changes[i].count = (int32_t) (s->liveCount - t->markCount[i]);
+        t->changes[i].bytes = (int32_t) (s->liveBytes - t->markBytes[i]);
+        t->markCount[i] = s->liveCount;
+        t->markBytes[i] = s->liveBytes;
+    }
+    ++t->checkpoints;
+}
+
+void HeapTelemetryReset(HeapTelemetry *t)
+{
+    for (int i = 0; i < HEAP_TELEMETRY_SITES; ++i)
+    {
+        HeapSite *s = &t->sites[i];
+        s->allocs = s->frees = 0;
+        s->peakBytes = s->liveBytes;
+    }
+    t->peakBytes = t->liveBytes;
+    t->badFrees = 0;
+}
+
+void HeapTelemetryPrintTotals(const HeapTelemetry *t)
+{
+    // How much of what's held is rounding and headers, in tenths of a percent
+    uint32_t waste = t->blockBytes ? (uint32_t) ((uint64_t) (t->blockBytes - t->liveBytes) * 1000 / t->blockBytes) : 0;
+    printf("\r\nLive %u bytes in %u blocks, peak %u; blocks hold %u (%u.%u%% waste); %u bad frees\r\n",
+        (unsigned) t->liveBytes, (unsigned) t->liveCount, (unsigned) t->peakBytes,
+        (unsigned) t->blockBytes, (unsigned) (waste / 10), (unsigned) (waste % 10), (unsigned) t->badFrees);
+    printf("Site           Allocs     Frees    Live     Bytes      Peak\r\n");
+}
+
+void HeapTelemetryPrintSite(const HeapTelemetry *t, int index)
+{
+    const HeapSite *s = &t->sites[index];
+    if (s->allocs == 0 && s->liveCount == 0)
+        return;
+    if (index == 0)
+        printf("(others)  ");
+    else
+        printf("0x%08lx", (unsigned long) s->address);
+    printf(" %11u %9u %7u %9u %9u\r\n", (unsigned) s->allocs, (unsigned) s->frees,
+        (unsigned) s->liveCount, (unsigned) s->liveBytes, (unsigned) s->peakBytes);
+}
+
+void HeapTelemetryPrintChange(const HeapTelemetry *t, int index)
+{
+    const HeapSiteChange *c = &t->changes[index];
+    if (c->count == 0 && c->bytes == 0)
+        return;
+    if (index == 0)
+        printf("(others)  ");
+    else
+        printf("0x%08lx", (unsigned long) t->sites[index].address);
+    printf(" %+d blocks, %+d bytes\r\n", (int) c->count, (int) c->bytes);
+}
@@ -0,0 +1,110 @@
+/*
+ * File:   HeapTelemetry.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:30 AM
+ */
+
+#ifndef HEAPTELEMETRY_H
+#define	HEAPTELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/******************************************************************************
+Heap telemetry -- who's allocating, what's live, and what's been left behind
+DESCRIPTION
+    Each allocation is counted against its call site, the address it was
+    called from. Each allocation also gets a header, which says how big it
+    was and which site it came from, so freeing it can be counted without
+    searching. The header also has a check value, which catches frees of
+    things that weren't allocated or were already freed.
+
+    Sites get a slot the first time they're seen. The slot is found by
+    hashing the address and probing a few slots from there. When those are
+    all taken, the allocation goes to slot 0, which is "everything else".
+    So every call costs the same, however many sites there are.
+
+    For each site there's the number of allocations and frees, and what's
+    live now and at most. The totals also keep the bytes in the blocks the
+    allocations really got, so the waste from rounding up shows as internal
+    fragmentation.
+
+    A checkpoint compares what's live at each site with the last checkpoint
+    and keeps the difference. Taken at each tool switch, after the old tool
+    has been deleted, the difference is whatever that tool left behind.
+
+    Nothing here knows about the PIC32, so it builds on the host. It isn't
+    safe against being interrupted, so the caller disables interrupts
+    around each call if ISRs allocate.
+******************************************************************************/
+
+#define HEAP_TELEMETRY_SITES 64
+#define HEAP_TELEMETRY_PROBES 8
+
+// In front of each allocation. 8 bytes, so allocations stay aligned.
+typedef struct
+{
+    uint32_t size;          // As asked for
+    uint16_t site;          // Slot
+    uint16_t check;
+} HeapTelemetryHeader;
+
+typedef struct
+{
+    uintptr_t address;      // 0 for a slot that's free, and for slot 0
+    uint32_t allocs, frees;
+    uint32_t liveCount, liveBytes;
+    uint32_t peakBytes;
+} HeapSite;
+
+typedef struct
+{
+    int32_t count, bytes;
+} HeapSiteChange;
+
+typedef struct
+{
+    HeapSite sites[HEAP_TELEMETRY_SITES];
+
+    uint32_t liveCount, liveBytes, peakBytes;
+    uint32_t blockBytes;    // Held by live allocations, including rounding
+    uint32_t badFrees;      // Not allocated, or freed already
+
+    // What was live at each site at the last checkpoint, and the
+    // difference between that and the one before
+    uint32_t markCount[HEAP_TELEMETRY_SITES], markBytes[HEAP_TELEMETRY_SITES];
+    HeapSiteChange changes[HEAP_TELEMETRY_SITES];
+    int checkpoints;
+} HeapTelemetry;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+void HeapTelemetryInit(HeapTelemetry *t);
+
+// Count an allocation of size bytes from site, in a block of blockSize
+// bytes (header included). Fills in the header.
+void HeapTelemetryAlloc(HeapTelemetry *t, HeapTelemetryHeader *h, size_t size, uintptr_t site, size_t blockSize);
+// Count a free. Returns false, and counts nothing, if the header isn't one
+// that's live, in which case the block mustn't be freed.
+bool HeapTelemetryFree(HeapTelemetry *t, HeapTelemetryHeader *h, size_t blockSize);
+
+void HeapTelemetryCheckpoint(HeapTelemetry *t);
+// Zero the counts and bring the peaks down to what's live now
+void HeapTelemetryReset(HeapTelemetry *t);
+
+// Print the totals, a site, or a site's change at the last checkpoint.
+// Sites with nothing to show print nothing.
+void HeapTelemetryPrintTotals(const HeapTelemetry *t);
+void HeapTelemetryPrintSite(const HeapTelemetry *t, int index);
+void HeapTelemetryPrintChange(const HeapTelemetry *t, int index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* HEAPTELEMETRY_H */
@@ -0,0 +1,140 @@
+/*
+ * File:   InterruptStats.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:15 AM
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "InterruptStats.h"
+
+void InterruptStats::Reset()
+{
+    memset(_stats, 0, sizeof(_stats));
+    memset(_slots, 0, sizeof(_slots));
+    _slotCount = 0;
+    _depth = 0;
+    _skipped = 0;
+    _overflow = 0;
+}
+
+int InterruptStats::Bucket(uint32_t ticks)
+{
+    int bucket = ticks ? 32 - __builtin_clz(ticks) : 0;
+    return bucket < INTERRUPT_STATS_BUCKETS ? bucket : INTERRUPT_STATS_BUCKETS - 1;
+}
+
+int InterruptStats::Slot(int vector)
+{
+    if (vector < 0 || vector >= INTERRUPT_STATS_VECTORS)
+        return -1;
+    if (_slots[vector])
+        return _slots[vector] - 1;
+    if (_slotCount == INTERRUPT_STATS_SLOTS)
+        return -1;
+
+    InterruptVectorStats &stats = _stats[_slotCount];
+    stats.vector = vector;
+    stats.minTicks = UINT32_MAX;
+    stats.minInterval = UINT32_MAX;
+    _slots[vector] = uint8_t(++_slotCount);
+    return _slotCount - 1;
+}
+
+void InterruptStats::Enter(int vector, uint32_t now)
+{
+    if (_depth == INTERRUPT_STATS_DEPTH)
+    {
+        // Can't happen with one level per priority, but don't run off the end
+        ++_overflow;
+        ++_skipped;
+        return;
+    }
+    if (_depth > 0 && _stack[_depth - 1].slot >= 0)
+        ++_stats[_stack[_depth - 1].slot].preempted;
+
+    int slot = Slot(vector);
+    if (slot >= 0)
+    {
+        InterruptVectorStats &stats = _stats[slot];
+        if (stats.count)
+        {
+            uint32_t interval = now - stats.lastEntry;
+            if (interval < stats.minInterval)
+                stats.minInterval = interval;
+            if (interval > stats.maxInterval)
+                stats.maxInterval = interval;
+        }
+        stats.lastEntry = now;
+    }
+    else
+        ++_overflow;
+
+    _stack[_depth++] = {slot, now, 0};
+}
+
+void InterruptStats::Exit(uint32_t now)
+{
+    if (_skipped)
+    {
+        --_skipped;
+        return;
+    }
+    if (_depth == 0)
+        return;
+
+    const Frame &frame = _stack[--_depth];
+    uint32_t elapsed = now - frame.start;
+    if (_depth > 0)
+        _stack[_depth - 1].nested += elapsed;
+    if (frame.slot < 0)
+        return;
+
+    InterruptVectorStats &stats = _stats[frame.slot];
+    uint32_t ticks = elapsed - frame.nested;
+    ++stats.count;
+    stats.totalTicks += ticks;
+    if (ticks < stats.minTicks)
+        stats.minTicks = ticks;
+    if (ticks > stats.maxTicks)
+        stats.maxTicks = ticks;
+    ++stats.histogram[Bucket(ticks)];
+}
+
+const InterruptVectorStats *InterruptStats::Get(int index) const
+{
+    return index >= 0 && index < _slotCount ? _stats + index : nullptr;
+}
+
+static uint32_t TicksToNs(uint64_t ticks, uint32_t ticksPerUs)
+{
+    return uint32_t(ticks * 1000 / ticksPerUs);
+}
+
+void InterruptStats::Print(const InterruptVectorStats &s, uint32_t ticksPerUs)
+{
+    if (!s.count)
+    {
+        printf("Vector %d: no calls\r\n", s.vector);
+        return;
+    }
+
+    printf("Vector %d: %u calls, min %uns, avg %uns, max %uns, preempted %u\r\n ",
+        s.vector, s.count, TicksToNs(s.minTicks, ticksPerUs),
+        TicksToNs(s.totalTicks / s.count, ticksPerUs), TicksToNs(s.maxTicks, ticksPerUs),
+        s.preempted);
+    if (s.count > 1)
+    {
+        printf(" interval %uns..%uns\r\n ", TicksToNs(s.minInterval, ticksPerUs),
+            TicksToNs(s.maxInterval, ticksPerUs));
+    }
+    for (int i = 0; i < INTERRUPT_STATS_BUCKETS; ++i)
+    {
+        if (s.histogram[i] && i == INTERRUPT_STATS_BUCKETS - 1)
+            printf(" >=%uns:%u", TicksToNs(1u << (i - 1), ticksPerUs), s.histogram[i]);
+        else if (s.histogram[i])
+            printf(" <%uns:%u", TicksToNs(1u << i, ticksPerUs), s.histogram[i]);
+    }
+    printf("\r\n");
+}
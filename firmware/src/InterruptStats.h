@@ -0,0 +1,90 @@
+/*
+ * File:   InterruptStats.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:15 AM
+ */
+
+#ifndef INTERRUPTSTATS_H
+#define	INTERRUPTSTATS_H
+
+#include <stdint.h>
+
+/******************************************************************************
+Interrupt stats -- how long ISRs take and how they get in each other's way
+DESCRIPTION
+    Enter() and Exit() are called at the start and end of each ISR with a
+    timestamp (core timer ticks on the PIC32). ISRs nest, so a stack of the
+    ones running is kept, and an ISR's time doesn't include the time spent
+    in higher priority ISRs that interrupted it. Those are counted as
+    preemptions of the one interrupted.
+
+    For each vector there's the number of calls, the shortest, longest and
+    total time, and a histogram of times. The time between one entry and the
+    next is kept too: for an interrupt that comes regularly, the difference
+    between the shortest and longest is how much its latency varies.
+
+    Vectors get a slot the first time they're seen; once the slots run out,
+    new vectors are only counted in Overflow(). Nothing here knows about the
+    PIC32, so it builds on the host. It isn't safe against being interrupted,
+    so the caller disables interrupts around each call.
+******************************************************************************/
+
+#define INTERRUPT_STATS_VECTORS 256
+#define INTERRUPT_STATS_SLOTS 16
+#define INTERRUPT_STATS_DEPTH 8
+// Bucket n counts ISRs that took [2^(n-1), 2^n) ticks. Bucket 0 is 0 ticks;
+// the last bucket also gets everything longer.
+#define INTERRUPT_STATS_BUCKETS 16
+
+struct InterruptVectorStats
+{
+    int vector;
+    uint32_t count;
+    uint32_t preempted;             // Times a higher priority ISR ran inside this one
+    uint32_t minTicks, maxTicks;    // Time in the ISR, less any ISRs inside it
+    uint64_t totalTicks;
+    uint32_t minInterval, maxInterval;  // Entry to entry
+    uint32_t lastEntry;
+    uint32_t histogram[INTERRUPT_STATS_BUCKETS];
+};
+
+class InterruptStats
+{
+public:
+    InterruptStats() {Reset();}
+
+    void Enter(int vector, uint32_t now);
+    void Exit(uint32_t now);
+    // Only while no ISR is being timed
+    void Reset();
+
+    // The stats for the nth vector seen, or nullptr past the last
+    const InterruptVectorStats *Get(int index) const;
+    uint32_t Overflow() const {return _overflow;}
+    int Depth() const {return _depth;}
+
+    static int Bucket(uint32_t ticks);
+    // Print a vector's stats, with times in ns
+    static void Print(const InterruptVectorStats &stats, uint32_t ticksPerUs);
+
+private:
+    struct Frame
+    {
+        int slot;               // -1 for a vector with no slot
+        uint32_t start;
+        uint32_t nested;        // Ticks spent in ISRs inside this one
+    };
+
+    int Slot(int vector);
+
+    InterruptVectorStats _stats[INTERRUPT_STATS_SLOTS];
+    int _slotCount;
+    uint8_t _slots[INTERRUPT_STATS_VECTORS];    // Slot + 1, or 0 if none
+    Frame _stack[INTERRUPT_STATS_DEPTH];
+    int _depth;
+    int _skipped;               // Entered past the end of the stack
+    uint32_t _overflow;
+};
+
+#endif	/* INTERRUPTSTATS_H */
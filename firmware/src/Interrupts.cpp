@@ -10,6 +10,8 @@ extern "C"
 #include "definitions.h"
 }
 #include "Interrupts.h"
+#include "InterruptStats.h"
+#include "Utility.h"
 
 const SPIIntMeta SPIInt[] = 
 {
@@ -231,3 +233,73 @@ const DMAIntMeta DMAInt[] =
 };
 
 UserInterruptHandler userInterruptHandlers[213];
+
+void InterruptsInitialize()
+{
+    // Priority n uses shadow set n (PRInSS is bits 4n+3..4n). Priority 0
+    // never interrupts, and SS0 is only for single vector mode.
+    PRISS = 0x76543210;
+}
+
+#ifdef INTERRUPT_STATS
+static InterruptStats interruptStats;
+
+// These run at the start and end of the ISR, after the prologue and before
+// the epilogue, so the time saving and restoring registers isn't counted
+void InterruptStatsEnter(int vector)
+{
+    DisableInterrupts di;
+    interruptStats.Enter(vector, _CP0_GET_COUNT());
+}
+
+void InterruptStatsExit()
+{
+    DisableInterrupts di;
+    interruptStats.Exit(_CP0_GET_COUNT());
+}
+
+// Everything's copied with interrupts off, and printed after they're back
+// on, since the console needs its interrupts to go anywhere
+int InterruptStatsDump(int index)
+{
+    InterruptVectorStats stats;
+    uint32_t overflow;
+    bool found, more;
+    {
+        DisableInterrupts di;
+        overflow = interruptStats.Overflow();
+        const InterruptVectorStats *s = interruptStats.Get(index);
+        found = s != nullptr;
+        if (found)
+            stats = *s;
+        more = interruptStats.Get(index + 1) != nullptr;
+    }
+
+    if (index == 0)
+        printf("\r\nInterrupt timing (overflow %u)\r\n", overflow);
+    if (!found)
+    {
+        if (index == 0)
+            printf("No interrupts\r\n");
+        return -1;
+    }
+    InterruptStats::Print(stats, CORETIMER_FrequencyGet() / 1000000);
+    return more ? index + 1 : -1;
+}
+
+void InterruptStatsReset()
+{
+    DisableInterrupts di;
+    interruptStats.Reset();
+}
+#else
+int InterruptStatsDump(int index)
+{
+    printf("\r\nInterrupt timing isn't compiled in (see INTERRUPT_STATS)\r\n");
+    return -1;
+}
+
+void InterruptStatsReset()
+{
+}
+#endif
@@ -65,6 +65,22 @@ struct DMAIntMeta
 
 extern const DMAIntMeta DMAInt[];
 
+// Uncomment to time every ISR made with the macros below. The stats are
+// dumped over the USB console from the Utility tool.
+//#define INTERRUPT_STATS
+
+#ifdef INTERRUPT_STATS
+void InterruptStatsEnter(int vector);
+void InterruptStatsExit();
+#else
+inline void InterruptStatsEnter(int vector) {}
+inline void InterruptStatsExit() {}
+#endif
+// Prints one vector's stats to the console. Returns the next to print, or -1
+// after the last one.
+int InterruptStatsDump(int index);
+void InterruptStatsReset();
+
 // Use this macro to define an interrupt handling routine. It takes two arguments,
 // a vector name (which Microchip declares in their microcontroller .h files),
 // and the interrupt's IntMeta struct
@@ -78,9 +94,11 @@ extern const DMAIntMeta DMAInt[];
 #define Implement_InterruptHandler(v, intMeta) \
 extern "C" void __ISR(v, ipl1AUTO) PIC32_##v##Handler() \
 { \
+    InterruptStatsEnter(v); \
     if (userInterruptHandlers[v].fn) \
         (*userInterruptHandlers[v].fn)(userInterruptHandlers[v].context); \
     intMeta.flag = 0; \
+    InterruptStatsExit(); \
 }
 
 typedef struct
@@ -101,5 +119,78 @@ inline void ClearInterruptHandler(int vectorNumber)
     userInterruptHandlers[vectorNumber].fn = nullptr;
 }
 
+/******************************************************************************
+DirectInterrupt -- an interrupt bound at compile time to a member function
+DESCRIPTION
+    The handlers above go through the userInterruptHandlers table, so the ISR
+    loads a function pointer and a context and calls through them, and with
+    ipl1AUTO it saves and restores every register the call might use. That's
+    fine for most interrupts, but not for the ones that have to keep up with
+    the outside world.
+
+    A DirectInterrupt is keyed on the vector and the owner's type, and names
+    the owner's handler as a template argument, so the ISR calls the handler
+    directly (the compiler can inline it). The ISR runs at its own priority
+    with a shadow register set, so there's nothing to save on the way in.
+    InterruptsInitialize() gives each priority its own shadow set.
+
+    E.g.:
+        typedef DirectInterrupt<_UART3_RX_VECTOR, 5, ToolUART, &ToolUART::ReceiveBytes> UARTReceive;
+        Implement_DirectInterruptHandler(UARTReceive, _UART3_RX_VECTOR, 5, UARTInt[2].receiveDone)
+    and then
+        UARTReceive::Bind(this, UARTInt[2].receiveDone);
+
+    A vector is either bound directly or goes through the table, not both, so
+    the peripheral's .cpp must leave out its Implement_InterruptHandler.
+******************************************************************************/
+template <int v, int level, class Owner, void (Owner::*handler)()>
+class DirectInterrupt
+{
+public:
+    static const int vector = v;
+    static const int priority = level;
+
+    // Send the interrupt to owner. This sets the interrupt's priority to the
+    // one the ISR was built for, so do it after SetInterruptPriorities().
+    static void Bind(Owner *owner, const IntMeta &intMeta)
+    {
+        _owner = owner;
+        intMeta.priority = level;
+        intMeta.subpriority = 0;
+    }
+    static void Unbind() {_owner = nullptr;}
+    static Owner *GetOwner() {return _owner;}
+
+    static inline void Dispatch()
+    {
+        Owner *owner = _owner;
+        if (owner)
+            (owner->*handler)();
+    }
+
+private:
+    static Owner *_owner;
+};
+
+template <int v, int level, class Owner, void (Owner::*handler)()>
+Owner *DirectInterrupt<v, level, Owner, handler>::_owner;
+
+// Use this macro to define the ISR for a DirectInterrupt. The vector and
+// priority have to be given again because the __ISR attribute needs them as
+// literals; they're checked against the binding.
+#define Implement_DirectInterruptHandler(binding, v, level, intMeta) \
+static_assert(binding::vector == v && binding::priority == level, \
+    #binding " is bound to a different vector or priority"); \
+extern "C" void __ISR(v, ipl##level##SRS) PIC32_##v##Handler() \
+{ \
+    InterruptStatsEnter(v); \
+    binding::Dispatch(); \
+    intMeta.flag = 0; \
+    InterruptStatsExit(); \
+}
+
+// Give each interrupt priority its own shadow register set
+void InterruptsInitialize();
+
 #endif	/* INTERRUPTS_H */
 
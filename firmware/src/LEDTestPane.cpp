@@ -10,6 +10,7 @@ extern "C"
 #include "definitions.h"
 }
 #include "Display.h"
+#include "Format.h"
 #include "LEDTestPane.h"
 
 laString *LEDTestPane::_cursor;
@@ -66,11 +67,12 @@ void LEDTestPane::SetCurrentLevel(XY &data)
     
     // Set the text display
     char buf[20];
-    sprintf(buf, "%2dmA", _current.Y / 1000);
+    FormatText(FormatInt(buf, _current.Y / 1000, 2), "mA");
     laString s = laString_CreateFromCharBuffer(buf, &MonoFont);
     laLabelWidget_SetText(mASetting, s);
     laString_Destroy(&s);
-    sprintf(buf, "%d.%dV", _current.X / 1000, _current.X / 100 % 10);
+    char *p = FormatInt(buf, _current.X / 1000);
+    FormatText(FormatInt(FormatText(p, "."), _current.X / 100 % 10), "V");
     s = laString_CreateFromCharBuffer(buf, &MonoFont);
     laLabelWidget_SetText(VfSetting, s);
     laString_Destroy(&s);
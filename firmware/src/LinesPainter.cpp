@@ -17,6 +17,21 @@ LinesPainter::~LinesPainter()
 
 bool LinesPainter::OnDraw(SurfaceWrapper *surface, GFX_Rect *bounds)
 {
+    // Off-screen, we redraw the whole surface so there's nothing to erase
+    Canvas *canvas = BeginCanvas(bounds);
+    if (canvas)
+    {
+        canvas->Clear(0xffff);
+        for (size_t i = 1; i < _points.size(); ++i)
+        {
+            canvas->DrawLine(_points[i - 1].x + _xOffset, _points[i - 1].y + _yOffset, 
+                    _points[i].x + _xOffset, _points[i].y + _yOffset, 0x0);
+        }
+        FlushCanvas(bounds);
+        _previouslyDrawn.clear();
+        return true;
+    }
+    
     // Erase any previously drawn lines
     if (_previouslyDrawn.size())
     {
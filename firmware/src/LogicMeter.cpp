@@ -12,9 +12,12 @@ extern "C"
 }
 #include "Utility.h"
 #include "GPIO.h"
+#include "Interrupts.h"
 #include "LogicMeter.h"
+#include "Malloc.h"
 #include "Display.h"
 #include "Oscillator.h"
+#include "Remote.h"
 #include "Settings.h"
 #include "Tool.h"
 #include "ToolGPS.h"
@@ -66,9 +69,11 @@ void LogicMeterTask()
 }
 
 LogicMeter::LogicMeter() :
-    _currentTool(NULL), _currentSelection(-1), _lastUserInteractionTime(SYS_TIME_CounterGet()), 
+    _currentTool(NULL), _currentSelection(-1), _remote(new RemoteControl(*this)), _remoteSelection(-1),
+    _switchPosition(-1), _restartTool(false), _lastUserInteractionTime(SYS_TIME_CounterGet()), 
     _displayDimmed(true)
 {
+    InterruptsInitialize();
     display.Initialize();
     SettingsInitialize();
     
@@ -79,6 +84,18 @@ LogicMeter::LogicMeter() :
 
 LogicMeter::~LogicMeter() 
 {
+    delete _remote;
+}
+
+int LogicMeter::ToolCount()
+{
+    return int(countof(toolFactories));
+}
+
+void LogicMeter::SelectRemoteTool(int index)
+{
+    _remoteSelection = index;
+    _restartTool = index >= 0;
 }
 
 char exc[100];
@@ -98,17 +115,35 @@ void LogicMeter::Task()
     
     try
     {
-        int newSelection = ReadSelectorSwitch() - 1;
+        _remote->OnIdle();
+        
+        // Turning the switch takes control back from remote control
+        int switchPosition = ReadSelectorSwitch() - 1;
+        bool switchTurned = switchPosition != _switchPosition;
+        if (switchTurned)
+        {
+            _switchPosition = switchPosition;
+            _remoteSelection = -1;
+            _remote->Leave();
+        }
+        int newSelection = _remoteSelection >= 0 ? _remoteSelection : switchPosition;
         
         if (newSelection >= 0)
         {
-            if (_currentSelection != newSelection)
+            if (_currentSelection != newSelection || _restartTool)
             {
+                _restartTool = false;
                 if (_currentTool)
                 {
                     _currentTool->RequestDeactivate();
                 }
+                // USB stays up while tools are switched remotely, but not
+                // once the switch is turned
+                if (switchTurned)
+                    ToolUtility::StopUSB();
                 delete _currentTool;
+                // Whatever the old tool left allocated shows up here
+                HeapCheckpoint();
                 if (newSelection < countof(toolFactories))
                     _currentTool = (*toolFactories[newSelection])();
                 else
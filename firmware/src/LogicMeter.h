@@ -19,6 +19,7 @@ void LogicMeterTask();
 #ifdef __cplusplus
 
 class Tool;
+class RemoteControl;
 
 class LogicMeter 
 {
@@ -28,6 +29,18 @@ public:
     
     void Task();
     
+    // For remote control
+    static int ToolCount();
+    Tool *CurrentTool() const {return _currentTool;}
+    int CurrentSelection() const {return _currentSelection;}
+    bool IsRemote() const {return _remoteSelection >= 0;}
+    // Start a tool as if the selector switch had been turned to it, until
+    // the switch really is turned. Selecting the current tool starts it
+    // again. -1 hands control back to the switch.
+    void SelectRemoteTool(int index);
+    // Start the current tool again, so it reads the settings afresh
+    void RestartTool() {_restartTool = true;}
+    
 private:
     LogicMeter(const LogicMeter& orig);
 
@@ -40,6 +53,11 @@ private:
     Tool *_currentTool;
     int _currentSelection;
     
+    RemoteControl *_remote;
+    int _remoteSelection;
+    int _switchPosition;
+    bool _restartTool;
+    
     // Keep track of when the user last did something, for dimming the display
     uint32_t _lastUserInteractionTime;
     bool _displayDimmed;
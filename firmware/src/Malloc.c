@@ -1,9 +1,16 @@
-
 // To enable this code, the linker needs these switches on the command line:
-// --wrap malloc --wrap free
+// --wrap malloc --wrap free --wrap realloc
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "Malloc.h"
+#include "PoolHeap.h"
+#include "HeapTelemetry.h"
+
+// Comment out to leave everything to the toolchain's heap
+#define REPLACE_HEAP
 
 void *__real_malloc(size_t);
 void __real_free(void *);
@@ -11,172 +18,271 @@ void *__real_realloc(void *, size_t);
 
 size_t largest, total;
 
-void *__wrap_malloc(size_t sz)
+#ifdef REPLACE_HEAP
+
+// Small blocks come from pools of fixed sizes (see PoolHeap.h), and only
+// what's too big for them, or what comes once the pools' arena is used up,
+// goes to the toolchain's heap
+#define POOL_ARENA_SIZE (24 * 1024)
+
+static uint64_t poolArena[POOL_ARENA_SIZE / sizeof(uint64_t)];
+static uint8_t poolPageClass[POOL_ARENA_SIZE / POOL_HEAP_PAGE_SIZE];
+static PoolHeap pool;
+static bool poolReady;
+static uint32_t poolMisses;     // Too big, or no room
+
+#endif // REPLACE_HEAP
+
+#ifdef HEAP_TELEMETRY
+static HeapTelemetry telemetry;
+#endif
+
+// The LCD's DMA callback news and deletes from an ISR, so the pools and the
+// telemetry are changed with interrupts off. It's only ever a few
+// instructions.
+static unsigned HeapLock()
 {
-    if (sz > largest)
-        largest = sz;
-    total += sz;
+    unsigned status = __builtin_disable_interrupts();
+#ifdef REPLACE_HEAP
+    // Static constructors allocate before anything else runs
+    if (!poolReady)
+    {
+        PoolHeapInit(&pool, poolArena, sizeof(poolArena), poolPageClass);
+        poolReady = true;
+    }
+#endif
+    return status;
+}
+
+static void HeapUnlock(unsigned status)
+{
+    if (status & 1)
+        __builtin_enable_interrupts();
+}
+
+static void *RawMalloc(size_t sz)
+{
+#ifdef REPLACE_HEAP
+    unsigned status = HeapLock();
+    void *p = PoolHeapAlloc(&pool, sz);
+    if (!p)
+        ++poolMisses;
+    HeapUnlock(status);
+    if (p)
+        return p;
+#endif
     return __real_malloc(sz);
 }
 
-void __wrap_free(void *p)
+static void RawFree(void *p)
 {
+#ifdef REPLACE_HEAP
+    if (p && PoolHeapOwns(&pool, p))
+    {
+        unsigned status = HeapLock();
+        PoolHeapFree(&pool, p);
+        HeapUnlock(status);
+        return;
+    }
+#endif
     __real_free(p);
 }
 
-void *__wrap_realloc(void *p, size_t sz)
+static void *RawRealloc(void *p, size_t sz)
 {
+#ifdef REPLACE_HEAP
+    // A pool block can't grow in place, but if the new size still fits,
+    // it's kept. A block from the toolchain's heap stays there.
+    if (PoolHeapOwns(&pool, p))
+    {
+        size_t blockSize = PoolHeapBlockSize(&pool, p);
+        if (sz <= blockSize)
+            return p;
+        void *bigger = RawMalloc(sz);
+        if (bigger)
+        {
+            memcpy(bigger, p, blockSize);
+            RawFree(p);
+        }
+        return bigger;
+    }
+#endif
     return __real_realloc(p, sz);
 }
 
-#ifdef REPLACE_HEAP
+#ifdef HEAP_TELEMETRY
 
-#define countof(x) (sizeof(x) / sizeof((x)[0]))
+// What a block really holds, for the fragmentation figures. The toolchain's
+// heap doesn't say, so its blocks count as what was asked for.
+static size_t BlockSize(const HeapTelemetryHeader *h, size_t sz)
+{
+#ifdef REPLACE_HEAP
+    if (PoolHeapOwns(&pool, h))
+        return PoolHeapBlockSize(&pool, h);
+#endif
+    return sz + sizeof(HeapTelemetryHeader);
+}
 
-#define HEAP_SIZE 100000
+#endif // HEAP_TELEMETRY
 
-size_t heap[HEAP_SIZE / sizeof(size_t)] = {HEAP_SIZE};
-typedef struct FreeHeader_s
+void *MallocFrom(size_t sz, void *site)
 {
-    size_t sz; // size of the block includes the header and tail
-    int inUse; // non-zero if block is in use
-    struct FreeHeader_s *prev, *next;
-} FreeHeader;
-typedef struct
+#ifdef HEAP_TELEMETRY
+    HeapTelemetryHeader *h = (HeapTelemetryHeader *) RawMalloc(sz + sizeof(HeapTelemetryHeader));
+    if (!h)
+        return NULL;
+    unsigned status = HeapLock();
+    HeapTelemetryAlloc(&telemetry, h, sz, (uintptr_t) site, BlockSize(h, sz));
+    HeapUnlock(status);
+    return h + 1;
+#else
+    return RawMalloc(sz);
+#endif
+}
+
+void FreeFrom(void *p)
 {
-    size_t sz; // size of the block includes the header and tail
-} Tail;
+#ifdef HEAP_TELEMETRY
+    if (!p)
+        return;
+    HeapTelemetryHeader *h = (HeapTelemetryHeader *) p - 1;
+    unsigned status = HeapLock();
+    bool live = HeapTelemetryFree(&telemetry, h, BlockSize(h, h->size));
+    HeapUnlock(status);
+    // Freeing it again would wreck the heap
+    if (live)
+        RawFree(h);
+#else
+    RawFree(p);
+#endif
+}
 
-typedef struct
+void *__wrap_malloc(size_t sz)
 {
-    size_t sz;
-    int inUse;
-} AllocatedHeader;
+    if (sz > largest)
+        largest = sz;
+    total += sz;
+    return MallocFrom(sz, __builtin_return_address(0));
+}
 
-FreeHeader *freeList = (FreeHeader *) heap;
+void __wrap_free(void *p)
+{
+    FreeFrom(p);
+}
 
-static void *replaceHeapMalloc(size_t sz)
+void *__wrap_realloc(void *p, size_t sz)
 {
-    // Enlarge sz so we have room for the block header and tail
-    sz += sizeof(AllocatedHeader) + sizeof(Tail);
-    // Make sure sz is a multiple of 4 bytes
-    sz = (sz + 3) & 0xfffffffc;
-    
-    // Find the first free block that's big enough
-    FreeHeader *freeBlock = freeList;
-    while (freeBlock && freeBlock->sz < sz)
-        freeBlock = freeBlock->next;
-    
-    if (freeBlock == NULL)
-    {
-        __builtin_software_breakpoint();
-        return (void *) 0;
-    }
-    
-    // If we split the block, how big would the remainder be?
-    size_t remainderSz = freeBlock->sz - sz;
-    // If the free block is big enough to split
-    if (remainderSz > sizeof(FreeHeader) + sizeof(Tail))
+    if (p == NULL)
+        return MallocFrom(sz, __builtin_return_address(0));
+#ifdef HEAP_TELEMETRY
+    // The block's counted out while it moves, and back in against the
+    // realloc's caller
+    HeapTelemetryHeader *h = (HeapTelemetryHeader *) p - 1;
+    size_t oldSize = h->size;
+    unsigned status = HeapLock();
+    bool live = HeapTelemetryFree(&telemetry, h, BlockSize(h, oldSize));
+    HeapUnlock(status);
+    if (!live)
+        return NULL;
+
+    HeapTelemetryHeader *moved = (HeapTelemetryHeader *) RawRealloc(h, sz + sizeof(HeapTelemetryHeader));
+    if (moved)
     {
-        // Shrink the freeBlock
-        freeBlock->sz = remainderSz;
-        // Make a new tail for the freeBlock
-        Tail *freeTail = (Tail *) ((uint8_t *) freeBlock + freeBlock->sz - sizeof(Tail));
-        freeTail->sz = freeBlock->sz;
-        // Initialize the allocated block's header and tail
-        AllocatedHeader *allocated = (AllocatedHeader *) (freeTail + 1);
-        allocated->sz = sz;
-        allocated->inUse = 1;
-        Tail *allocatedTail = (Tail *) ((uint8_t *) allocated + sz - sizeof(Tail));
-        allocatedTail->sz = sz;
-        
-        // Return a pointer to the usable space
-        return allocated + 1;
+        h = moved;
+        oldSize = sz;
     }
-    // Else (return the whole block)
-    else
+    status = HeapLock();
+    HeapTelemetryAlloc(&telemetry, h, oldSize, (uintptr_t) __builtin_return_address(0), BlockSize(h, oldSize));
+    HeapUnlock(status);
+    return moved ? moved + 1 : NULL;
+#else
+    return RawRealloc(p, sz);
+#endif
+}
+
+/******************************************************************************
+FUNCTION HeapStatsDump -- print the heap's stats a line at a time
+DESCRIPTION
+    First the pools' size classes, then (with HEAP_TELEMETRY) the totals and
+    each call site, and then what changed at each site between the last two
+    tool switches.
+******************************************************************************/
+#define DUMP_POOLS 0
+#define DUMP_SITES (DUMP_POOLS + POOL_HEAP_CLASSES)
+#define DUMP_CHANGES (DUMP_SITES + HEAP_TELEMETRY_SITES)
+#define DUMP_END (DUMP_CHANGES + HEAP_TELEMETRY_SITES)
+
+int HeapStatsDump(int index)
+{
+    if (index < DUMP_SITES)
     {
-        // Remove the block from the free list
-        freeBlock->inUse = 1;
-        // If there's a previous free block
-        if (freeBlock->prev)
+#ifdef REPLACE_HEAP
+        if (index == DUMP_POOLS)
         {
-            freeBlock->prev->next = freeBlock->next;
+            printf("\r\nHeap pools (%u of %u pages used, %u to the toolchain's heap)\r\n",
+                (unsigned) pool.nextPage, (unsigned) pool.pageCount, (unsigned) poolMisses);
+            printf("Size Pages  In use    Peak    Allocs     Frees  Failed\r\n");
         }
-        // Else (no previous free block) we must be the head of the list.
-        // But not anymore
-        else
-            freeList = freeBlock->next;
-        if (freeBlock->next)
-            freeBlock->next->prev = freeBlock->prev;
-        
-        // Return a pointer to the usable space
-        return (AllocatedHeader *) freeBlock + 1;
+        unsigned status = HeapLock();
+        PoolClass pc = pool.classes[index - DUMP_POOLS];
+        HeapUnlock(status);
+        printf("%4u %5u %7u %7u %9u %9u %7u\r\n", pc.blockSize, (unsigned) pc.pages, (unsigned) pc.inUse,
+            (unsigned) pc.peak, (unsigned) pc.allocs, (unsigned) pc.frees, (unsigned) pc.failures);
+        return index + 1;
+#else
+        printf("\r\nHeap pools aren't compiled in (see REPLACE_HEAP)\r\n");
+        return DUMP_SITES;
+#endif
     }
-}
 
-static FreeHeader *AddToFreeList(AllocatedHeader *allocated)
-{
-    FreeHeader *freed = (FreeHeader *) allocated;
-    freed->inUse = 0;
-    freed->prev = NULL;
-    freed->next = freeList;
-    if (freeList)
-        freeList->prev = freed;
-    freeList = freed;
-    return freed;
+#ifdef HEAP_TELEMETRY
+    // Print from a copy, so an ISR can't change it halfway through a line
+    static HeapTelemetry copy;
+    if (index == DUMP_SITES)
+    {
+        unsigned status = HeapLock();
+        copy = telemetry;
+        HeapUnlock(status);
+        HeapTelemetryPrintTotals(&copy);
+    }
+    if (index < DUMP_CHANGES)
+    {
+        HeapTelemetryPrintSite(&copy, index - DUMP_SITES);
+        return index + 1;
+    }
+    if (index == DUMP_CHANGES)
+        printf("Changes across the last tool (%d switches)\r\n", copy.checkpoints);
+    HeapTelemetryPrintChange(&copy, index - DUMP_CHANGES);
+    return index + 1 < DUMP_END ? index + 1 : -1;
+#else
+    printf("\r\nHeap telemetry isn't compiled in (see HEAP_TELEMETRY)\r\n");
+    return -1;
+#endif
 }
 
-static void replaceHeapFree(void *p)
+void HeapStatsReset()
 {
-    if (p)
+    unsigned status = HeapLock();
+#ifdef REPLACE_HEAP
+    for (int i = 0; i < POOL_HEAP_CLASSES; ++i)
     {
-        AllocatedHeader *allocated = (AllocatedHeader *) ((uint8_t *) p - sizeof(AllocatedHeader));
-        Tail *allocatedTail = (Tail *) ((uint8_t *) allocated + allocated->sz - sizeof(Tail));
-        if (!allocated->inUse)
-            __builtin_software_breakpoint();
-        
-        FreeHeader *freed;
-        
-        // If we're not at the front of the heap
-        if ((size_t *) allocated != heap)
-        {
-            // Get the tail of the previous block
-            Tail *prevTail = (Tail *) allocated - 1;
-            FreeHeader *prevBlock = (FreeHeader *) ((uint8_t *) allocated - prevTail->sz);
-            // If the previous block is not in use
-            if (!prevBlock->inUse)
-            {
-                // Coalesce
-                prevBlock->sz += allocated->sz;
-                allocatedTail->sz = prevBlock->sz;
-                freed = (FreeHeader *) allocated;
-            }
-            // Else (previous block is in use)
-            else
-            {
-                freed = AddToFreeList(allocated);
-            }
-        }
-        // Else (we're the first memory location in the heap)
-        else
-            freed = AddToFreeList(allocated);
-        
-        // See if we can coalesce with the block after us
-        FreeHeader *nextBlock = (FreeHeader *) ((uint8_t *) freed + freed->sz);
-        if (!nextBlock->inUse)
-        {
-            // Combine the blocks
-            Tail *nextTail = (Tail *) ((uint8_t *) nextBlock + nextBlock->sz - sizeof(Tail));
-            freed->sz += nextBlock->sz;
-            nextTail->sz = freed->sz;
-            // Adjust the pointers
-            if (nextBlock->prev)
-                nextBlock->prev->next = nextBlock->next;
-            if (nextBlock->next)
-                nextBlock->next->prev = nextBlock->prev;
-        }
+        PoolClass *pc = &pool.classes[i];
+        pc->allocs = pc->frees = pc->failures = 0;
+        pc->peak = pc->inUse;
     }
+    poolMisses = 0;
+#endif
+#ifdef HEAP_TELEMETRY
+    HeapTelemetryReset(&telemetry);
+#endif
+    HeapUnlock(status);
 }
 
-#endif // REPLACE_HEAP
\ No newline at end of file
+#ifdef HEAP_TELEMETRY
+void HeapCheckpoint()
+{
+    unsigned status = HeapLock();
+    HeapTelemetryCheckpoint(&telemetry);
+    HeapUnlock(status);
+}
+#endif
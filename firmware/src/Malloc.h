@@ -0,0 +1,49 @@
+/*
+ * File:   Malloc.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:30 AM
+ */
+
+#ifndef MALLOC_H
+#define	MALLOC_H
+
+#include <stddef.h>
+
+// Count allocations against their call sites, and what each tool leaves
+// allocated when it's switched away from (see HeapTelemetry.h). The stats
+// are dumped over the USB console from the Utility tool; look the sites up
+// in the map file. It's on in debug builds only: the 8 byte header moves
+// most small allocations up a pool size class, so the pools hold noticeably
+// less, and the table and the dump's copy of it take about 5K of RAM.
+#ifdef __DEBUG
+#define HEAP_TELEMETRY
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// malloc and free, saying where the allocation's for. operator new uses
+// these so its caller is the site, rather than operator new.
+void *MallocFrom(size_t sz, void *site);
+void FreeFrom(void *p);
+
+// Prints one line of the heap's stats to the console. Returns the next to
+// print, or -1 after the last one.
+int HeapStatsDump(int index);
+void HeapStatsReset();
+
+// Call at each tool switch, once the old tool's gone
+#ifdef HEAP_TELEMETRY
+void HeapCheckpoint();
+#else
+static inline void HeapCheckpoint() {}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* MALLOC_H */
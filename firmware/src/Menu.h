@@ -19,30 +19,27 @@ class MenuItem
 {
 public:
     
-    MenuItem(const char *text = "", MenuType menuType = NoChange, 
-            const Menu *menu = NULL, const Callback *execute = NULL) :
+    // constexpr, so the static menus are built by the compiler, into flash
+    constexpr MenuItem(const char *text = "", MenuType menuType = NoChange, 
+            const Menu *menu = NULL, Callback execute = Callback()) :
         _text(text), _nextMenuType(menuType), _nextMenu(menu), _execute(execute)
     {
     }
-    ~MenuItem() {delete _execute;}
     
     const char *Text() const {return _text;}
     MenuType NextMenuType() const {return _nextMenuType;}
     const Menu *NextMenu() const {return _nextMenu;}
     void Execute(Tool *tool) const 
     {
-        if (_execute) 
-        {
-            Callback *execute = (Callback *) _execute;
-            (*execute)(tool);
-        }
+        if (_execute.IsSet()) 
+            _execute(tool);
     }
     
 private:
     const char *_text;
     MenuType _nextMenuType;
     const Menu *_nextMenu;
-    const Callback *_execute;
+    Callback _execute;
 };
 
 typedef MenuItem MenuItemArray[5];
@@ -50,11 +47,10 @@ typedef MenuItem MenuItemArray[5];
 class Menu 
 {
 public:
-    Menu(const MenuItemArray &menuItems) :
+    constexpr Menu(const MenuItemArray &menuItems) :
         _menuItems(menuItems)
     {
     }
-    ~Menu() {}
     
     const MenuItemArray &MenuItems() const {return _menuItems;}
     
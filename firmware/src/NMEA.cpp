@@ -0,0 +1,94 @@
+/*
+ * File:   NMEA.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 8:45 AM
+ */
+
+#include <string.h>
+#include "NMEA.h"
+
+static const char hexDigits[] = "0123456789ABCDEF";
+
+NMEATemplate::NMEATemplate(const char *text) : _fieldCount(0), _checksum(0)
+{
+    // Leave room for "*hh\r\n"
+    _length = strlen(text);
+    if (_length > NMEA_MAX_LENGTH - 5)
+        _length = NMEA_MAX_LENGTH - 5;
+    memcpy(_text, text, _length);
+
+    // Fields start after the $ and after each comma. The checksum covers
+    // everything between the $ and the *.
+    _fields[_fieldCount++] = 1;
+    for (size_t i = 1; i < _length; ++i)
+    {
+        if (_text[i] == ',' && _fieldCount < (int) sizeof(_fields))
+            _fields[_fieldCount++] = uint8_t(i + 1);
+        _checksum ^= _text[i];
+    }
+
+    memcpy(_text + _length, "*00\r\n", 6);
+    _length += 5;
+    UpdateChecksumText();
+}
+
+void NMEATemplate::UpdateChecksumText()
+{
+    _text[_length - 4] = hexDigits[_checksum >> 4];
+    _text[_length - 3] = hexDigits[_checksum & 0xf];
+}
+
+void NMEATemplate::Patch(int field, size_t offset, const char *chars, size_t count)
+{
+    if (field >= _fieldCount)
+        return;
+    char *p = _text + _fields[field] + offset;
+    // Don't run into the checksum
+    char *end = _text + _length - 5;
+    for (size_t i = 0; i < count && p < end; ++i, ++p)
+    {
+        if (*p != chars[i])
+        {
+            _checksum ^= *p ^ chars[i];
+            *p = chars[i];
+        }
+    }
+    UpdateChecksumText();
+}
+
+void NMEATemplate::PatchDigits(int field, size_t offset, uint32_t value, size_t digits)
+{
+    char buf[10];
+    if (digits > sizeof(buf))
+        digits = sizeof(buf);
+    for (size_t i = digits; i > 0; --i)
+    {
+        buf[i - 1] = '0' + value % 10;
+        value /= 10;
+    }
+    Patch(field, offset, buf, digits);
+}
+
+/******************************************************************************
+FUNCTION NMEAPlan -- fit messages into a fix's worth of characters
+DESCRIPTION
+    Characters are 10 bits (8N1). A tenth of the time is kept spare so the
+    messages are out well before the next fix's are due, even with main loop
+    jitter.
+******************************************************************************/
+uint32_t NMEAPlan(uint32_t baud, uint32_t fixesPerSecond, const size_t *lengths, int count)
+{
+    size_t budget = baud / 10 * 9 / 10 / fixesPerSecond;
+    uint32_t mask = 0;
+    for (int i = 0; i < count && i < 32; ++i)
+    {
+        if (lengths[i] && lengths[i] <= budget)
+        {
+            budget -= lengths[i];
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
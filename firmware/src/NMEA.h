@@ -0,0 +1,60 @@
+/*
+ * File:   NMEA.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 8:45 AM
+ */
+
+#ifndef NMEA_H
+#define	NMEA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// NMEA 0183 allows 82 characters including the $ and the CR LF
+#define NMEA_MAX_LENGTH 82
+
+/******************************************************************************
+CLASS NMEATemplate -- an NMEA sentence that's patched in place
+DESCRIPTION
+    The sentence is built once from text with every field at its final
+    width, e.g. "$GPGGA,000000,0000.0000,N,...". After that only the
+    characters that change are written, and the XOR checksum is adjusted for
+    just those characters, so the sentence is always ready to send with no
+    formatting or allocation. Fields are numbered from 0 (the sentence ID),
+    as in the NMEA documents.
+******************************************************************************/
+class NMEATemplate
+{
+public:
+    // The text is the sentence without the checksum or CR LF
+    NMEATemplate(const char *text);
+
+    const char *Text() const {return _text;}
+    size_t Length() const {return _length;}
+
+    // Overwrite part of a field
+    void Patch(int field, size_t offset, const char *chars, size_t count);
+    void Patch(int field, char c) {Patch(field, 0, &c, 1);}
+    // Write a zero-padded decimal number into part of a field
+    void PatchDigits(int field, size_t offset, uint32_t value, size_t digits);
+
+private:
+    void UpdateChecksumText();
+
+    char _text[NMEA_MAX_LENGTH + 1];
+    size_t _length;
+    // Where each field starts
+    uint8_t _fields[NMEA_MAX_LENGTH / 2];
+    int _fieldCount;
+    uint8_t _checksum;
+};
+
+// Work out which messages fit into each fix at a baud rate and fix rate.
+// Messages are given in priority order; each is taken if it fits in what's
+// left after the ones before it. A length of 0 means the message isn't
+// wanted. Returns a mask with bit n set if message n is in.
+uint32_t NMEAPlan(uint32_t baud, uint32_t fixesPerSecond, const size_t *lengths, int count);
+
+#endif	/* NMEA_H */
+
@@ -0,0 +1,62 @@
+/*
+ * File:   New.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:30 AM
+ */
+
+#include <new>
+#include "Malloc.h"
+
+#ifdef HEAP_TELEMETRY
+
+// Inside the library's operator new, malloc's caller is always operator new.
+// These replace it, so each new is counted where it's written.
+
+void *operator new(size_t size)
+{
+    void *p = MallocFrom(size, __builtin_return_address(0));
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    void *p = MallocFrom(size, __builtin_return_address(0));
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    return MallocFrom(size, __builtin_return_address(0));
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return MallocFrom(size, __builtin_return_address(0));
+}
+
+void operator delete(void *p) noexcept
+{
+    FreeFrom(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    FreeFrom(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    FreeFrom(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    FreeFrom(p);
+}
+
+#endif // HEAP_TELEMETRY
@@ -0,0 +1,455 @@
+/*
+ * File:   Pattern.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 8:40 AM
+ */
+
+#include <string.h>
+#include <ctype.h>
+#include "Pattern.h"
+
+// Bytecode. Multi-byte operands are little endian.
+enum PatternOp : uint8_t
+{
+    OpEnd,
+    OpBytes,        // length (1..255), bytes
+    OpGap,          // microseconds (4 bytes)
+    OpWait,         // microseconds (4 bytes)
+    OpRepeat,       // count (2 bytes)
+    OpNext,         // end of the innermost repeat
+    OpBegin,
+    OpStop,
+    OpSum8,
+    OpXor8,
+    OpSumHex,
+    OpXorHex,
+};
+
+static inline uint32_t Get32(const uint8_t *p) {return p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24);}
+
+static int HexDigit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    c = tolower(c);
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+void PatternCompiler::AddByte(uint8_t byte)
+{
+    _sends = true;
+    // Extend the current run of bytes if there's room
+    if (_bytesOp && _code[_bytesOp] < 255)
+    {
+        ++_code[_bytesOp];
+    }
+    else
+    {
+        _code.push_back(OpBytes);
+        _bytesOp = _code.size();
+        _code.push_back(1);
+    }
+    _code.push_back(byte);
+}
+
+void PatternCompiler::AddChecksum(uint8_t op)
+{
+    _sends = true;
+    _code.push_back(op);
+}
+
+void PatternCompiler::Add32(uint8_t op, uint32_t value)
+{
+    _code.push_back(op);
+    for (int i = 0; i < 4; ++i, value >>= 8)
+        _code.push_back(uint8_t(value));
+}
+
+bool PatternCompiler::ParseNumber(uint32_t &value)
+{
+    int base = 10;
+    if (_end - _p > 2 && _p[0] == '0' && tolower(_p[1]) == 'x')
+    {
+        base = 16;
+        _p += 2;
+    }
+    const char *start = _p;
+    uint64_t v = 0;
+    for (; _p < _end; ++_p)
+    {
+        int digit = HexDigit(*_p);
+        if (digit < 0 || digit >= base)
+            break;
+        v = v * base + digit;
+        if (v > UINT32_MAX)
+            return Fail("Number too big");
+    }
+    if (_p == start)
+        return Fail("Number expected");
+    value = uint32_t(v);
+    return true;
+}
+
+bool PatternCompiler::ParseTime(uint32_t &microseconds)
+{
+    uint32_t value;
+    if (!ParseNumber(value))
+        return false;
+    while (_p < _end && (*_p == ' ' || *_p == '\t'))
+        ++_p;
+    char unit[4];
+    if (!ParseWord(unit, sizeof(unit)))
+        return Fail("Time needs us, ms or s");
+
+    uint64_t us = value;
+    if (strcmp(unit, "ms") == 0)
+        us *= 1000;
+    else if (strcmp(unit, "s") == 0)
+        us *= 1000000;
+    else if (strcmp(unit, "us") != 0)
+        return Fail("Time needs us, ms or s");
+    if (us > UINT32_MAX)
+        return Fail("Time too long");
+    microseconds = uint32_t(us);
+    return true;
+}
+
+bool PatternCompiler::ParseString()
+{
+    // Skip the opening quote
+    ++_p;
+    while (_p < _end && *_p != '"')
+    {
+        char c = *_p++;
+        if (c == '\n')
+            return Fail("Unterminated string");
+        if (c == '\\' && _p < _end)
+        {
+            c = *_p++;
+            switch (c)
+            {
+                case 'n' : c = '\n'; break;
+                case 'r' : c = '\r'; break;
+                case 't' : c = '\t'; break;
+                case '0' : c = '\0'; break;
+                case 'x' :
+                    if (_end - _p < 2 || HexDigit(_p[0]) < 0 || HexDigit(_p[1]) < 0)
+                        return Fail("Bad \\x escape");
+                    c = char(HexDigit(_p[0]) * 16 + HexDigit(_p[1]));
+                    _p += 2;
+                    break;
+                default :
+                    // \\ and \" (and anything else) stand for themselves
+                    break;
+            }
+        }
+        AddByte(uint8_t(c));
+    }
+    if (_p == _end)
+        return Fail("Unterminated string");
+    ++_p;
+    return true;
+}
+
+bool PatternCompiler::ParseHex()
+{
+    // Skip the <
+    ++_p;
+    int high = -1;
+    for (; _p < _end && *_p != '>'; ++_p)
+    {
+        if (*_p == '\n')
+            ++_line;
+        if (isspace(*_p))
+            continue;
+        int digit = HexDigit(*_p);
+        if (digit < 0)
+            return Fail("Bad hex digit");
+        if (high < 0)
+        {
+            high = digit;
+        }
+        else
+        {
+            AddByte(uint8_t(high * 16 + digit));
+            high = -1;
+        }
+    }
+    if (_p == _end)
+        return Fail("Missing >");
+    if (high >= 0)
+        return Fail("Odd number of hex digits");
+    ++_p;
+    return true;
+}
+
+// Reads a run of letters and digits
+bool PatternCompiler::ParseWord(char *word, size_t size)
+{
+    size_t i = 0;
+    while (_p < _end && isalnum(*_p))
+    {
+        if (i == size - 1)
+            return false;
+        word[i++] = tolower(*_p++);
+    }
+    word[i] = '\0';
+    return i != 0;
+}
+
+/******************************************************************************
+FUNCTION Compile -- turn pattern script text into bytecode
+RETURNS
+    false if there's an error, with ErrorLine() and Error() set to say where
+    and what
+******************************************************************************/
+bool PatternCompiler::Compile(const char *source, size_t size)
+{
+    _code.clear();
+    _bytesOp = 0;
+    _sends = false;
+    _p = source;
+    _end = source + size;
+    _line = 1;
+    _error = nullptr;
+    int depth = 0;
+
+    bool ok = true;
+    while (ok)
+    {
+        // Skip white space and comments
+        while (_p < _end && (isspace(*_p) || *_p == ','))
+        {
+            if (*_p++ == '\n')
+                ++_line;
+        }
+        if (_p < _end && *_p == '#')
+        {
+            while (_p < _end && *_p != '\n')
+                ++_p;
+            continue;
+        }
+        if (_p == _end)
+            break;
+
+        _errorLine = _line;
+        char c = *_p;
+        if (c == '"')
+        {
+            ok = ParseString();
+        }
+        else if (c == '<')
+        {
+            ok = ParseHex();
+        }
+        else if (isdigit(c))
+        {
+            uint32_t value;
+            ok = ParseNumber(value);
+            if (ok && value > 255)
+                ok = Fail("Byte value too big");
+            if (ok)
+                AddByte(uint8_t(value));
+        }
+        else if (c == '}')
+        {
+            ++_p;
+            if (depth == 0)
+                ok = Fail("Unmatched }");
+            // A repeat that sends nothing would keep the runner going round
+            // it without ever returning a byte
+            else if (!_sends)
+                ok = Fail("Repeat has nothing to send");
+            --depth;
+            _code.push_back(OpNext);
+            _bytesOp = 0;
+        }
+        else
+        {
+            char word[8];
+            if (!ParseWord(word, sizeof(word)))
+            {
+                ok = Fail("Unknown item");
+                break;
+            }
+            _bytesOp = 0;
+            while (_p < _end && (*_p == ' ' || *_p == '\t'))
+                ++_p;
+
+            uint32_t value;
+            if (strcmp(word, "gap") == 0 || strcmp(word, "wait") == 0)
+            {
+                ok = ParseTime(value);
+                if (ok)
+                    Add32(word[0] == 'g' ? OpGap : OpWait, value);
+            }
+            else if (strcmp(word, "repeat") == 0)
+            {
+                ok = ParseNumber(value);
+                if (ok && (value == 0 || value > UINT16_MAX))
+                    ok = Fail("Repeat count must be 1 to 65535");
+                while (ok && _p < _end && isspace(*_p))
+                {
+                    if (*_p++ == '\n')
+                        ++_line;
+                }
+                if (ok && (_p == _end || *_p++ != '{'))
+                    ok = Fail("Missing {");
+                if (ok && ++depth > PATTERN_MAX_NESTING)
+                    ok = Fail("Repeats nested too deeply");
+                if (ok)
+                {
+                    _sends = false;
+                    _code.push_back(OpRepeat);
+                    _code.push_back(uint8_t(value));
+                    _code.push_back(uint8_t(value >> 8));
+                }
+            }
+            else if (strcmp(word, "begin") == 0)
+                _code.push_back(OpBegin);
+            else if (strcmp(word, "end") == 0)
+                _code.push_back(OpStop);
+            else if (strcmp(word, "sum8") == 0)
+                AddChecksum(OpSum8);
+            else if (strcmp(word, "xor8") == 0)
+                AddChecksum(OpXor8);
+            else if (strcmp(word, "sumhex") == 0)
+                AddChecksum(OpSumHex);
+            else if (strcmp(word, "xorhex") == 0)
+                AddChecksum(OpXorHex);
+            else
+                ok = Fail("Unknown item");
+        }
+    }
+
+    if (ok && depth)
+    {
+        _errorLine = _line;
+        ok = Fail("Missing }");
+    }
+    _code.push_back(OpEnd);
+    return ok;
+}
+
+void PatternRunner::Start(const uint8_t *code)
+{
+    _code = code;
+    _wait = 0;
+    _first = true;
+    Restart();
+}
+
+void PatternRunner::Restart()
+{
+    _pc = 0;
+    _runLength = 0;
+    _gap = 0;
+    _depth = 0;
+    _summing = true;
+    _sum = _xor = 0;
+}
+
+/******************************************************************************
+FUNCTION Next -- step to the next byte to send
+DESCRIPTION
+    Runs the bytecode up to the next byte. Waits met along the way add up,
+    and the current gap goes in front of every byte but the very first.
+    This is called from the TX timer interrupt, so it mustn't allocate or
+    take long.
+******************************************************************************/
+bool PatternRunner::Next(uint8_t &byte, uint32_t &idleMicroseconds)
+{
+    if (!_code)
+        return false;
+
+    for (;;)
+    {
+        if (_runLength)
+        {
+            byte = *_run++;
+            --_runLength;
+            if (_runSummed && _summing)
+            {
+                _sum += byte;
+                _xor ^= byte;
+            }
+            idleMicroseconds = _wait + (_first ? 0 : _gap);
+            _wait = 0;
+            _first = false;
+            return true;
+        }
+
+        const uint8_t *operand = _code + _pc + 1;
+        switch (_code[_pc++])
+        {
+            case OpEnd :
+                // Stay at the end
+                --_pc;
+                return false;
+
+            case OpBytes :
+                _runLength = operand[0];
+                _run = operand + 1;
+                _runSummed = true;
+                _pc += 1 + _runLength;
+                break;
+
+            case OpGap :
+                _gap = Get32(operand);
+                _pc += 4;
+                break;
+
+            case OpWait :
+                _wait += Get32(operand);
+                _pc += 4;
+                break;
+
+            case OpRepeat :
+                _loops[_depth].count = operand[0] | (operand[1] << 8);
+                _pc += 2;
+                _loops[_depth++].start = _pc;
+                break;
+
+            case OpNext :
+                if (--_loops[_depth - 1].count)
+                    _pc = _loops[_depth - 1].start;
+                else
+                    --_depth;
+                break;
+
+            case OpBegin :
+                _summing = true;
+                _sum = _xor = 0;
+                break;
+
+            case OpStop :
+                _summing = false;
+                break;
+
+            case OpSum8 :
+            case OpXor8 :
+                _checksum[0] = _code[_pc - 1] == OpSum8 ? _sum : _xor;
+                _run = _checksum;
+                _runLength = 1;
+                _runSummed = false;
+                break;
+
+            case OpSumHex :
+            case OpXorHex :
+            {
+                static const char hex[] = "0123456789ABCDEF";
+                uint8_t value = _code[_pc - 1] == OpSumHex ? _sum : _xor;
+                _checksum[0] = hex[value >> 4];
+                _checksum[1] = hex[value & 0xf];
+                _run = _checksum;
+                _runLength = 2;
+                _runSummed = false;
+                break;
+            }
+        }
+    }
+}
+
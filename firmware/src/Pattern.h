@@ -0,0 +1,121 @@
+/*
+ * File:   Pattern.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 8:40 AM
+ */
+
+#ifndef PATTERN_H
+#define	PATTERN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/******************************************************************************
+Pattern scripts -- timed byte sequences for UART Out
+DESCRIPTION
+    A pattern script is a text file of whitespace-separated items:
+
+        "text"          Bytes of text. \n \r \t \0 \\ \" and \xHH escapes.
+        <41 42 0d0a>    A block of hex bytes. Spaces are optional.
+        65, 0x41        A single byte
+        gap 100us       Idle time between the end of one byte and the start
+                        of the next, from here on (us, ms or s)
+        wait 10ms       Extra idle time before the next byte only
+        repeat 5 { }    Repeat what's between the braces (nestable). It must
+                        send something.
+        begin, end      Start (clearing it) and stop the running checksum.
+                        Without a begin, everything sent is summed.
+        sum8, xor8      Send the checksum as one byte
+        sumhex, xorhex  Send the checksum as two upper case hex digits
+        # ...           Comment to the end of the line
+
+    e.g. an NMEA sentence once a second:
+
+        repeat 10 { "$" begin "GPTXT,01,01,02,Hello" end "*" xorhex "\r\n" wait 1s }
+
+    PatternCompiler turns the text into bytecode once. PatternRunner steps
+    through the bytecode one byte at a time, which is cheap enough to do in
+    the TX timer interrupt. Neither knows about the PIC32, so they build on
+    the host.
+******************************************************************************/
+
+#define PATTERN_MAX_NESTING 4
+
+class PatternCompiler
+{
+public:
+    PatternCompiler() : _errorLine(0), _error(nullptr) {}
+
+    // Returns false on error; see ErrorLine() and Error()
+    bool Compile(const char *source, size_t size);
+
+    const std::vector<uint8_t> &Code() const {return _code;}
+    int ErrorLine() const {return _errorLine;}
+    const char *Error() const {return _error;}
+
+private:
+    bool Fail(const char *error) {_error = error; return false;}
+    bool ParseNumber(uint32_t &value);
+    bool ParseTime(uint32_t &microseconds);
+    bool ParseString();
+    bool ParseHex();
+    bool ParseWord(char *word, size_t size);
+    void AddByte(uint8_t byte);
+    void AddChecksum(uint8_t op);
+    void Add32(uint8_t op, uint32_t value);
+
+    std::vector<uint8_t> _code;
+    // Where the current run of literal bytes started, or 0 if there isn't one
+    size_t _bytesOp;
+    // Something has been sent since the innermost repeat began
+    bool _sends;
+
+    const char *_p, *_end;
+    int _line;
+    int _errorLine;
+    const char *_error;
+};
+
+class PatternRunner
+{
+public:
+    PatternRunner() : _code(nullptr) {}
+
+    // The code must stay put while the runner uses it
+    void Start(const uint8_t *code);
+    // Go back to the beginning. Any wait at the end of the script carries over
+    // to the first byte.
+    void Restart();
+
+    // Get the next byte, and the idle time in microseconds to leave before
+    // sending it. Returns false at the end of the script.
+    bool Next(uint8_t &byte, uint32_t &idleMicroseconds);
+
+private:
+    const uint8_t *_code;
+    size_t _pc;
+
+    // The run of bytes being sent
+    const uint8_t *_run;
+    uint8_t _runLength;
+    bool _runSummed;
+
+    uint32_t _gap, _wait;
+    bool _first;
+
+    struct Loop
+    {
+        size_t start;
+        uint16_t count;
+    } _loops[PATTERN_MAX_NESTING];
+    int _depth;
+
+    bool _summing;
+    uint8_t _sum, _xor;
+    uint8_t _checksum[2];
+};
+
+#endif	/* PATTERN_H */
+
@@ -25,7 +25,7 @@
 template <class T>
 struct RegisterTCSI
 {
-    uint32_t operator=(uint32_t rhs) {reg = rhs;}
+    uint32_t operator=(uint32_t rhs) {reg = rhs; return rhs;}
     operator uint32_t() const {return reg;}
     union
     {
@@ -39,7 +39,7 @@ struct RegisterTCSI
 // bit-field type, but has CLR, SET, and INV[ert] registers
 struct RegisterCSI
 {
-    uint32_t operator=(uint32_t rhs) {reg = rhs;}
+    uint32_t operator=(uint32_t rhs) {reg = rhs; return rhs;}
     operator uint32_t() const {return reg;}
     volatile uint32_t reg;
     volatile uint32_t clr, set, inv;
@@ -49,7 +49,7 @@ struct RegisterCSI
 // bit-field type, CLR, SET, or INV[ert] registers
 struct Register
 {
-    uint32_t operator=(uint32_t rhs) {reg = rhs;}
+    uint32_t operator=(uint32_t rhs) {reg = rhs; return rhs;}
     operator uint32_t() const {return reg;}
     volatile uint32_t reg;
 };
@@ -61,10 +61,11 @@ struct RegisterBF
     const uint8_t msb, lsb;
     operator uint32_t() const {return (target >> lsb) & ((1 << (msb - lsb + 1)) - 1);}
     template <class RHS>
-    uint32_t &operator=(RHS rhs) const
+    uint32_t operator=(RHS rhs) const
     {
         uint32_t mask = (1 << (msb - lsb + 1)) - 1;
         target = (target & ~(mask << lsb)) | ((rhs & mask) << lsb);
+        return rhs & mask;
     }
 };
 
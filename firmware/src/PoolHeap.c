@@ -0,0 +1,93 @@
+/*
+ * File:   PoolHeap.c
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:30 AM
+ */
+
+#include <string.h>
+#include "PoolHeap.h"
+
+// Sizes in between the powers of two keep the waste to a third at most
+static const uint16_t classSizes[POOL_HEAP_CLASSES] = {8, 16, 24, 32, 48, 64, 96, 128, 192, 256};
+
+void PoolHeapInit(PoolHeap *heap, void *arena, size_t size, uint8_t *pageClass)
+{
+    memset(heap, 0, sizeof(*heap));
+    heap->arena = (uint8_t *) arena;
+    heap->pageCount = size / POOL_HEAP_PAGE_SIZE;
+    heap->pageClass = pageClass;
+
+    int c = 0;
+    for (int i = 0; i < POOL_HEAP_CLASSES; ++i)
+    {
+        heap->classes[i].blockSize = classSizes[i];
+        // Every size up to this class's that isn't in a smaller one
+        while (c * POOL_HEAP_ALIGN <= classSizes[i])
+            heap->classOf[c++] = (uint8_t) i;
+    }
+}
+
+/******************************************************************************
+FUNCTION PoolHeapAlloc -- a block from the class that fits
+DESCRIPTION
+    A freed block if there is one, else the next one off the class's newest
+    page, else the first block of a new page.
+******************************************************************************/
+void *PoolHeapAlloc(PoolHeap *heap, size_t size)
+{
+    if (size > POOL_HEAP_MAX_BLOCK)
+        return NULL;
+    PoolClass *pc = &heap->classes[heap->classOf[(size + POOL_HEAP_ALIGN - 1) / POOL_HEAP_ALIGN]];
+
+    void *p;
+    if (pc->freeList)
+    {
+        p = pc->freeList;
+        pc->freeList = pc->freeList->next;
+    }
+    else
+    {
+        if (pc->carveEnd - pc->carve < pc->blockSize)
+        {
+            if (heap->nextPage == heap->pageCount)
+            {
+                ++pc->failures;
+                return NULL;
+            }
+            heap->pageClass[heap->nextPage] = (uint8_t) (pc - heap->classes);
+            pc->carve = heap->arena + heap->nextPage * POOL_HEAP_PAGE_SIZE;
+            pc->carveEnd = pc->carve + POOL_HEAP_PAGE_SIZE;
+            ++heap->nextPage;
+            ++pc->pages;
+        }
+        p = pc->carve;
+        pc->carve += pc->blockSize;
+    }
+
+    ++pc->allocs;
+    if (++pc->inUse > pc->peak)
+        pc->peak = pc->inUse;
+    return p;
+}
+
+void PoolHeapFree(PoolHeap *heap, void *p)
+{
+    PoolClass *pc = &heap->classes[heap->pageClass[((uint8_t *) p - heap->arena) / POOL_HEAP_PAGE_SIZE]];
+    PoolBlock *block = (PoolBlock *) p;
+    block->next = pc->freeList;
+    pc->freeList = block;
+    ++pc->frees;
+    --pc->inUse;
+}
+
+bool PoolHeapOwns(const PoolHeap *heap, const void *p)
+{
+    const uint8_t *b = (const uint8_t *) p;
+    return b >= heap->arena && b < heap->arena + heap->nextPage * POOL_HEAP_PAGE_SIZE;
+}
+
+size_t PoolHeapBlockSize(const PoolHeap *heap, const void *p)
+{
+    return heap->classes[heap->pageClass[((const uint8_t *) p - heap->arena) / POOL_HEAP_PAGE_SIZE]].blockSize;
+}
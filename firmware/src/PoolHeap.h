@@ -0,0 +1,92 @@
+/*
+ * File:   PoolHeap.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:30 AM
+ */
+
+#ifndef POOLHEAP_H
+#define	POOLHEAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/******************************************************************************
+Pool heap -- small blocks from pools of fixed sizes
+DESCRIPTION
+    Most of what the firmware allocates is small and short lived: menu
+    callbacks, string bits, list nodes, DMA objects for LCD commands. A
+    first fit heap searches for each of them and fragments as they come and
+    go. Here each request is rounded up to one of a few size classes, and
+    each class has a free list of its own, so allocating and freeing are a
+    few instructions, whatever's been going on.
+
+    The arena is split into pages. A class takes a page when it runs out of
+    blocks and carves blocks off it as they're needed. Pages stay with their
+    class, so a page's class says how big a block is, and blocks don't need
+    headers. A request that's too big for the largest class, or that comes
+    when the arena's out of pages, gets NULL; the caller goes to the
+    ordinary heap for those.
+
+    Nothing here knows about the PIC32, so it builds on the host. It isn't
+    safe against being interrupted, so the caller disables interrupts
+    around each call if ISRs allocate.
+******************************************************************************/
+
+#define POOL_HEAP_PAGE_SIZE 512
+#define POOL_HEAP_CLASSES 10
+// The largest block, and the alignment of every block
+#define POOL_HEAP_MAX_BLOCK 256
+#define POOL_HEAP_ALIGN 8
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct PoolBlock_s
+{
+    struct PoolBlock_s *next;
+} PoolBlock;
+
+typedef struct
+{
+    uint16_t blockSize;
+    PoolBlock *freeList;
+    uint8_t *carve, *carveEnd;      // The newest page's blocks not yet handed out
+
+    // Stats
+    uint32_t pages;
+    uint32_t inUse, peak;           // Blocks
+    uint32_t allocs, frees;
+    uint32_t failures;              // Out of pages
+} PoolClass;
+
+typedef struct
+{
+    uint8_t *arena;
+    size_t pageCount, nextPage;
+    uint8_t *pageClass;             // Each page's class
+    PoolClass classes[POOL_HEAP_CLASSES];
+    // The class for each size, in POOL_HEAP_ALIGN steps
+    uint8_t classOf[POOL_HEAP_MAX_BLOCK / POOL_HEAP_ALIGN + 1];
+} PoolHeap;
+
+// The arena must be aligned to POOL_HEAP_ALIGN, and pageClass must have a
+// byte for each page
+void PoolHeapInit(PoolHeap *heap, void *arena, size_t size, uint8_t *pageClass);
+
+// NULL if it's too big, or there's no room
+void *PoolHeapAlloc(PoolHeap *heap, size_t size);
+// Only for blocks PoolHeapOwns()
+void PoolHeapFree(PoolHeap *heap, void *p);
+bool PoolHeapOwns(const PoolHeap *heap, const void *p);
+// How big p's block really is
+size_t PoolHeapBlockSize(const PoolHeap *heap, const void *p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* POOLHEAP_H */
@@ -0,0 +1,176 @@
+/*
+ * File:   Remote.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:25 AM
+ */
+
+extern "C"
+{
+#include "definitions.h"
+}
+#include <algorithm>
+#include "console.h"
+#include "LogicMeter.h"
+#include "Remote.h"
+#include "Settings.h"
+#include "SettingsJournal.h"
+#include "Tool.h"
+
+RemoteControl::RemoteControl(LogicMeter &meter) :
+    _meter(meter), _active(false), _waiting(0), _waitingSince(0)
+{
+}
+
+void RemoteControl::Enter()
+{
+    // A frame can have any byte in it
+    CONSOLE_SetBreakOnControlC(false);
+    _active = true;
+}
+
+void RemoteControl::Leave()
+{
+    CONSOLE_SetBreakOnControlC(true);
+    _active = false;
+}
+
+void RemoteControl::OnIdle()
+{
+    if (_active && !CONSOLE_IsOpen())
+        Leave();
+
+    const char *first, *second;
+    size_t firstLength, secondLength;
+    size_t size = CONSOLE_ReadPeek(&first, &firstLength, &second, &secondLength);
+    if (size == 0)
+        return;
+
+    size_t done = _parser.Parse(RemoteSpan((const uint8_t *) first, firstLength,
+        (const uint8_t *) second, secondLength), *this);
+
+    // If a frame's started and nothing's come in for a while, it isn't
+    // coming, so look again from the byte after its sync
+    uint32_t now = SYS_TIME_CounterGet();
+    size_t waiting = size - done;
+    if (done || waiting != _waiting)
+    {
+        _waiting = waiting;
+        _waitingSince = now;
+    }
+    else if (waiting && SYS_TIME_CountToMS(now - _waitingSince) > REMOTE_FRAME_TIMEOUT_MS)
+    {
+        done = RemoteParser::Skip();
+        _waiting = 0;
+        // The console turned Ctrl-C off at the sync byte. It wasn't a frame
+        // after all, so unless remote control has started, turn it back on.
+        if (!_active)
+            CONSOLE_SetBreakOnControlC(true);
+    }
+    CONSOLE_ReadConsume(done);
+}
+
+RemoteStatus RemoteControl::OnCommand(uint8_t command, const RemoteSpan &payload, RemoteResponse &response)
+{
+    if (!_active)
+        Enter();
+    Tool *tool = _meter.CurrentTool();
+
+    switch (RemoteCommand(command))
+    {
+        case RemoteCommand::Ping:
+            return response.Put(payload) ? RemoteStatus::OK : RemoteStatus::BadLength;
+
+        case RemoteCommand::Info:
+            response.PutU8(REMOTE_VERSION);
+            response.PutU8(uint8_t(LogicMeter::ToolCount()));
+            response.PutU8(_meter.CurrentSelection() < 0 ? 0xff : uint8_t(_meter.CurrentSelection()));
+            response.PutU8(_meter.IsRemote() ? 1 : 0);
+            return RemoteStatus::OK;
+
+        case RemoteCommand::Release:
+            Leave();
+            _meter.SelectRemoteTool(-1);
+            return RemoteStatus::OK;
+
+        case RemoteCommand::SelectTool:
+            if (payload.Size() != 1)
+                return RemoteStatus::BadLength;
+            if (payload[0] == 0xff)
+                _meter.SelectRemoteTool(-1);
+            else if (payload[0] < LogicMeter::ToolCount())
+                _meter.SelectRemoteTool(payload[0]);
+            else
+                return RemoteStatus::BadArgument;
+            return RemoteStatus::OK;
+
+        case RemoteCommand::ListSettings:
+        {
+            int count;
+            const JournalField *fields = SettingsFields(count);
+            for (int i = 0; i < count; ++i)
+            {
+                response.PutU8(fields[i].tag);
+                response.PutU8(uint8_t(fields[i].type));
+                response.PutU16(fields[i].size);
+            }
+            return RemoteStatus::OK;
+        }
+
+        case RemoteCommand::GetSetting:
+        {
+            if (payload.Size() != 1)
+                return RemoteStatus::BadLength;
+            const JournalField *field = SettingsFindField(payload[0]);
+            if (!field)
+                return RemoteStatus::BadArgument;
+            return response.Put((const uint8_t *) &settings + field->offset, field->size) ?
+                RemoteStatus::OK : RemoteStatus::BadLength;
+        }
+
+        case RemoteCommand::SetSetting:
+        {
+            if (payload.Size() < 1 || payload.Size() > 1 + JOURNAL_MAX_FIELD_SIZE)
+                return RemoteStatus::BadLength;
+            // The field has to be in one piece
+            uint8_t bytes[JOURNAL_MAX_FIELD_SIZE];
+            RemoteSpan value = payload.Sub(1, payload.Size() - 1);
+            value.CopyTo(bytes);
+            if (!SettingsSetField(payload[0], bytes, value.Size()))
+                return RemoteStatus::BadArgument;
+            // Tools read their settings when they start
+            _meter.RestartTool();
+            return RemoteStatus::OK;
+        }
+
+        case RemoteCommand::Arm:
+            return tool && tool->RemoteArm() ? RemoteStatus::OK : RemoteStatus::NotSupported;
+
+        case RemoteCommand::CaptureStatus:
+        {
+            uint32_t size = 0;
+            RemoteCapture state = tool ? tool->RemoteCaptureState(size) : RemoteCapture::None;
+            response.PutU8(uint8_t(state));
+            response.PutU32(size);
+            return RemoteStatus::OK;
+        }
+
+        case RemoteCommand::Fetch:
+        {
+            if (payload.Size() != 6)
+                return RemoteStatus::BadLength;
+            if (!tool)
+                return RemoteStatus::NotSupported;
+            size_t length = std::min(size_t(payload.U16(4)), response.Space());
+            // Straight into the response
+            response.Commit(tool->RemoteFetch(payload.U32(0), response.Tail(), length));
+            return RemoteStatus::OK;
+        }
+    }
+    return RemoteStatus::UnknownCommand;
+}
+
+void RemoteControl::Send(const uint8_t *frame, size_t length)
+{
+    CONSOLE_WriteSpan((const char *) frame, length);
+}
@@ -0,0 +1,65 @@
+/*
+ * File:   Remote.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:25 AM
+ */
+
+#ifndef REMOTE_H
+#define	REMOTE_H
+
+#include "RemoteProtocol.h"
+
+class LogicMeter;
+
+// How long a frame that's started can take to arrive before it's given up on
+#define REMOTE_FRAME_TIMEOUT_MS 100
+
+/******************************************************************************
+RemoteControl -- drive the meter from a script over the USB console
+DESCRIPTION
+    Whatever comes in over the console is taken as RemoteProtocol frames
+    (nothing else reads it). Responses go out over the console too, mixed
+    in with anything printed, which the host's parser skips like any other
+    garbage.
+
+    Until a whole frame comes in the console is left as it was, so a Ctrl-C
+    from a terminal still throws away what's been typed. The first frame
+    takes the console over: Ctrl-C is just another byte from then on. A
+    Release command, turning the selector switch or closing the port hands
+    it back.
+
+    USB is started by the Utility tool, so turn the selector switch there
+    first. After that tools can be selected remotely, and USB stays up
+    until the switch is turned. Tools read their settings when they start,
+    so select the tool again after setting them.
+******************************************************************************/
+class RemoteControl : public RemoteHandler
+{
+public:
+    RemoteControl(LogicMeter &meter);
+
+    // Handle the frames that have come in. Called from the main loop.
+    void OnIdle();
+    // Whether a script has taken over the console
+    bool IsActive() const {return _active;}
+    // Hand the console back
+    void Leave();
+
+    virtual RemoteStatus OnCommand(uint8_t command, const RemoteSpan &payload, RemoteResponse &response);
+    virtual void Send(const uint8_t *frame, size_t length);
+
+private:
+    RemoteControl(const RemoteControl& orig);
+
+    void Enter();
+
+    LogicMeter &_meter;
+    bool _active;
+    RemoteParser _parser;
+    // The start of a frame that's still coming in, and since when
+    size_t _waiting;
+    uint32_t _waitingSince;
+};
+
+#endif	/* REMOTE_H */
@@ -0,0 +1,150 @@
+/*
+ * File:   RemoteProtocol.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:25 AM
+ */
+
+#include <string.h>
+#include "RemoteProtocol.h"
+
+// A nibble at a time, like the settings journal's CRC, so the table is small
+uint16_t RemoteCRC(uint16_t crc, const uint8_t *data, size_t length)
+{
+    static const uint16_t table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+        0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef
+    };
+    while (length--)
+    {
+        crc ^= uint16_t(*data++) << 8;
+        crc = uint16_t(crc << 4) ^ table[crc >> 12];
+        crc = uint16_t(crc << 4) ^ table[crc >> 12];
+    }
+    return crc;
+}
+
+RemoteSpan RemoteSpan::Sub(size_t offset, size_t length) const
+{
+    if (offset >= _firstLength)
+        return RemoteSpan(_second + offset - _firstLength, length, nullptr, 0);
+    size_t first = _firstLength - offset;
+    if (first >= length)
+        return RemoteSpan(_first + offset, length, nullptr, 0);
+    return RemoteSpan(_first + offset, first, _second, length - first);
+}
+
+uint16_t RemoteSpan::CRC(uint16_t crc) const
+{
+    crc = RemoteCRC(crc, _first, _firstLength);
+    return RemoteCRC(crc, _second, _secondLength);
+}
+
+void RemoteSpan::CopyTo(uint8_t *data) const
+{
+    if (_firstLength)
+        memcpy(data, _first, _firstLength);
+    if (_secondLength)
+        memcpy(data + _firstLength, _second, _secondLength);
+}
+
+RemoteResponse::RemoteResponse(uint8_t *buffer, uint8_t command, uint8_t sequence) :
+    _buffer(buffer), _length(1)
+{
+    _buffer[0] = REMOTE_SYNC;
+    _buffer[1] = command | REMOTE_RESPONSE;
+    _buffer[2] = sequence;
+}
+
+bool RemoteResponse::Put(const void *data, size_t length)
+{
+    if (length > Space())
+        return false;
+    memcpy(Tail(), data, length);
+    _length += length;
+    return true;
+}
+
+bool RemoteResponse::Put(const RemoteSpan &data)
+{
+    if (data.Size() > Space())
+        return false;
+    data.CopyTo(Tail());
+    _length += data.Size();
+    return true;
+}
+
+bool RemoteResponse::PutU16(uint16_t value)
+{
+    uint8_t bytes[2] = {uint8_t(value), uint8_t(value >> 8)};
+    return Put(bytes, sizeof(bytes));
+}
+
+bool RemoteResponse::PutU32(uint32_t value)
+{
+    uint8_t bytes[4] = {uint8_t(value), uint8_t(value >> 8), uint8_t(value >> 16), uint8_t(value >> 24)};
+    return Put(bytes, sizeof(bytes));
+}
+
+size_t RemoteResponse::Finish(RemoteStatus status)
+{
+    _buffer[3] = uint8_t(_length);
+    _buffer[4] = uint8_t(_length >> 8);
+    _buffer[5] = uint8_t(status);
+    uint16_t crc = RemoteCRC(0xffff, _buffer + 1, 4 + _length);
+    _buffer[5 + _length] = uint8_t(crc);
+    _buffer[6 + _length] = uint8_t(crc >> 8);
+    return REMOTE_OVERHEAD + _length;
+}
+
+/******************************************************************************
+FUNCTION RemoteParser::Parse -- handle the frames in some received bytes
+DESCRIPTION
+    Anything before a sync byte is skipped. A frame whose length is too big,
+    or whose CRC is wrong, has only its sync byte skipped, since the real
+    frame may start inside it.
+RETURNS
+    The number of bytes the caller can drop
+******************************************************************************/
+size_t RemoteParser::Parse(const RemoteSpan &input, RemoteHandler &handler)
+{
+    size_t done = 0;
+    size_t size = input.Size();
+    while (done < size)
+    {
+        if (input[done] != REMOTE_SYNC)
+        {
+            ++done;
+            continue;
+        }
+        if (size - done < 5)
+            break;
+
+        size_t length = input.U16(done + 3);
+        size_t most = input[done + 1] & REMOTE_RESPONSE ? REMOTE_MAX_PAYLOAD + 1 : REMOTE_MAX_PAYLOAD;
+        if (length > most)
+        {
+            ++_errors;
+            ++done;
+            continue;
+        }
+        if (size - done < REMOTE_OVERHEAD + length)
+            break;
+
+        uint16_t crc = input.Sub(done + 1, 4 + length).CRC(0xffff);
+        if (crc != input.U16(done + 5 + length))
+        {
+            ++_errors;
+            ++done;
+            continue;
+        }
+
+        ++_frames;
+        uint8_t command = input[done + 1];
+        RemoteResponse response(_response, command, input[done + 2]);
+        RemoteStatus status = handler.OnCommand(command, input.Sub(done + 5, length), response);
+        handler.Send(_response, response.Finish(status));
+        done += REMOTE_OVERHEAD + length;
+    }
+    return done;
+}
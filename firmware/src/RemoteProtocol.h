@@ -0,0 +1,160 @@
+/*
+ * File:   RemoteProtocol.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:25 AM
+ */
+
+#ifndef REMOTEPROTOCOL_H
+#define	REMOTEPROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/******************************************************************************
+Remote protocol -- binary commands and responses over the USB console
+DESCRIPTION
+    Each command and each response is a frame:
+
+        sync        0xA5
+        command     a RemoteCommand; the response has the top bit set
+        sequence    anything; the response echoes it
+        length      of the payload, 16 bits little endian, at most
+                    REMOTE_MAX_PAYLOAD for a command and one more for a
+                    response
+        payload
+        CRC         CRC-16/CCITT (0x1021, starting at 0xFFFF) of everything
+                    from command to the end of the payload, little endian
+
+    A response's payload starts with a RemoteStatus, then has room for as
+    much data as the biggest command, so a Ping can always be echoed.
+    Numbers are little endian throughout.
+
+    The parser works in place on the receive queue, which can wrap, so it's
+    given the bytes as two spans and hands the payload on the same way.
+    Nothing is copied. Bytes that aren't a frame are skipped, and a frame
+    with a bad CRC loses its sync byte, so the parser finds the next frame
+    after any garbage. A frame that's started but never finishes is dropped
+    by the caller with Skip() after a timeout.
+
+    Nothing here knows about the PIC32, so it builds on the host.
+******************************************************************************/
+
+#define REMOTE_SYNC 0xa5
+#define REMOTE_VERSION 1
+#define REMOTE_MAX_PAYLOAD 512
+// Sync, command, sequence, length and CRC
+#define REMOTE_OVERHEAD 7
+#define REMOTE_MAX_FRAME (REMOTE_MAX_PAYLOAD + REMOTE_OVERHEAD)
+// A response has the status on top
+#define REMOTE_MAX_RESPONSE_FRAME (REMOTE_MAX_FRAME + 1)
+#define REMOTE_RESPONSE 0x80
+
+enum class RemoteCommand : uint8_t
+{
+    Ping = 0x01,            // Anything -> the same back
+    Info = 0x02,            // -> version, tool count, current tool (0xFF for none), remote (1 if a tool was selected remotely)
+    Release = 0x03,         // Leave remote control, handing the console and the tools back
+    SelectTool = 0x10,      // Tool index, or 0xFF to go back to the selector switch
+    ListSettings = 0x20,    // -> tag, type, size (16 bits) for each setting
+    GetSetting = 0x21,      // Tag -> the setting's bytes
+    SetSetting = 0x22,      // Tag, bytes; BadArgument if the field can't take them
+    Arm = 0x30,             // Start a capture with the current tool
+    CaptureStatus = 0x31,   // -> RemoteCapture state, result size (32 bits)
+    Fetch = 0x32,           // Offset (32 bits), length (16 bits) -> up to length bytes of the result
+};
+
+enum class RemoteStatus : uint8_t
+{
+    OK,
+    UnknownCommand,
+    BadLength,
+    BadArgument,
+    NotSupported,
+};
+
+enum class RemoteCapture : uint8_t {None, Armed, Ready};
+
+uint16_t RemoteCRC(uint16_t crc, const uint8_t *data, size_t length);
+
+// Bytes that may be split in two, as they are in a ring
+class RemoteSpan
+{
+public:
+    RemoteSpan() : _first(nullptr), _firstLength(0), _second(nullptr), _secondLength(0) {}
+    RemoteSpan(const uint8_t *first, size_t firstLength, const uint8_t *second, size_t secondLength) :
+        _first(first), _firstLength(firstLength), _second(second), _secondLength(secondLength) {}
+
+    size_t Size() const {return _firstLength + _secondLength;}
+    uint8_t operator[](size_t i) const {return i < _firstLength ? _first[i] : _second[i - _firstLength];}
+    // Little endian numbers
+    uint16_t U16(size_t i) const {return (*this)[i] | (*this)[i + 1] << 8;}
+    uint32_t U32(size_t i) const {return U16(i) | uint32_t(U16(i + 2)) << 16;}
+    RemoteSpan Sub(size_t offset, size_t length) const;
+    uint16_t CRC(uint16_t crc) const;
+    void CopyTo(uint8_t *data) const;
+
+private:
+    const uint8_t *_first;
+    size_t _firstLength;
+    const uint8_t *_second;
+    size_t _secondLength;
+};
+
+// Builds a response frame in a buffer of REMOTE_MAX_RESPONSE_FRAME
+class RemoteResponse
+{
+public:
+    RemoteResponse(uint8_t *buffer, uint8_t command, uint8_t sequence);
+
+    // Room left for data
+    size_t Space() const {return REMOTE_MAX_PAYLOAD + 1 - _length;}
+    bool Put(const void *data, size_t length);
+    bool Put(const RemoteSpan &data);
+    bool PutU8(uint8_t value) {return Put(&value, 1);}
+    bool PutU16(uint16_t value);
+    bool PutU32(uint32_t value);
+    // Where data can be written in place; Commit() says how much was
+    uint8_t *Tail() {return _buffer + 5 + _length;}
+    void Commit(size_t length) {_length += length;}
+
+    // Sets the status and the CRC. Returns the frame's length.
+    size_t Finish(RemoteStatus status);
+
+private:
+    uint8_t *_buffer;
+    size_t _length;         // Of the payload, including the status
+};
+
+class RemoteHandler
+{
+public:
+    // Handle a command. The response has room for the data; the status is
+    // the return value.
+    virtual RemoteStatus OnCommand(uint8_t command, const RemoteSpan &payload, RemoteResponse &response) = 0;
+    // Send a finished response
+    virtual void Send(const uint8_t *frame, size_t length) = 0;
+};
+
+class RemoteParser
+{
+public:
+    RemoteParser() : _frames(0), _errors(0) {}
+
+    // Handle every whole frame in the bytes, returning how many bytes are
+    // done with. What's left is the start of a frame still coming in.
+    size_t Parse(const RemoteSpan &input, RemoteHandler &handler);
+    // How many bytes to drop to give up on a frame that's stuck: the sync
+    // byte, so the rest is searched again
+    static size_t Skip() {return 1;}
+
+    uint32_t Frames() const {return _frames;}
+    uint32_t Errors() const {return _errors;}
+
+private:
+    uint32_t _frames;
+    uint32_t _errors;       // Bad CRCs and lengths
+    uint8_t _response[REMOTE_MAX_RESPONSE_FRAME];
+};
+
+#endif	/* REMOTEPROTOCOL_H */
@@ -19,7 +19,9 @@ Implement_InterruptHandler(_SPI##n##_TX_VECTOR, SPIInt[n - 1].transferDone) \
 SPI_INTS(1)
 SPI_INTS(2)
 SPI_INTS(3)
-SPI_INTS(4)
+// SPI 4's receive interrupt is bound directly to ToolSPI
+Implement_InterruptHandler(_SPI4_FAULT_VECTOR, SPIInt[3].fault)
+Implement_InterruptHandler(_SPI4_TX_VECTOR, SPIInt[3].transferDone)
 #ifdef _SPI5_FAULT_VECTOR
 SPI_INTS(5)
 #endif
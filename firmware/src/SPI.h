@@ -65,6 +65,7 @@ public:
         _regs.SPICON.bits.CKE = _regs.SPICON.bits.MSTEN ? !phase : phase;
     }
     
+    // Only change the width while the SPI is disabled
     void SetWidth(int width)
     {
         _regs.SPICON.bits.MODE16 = (width == 16);
@@ -118,6 +119,7 @@ public:
    
     bool TXReady() {return !_regs.SPISTAT.bits.SPITBF;}
     bool TXEmpty() {return _regs.SPISTAT.bits.SPITBE;}
+    bool ShiftRegisterEmpty() {return _regs.SPISTAT.bits.SRMT;}
     void TXData(uint32_t data) {_regs.SPIBUF = data;}
    
     void RegisterWriteCallback(void (*callback)(void *), void *context) 
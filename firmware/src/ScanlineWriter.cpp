@@ -0,0 +1,77 @@
+/*
+ * File:   ScanlineWriter.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 10:30 AM
+ */
+
+#include <string.h>
+#include "ScanlineWriter.h"
+#include "Utility.h"
+
+ScanlineWriter::ScanlineWriter(uint8_t *line0, uint8_t *line1, size_t lineBytes, StartFunction start, void *context) :
+    _lines{line0, line1}, _lineBytes(lineBytes), _bytes{0, 0}, _start(start), _context(context),
+    _busy{false, false}, _next(0), _sending(-1), _waiting(-1)
+{
+}
+
+int ScanlineWriter::WordBits(size_t bytes, int maxWordBits)
+{
+    if (bytes & 1)
+        return 8;
+    return (maxWordBits == 32 && (bytes & 3)) ? 16 : maxWordBits;
+}
+
+uint32_t ScanlineWriter::PacingHz(uint32_t sckHz, int wordBits, uint32_t maxByteRate, int marginPercent)
+{
+    uint64_t byteRate = uint64_t(sckHz / 8) * (100 - marginPercent) / 100;
+    if (byteRate > maxByteRate)
+        byteRate = maxByteRate;
+    return uint32_t(byteRate / (wordBits / 8));
+}
+
+void ScanlineWriter::WriteLine(const uint8_t *data, size_t bytes, int wordBits)
+{
+    int i = _next;
+    uint8_t *dest = _lines[i];
+    _bytes[i] = bytes;
+    switch (wordBits)
+    {
+        case 16 :
+            for (uint16_t *d = (uint16_t *) dest; bytes; bytes -= 2, data += 2)
+                *d++ = (data[0] << 8) | data[1];
+            break;
+
+        case 32 :
+            for (uint32_t *d = (uint32_t *) dest; bytes; bytes -= 4, data += 4)
+                *d++ = (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (data[2] << 8) | data[3];
+            break;
+
+        default :
+            memcpy(dest, data, bytes);
+            break;
+    }
+    _busy[i] = true;
+    _next = i ^ 1;
+
+    // Keep Complete() out while deciding who starts this line
+    DisableInterrupts di;
+    if (_sending < 0)
+    {
+        _sending = i;
+        _start(_lines[i], _bytes[i], _context);
+    }
+    else
+        _waiting = i;
+}
+
+void ScanlineWriter::Complete()
+{
+    if (_sending < 0)
+        return;
+    _busy[_sending] = false;
+    _sending = _waiting;
+    _waiting = -1;
+    if (_sending >= 0)
+        _start(_lines[_sending], _bytes[_sending], _context);
+}
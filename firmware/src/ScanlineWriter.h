@@ -0,0 +1,72 @@
+/*
+ * File:   ScanlineWriter.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 10:30 AM
+ */
+
+#ifndef SCANLINEWRITER_H
+#define	SCANLINEWRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/******************************************************************************
+Scanline writer -- double buffered pixel data for a DMA transport
+DESCRIPTION
+    Pixel data is copied into one of two line buffers and handed to the
+    transport (the LCD's SPI DMA), while the CPU goes on to fill the other.
+    So preparing the next line overlaps sending this one, and the caller
+    may reuse its own buffer as soon as a line has been written: the DMA
+    never reads memory the caller is about to change.
+
+    The SPI shifts each word out MSB first, but the DMA reads words from
+    memory little endian. So the bytes of each 16 or 32 bit word are stored
+    reversed to have them go out in the order they were given.
+
+    When a transfer completes, Complete() (called from the DMA's interrupt)
+    starts the other line if it's waiting. WriteLine() is called from the
+    main loop when LineFree().
+
+    Nothing here knows about the PIC32, so it builds on the host.
+******************************************************************************/
+
+class ScanlineWriter
+{
+public:
+    // Start sending bytes from line. Called from WriteLine() or Complete().
+    typedef void (*StartFunction)(const uint8_t *line, size_t bytes, void *context);
+
+    // The lines are what the DMA reads, so coherent memory on the PIC32
+    ScanlineWriter(uint8_t *line0, uint8_t *line1, size_t lineBytes, StartFunction start, void *context);
+
+    // The SPI word width for pixel data of this many bytes. Pixels are two
+    // bytes, so an odd number of them can't go out in 32 bit words.
+    static int WordBits(size_t bytes, int maxWordBits);
+    // How many words a second to pace the DMA at: marginPercent under the
+    // SPI's byte rate at sckHz, and never more than maxByteRate bytes
+    static uint32_t PacingHz(uint32_t sckHz, int wordBits, uint32_t maxByteRate, int marginPercent);
+
+    // The line WriteLine() fills next has been sent
+    bool LineFree() const {return !_busy[_next];}
+    // Copy up to LineBytes() bytes in and queue them. Only when LineFree().
+    void WriteLine(const uint8_t *data, size_t bytes, int wordBits);
+    // The transport finished the line it was sending
+    void Complete();
+
+    // A line is being sent or waiting to be
+    bool Busy() const {return _sending >= 0;}
+    size_t LineBytes() const {return _lineBytes;}
+
+private:
+    uint8_t *_lines[2];
+    size_t _lineBytes, _bytes[2];
+    StartFunction _start;
+    void *_context;
+    volatile bool _busy[2];
+    int _next;                      // The line to fill next
+    volatile int _sending;          // The line being sent, or -1
+    volatile int _waiting;          // The line queued behind it, or -1
+};
+
+#endif	/* SCANLINEWRITER_H */
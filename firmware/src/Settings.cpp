@@ -9,67 +9,192 @@ extern "C"
 {
 #include "definitions.h"
 }
+#include <stddef.h>
+#include <string.h>
 #include "Settings.h"
+#include "SettingsJournal.h"
 
 Settings settings;
 
-static volatile uint8_t flashBlock[NVM_FLASH_PAGESIZE / sizeof(uint8_t)] 
-    __attribute__((aligned(NVM_FLASH_PAGESIZE), space(prog)));
+#define PAGE_WORDS (NVM_FLASH_PAGESIZE / sizeof(uint32_t))
 
-static bool isDirty = false;
-static uint32_t dirtyTime;
+// The first page is where the settings were kept before the journal, when
+// this was a single page the linker placed. It put it at 0x9d188000 (the
+// one page of zeros past the disk image in the hex built before), so it's
+// pinned there for LoadLegacySettings to find them, with the second page
+// after it.
+#define SETTINGS_FLASH_ADDRESS 0x9d188000
+
+static volatile uint32_t flashBlock[2 * PAGE_WORDS] 
+    __attribute__((aligned(NVM_FLASH_PAGESIZE), space(prog), address(SETTINGS_FLASH_ADDRESS)));
+
+// The fields that are saved. Each has a tag in flash that stays with it
+// for good: new fields get new tags, and the tags of fields that go aren't
+// used again. A field can change size, or move.
+#define SETTINGS_FIELD(tag, type, name) {tag, JournalType::type, offsetof(Settings, name), sizeof(Settings::name)}
+static const JournalField fields[] = {
+    SETTINGS_FIELD(1, Unsigned, screenDimMinutes),
+    SETTINGS_FIELD(2, Unsigned, screenBrightness),
+    SETTINGS_FIELD(3, Signed, gpsLatitude),
+    SETTINGS_FIELD(4, Signed, gpsLongitude),
+    SETTINGS_FIELD(5, Signed, gpsTime),
+    SETTINGS_FIELD(6, Unsigned, gpsBaud),
+    SETTINGS_FIELD(7, Unsigned, gpsRate),
+    SETTINGS_FIELD(8, Unsigned, gpsFormat),
+    SETTINGS_FIELD(9, Signed, pwmHertz),
+    SETTINGS_FIELD(10, Signed, pwmDuty),
+    SETTINGS_FIELD(11, Signed, servoDuty),
+    SETTINGS_FIELD(12, Unsigned, spiPolarity),
+    SETTINGS_FIELD(13, Unsigned, spiPhase),
+    SETTINGS_FIELD(14, Unsigned, spiUseSelect),
+    SETTINGS_FIELD(15, Unsigned, spiWidth),
+    SETTINGS_FIELD(16, Unsigned, uartAutobaud),
+    SETTINGS_FIELD(17, Unsigned, uartBaud),
+    SETTINGS_FIELD(18, Unsigned, uartOutBaud),
+    SETTINGS_FIELD(19, String, uartOutFile),
+    SETTINGS_FIELD(20, Unsigned, triggerMode),
+    SETTINGS_FIELD(21, Unsigned, enabledChannels),
+    SETTINGS_FIELD(22, Unsigned, triggerChannel),
+    SETTINGS_FIELD(23, Unsigned, triggerEdge),
+    SETTINGS_FIELD(24, Unsigned, triggerPosition),
+    SETTINGS_FIELD(25, Unsigned, sampleFreq)
+};
+
+// Bump SETTINGS_VERSION when a field's meaning changes, e.g. its units, and
+// convert settings saved with older versions here. Changes of size are
+// taken care of by the journal.
+#define SETTINGS_VERSION 1
+
+// Version 0 is the whole struct saved before the journal (see
+// LoadLegacySettings). No field has changed its meaning since, and the ones
+// added since keep their defaults, so there's nothing to do for it yet.
+static void MigrateSettings(uint32_t version, void *data)
+{
+}
+
+// The settings pages, read uncached so we see what's been written
+class NVMFlash : public JournalFlash
+{
+public:
+    uint32_t Read(int page, size_t word) const 
+    {
+        return ((volatile uint32_t *) KVA0_TO_KVA1(flashBlock))[page * PAGE_WORDS + word];
+    }
+    bool IsBusy() const {return NVM_IsBusy();}
+    void Write(int page, size_t word, uint32_t value)
+    {
+        NVM_WordWrite(value, uint32_t(flashBlock + page * PAGE_WORDS + word));
+    }
+    void Erase(int page) {NVM_PageErase(uint32_t(flashBlock + page * PAGE_WORDS));}
+};
+
+// The settings as the firmware before the journal kept them: whole
+// structs, one after another from the start of the first page, the last
+// with validity 1 being the current one. The fields are as they were then,
+// so the compiler lays it out the same.
+struct LegacySettings
+{
+    uint8_t validity;
+    uint32_t screenDimMinutes;
+    uint8_t screenBrightness;
+    int32_t gpsLatitude, gpsLongitude;
+    time_t gpsTime;
+    uint32_t gpsBaud;
+    long long pwmHertz, pwmDuty;
+    long long servoDuty;
+    uint8_t spiPolarity, spiPhase, spiUseSelect;
+    uint8_t spiWidth;
+    bool uartAutobaud;
+    uint32_t uartBaud;
+    uint32_t uartOutBaud;
+    char uartOutFile[SYS_FS_FILE_NAME_LEN + 1];
+    TriggerMode triggerMode;
+    uint8_t enabledChannels;
+    uint8_t triggerChannel;
+    TriggerEdge triggerEdge;
+    uint32_t triggerPosition;
+    uint32_t sampleFreq;
+};
 
-// Returns the last Settings struct in flash memory that has valid set. If
-// there are only invalid settings, returns -1
-static int GetLatestFlashSettingsIndex()
+/******************************************************************************
+FUNCTION LoadLegacySettings -- read settings saved before the journal
+DESCRIPTION
+    So an upgrade keeps the settings rather than going back to the defaults,
+    as long as it leaves this page alone: a bootloader does, and so does a
+    programmer set to preserve the range.
+    The journal leaves the first page alone until it has a page of its own
+    that's good, so if the power goes while that's written, this finds them
+    again next time.
+RETURNS
+    false if there weren't any
+******************************************************************************/
+static bool LoadLegacySettings()
 {
-    const Settings *s = (const Settings *) flashBlock;
-    size_t settingsCount = sizeof(flashBlock) / sizeof(Settings);
+    const LegacySettings *s = (const LegacySettings *) KVA0_TO_KVA1(flashBlock);
+    size_t count = NVM_FLASH_PAGESIZE / sizeof(LegacySettings);
     size_t i;
-    for (i = 0; i < settingsCount && s[i].validity == 1; ++i)
+    for (i = 0; i < count && s[i].validity == 1; ++i)
     {
     }
-    return int(i) - 1;
+    if (i == 0)
+        return false;
+
+    LegacySettings old = s[i - 1];
+    settings.screenDimMinutes = old.screenDimMinutes;
+    settings.screenBrightness = old.screenBrightness;
+    settings.gpsLatitude = old.gpsLatitude;
+    settings.gpsLongitude = old.gpsLongitude;
+    settings.gpsTime = old.gpsTime;
+    settings.gpsBaud = old.gpsBaud;
+    settings.pwmHertz = old.pwmHertz;
+    settings.pwmDuty = old.pwmDuty;
+    settings.servoDuty = old.servoDuty;
+    settings.spiPolarity = old.spiPolarity;
+    settings.spiPhase = old.spiPhase;
+    settings.spiUseSelect = old.spiUseSelect;
+    settings.spiWidth = old.spiWidth;
+    settings.uartAutobaud = old.uartAutobaud;
+    settings.uartBaud = old.uartBaud;
+    settings.uartOutBaud = old.uartOutBaud;
+    memcpy(settings.uartOutFile, old.uartOutFile, sizeof(settings.uartOutFile));
+    settings.uartOutFile[sizeof(settings.uartOutFile) - 1] = '\0';
+    settings.triggerMode = old.triggerMode;
+    settings.enabledChannels = old.enabledChannels;
+    settings.triggerChannel = old.triggerChannel;
+    settings.triggerEdge = old.triggerEdge;
+    settings.triggerPosition = old.triggerPosition;
+    settings.sampleFreq = old.sampleFreq;
+    return true;
 }
 
+static NVMFlash nvmFlash;
+static SettingsJournal journal(nvmFlash, PAGE_WORDS, NVM_FLASH_ROWSIZE / sizeof(uint32_t),
+    fields, sizeof(fields) / sizeof(fields[0]), sizeof(Settings), SETTINGS_VERSION, MigrateSettings);
+
+static bool isDirty = false;
+static uint32_t dirtyTime;
+
 void SettingsInitialize()
 {
-    int i = GetLatestFlashSettingsIndex();
-    if (i >= 0)
-        settings = *((Settings *) KVA0_TO_KVA1(flashBlock) + i);
+    // Settings from before the journal are version 0, and go straight into
+    // its first snapshot
+    if (!journal.Load(&settings) && LoadLegacySettings())
+    {
+        MigrateSettings(0, &settings);
+        journal.Save(&settings);
+    }
 }
 
+// Nothing here waits for the flash: the journal writes a word or starts an
+// erase each time round if the flash is ready
 void SettingsOnIdle()
 {
     if (isDirty && SYS_TIME_CountToMS(SYS_TIME_CounterGet() - dirtyTime) > SettingsWriteDelayMS)
     {
         isDirty = false;
-        
-        // Find the next available spot to write the settings
-        int validSettingsIndex = GetLatestFlashSettingsIndex();
-        // If validSettingsIndex == -1, there are no valid settings in flash. That means it's a brand
-        // new burn of flash memory. We need to do a Page Erase before writing settings.
-        // If validSettingsIndex is the last settings block that fits in flash, then we also need to do
-        // Page Erase(s) and start writing settings at the beginning of the block.
-        if (validSettingsIndex == -1 || validSettingsIndex >= sizeof(flashBlock) / sizeof(Settings) - 1)
-        {
-            uint32_t page = uint32_t(flashBlock);
-            for (int i = 0; i < sizeof(flashBlock) / NVM_FLASH_PAGESIZE; ++i, page += NVM_FLASH_PAGESIZE)
-            {
-                while (NVM_IsBusy()) {}
-                NVM_PageErase(uint32_t(page));
-            }
-            validSettingsIndex = -1;
-        }
-        
-        //  Now write the settings
-        uint32_t dest = uint32_t((Settings *) flashBlock + validSettingsIndex + 1);
-        for (int i = 0; i < sizeof(Settings) / sizeof(uint32_t); ++i, dest += sizeof(uint32_t))
-        {
-            while (NVM_IsBusy()) {}
-            NVM_WordWrite(*((uint32_t *) &settings + i), dest);
-        }
+        journal.Save(&settings);
     }
+    journal.Step();
 }
 
 void SettingsModified()
@@ -78,10 +203,160 @@ void SettingsModified()
     isDirty = true;
 }
 
+const JournalField *SettingsFields(int &count)
+{
+    count = sizeof(fields) / sizeof(fields[0]);
+    return fields;
+}
+
+const JournalField *SettingsFindField(int tag)
+{
+    for (const JournalField &field : fields)
+    {
+        if (field.tag == tag)
+            return &field;
+    }
+    return nullptr;
+}
+
+// What each field may be set to from outside: what the menus and spinners
+// can set it to, or what the code that uses it can cope with
+static bool OneOf(uint32_t value, const uint32_t *values, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (values[i] == value)
+            return true;
+    }
+    return false;
+}
+
+// The rates on the baud menus
+static bool ValidBaud(uint32_t baud)
+{
+    static const uint32_t bauds[] = {110, 300, 1200, 2400, 4800, 9600, 14400, 19200, 38400, 57600, 115200};
+    return OneOf(baud, bauds, sizeof(bauds) / sizeof(bauds[0]));
+}
+
+static bool ValidFlag(const void *flag) {return *(const uint8_t *) flag <= 1;}
+
+static bool ValidDuty(long long duty) {return duty >= 0 && duty <= 100 * fixed::scale;}
+
+// A file in the flash disk's root, so printable and no path
+static bool ValidFileName(const char *name)
+{
+    for (; *name; ++name)
+    {
+        if (*name < ' ' || *name > '~' || *name == '/' || *name == '\\')
+            return false;
+    }
+    return true;
+}
+
+static bool ValidScreenDimMinutes(const Settings &s) {return s.screenDimMinutes >= 1 && s.screenDimMinutes <= 24 * 60;}
+static bool ValidScreenBrightness(const Settings &s) {return s.screenBrightness >= 1 && s.screenBrightness <= 100;}
+static bool ValidGPSLatitude(const Settings &s) {return s.gpsLatitude >= -900000 && s.gpsLatitude <= 900000;}
+static bool ValidGPSLongitude(const Settings &s) {return s.gpsLongitude >= -1800000 && s.gpsLongitude <= 1800000;}
+static bool ValidGPSTime(const Settings &s) {return s.gpsTime >= 0;}
+static bool ValidGPSBaud(const Settings &s) {return ValidBaud(s.gpsBaud);}
+static bool ValidPWMHertz(const Settings &s)
+{
+    return s.pwmHertz >= 0 && s.pwmHertz <= fixed(TMR2_FrequencyGet()).raw();
+}
+static bool ValidPWMDuty(const Settings &s) {return ValidDuty(s.pwmDuty);}
+static bool ValidServoDuty(const Settings &s) {return ValidDuty(s.servoDuty);}
+static bool ValidSPIPolarity(const Settings &s) {return s.spiPolarity <= 1;}
+static bool ValidSPIPhase(const Settings &s) {return s.spiPhase <= 1;}
+static bool ValidSPIUseSelect(const Settings &s) {return s.spiUseSelect <= 1;}
+static bool ValidSPIWidth(const Settings &s) {return s.spiWidth == 8 || s.spiWidth == 16 || s.spiWidth == 32;}
+static bool ValidUARTAutobaud(const Settings &s) {return ValidFlag(&s.uartAutobaud);}
+static bool ValidUARTBaud(const Settings &s) {return ValidBaud(s.uartBaud);}
+static bool ValidUARTOutBaud(const Settings &s) {return ValidBaud(s.uartOutBaud);}
+static bool ValidUARTOutFile(const Settings &s) {return ValidFileName(s.uartOutFile);}
+static bool ValidTriggerMode(const Settings &s) {return uint8_t(s.triggerMode) <= uint8_t(TriggerMode::Single);}
+static bool ValidEnabledChannels(const Settings &s) {return s.enabledChannels <= 7;}
+static bool ValidTriggerChannel(const Settings &s) {return s.triggerChannel <= 3;}
+static bool ValidTriggerEdge(const Settings &s) {return uint8_t(s.triggerEdge) <= uint8_t(TriggerEdge::Either);}
+static bool ValidTriggerPosition(const Settings &s) {return s.triggerPosition <= 100;}
+static bool ValidSampleFreq(const Settings &s)
+{
+    static const uint32_t rates[] = {10000, 100000, 1000000, 10000000};
+    return OneOf(s.sampleFreq, rates, sizeof(rates) / sizeof(rates[0]));
+}
+static bool ValidGPSRate(const Settings &s)
+{
+    static const uint32_t rates[] = {1, 2, 4, 5, 10};
+    return OneOf(s.gpsRate, rates, sizeof(rates) / sizeof(rates[0]));
+}
+static bool ValidGPSFormat(const Settings &s) {return uint8_t(s.gpsFormat) <= uint8_t(GPSFormat::Both);}
+
+// By tag. A field that isn't here can't be set from outside.
+struct FieldValidator
+{
+    uint8_t tag;
+    bool (*valid)(const Settings &s);
+};
+static const FieldValidator validators[] = {
+    {1, ValidScreenDimMinutes},
+    {2, ValidScreenBrightness},
+    {3, ValidGPSLatitude},
+    {4, ValidGPSLongitude},
+    {5, ValidGPSTime},
+    {6, ValidGPSBaud},
+    {7, ValidGPSRate},
+    {8, ValidGPSFormat},
+    {9, ValidPWMHertz},
+    {10, ValidPWMDuty},
+    {11, ValidServoDuty},
+    {12, ValidSPIPolarity},
+    {13, ValidSPIPhase},
+    {14, ValidSPIUseSelect},
+    {15, ValidSPIWidth},
+    {16, ValidUARTAutobaud},
+    {17, ValidUARTBaud},
+    {18, ValidUARTOutBaud},
+    {19, ValidUARTOutFile},
+    {20, ValidTriggerMode},
+    {21, ValidEnabledChannels},
+    {22, ValidTriggerChannel},
+    {23, ValidTriggerEdge},
+    {24, ValidTriggerPosition},
+    {25, ValidSampleFreq}
+};
+
+/******************************************************************************
+FUNCTION SettingsSetField -- set a field from outside, if the value's good
+DESCRIPTION
+    The bytes are decoded into a copy of the settings and checked there, so
+    a bad value never reaches the tools. A field with no validator is
+    refused.
+RETURNS
+    false if the tag isn't a field that can be set, or the value isn't one
+    it can take
+******************************************************************************/
+bool SettingsSetField(int tag, const uint8_t *bytes, size_t length)
+{
+    const FieldValidator *validator = nullptr;
+    for (const FieldValidator &v : validators)
+    {
+        if (v.tag == tag)
+            validator = &v;
+    }
+    if (!validator || !SettingsFindField(tag))
+        return false;
+
+    Settings changed = settings;
+    journal.DecodeField(tag, bytes, length, &changed);
+    if (!(*validator->valid)(changed))
+        return false;
+    settings = changed;
+    SettingsModified();
+    return true;
+}
+
 void SettingsDump()
 {
-    printf("validity = %d;\r\n\r\n"
-            "screenDimMinutes = %d;\r\n\r\n"
+    printf("screenDimMinutes = %d;\r\n\r\n"
             "gpsLatitude = %d, gpsLongitude = %d;\r\n"
             "gpsTime = %u;\r\n"
             "gpsBaud = %u;\r\n\r\n"
@@ -90,10 +365,9 @@ void SettingsDump()
             "spiPolarity = %d, spiPhase = %d, spiUseSelect = %d;\r\n\r\n"
             "uartAutobaud = %d;\r\n"
             "uartBaud = %u;\r\n",
-            settings.validity, 
             settings.screenDimMinutes, 
             settings.gpsLatitude, settings.gpsLongitude, 
-            settings.gpsTime, settings.gpsBaud,
+            (unsigned) settings.gpsTime, settings.gpsBaud,
             settings.pwmHertz, settings.pwmDuty,
             settings.servoDuty,
             settings.spiPolarity, settings.spiPhase, settings.spiUseSelect,
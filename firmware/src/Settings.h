@@ -8,18 +8,17 @@
 #ifndef SETTINGS_H
 #define	SETTINGS_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <time.h>
 #include "fixed.h"
 
 enum class TriggerMode : uint8_t {Auto, Normal, Single};
 enum class TriggerEdge : uint8_t {Rising, Falling, Either};
+enum class GPSFormat : uint8_t {NMEA, UBX, Both};
 
 struct Settings
 {
-    // 1 is valid; any other value is invalid
-    uint8_t validity = 1;
-    
     // System
     uint32_t screenDimMinutes = 5;
     uint8_t screenBrightness = 50; // 1..100; lower numbers are brighter
@@ -56,6 +55,9 @@ struct Settings
     uint32_t triggerPosition = 50; // Percentage of the acquisition buffer before trigger
     uint32_t sampleFreq = 1000000;
     
+    // GPS output
+    uint8_t gpsRate = 1; // Fixes per second
+    GPSFormat gpsFormat = GPSFormat::NMEA;
 };
 
 void SettingsInitialize();
@@ -63,6 +65,16 @@ void SettingsOnIdle();
 void SettingsModified();
 void SettingsDump();
 
+// The saved fields, by tag, for getting at settings from outside, e.g. by
+// remote control
+struct JournalField;
+const JournalField *SettingsFields(int &count);
+const JournalField *SettingsFindField(int tag);
+// Set a field from bytes the way they'd be loaded from flash, so they're
+// extended or truncated to the field's size. Returns false for a tag
+// that isn't a field that can be set, or a value the field can't take.
+bool SettingsSetField(int tag, const uint8_t *bytes, size_t length);
+
 // How many ms to wait before writing modified settings to flash
 #define SettingsWriteDelayMS 5000
 
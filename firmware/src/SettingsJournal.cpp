@@ -0,0 +1,408 @@
+/*
+ * File:   SettingsJournal.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:10 AM
+ */
+
+#include <string.h>
+#include "SettingsJournal.h"
+
+#define ERASED 0xffffffff
+#define PAGE_MARKER 0x4c4d534a  // "LMSJ"
+#define RECORD_MARKER 0x5e
+#define SNAPSHOT_TAG 0xff
+// The page header is the marker, then the sequence number
+#define HEADER_WORDS 2
+
+static uint32_t RecordHeader(int tag, size_t length)
+{
+    return (uint32_t(RECORD_MARKER) << 24) | (uint32_t(tag) << 16) | uint32_t(length);
+}
+
+/******************************************************************************
+FUNCTION SettingsJournal::CRC -- CRC-32 of some words
+DESCRIPTION
+    The usual reflected CRC-32 (as in zip), a nibble at a time so the table
+    is small. Words go low byte first.
+RETURNS
+    The CRC, except that all ones becomes 0 so it never looks unwritten
+******************************************************************************/
+uint32_t SettingsJournal::CRC(const uint32_t *words, size_t count)
+{
+    static const uint32_t table[16] = {
+        0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+        0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c
+    };
+    uint32_t crc = ERASED;
+    for (size_t i = 0; i < count; ++i)
+    {
+        crc ^= words[i];
+        for (int j = 0; j < 8; ++j)
+            crc = (crc >> 4) ^ table[crc & 0xf];
+    }
+    crc = ~crc;
+    return crc == ERASED ? 0 : crc;
+}
+
+SettingsJournal::SettingsJournal(JournalFlash &flash, size_t pageWords, size_t blockWords,
+        const JournalField *fields, int fieldCount, size_t dataSize,
+        uint32_t version, JournalMigration migrate) :
+    _flash(flash), _pageWords(pageWords), _blockWords(blockWords),
+    _fields(fields), _fieldCount(fieldCount), _dataSize(dataSize),
+    _version(version), _migrate(migrate),
+    _active(-1), _sequence(0), _page(0), _block(0), _writeWord(HEADER_WORDS),
+    _state(Idle), _compacting(false), _snapshotDue(true), _field(0), _recordLength(0), _recordPos(0)
+{
+    _latest = new uint8_t[dataSize];
+    _saved = new uint8_t[dataSize];
+    _record = new uint32_t[blockWords];
+}
+
+SettingsJournal::~SettingsJournal()
+{
+    delete [] _latest;
+    delete [] _saved;
+    delete [] _record;
+}
+
+size_t SettingsJournal::BlockStart(int block) const
+{
+    return block ? block * _blockWords : HEADER_WORDS;
+}
+
+size_t SettingsJournal::EncodeField(int index, const void *data, uint32_t *words) const
+{
+    const JournalField &field = _fields[index];
+    size_t dataWords = (field.size + 3) / 4;
+    words[0] = RecordHeader(field.tag, field.size);
+    words[dataWords] = 0;
+    memcpy(words + 1, (const uint8_t *) data + field.offset, field.size);
+    words[1 + dataWords] = CRC(words, 1 + dataWords);
+    return 2 + dataWords;
+}
+
+size_t SettingsJournal::EncodeSnapshot(const void *data, uint32_t *words) const
+{
+    size_t w = 1;
+    words[w++] = _version;
+    for (int i = 0; i < _fieldCount; ++i)
+    {
+        const JournalField &field = _fields[i];
+        size_t dataWords = (field.size + 3) / 4;
+        words[w] = (uint32_t(field.tag) << 16) | field.size;
+        words[w + dataWords] = 0;
+        memcpy(words + w + 1, (const uint8_t *) data + field.offset, field.size);
+        w += 1 + dataWords;
+    }
+    words[0] = RecordHeader(SNAPSHOT_TAG, (w - 1) * 4);
+    words[w] = CRC(words, w);
+    return w + 1;
+}
+
+/******************************************************************************
+FUNCTION SettingsJournal::DecodeField -- migrate a field's bytes into place
+DESCRIPTION
+    A field of a different size than it was saved with is truncated, or
+    extended with zeros (or with ones, for a negative signed number). A
+    string is always left terminated. A tag that's no longer in the table is
+    a field that's gone, and is ignored.
+******************************************************************************/
+void SettingsJournal::DecodeField(int tag, const uint8_t *bytes, size_t length, void *data) const
+{
+    const JournalField *field = nullptr;
+    for (int i = 0; i < _fieldCount && !field; ++i)
+    {
+        if (_fields[i].tag == tag)
+            field = _fields + i;
+    }
+    if (!field)
+        return;
+
+    uint8_t *dest = (uint8_t *) data + field->offset;
+    size_t n = length < field->size ? length : field->size;
+    memcpy(dest, bytes, n);
+    if (n < field->size)
+    {
+        uint8_t fill = 0;
+        if (field->type == JournalType::Signed && n && (bytes[n - 1] & 0x80))
+            fill = 0xff;
+        memset(dest + n, fill, field->size - n);
+    }
+    if (field->type == JournalType::String && field->size)
+        dest[field->size - 1] = '\0';
+}
+
+bool SettingsJournal::DecodeSnapshot(const uint32_t *words, size_t count, void *data, uint32_t &version) const
+{
+    if (count < 3 || words[0] != RecordHeader(SNAPSHOT_TAG, (count - 2) * 4) ||
+        words[count - 1] != CRC(words, count - 1))
+    {
+        return false;
+    }
+
+    version = words[1];
+    size_t w = 2;
+    while (w < count - 1)
+    {
+        int tag = (words[w] >> 16) & 0xff;
+        size_t length = words[w] & 0xffff;
+        size_t dataWords = (length + 3) / 4;
+        if (w + 1 + dataWords > count - 1)
+            break;
+        DecodeField(tag, (const uint8_t *) (words + w + 1), length, data);
+        w += 1 + dataWords;
+    }
+    return true;
+}
+
+int SettingsJournal::FindLastBlock(int page) const
+{
+    // Block 0 is always there on a finished page
+    int low = 0, high = int(_pageWords / _blockWords) - 1;
+    while (low < high)
+    {
+        int middle = (low + high + 1) / 2;
+        if (_flash.Read(page, BlockStart(middle)) != ERASED)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    return low;
+}
+
+// Read the record at word into _record. Returns its length in words, or 0
+// if there's no record there, it runs past end or its CRC is wrong.
+size_t SettingsJournal::ReadRecord(int page, size_t word, size_t end)
+{
+    uint32_t header = _flash.Read(page, word);
+    size_t count = 2 + ((header & 0xffff) + 3) / 4;
+    if (header == ERASED || header >> 24 != RECORD_MARKER || word + count > end)
+        return 0;
+    for (size_t i = 0; i < count; ++i)
+        _record[i] = _flash.Read(page, word + i);
+    return _record[count - 1] == CRC(_record, count - 1) ? count : 0;
+}
+
+bool SettingsJournal::Load(void *data)
+{
+    // Find the newest page that was finished
+    _active = -1;
+    for (int page = 0; page < 2; ++page)
+    {
+        if (_flash.Read(page, 0) != PAGE_MARKER)
+            continue;
+        uint32_t sequence = _flash.Read(page, 1);
+        if (_active < 0 || int32_t(sequence - _sequence) > 0)
+        {
+            _active = page;
+            _sequence = sequence;
+        }
+    }
+
+    _state = Idle;
+    _snapshotDue = true;
+    uint8_t *bytes = (uint8_t *) data;
+    uint32_t version = _version;
+
+    int last = _active >= 0 ? FindLastBlock(_active) : -1;
+    int block;
+    size_t count = 0;
+    for (block = last; block >= 0; --block)
+    {
+        count = ReadRecord(_active, BlockStart(block), BlockEnd(block));
+        if (count && DecodeSnapshot(_record, count, data, version))
+            break;
+    }
+
+    if (block >= 0)
+    {
+        // Replay the records after the snapshot
+        size_t word = BlockStart(block) + count;
+        size_t end = BlockEnd(block);
+        while (word < end)
+        {
+            uint32_t header = _flash.Read(_active, word);
+            if (header == ERASED)
+                break;
+            size_t span = 2 + ((header & 0xffff) + 3) / 4;
+            int tag = (header >> 16) & 0xff;
+            if (header >> 24 != RECORD_MARKER || tag == SNAPSHOT_TAG || word + span > end)
+            {
+                // Not something we wrote. Don't add to this block.
+                word = end;
+                break;
+            }
+            if (ReadRecord(_active, word, end))
+                DecodeField(tag, (const uint8_t *) (_record + 1), header & 0xffff, data);
+            word += span;
+        }
+
+        // Carry on after the last record, unless this isn't the last block
+        _page = _active;
+        _block = last;
+        _writeWord = word;
+        _snapshotDue = block != last;
+    }
+    else
+        _active = -1;
+
+    // Settings from an older layout get a snapshot in the current one
+    if (_active >= 0 && version != _version)
+    {
+        if (_migrate && version < _version)
+            (*_migrate)(version, data);
+        _snapshotDue = true;
+    }
+
+    memcpy(_latest, bytes, _dataSize);
+    memcpy(_saved, bytes, _dataSize);
+    return _active >= 0;
+}
+
+void SettingsJournal::Save(const void *data)
+{
+    memcpy(_latest, data, _dataSize);
+    if (_state == Idle)
+    {
+        _field = 0;
+        NextRecord();
+    }
+}
+
+void SettingsJournal::StartSnapshot()
+{
+    memcpy(_saved, _latest, _dataSize);
+    _recordLength = EncodeSnapshot(_saved, _record);
+    _recordPos = 0;
+    _field = 0;
+    _snapshotDue = false;
+    _state = Writing;
+}
+
+void SettingsJournal::StartCompaction()
+{
+    // A first journal goes in the second page, so whatever's in the first
+    // (settings from before the journal) stays until the journal's good
+    _page = _active < 0 ? 1 : 1 - _active;
+    _compacting = true;
+    _flash.Erase(_page);
+    _state = Erasing;
+}
+
+/******************************************************************************
+FUNCTION SettingsJournal::NextRecord -- set up the next record to write
+DESCRIPTION
+    Fields that differ from what's in flash get a record. If one won't fit
+    in the block, the next block is started with a snapshot, and if there
+    isn't a next block the journal moves to the other page.
+
+    A field that changes after its record has gone out is caught by going
+    round again once the rest are done.
+RETURNS
+    true if there's something to write
+******************************************************************************/
+bool SettingsJournal::NextRecord()
+{
+    if (_compacting)
+    {
+        // The snapshot is in; finish the page
+        _recordPos = 0;
+        _state = WritingHeader;
+        return true;
+    }
+
+    for (;;)
+    {
+        if (_snapshotDue || _active < 0)
+        {
+            if (_active < 0 || _block + 1 >= int(_pageWords / _blockWords))
+            {
+                StartCompaction();
+                return true;
+            }
+            ++_block;
+            _writeWord = BlockStart(_block);
+            StartSnapshot();
+            return true;
+        }
+
+        for (; _field < _fieldCount; ++_field)
+        {
+            const JournalField &field = _fields[_field];
+            if (!memcmp(_latest + field.offset, _saved + field.offset, field.size))
+                continue;
+
+            if (_writeWord + 2 + (field.size + 3) / 4 > BlockEnd(_block))
+            {
+                _snapshotDue = true;
+                break;
+            }
+            memcpy(_saved + field.offset, _latest + field.offset, field.size);
+            _recordLength = EncodeField(_field++, _saved, _record);
+            _recordPos = 0;
+            _state = Writing;
+            return true;
+        }
+
+        if (_snapshotDue)
+            continue;
+        if (!memcmp(_latest, _saved, _dataSize))
+        {
+            _state = Idle;
+            return false;
+        }
+        _field = 0;
+    }
+}
+
+bool SettingsJournal::Step()
+{
+    if (_state == Idle)
+        return false;
+    if (_flash.IsBusy())
+        return true;
+
+    switch (_state)
+    {
+    case Erasing:
+        _block = 0;
+        _writeWord = BlockStart(0);
+        StartSnapshot();
+        break;
+
+    case Writing:
+        if (_recordPos < _recordLength)
+            _flash.Write(_page, _writeWord++, _record[_recordPos++]);
+        else
+            NextRecord();
+        break;
+
+    case WritingHeader:
+        // The sequence number, then the marker that makes the page good
+        if (_recordPos == 0)
+        {
+            _flash.Write(_page, 1, _sequence + 1);
+            _recordPos = 1;
+        }
+        else if (_recordPos == 1)
+        {
+            _flash.Write(_page, 0, PAGE_MARKER);
+            _recordPos = 2;
+        }
+        else
+        {
+            _active = _page;
+            ++_sequence;
+            _compacting = false;
+            _field = 0;
+            NextRecord();
+        }
+        break;
+
+    default:
+        break;
+    }
+    return _state != Idle;
+}
+
@@ -0,0 +1,144 @@
+/*
+ * File:   SettingsJournal.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:10 AM
+ */
+
+#ifndef SETTINGSJOURNAL_H
+#define	SETTINGSJOURNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/******************************************************************************
+Settings journal -- settings kept in flash as a log of changed fields
+DESCRIPTION
+    Two flash pages take turns, and each page is split into blocks (a flash
+    row each on the PIC32). A block starts with a snapshot record of every
+    field, followed by a record for each field as it changes. A record is
+
+        header      0x5E, a tag (8 bits), the length in bytes (16 bits)
+        data        padded to whole words
+        CRC         CRC-32 of the header and data, never all ones
+
+    A field's record has the field's tag and its bytes. A snapshot has tag
+    0xFF, and its data is the layout version followed by each field as a
+    word with its tag and length and then its bytes. The CRC is written
+    last, so a record cut off by a power loss fails it and is skipped.
+
+    Fields are found by tag, so fields can come and go and be moved around
+    in the settings. A field whose size has changed is sign or zero
+    extended, or truncated. If the layout version in flash is older than
+    the current one, a migration function gets to fix up anything else, and
+    a fresh snapshot is written at the next save.
+
+    Blocks are started in order, and the first word of a block is the first
+    written, so finding the last block is a binary search. Loading decodes
+    its snapshot and replays the records after it, so it takes the same
+    time however full the page is. If the last block's snapshot was cut
+    off, the block before it is used.
+
+    When a record won't fit in a block, a new block is started with a
+    snapshot. When the page runs out of blocks, a snapshot is written to the
+    other page and its header (a sequence number, then a marker) is written
+    last. Until then the old page is still the one that's loaded. The page
+    with the marker and the highest sequence number is the active one.
+
+    Nothing waits for the flash. Step() starts the next word write or erase
+    if the flash is ready, so it's called from the main loop and the main
+    loop never stalls. Nothing here knows about the PIC32, so it builds on
+    the host. Fields are stored in the machine's byte order, which is little
+    endian on the PIC32.
+******************************************************************************/
+
+#define JOURNAL_MAX_FIELD_SIZE 256
+
+enum class JournalType : uint8_t {Unsigned, Signed, Bytes, String};
+
+// Where a field is in the settings. A tag mustn't be used again once its
+// field has gone.
+struct JournalField
+{
+    uint8_t tag;
+    JournalType type;
+    uint16_t offset, size;
+};
+
+// Fixes up settings loaded from an older layout version
+typedef void (*JournalMigration)(uint32_t version, void *data);
+
+// The flash the journal is kept in: two pages of words
+class JournalFlash
+{
+public:
+    virtual uint32_t Read(int page, size_t word) const = 0;
+    virtual bool IsBusy() const = 0;
+    virtual void Write(int page, size_t word, uint32_t value) = 0;
+    virtual void Erase(int page) = 0;
+};
+
+class SettingsJournal
+{
+public:
+    SettingsJournal(JournalFlash &flash, size_t pageWords, size_t blockWords,
+        const JournalField *fields, int fieldCount, size_t dataSize,
+        uint32_t version, JournalMigration migrate);
+    ~SettingsJournal();
+
+    // Load the journal into data. Fields with no record are left alone.
+    // Returns false if there's no journal in flash.
+    bool Load(void *data);
+    // Start writing whatever's changed since the last save
+    void Save(const void *data);
+    // Start the next flash operation if the flash is ready. Returns true
+    // while there's still writing to do.
+    bool Step();
+
+    // Records, each returning its length in words
+    size_t EncodeSnapshot(const void *data, uint32_t *words) const;
+    size_t EncodeField(int index, const void *data, uint32_t *words) const;
+    // Apply a snapshot record to data. Returns false if it isn't one or its
+    // CRC is wrong.
+    bool DecodeSnapshot(const uint32_t *words, size_t count, void *data, uint32_t &version) const;
+    // Copy a field's bytes into data, migrating them to its current size
+    void DecodeField(int tag, const uint8_t *bytes, size_t length, void *data) const;
+    // The last block that's been started on a page
+    int FindLastBlock(int page) const;
+
+    static uint32_t CRC(const uint32_t *words, size_t count);
+
+private:
+    size_t BlockStart(int block) const;
+    size_t BlockEnd(int block) const {return (block + 1) * _blockWords;}
+    size_t ReadRecord(int page, size_t word, size_t end);
+    bool NextRecord();
+    void StartSnapshot();
+    void StartCompaction();
+
+    JournalFlash &_flash;
+    size_t _pageWords, _blockWords;
+    const JournalField *_fields;
+    int _fieldCount;
+    size_t _dataSize;
+    uint32_t _version;
+    JournalMigration _migrate;
+
+    // The settings as last saved, and as they are in flash (or will be once
+    // the record being written is done)
+    uint8_t *_latest, *_saved;
+
+    int _active;            // The active page, or -1 if there isn't one
+    uint32_t _sequence;
+    int _page, _block;      // Where records are being written
+    size_t _writeWord;      // Where the next word goes
+
+    enum {Idle, Erasing, Writing, WritingHeader} _state;
+    bool _compacting, _snapshotDue;
+    int _field;             // The next field to look at
+    uint32_t *_record;      // A block's worth
+    size_t _recordLength, _recordPos;
+};
+
+#endif	/* SETTINGSJOURNAL_H */
+
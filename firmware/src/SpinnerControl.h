@@ -168,7 +168,7 @@ protected:
     
     void OnFieldChanged(fixed newValue)
     {
-        (dynamic_cast<DerivedClass *>(this)->*_currentFieldSetter)(newValue);
+        (static_cast<DerivedClass *>(this)->*_currentFieldSetter)(newValue);
     }
 
     PaneWithSpinners *_pane = NULL;
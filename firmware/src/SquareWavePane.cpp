@@ -13,13 +13,41 @@ extern "C"
 #include "Utility.h"
 #include "SquareWavePane.h"
 #include "SurfaceWrapper.h"
+#include "Format.h"
+
+/******************************************************************************
+FUNCTION ActualSurface -- the surface under the pulse widget
+DESCRIPTION
+    The rest of the panel comes from the Aria layout. This one's made here the
+    first time a pane needs it and then kept, like the generated ones, so the
+    layout and the generated code don't have to change for it.
+******************************************************************************/
+static laDrawSurfaceWidget *ActualSurface()
+{
+    static laDrawSurfaceWidget *surface = NULL;
+    if (!surface)
+    {
+        surface = laDrawSurfaceWidget_New();
+        laWidget_SetPosition((laWidget *) surface, 38, 172);
+        laWidget_SetSize((laWidget *) surface, 245, 15);
+        laWidget_SetScheme((laWidget *) surface, &defaultScheme);
+        laWidget_SetBackgroundType((laWidget *) surface, LA_WIDGET_BACKGROUND_FILL);
+        laWidget_SetBorderType((laWidget *) surface, LA_WIDGET_BORDER_NONE);
+        laWidget_AddChild(SquareWavePanel, (laWidget *) surface);
+    }
+    return surface;
+}
 
 SquareWavePane::SquareWavePane(fixed hertz, fixed duty, Show show) :
     _hertz(hertz), _ratio(duty / 100),
     _waveformWidget(SquareWave), _cycleCaliperWidget(CycleCaliper), _pulseCaliperWidget(PulseCaliper),
     _freqWidget(SquareWaveFrequency, &_hertz, TMR2_FrequencyGet(), {show.ShowFrequency, show.ShowPeriod}), 
-    _dutyWidget(SquareWavePulse, _hertz, &_ratio, {show.ShowDutyCycle, show.ShowPulseWidth})
+    _dutyWidget(SquareWavePulse, _hertz, &_ratio, {show.ShowDutyCycle, show.ShowPulseWidth}),
+    _actualWidget(ActualSurface())
 {
+    _waveformPainter.UseCanvas(true);
+    _cycleCaliperPainter.UseCanvas(true);
+    _pulseCaliperPainter.UseCanvas(true);
     _waveformWidget.Register(&_waveformPainter);
     _cycleCaliperWidget.Register(&_cycleCaliperPainter);
     _pulseCaliperWidget.Register(&_pulseCaliperPainter);
@@ -103,6 +131,45 @@ void SquareWavePane::Update()
     _pulseCaliperWidget.Invalidate();
 }
 
+/******************************************************************************
+FUNCTION SquareWavePane::SetActual -- show the frequency the timer gives
+DESCRIPTION
+    The timer can only divide its clock by whole numbers, so the frequency
+    out is usually a little off the one set. The error is shown in parts per
+    million when it's small enough to read that way, else as a percentage.
+******************************************************************************/
+void SquareWavePane::SetActual(fixed hertz)
+{
+    if (!hertz || !_hertz)
+    {
+        _actualWidget.SetText("Output off");
+        return;
+    }
+    
+    char text[40];
+    char *p = FormatText(text, "Actual ");
+    p = FormatEngineering(p, hertz, 7, "Hz");
+    
+    // Below 0.05 ppm there's nothing to show to one decimal place
+    fixed error = (hertz - _hertz) / _hertz;
+    fixed magnitude = error < 0 ? -error : error;
+    if (magnitude >= fixed((long long) 50, true))
+    {
+        p = FormatText(p, error < 0 ? " " : " +");
+        if (magnitude < fixed((long long) 1000000, true))
+        {
+            p = FormatFixed(p, error * 1000000, 1);
+            FormatText(p, " ppm");
+        }
+        else
+        {
+            p = FormatFixed(p, error * 100, 2);
+            FormatText(p, "%");
+        }
+    }
+    _actualWidget.SetText(text);
+}
+
 void SquareWavePane::EnterSetFrequency()
 {
     _freqWidget.SetEditMode(FrequencyPeriodSpinWidget::Frequency);
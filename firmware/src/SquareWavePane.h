@@ -16,6 +16,7 @@
 #include "LinesPainter.h"
 #include "FrequencyPeriodSpinWidget.h"
 #include "DutyCycleSpinWidget.h"
+#include "RichLabelWidget.h"
 
 class SquareWavePane : public Pane
 {
@@ -41,6 +42,9 @@ public:
     fixed Hertz() const {return _hertz;}
     fixed DutyCycle() const {return _ratio * 100;}
     
+    // Show the frequency the timer actually gives, or 0 if it's off
+    void SetActual(fixed hertz);
+    
 protected:
     virtual laWidget *GetWidget() const;
 
@@ -51,6 +55,7 @@ private:
     
     FrequencyPeriodSpinWidget _freqWidget;
     DutyCycleSpinWidget _dutyWidget;
+    RichLabelWidget _actualWidget;
     
     void FrequencySetter(fixed newValue);
     void PeriodSetter(fixed newValue);
@@ -5,5 +5,66 @@
  * Created on May 14, 2020, 10:02 AM
  */
 
+#include <string.h>
+extern "C" 
+{
+#include "definitions.h"
+}
 #include "SurfacePainter.h"
 
+// Painters draw one at a time, so they all share one off-screen buffer. It's
+// just big enough for the largest surface that uses a canvas, the square wave
+// (SquareWave in the Aria layout, 300 x 53); anything bigger falls back to
+// drawing directly. Grow it if a bigger surface opts in.
+#define CANVAS_MAX_PIXELS   (300 * 53)
+static uint16_t canvasPixels[CANVAS_MAX_PIXELS];
+
+/******************************************************************************
+FUNCTION BeginCanvas -- get an off-screen canvas covering the surface
+RETURNS
+    The canvas, or NULL if the painter should draw directly to the display
+    (either it hasn't asked for a canvas or the surface is too big)
+******************************************************************************/
+Canvas *SurfacePainter::BeginCanvas(GFX_Rect *bounds)
+{
+    if (!_useCanvas || bounds->width * bounds->height > CANVAS_MAX_PIXELS)
+        return NULL;
+    _canvas = Canvas(canvasPixels, bounds->width, bounds->height);
+    return &_canvas;
+}
+
+/******************************************************************************
+FUNCTION FlushCanvas -- copy the canvas onto the surface
+DESCRIPTION
+    The LCD is refreshed from a full RGB565 frame buffer, so the canvas rows
+    are copied straight into the layer's write buffer, clipped the same way
+    GFX_DrawBlit() clips. GFX_DrawBlit() itself goes a pixel at a time 
+    through the HAL, which would cost more than the primitives we saved.
+******************************************************************************/
+void SurfacePainter::FlushCanvas(GFX_Rect *bounds)
+{
+    GFX_Context *context = GFX_ActiveContext();
+    if (!context || !context->layer.active || !context->layer.active->locked)
+        return;
+    
+    GFX_Layer *layer = context->layer.active;
+    GFX_PixelBuffer *target = &layer->buffers[layer->buffer_write_idx].pb;
+    if (target->mode != GFX_COLOR_MODE_RGB_565)
+        return;
+    
+    // Clip to the layer and to Aria's dirty area
+    GFX_Rect dest = {bounds->x, bounds->y, _canvas.Width(), _canvas.Height()};
+    GFX_RectClip(&dest, &layer->rect.local, &dest);
+    if (context->draw.clipEnable)
+        GFX_RectClip(&dest, &context->draw.clipRect, &dest);
+    if (dest.width <= 0 || dest.height <= 0)
+        return;
+    
+    for (int32_t row = 0; row < dest.height; ++row)
+    {
+        GFX_Point point = {dest.x, dest.y + row};
+        const uint16_t *src = _canvas.Pixels() + 
+            (dest.y + row - bounds->y) * _canvas.Width() + (dest.x - bounds->x);
+        memcpy(GFX_PixelBufferOffsetGet_Unsafe(target, &point), src, dest.width * sizeof(uint16_t));
+    }
+}
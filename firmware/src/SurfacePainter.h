@@ -9,6 +9,7 @@
 #define	SURFACEPAINTER_H
 
 #include <stdint.h>
+#include "Canvas.h"
 class SurfaceWrapper;
 struct GFX_Rect_t;
 typedef struct GFX_Rect_t GFX_Rect;
@@ -17,7 +18,7 @@ class SurfacePainter
 {
 public:
     SurfacePainter(int32_t xOffset = 0, int32_t yOffset = 0) :
-        _xOffset(xOffset), _yOffset(yOffset) {}
+        _xOffset(xOffset), _yOffset(yOffset), _useCanvas(false) {}
     virtual ~SurfacePainter() {}
     
     void SetOffset(int32_t xOffset, int32_t yOffset)
@@ -26,10 +27,20 @@ public:
         _yOffset = yOffset;
     }
     
+    // Have the painter render off-screen and copy the result to the display
+    // in one go. Only painters that own their whole surface should do this, 
+    // since the copy covers it completely.
+    void UseCanvas(bool use) {_useCanvas = use;}
+    
     virtual bool OnDraw(SurfaceWrapper *surface, GFX_Rect *bounds) = 0;
     
 protected:
+    Canvas *BeginCanvas(GFX_Rect *bounds);
+    void FlushCanvas(GFX_Rect *bounds);
+    
     int32_t _xOffset, _yOffset;
+    bool _useCanvas;
+    Canvas _canvas;
     
 private:
     SurfacePainter(const SurfacePainter& orig);
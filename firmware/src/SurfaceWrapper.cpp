@@ -13,6 +13,7 @@ extern "C"
 }
 #include "SurfaceWrapper.h"
 #include "SurfacePainter.h"
+#include "DisplayStats.h"
 
 std::map<laDrawSurfaceWidget *, SurfaceWrapper *> _surfaceToWrapper;
 
@@ -68,9 +69,13 @@ void SurfaceWrapper::Unregister(SurfacePainter *painter)
 
 bool SurfaceWrapper::DrawSurfaceCallback(GFX_Rect *bounds)
 {
+    DisplayStatsTimer timer(DisplayProbeDrawSurface);
     bool done = true;
     // Call all the painters
     for (auto &painter : _painters)
+    {
+        DisplayStatsTimer painterTimer(DisplayProbePainter);
         done &= painter->OnDraw(this, bounds);
+    }
     return done;
 }
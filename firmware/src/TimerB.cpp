@@ -0,0 +1,23 @@
+/* 
+ * File:   TimerB.cpp
+ * Author: Bob
+ * 
+ * Created on October 19, 2026, 8:40 AM
+ */
+
+extern "C" 
+{
+#include "definitions.h"
+}
+#include "TimerB.h"
+#include "Interrupts.h"
+
+// Timer 4 is left out: its interrupt belongs to Harmony's TMR4 plib, which
+// runs the backlight PWM
+Implement_InterruptHandler(_TIMER_2_VECTOR, TMRInt[1].timer)
+Implement_InterruptHandler(_TIMER_3_VECTOR, TMRInt[2].timer)
+Implement_InterruptHandler(_TIMER_5_VECTOR, TMRInt[4].timer)
+Implement_InterruptHandler(_TIMER_6_VECTOR, TMRInt[5].timer)
+Implement_InterruptHandler(_TIMER_7_VECTOR, TMRInt[6].timer)
+Implement_InterruptHandler(_TIMER_8_VECTOR, TMRInt[7].timer)
+Implement_InterruptHandler(_TIMER_9_VECTOR, TMRInt[8].timer)
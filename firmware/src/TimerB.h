@@ -10,6 +10,7 @@
 #define	TIMERB_H
 
 #include "fixed.h"
+#include "TimerSolver.h"
 #include "PPS.h"
 #include "Peripherals.h"
 #include "Interrupts.h"
@@ -54,13 +55,8 @@ public:
     
     double GetFrequency()
     {
-        uint32_t divisor = _regs.PR & 0xffff;
-        // Factor in the timer prescaler. The prescaler goes 1, 2, 4, 8, 16, 32, 64,
-        // then skips 128 and goes to 256. So we need to handle that
-        divisor <<= _regs.TCON.bits.TCKPS;
-        if (_regs.TCON.bits.TCKPS == 7)
-            divisor <<= 1;
-        
+        // The timer rolls over every PR + 1 counts
+        uint32_t divisor = ((_regs.PR & 0xffff) + 1) * TimerPrescaleDivisor(_regs.TCON.bits.TCKPS);
         return double(oscillator.PBCLK(3)) / divisor;
     }
     
@@ -72,6 +68,29 @@ public:
     }
     void EnableInterrupt() {TMRInt[index - 1].timer.enable = 1;}
     void DisableInterrupt() {TMRInt[index - 1].timer.enable = 0;}
+    
+    void RegisterCallback(void (*callback)(void *), void *context) 
+    {
+        SetInterruptHandler(TMRInt[index - 1].timer.irqNumber, callback, context);
+    }
+    void UnregisterCallback() 
+    {
+        ClearInterruptHandler(TMRInt[index - 1].timer.irqNumber);
+    }
+    
+    // Count PBCLK3 divided by the prescaler (0..6 divide by 2^prescale; 7 
+    // divides by 256), rolling over every period + 1 counts
+    void InitializeCounts(uint8_t prescale, uint32_t period)
+    {
+        Disable();
+        DisableInterrupt();
+        _regs.TCON = 0;
+        TMRInt[index - 1].timer.flag = 0;
+        _regs.TCON.bits.TCKPS = prescale;
+        _regs.PR = period;
+        _regs.TMR = 0;
+    }
+    void SetPeriod(uint32_t period) {_regs.PR = period;}
 
     TMRxRegisters &Regs() const {return _regs;}
     
@@ -79,85 +98,20 @@ public:
     
 protected:
 
-    // Calculate the register settings for the requested frequency as close as possible.
-    static void CalculateFreqPSPR(uint32_t hertz, uint8_t &prescale, uint32_t &period)
-    {
-        // What's our input clock rate?
-        uint32_t clock = oscillator.PBCLK(3);
-        // What divisor do we want? (Add hertz / 2 for rounding)
-        uint32_t divisor = (clock + hertz / 2) / hertz;
-        unsigned int trailingZeros = __builtin_ctz(divisor);
-        
-        // Set the timer prescaler. The prescaler goes 1, 2, 4, 8, 16, 32, 64,
-        // then skips 128 and goes to 256. So we need to handle that
-        if (trailingZeros >= 8)
-        {
-            prescale = 7;
-            divisor /= 256;
-        }
-        else if (trailingZeros == 7)
-        {
-            prescale = 6;
-            divisor /= 64;
-        }
-        else
-        {
-            prescale = trailingZeros;
-            divisor >>= trailingZeros;
-        }
-
-        period = divisor - 1;
-        // If the period is 0, that's not going to work. We need to decrease
-        // the prescale and increase the divisor
-        if (period == 0 && prescale)
-        {
-            --prescale;
-            // If prescale == 6, we skipped from a factor of 256 to a factor of 64
-            if (prescale == 6)
-                period = 3;
-            else
-                period = 1;
-        }
-    }
-    // Calculate the register settings for the requested duration as close as possible.
-    static void CalculateDurationPSPR(fixed seconds, uint8_t &prescale, uint32_t &period)
-    {
-        // What's our input clock rate?
-        uint32_t clock = oscillator.PBCLK(3);
-        // What divisor do we want?
-        uint32_t divisor = int(fixed(clock) * seconds);
-        unsigned int trailingZeros = __builtin_ctz(divisor);
-        
-        // Set the timer prescaler. The prescaler goes 1, 2, 4, 8, 16, 32, 64,
-        // then skips 128 and goes to 256. So we need to handle that
-        if (trailingZeros >= 8)
-        {
-            prescale = 7;
-            divisor /= 256;
-        }
-        else if (trailingZeros == 7)
-        {
-            prescale = 6;
-            divisor /= 64;
-        }
-        else
-        {
-            prescale = trailingZeros;
-            divisor >>= trailingZeros;
-        }
-        
-        period = divisor - 1;
-        // If the period is 0, that's not going to work. We need to decrease
-        // the prescale and increase the divisor
-        if (period == 0 && prescale)
-        {
-            --prescale;
-            // If prescale == 6, we skipped from a factor of 256 to a factor of 64
-            if (prescale == 6)
-                period = 3;
-            else
-                period = 1;
-        }
+    // The register settings nearest the requested frequency
+    static TimerSetting CalculateFreqPSPR(uint32_t hertz, uint32_t initTCON)
+    {
+        return SolveTimer(oscillator.PBCLK(3), fixed(hertz), MaxCounts(initTCON));
+    }
+    // The register settings nearest the requested duration in seconds
+    static TimerSetting CalculateDurationPSPR(fixed seconds, uint32_t initTCON)
+    {
+        fixed clocks = fixed(oscillator.PBCLK(3)) * seconds;
+        return SolveTimerCounts((clocks.raw() + fixed::scale / 2) / fixed::scale, MaxCounts(initTCON));
+    }
+    static uint64_t MaxCounts(uint32_t initTCON)
+    {
+        return initTCON & _T2CON_T32_MASK ? TIMER_MAX_COUNTS_32 : TIMER_MAX_COUNTS_16;
     }
     
     void Initialize(uint32_t freq, uint32_t initTCON)
@@ -166,11 +120,9 @@ protected:
         DisableInterrupt();
         _regs.TCON = initTCON;
         TMRInt[index - 1].timer.flag = 0;
-        uint8_t prescale;
-        uint32_t period;
-        CalculateFreqPSPR(freq, prescale, period);
-        _regs.TCON.bits.TCKPS = prescale;
-        _regs.PR = period - 1;
+        TimerSetting setting = CalculateFreqPSPR(freq, initTCON);
+        _regs.TCON.bits.TCKPS = setting.prescale;
+        _regs.PR = uint32_t(setting.counts - 1);
         _regs.TMR = 0;
     }
     
@@ -181,11 +133,9 @@ protected:
         DisableInterrupt();
         _regs.TCON = initTCON;
         TMRInt[index - 1].timer.flag = 0;
-        uint8_t prescale;
-        uint32_t period;
-        CalculateDurationPSPR(duration, prescale, period);
-        _regs.TCON.bits.TCKPS = prescale;
-        _regs.PR = period - 1;
+        TimerSetting setting = CalculateDurationPSPR(duration, initTCON);
+        _regs.TCON.bits.TCKPS = setting.prescale;
+        _regs.PR = uint32_t(setting.counts - 1);
         _regs.TMR = 0;
     }
 
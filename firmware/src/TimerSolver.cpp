@@ -0,0 +1,136 @@
+/*
+ * File:   TimerSolver.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:05 AM
+ */
+
+#include "TimerSolver.h"
+
+// The settings either side of an ideal divisor of the clock
+struct Bracket
+{
+    TimerSetting below, above;
+    // What each divides the clock by, or 0 if there isn't one
+    uint64_t belowDivisor, aboveDivisor;
+};
+
+uint32_t TimerPrescaleDivisor(uint8_t prescale)
+{
+    // The prescaler goes 1, 2, 4, 8, 16, 32, 64, then skips 128 and goes to 256
+    return prescale >= 7 ? 256 : 1u << prescale;
+}
+
+/******************************************************************************
+FUNCTION FindBracket -- find the nearest settings either side of a divisor
+DESCRIPTION
+    The ideal divisor is num / den. For each prescaler the counts are rounded
+    down and up, so there's a candidate on each side of the ideal, and the
+    nearest on each side is kept. Prescalers are tried smallest first and only
+    a nearer candidate replaces one, so of equal divisors the one with the
+    most counts is kept.
+******************************************************************************/
+static Bracket FindBracket(uint64_t num, uint64_t den, uint64_t maxCounts)
+{
+    Bracket bracket = {{0, 0}, {0, 0}, 0, 0};
+    uint64_t ideal = num / den;
+    bool exact = num % den == 0;
+
+    for (uint8_t prescale = 0; prescale < 8; ++prescale)
+    {
+        uint32_t divisor = TimerPrescaleDivisor(prescale);
+        uint64_t floorCounts = ideal / divisor;
+        uint64_t ceilCounts = floorCounts;
+        if (!exact || ideal % divisor)
+            ++ceilCounts;
+
+        // The timer needs at least 2 counts to roll over
+        uint64_t counts = floorCounts < maxCounts ? floorCounts : maxCounts;
+        if (counts >= 2 && counts * divisor > bracket.belowDivisor)
+        {
+            bracket.below = {prescale, counts};
+            bracket.belowDivisor = counts * divisor;
+        }
+
+        counts = ceilCounts > 2 ? ceilCounts : 2;
+        if (counts <= maxCounts && (!bracket.aboveDivisor || counts * divisor < bracket.aboveDivisor))
+        {
+            bracket.above = {prescale, counts};
+            bracket.aboveDivisor = counts * divisor;
+        }
+    }
+    return bracket;
+}
+
+// Pick between two settings that are as good as each other
+static const TimerSetting &Finer(const TimerSetting &a, const TimerSetting &b)
+{
+    return a.counts >= b.counts ? a : b;
+}
+
+// Compare two 128-bit numbers, returning <0, 0 or >0
+static int Compare128(uint64_t aHi, uint64_t aLo, uint64_t bHi, uint64_t bLo)
+{
+    if (aHi != bHi)
+        return aHi < bHi ? -1 : 1;
+    if (aLo != bLo)
+        return aLo < bLo ? -1 : 1;
+    return 0;
+}
+
+/******************************************************************************
+FUNCTION SolveTimer -- the setting nearest a frequency
+DESCRIPTION
+    Working in nanohertz, as fixed does, the ideal divisor is C / T where
+    C = clock * 10^9 and T is the frequency. The frequency error below the
+    ideal is C / Dlo - T and above it is T - C / Dhi, so the one below is
+    nearer when C (Dlo + Dhi) < 2 T Dlo Dhi. T Dlo is at most C, so each side
+    is a product of two 64-bit numbers, and the comparison is exact.
+******************************************************************************/
+TimerSetting SolveTimer(uint32_t clock, fixed hertz, uint64_t maxCounts)
+{
+    if (hertz.raw() <= 0)
+        return {7, maxCounts};
+
+    uint64_t c = uint64_t(clock) * fixed::scale;
+    uint64_t t = hertz.raw();
+    Bracket bracket = FindBracket(c, t, maxCounts);
+    if (!bracket.belowDivisor)
+        return bracket.above;
+    if (!bracket.aboveDivisor)
+        return bracket.below;
+
+    uint64_t leftHi, leftLo, rightHi, rightLo;
+    fixed_multiply(c, bracket.belowDivisor + bracket.aboveDivisor, leftHi, leftLo);
+    fixed_multiply(t * bracket.belowDivisor, 2 * bracket.aboveDivisor, rightHi, rightLo);
+    int comparison = Compare128(leftHi, leftLo, rightHi, rightLo);
+    if (comparison == 0)
+        return Finer(bracket.below, bracket.above);
+    return comparison < 0 ? bracket.below : bracket.above;
+}
+
+TimerSetting SolveTimerCounts(uint64_t clocks, uint64_t maxCounts)
+{
+    Bracket bracket = FindBracket(clocks, 1, maxCounts);
+    if (!bracket.belowDivisor)
+        return bracket.above;
+    if (!bracket.aboveDivisor)
+        return bracket.below;
+
+    // Here the error is in time, so it's just the difference in clocks
+    uint64_t belowError = clocks - bracket.belowDivisor;
+    uint64_t aboveError = bracket.aboveDivisor - clocks;
+    if (belowError == aboveError)
+        return Finer(bracket.below, bracket.above);
+    return belowError < aboveError ? bracket.below : bracket.above;
+}
+
+fixed TimerFrequency(uint32_t clock, const TimerSetting &setting)
+{
+    uint64_t divisor = TimerPrescaleDivisor(setting.prescale) * setting.counts;
+    if (!divisor)
+        return 0;
+    uint64_t c = uint64_t(clock) * fixed::scale;
+    return fixed((long long) ((c + divisor / 2) / divisor), true);
+}
+
@@ -0,0 +1,52 @@
+/*
+ * File:   TimerSolver.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:05 AM
+ */
+
+#ifndef TIMERSOLVER_H
+#define	TIMERSOLVER_H
+
+#include <stdint.h>
+#include "fixed.h"
+
+/******************************************************************************
+Timer solver -- prescaler and period for a type B timer
+DESCRIPTION
+    A type B timer counts its clock divided by the prescaler (1, 2, 4, 8, 16,
+    32, 64 or 256) and rolls over every counts clocks, so the output divides
+    the clock by prescaler * counts. Every prescaler is tried with the counts
+    either side of the ideal divisor, and the pair giving the frequency (or
+    duration) nearest the one asked for wins. Of pairs that divide by the same
+    amount, the one with the smallest prescaler wins, since the most counts
+    per cycle gives the finest duty cycle.
+
+    The maximum counts is TIMER_MAX_COUNTS_16 for a single timer or
+    TIMER_MAX_COUNTS_32 for a pair running as a 32-bit timer. Nothing here
+    knows about the PIC32, so it builds on the host.
+******************************************************************************/
+
+#define TIMER_MAX_COUNTS_16 0x10000ULL
+#define TIMER_MAX_COUNTS_32 0x100000000ULL
+
+struct TimerSetting
+{
+    uint8_t prescale;       // TCKPS: 0..6 divide by 2^prescale; 7 by 256
+    uint64_t counts;        // Clocks per cycle, so the period register is one less
+};
+
+// What the TCKPS value divides by
+uint32_t TimerPrescaleDivisor(uint8_t prescale);
+
+// The setting nearest a frequency. A frequency of 0 gives the slowest there
+// is, which is up to the caller to keep quiet.
+TimerSetting SolveTimer(uint32_t clock, fixed hertz, uint64_t maxCounts);
+// The setting nearest a number of clocks, e.g. for a duration
+TimerSetting SolveTimerCounts(uint64_t clocks, uint64_t maxCounts);
+
+// The frequency a setting actually gives
+fixed TimerFrequency(uint32_t clock, const TimerSetting &setting);
+
+#endif	/* TIMERSOLVER_H */
+
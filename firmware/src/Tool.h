@@ -8,7 +8,10 @@
 #ifndef TOOL_H
 #define	TOOL_H
 
+#include <stddef.h>
+#include <stdint.h>
 #include "Help.h"
+#include "RemoteProtocol.h"
 
 class Pane;
 class Menu;
@@ -30,6 +33,13 @@ public:
     // Called when there's time available
     virtual void OnIdle() {}
     
+    // Remote control. A tool that captures something starts a capture when
+    // it's armed, and hands over the result once it's ready. Fetch copies up
+    // to length bytes of the result from offset and returns how many.
+    virtual bool RemoteArm() {return false;}
+    virtual RemoteCapture RemoteCaptureState(uint32_t &size) {size = 0; return RemoteCapture::None;}
+    virtual size_t RemoteFetch(uint32_t offset, uint8_t *data, size_t length) {return 0;}
+    
     void ExitHelp();
 
 protected:
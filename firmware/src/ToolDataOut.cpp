@@ -18,9 +18,27 @@ extern "C"
 #include "Display.h"
 #include "DataOutPane.h"
 #include "FileSystem.h"
+#include "TimerB.h"
+#include "Format.h"
 
 #define ASCII_CHARS_NAME "ASCII characters"
 
+// File data that has to come through SYS_FS is read a sector at a time into
+// these, and sent from them by DMA. They're coherent (uncached) so the DMA sees
+// what the CPU wrote.
+#define FILE_BLOCK_SIZE 512
+static char __attribute__((coherent, aligned(16))) fileBlocks[2][FILE_BLOCK_SIZE];
+
+// The internal flash disk, which we can read in place. It's read uncached, as
+// DumpDisk() does, since writes to it go round the cache.
+extern "C" const uint8_t diskImage[];
+
+// Pattern scripts are files with this extension
+#define PATTERN_EXTENSION ".PAT"
+#define PATTERN_MAX_SIZE 8192
+// The pattern timer counts PBCLK3 / 8
+#define PATTERN_TIMER_PRESCALE 3
+
 extern const Menu uartOutBaud1;
 
 static const MenuItem selectionItems[5] = {
@@ -54,16 +72,17 @@ const Menu dataOutRunningMenu(runningMenuItems);
 
 ToolDataOut::ToolDataOut(const char *title, const Menu &menu, const Help &help) :
     Tool(title, new DataOutPane, menu, help), _asciiChar(' '), _transmitting(Stopped),
-    _file(SYS_FS_HANDLE_INVALID), _firstIdle(true), _mount(nullptr)
+    _file(SYS_FS_HANDLE_INVALID), _flashFile((const uint8_t *) KVA0_TO_KVA1(diskImage), DRV_MEMORY_DEVICE_MEDIA_SIZE * 1024),
+    _endOfFile(false), _streamer(fileBlocks[0], fileBlocks[1], FILE_BLOCK_SIZE),
+    _firstIdle(true), _mount(nullptr), _lock(nullptr), _patternTimer(nullptr), _patternDone(false)
 {
 }
 
 ToolDataOut::~ToolDataOut() 
 {
     laWidget_SetVisible((laWidget *) ListBox, LA_FALSE);
-    if (_file != SYS_FS_HANDLE_INVALID)
-        SYS_FS_FileClose(_file);
-    delete _mount;
+    StopPattern();
+    CloseFile();
 }
 
 void ToolDataOut::SelectData()
@@ -158,13 +177,7 @@ void ToolDataOut::SelectionOK()
         SetFileName(_fileNames[sel - 1].c_str());
     else
         SetFileName("");
-    if (_file != SYS_FS_HANDLE_INVALID)
-    {
-        SYS_FS_FileClose(_file);
-        _file = SYS_FS_HANDLE_INVALID;
-        delete _mount;
-        _mount = nullptr;
-    }
+    CloseFile();
     SelectionCancel();
     SetLabels();
 }
@@ -179,47 +192,16 @@ void ToolDataOut::OnIdle()
     
     if (_transmitting == Sending)
     {
-        // If we're transmitting a file
-        if (FileName()[0])
+        // If we're running a pattern script
+        if (IsPatternFile())
         {
-            // Try to open the file
-            if (_file == SYS_FS_HANDLE_INVALID)
-            {
-                _mount = new MountDrive();
-                _file = SYS_FS_FileOpen(FileName(), SYS_FS_FILE_OPEN_READ);
-                // If we can't open it
-                if (_file == SYS_FS_HANDLE_INVALID)
-                {
-                    // Clear the file setting and stop transmitting
-                    SetFileName("");
-                    _transmitting = Stopped;
-                    return;
-                }
-            }
-            
-            // Send characters from the file
-            while (_transmitting && TXReady())
-            {
-                char c;
-                // If we successfully read a character
-                if (SYS_FS_FileRead(_file, &c, 1) == 1)
-                {
-                    // Transmit it
-                    TXData(c);
-                    // Display it
-                    GetPane()->AddText(&c, 1);
-                }
-                // Else (file error; most likely EOF)
-                else
-                {
-                    SYS_FS_FileClose(_file);
-                    _file = SYS_FS_HANDLE_INVALID;
-                    delete _mount;
-                    _mount = nullptr;
-                    if (!_loop)
-                        _transmitting = Stopped;
-                }
-            }
+            SendPattern();
+        }
+        
+        // Else if we're transmitting a file
+        else if (FileName()[0])
+        {
+            SendFile();
         }
         
         // Else (we're transmitting ASCII characters)
@@ -252,9 +234,100 @@ void ToolDataOut::OnIdle()
     }
 }
 
-void ToolDataOut::ResetData()
+/******************************************************************************
+FUNCTION SendFile -- keep the file streaming out
+DESCRIPTION
+    Fills whichever block is free and hands full blocks to TXBlock() in turn,
+    so the next block is ready while the previous one goes out in the 
+    background. Files on the internal flash disk are sent straight from flash:
+    a block is just a pointer into the disk image. Anything else is read a 
+    sector at a time through SYS_FS into fileBlocks. Each block is added to 
+    the pane when it starts sending. At the end of the file we start again if
+    we're looping, otherwise we stop once the last block has gone.
+******************************************************************************/
+void ToolDataOut::SendFile()
 {
-    _asciiChar = ' ';
+    // Release the block that was being sent once it's done
+    if (_streamer.Sending() && !TXBlockBusy())
+        _streamer.Sent();
+    
+    // Try to open the file, preferably in place in flash
+    if (!_flashFile.IsOpen() && _file == SYS_FS_HANDLE_INVALID && !_endOfFile)
+    {
+        _lock = new LockDrive();
+        if (_flashFile.Open(FileName()))
+        {
+            _span.size = 0;
+        }
+        else
+        {
+            delete _lock;
+            _lock = nullptr;
+            _mount = new MountDrive();
+            _file = SYS_FS_FileOpen(FileName(), SYS_FS_FILE_OPEN_READ);
+            // If we can't open it
+            if (_file == SYS_FS_HANDLE_INVALID)
+            {
+                delete _mount;
+                _mount = nullptr;
+                // Clear the file setting and stop transmitting
+                SetFileName("");
+                ResetData();
+                _transmitting = Stopped;
+                return;
+            }
+        }
+    }
+    
+    // Fill the free blocks. Running out is most likely EOF.
+    if ((_flashFile.IsOpen() || _file != SYS_FS_HANDLE_INVALID) && !_streamer.Fill(ReadBlock, this))
+    {
+        CloseFile();
+        _endOfFile = !_loop;
+    }
+    
+    // Start sending the next block
+    const char *data;
+    size_t size;
+    if (_streamer.Next(data, size))
+    {
+        TXBlock(data, size);
+        GetPane()->AddText(data, size);
+    }
+    
+    // If there's nothing more to send, we're done
+    else if (!_streamer.Sending() && _endOfFile)
+    {
+        _endOfFile = false;
+        _transmitting = Stopped;
+    }
+}
+
+// The next piece of the open file for the streamer
+size_t ToolDataOut::ReadBlock(const char *&data, char *buffer, size_t bytes)
+{
+    if (_flashFile.IsOpen())
+    {
+        // Take the next piece of the current span
+        if (_span.size == 0 && !_flashFile.NextSpan(_span))
+            return 0;
+        if (bytes > _span.size)
+            bytes = _span.size;
+        data = (const char *) _span.data;
+        _span.data += bytes;
+        _span.size -= bytes;
+        return bytes;
+    }
+    
+    bytes = SYS_FS_FileRead(_file, buffer, bytes);
+    return bytes == (size_t) -1 ? 0 : bytes;
+}
+
+void ToolDataOut::CloseFile()
+{
+    _flashFile.Close();
+    delete _lock;
+    _lock = nullptr;
     if (_file != SYS_FS_HANDLE_INVALID)
     {
         SYS_FS_FileClose(_file);
@@ -264,13 +337,227 @@ void ToolDataOut::ResetData()
     }
 }
 
+void ToolDataOut::Pause()
+{
+    _transmitting = Paused;
+    TXBlockSuspend(true);
+    if (_patternTimer)
+        _patternTimer->Disable();
+    SetLabels();
+}
+
+void ToolDataOut::Resume()
+{
+    _transmitting = Sending;
+    TXBlockSuspend(false);
+    if (_patternTimer)
+        _patternTimer->Enable();
+    SetLabels();
+}
+
+bool ToolDataOut::IsPatternFile()
+{
+    size_t length = strlen(FileName());
+    size_t extLength = strlen(PATTERN_EXTENSION);
+    return length > extLength && strcasecmp(FileName() + length - extLength, PATTERN_EXTENSION) == 0;
+}
+
+bool ToolDataOut::ReadWholeFile(std::string &text)
+{
+    text.clear();
+    {
+        LockDrive lock;
+        if (_flashFile.Open(FileName()))
+        {
+            // Stop once it's too big, as below
+            FlashSpan span;
+            while (text.size() <= PATTERN_MAX_SIZE && _flashFile.NextSpan(span))
+            {
+                size_t room = PATTERN_MAX_SIZE + 1 - text.size();
+                text.append((const char *) span.data, span.size < room ? span.size : room);
+            }
+            _flashFile.Close();
+            return true;
+        }
+    }
+    
+    MountDrive mount;
+    SYS_FS_HANDLE file = SYS_FS_FileOpen(FileName(), SYS_FS_FILE_OPEN_READ);
+    if (file == SYS_FS_HANDLE_INVALID)
+        return false;
+    char buf[128];
+    size_t bytes;
+    while ((bytes = SYS_FS_FileRead(file, buf, sizeof(buf))) != (size_t) -1 && bytes != 0 &&
+            text.size() <= PATTERN_MAX_SIZE)
+        text.append(buf, bytes);
+    SYS_FS_FileClose(file);
+    return true;
+}
+
+bool ToolDataOut::LoadPattern()
+{
+    std::string text;
+    if (!ReadWholeFile(text))
+    {
+        _patternError = "Can't open file";
+        return false;
+    }
+    if (text.size() > PATTERN_MAX_SIZE)
+    {
+        _patternError = "Script too big";
+        return false;
+    }
+    if (!_pattern.Compile(text.data(), text.size()))
+    {
+        char buf[60];
+        char *p = FormatUnsigned(FormatText(buf, "Line "), _pattern.ErrorLine());
+        FormatText(FormatText(p, ": "), _pattern.Error());
+        _patternError = buf;
+        return false;
+    }
+    return true;
+}
+
+/******************************************************************************
+FUNCTION SendPattern -- run a pattern script
+DESCRIPTION
+    The script is compiled the first time through. After that the timer
+    interrupt does all the sending; here we just copy what it sent to the 
+    pane and notice when it's finished.
+******************************************************************************/
+void ToolDataOut::SendPattern()
+{
+    char buf[64];
+    size_t bytes = 0;
+    while (bytes < sizeof(buf) && _patternEcho.read(&buf[bytes]))
+        ++bytes;
+    if (bytes)
+        GetPane()->AddText(buf, bytes);
+    
+    if (_patternDone && _patternEcho.empty())
+    {
+        StopPattern();
+        _transmitting = Stopped;
+        return;
+    }
+    if (_patternTimer || _patternDone)
+        return;
+    
+    if (!LoadPattern())
+    {
+        _transmitting = Stopped;
+        return;
+    }
+    _patternRunner.Start(_pattern.Code().data());
+    uint32_t idle;
+    if (!_patternRunner.Next(_patternByte, idle))
+    {
+        _transmitting = Stopped;
+        return;
+    }
+    
+    _ticksPerSecond = oscillator.PBCLK(3) >> PATTERN_TIMER_PRESCALE;
+    _characterTicks = uint32_t(uint64_t(CharacterNanoseconds()) * _ticksPerSecond / 1000000000);
+    // Leave the interrupt a little time to get going before the first byte
+    _patternTicks = uint32_t(uint64_t(idle) * _ticksPerSecond / 1000000) + 100;
+    
+    _patternTimer = new TimerB<7>;
+    _patternTimer->InitializeCounts(PATTERN_TIMER_PRESCALE, 0);
+    LoadPatternTimer();
+    _patternTimer->SetInterruptPriorities();
+    _patternTimer->RegisterCallback(PatternTick, this);
+    _patternTimer->EnableInterrupt();
+    _patternTimer->Enable();
+}
+
+void ToolDataOut::StopPattern()
+{
+    if (_patternTimer)
+    {
+        _patternTimer->DisableInterrupt();
+        _patternTimer->UnregisterCallback();
+        delete _patternTimer;
+        _patternTimer = nullptr;
+    }
+    _patternDone = false;
+    _patternEcho.clear();
+}
+
+// Set the timer for the next stretch of the wait before the next byte. A
+// 16 bit timer only goes so far, so long waits take several periods; we avoid
+// leaving a very short last period in case we can't get back in time for it.
+void ToolDataOut::LoadPatternTimer()
+{
+    uint32_t ticks = _patternTicks;
+    if (ticks > 0x18000)
+        ticks = 0x10000;
+    else if (ticks > 0x10000)
+        ticks /= 2;
+    _patternTicks -= ticks;
+    _patternTimer->SetPeriod(ticks - 1);
+}
+
+/******************************************************************************
+FUNCTION PatternTick -- the pattern timer interrupt
+DESCRIPTION
+    Once the wait is up, sends the byte and works out when the next one goes:
+    a character time (so the gap is measured from the end of this one) plus
+    the script's idle time. The timer keeps counting through the interrupt, 
+    so latency here doesn't add up from byte to byte.
+******************************************************************************/
+void ToolDataOut::PatternTick()
+{
+    if (_patternTicks)
+    {
+        LoadPatternTimer();
+        return;
+    }
+    
+    TXData(_patternByte);
+    _patternEcho.writeUnsafe(_patternByte);
+    
+    uint32_t idle;
+    bool more = _patternRunner.Next(_patternByte, idle);
+    if (!more && _loop)
+    {
+        _patternRunner.Restart();
+        more = _patternRunner.Next(_patternByte, idle);
+    }
+    if (!more)
+    {
+        _patternTimer->Disable();
+        _patternDone = true;
+        return;
+    }
+    
+    _patternTicks = _characterTicks + uint32_t(uint64_t(idle) * _ticksPerSecond / 1000000);
+    LoadPatternTimer();
+}
+
+void ToolDataOut::ResetData()
+{
+    _asciiChar = ' ';
+    StopPattern();
+    _patternError.clear();
+    TXBlockCancel();
+    CloseFile();
+    _endOfFile = false;
+    _streamer.Reset();
+}
+
 void ToolDataOut::SetLabels()
 {
     GetPane()->SetDataName(*FileName() ? FileName() : ASCII_CHARS_NAME);
-    char buf[30];
+    char buf[50];
     switch (_transmitting)
     {
         case Stopped :
+            // Show why a pattern script didn't run
+            if (!_patternError.empty())
+            {
+                GetPane()->SetStatus(_patternError.c_str());
+                return;
+            }
             strcpy(buf, "Stopped"); break;
         case Paused :
             strcpy(buf, "Paused"); break;
@@ -10,9 +10,14 @@
 
 #include "Tool.h"
 #include "Utility.h"
+#include "FlashFile.h"
+#include "FileStreamer.h"
+#include "Pattern.h"
 
 class DataOutPane;
 class MountDrive;
+class LockDrive;
+template <int index> class TimerB;
 
 class ToolDataOut : public Tool
 {
@@ -26,8 +31,8 @@ public:
     
     void Start() {ResetData(); _loop = false; _transmitting = Sending; SetLabels();}
     void Loop() {ResetData(); _loop = true; _transmitting = Sending; SetLabels();}
-    void Pause() {_transmitting = Paused; SetLabels();}
-    void Resume() {_transmitting = Sending; SetLabels();}
+    void Pause();
+    void Resume();
     void Stop() {_transmitting = Stopped; _loop = false; ResetData(); SetLabels();}
     void SelectData();
     
@@ -39,6 +44,14 @@ public:
 protected:
     virtual bool TXReady() const = 0;
     virtual void TXData(uint32_t data) = 0;
+    // File data goes out a block at a time in the background. The block 
+    // stays valid until TXBlockBusy() returns false.
+    virtual void TXBlock(const char *data, size_t size) = 0;
+    virtual bool TXBlockBusy() const = 0;
+    virtual void TXBlockSuspend(bool suspend) = 0;
+    virtual void TXBlockCancel() = 0;
+    // How long one character takes to send
+    virtual uint32_t CharacterNanoseconds() const = 0;
     virtual char *FileName() = 0;
     virtual void SetFileName(const char *fileName) = 0;
 
@@ -50,6 +63,20 @@ private:
     void SetLabels();
     
     void ResetData();
+    void CloseFile();
+    void SendFile();
+    size_t ReadBlock(const char *&data, char *buffer, size_t bytes);
+    static size_t ReadBlock(const char *&data, char *buffer, size_t bytes, void *pthis)
+        {return ((ToolDataOut *) pthis)->ReadBlock(data, buffer, bytes);}
+    
+    bool IsPatternFile();
+    bool ReadWholeFile(std::string &text);
+    bool LoadPattern();
+    void SendPattern();
+    void StopPattern();
+    void LoadPatternTimer();
+    void PatternTick();
+    static void PatternTick(void *pthis) {((ToolDataOut *) pthis)->PatternTick();}
     
     enum {Stopped, Paused, Sending} _transmitting;
     bool _loop;
@@ -58,7 +85,30 @@ private:
     
     std::vector<std::string> _fileNames;
     SYS_FS_HANDLE _file;
+    FlashFile _flashFile;
+    FlashSpan _span;
+    bool _endOfFile;
+    
+    // File blocks, sent in the order they're read. One is transmitted while
+    // the other is filled.
+    FileStreamer _streamer;
     MountDrive *_mount;
+    // Keeps USB off the drive while _flashFile reads it
+    LockDrive *_lock;
+    
+    // Pattern scripts are run by a timer interrupt, which sends each byte and
+    // sets the timer for the next one
+    PatternCompiler _pattern;
+    PatternRunner _patternRunner;
+    std::string _patternError;
+    TimerB<7> *_patternTimer;
+    uint32_t _ticksPerSecond;
+    uint32_t _characterTicks;
+    uint32_t _patternTicks;
+    uint8_t _patternByte;
+    volatile bool _patternDone;
+    // Bytes sent, for the pane
+    CQueue<char, 256> _patternEcho;
 };
 
 extern const Menu dataOutRunningMenu;
@@ -9,18 +9,28 @@ extern "C"
 {
 #include "definitions.h"
 }
+#include <string.h>
+#include <algorithm>
 #include "Settings.h"
+#include "Format.h"
 #include "ToolGPS.h"
 #include "GPSPane.h"
 #include "Menu.h"
 #include "PPS.h"
 #include "Display.h"
 #include "TerminalPane.h"
+#include "FileSystem.h"
 
 extern "C" int32_t la_strcmp(GFXU_CHAR* str1, const GFXU_CHAR* str2);
 
 static const Help help(NULL, "GPS UART Data", NULL, 
-        "Outputs simulated NMEA sentences.");
+        "Outputs simulated NMEA sentences and/or UBX NAV-PVT messages, 1 to 10 times a second. If the baud rate can't carry them all, "
+        "the status shows how many are sent. "
+        "Track plays a .GPX or .CSV file (time,lat,long per line) from the drive, over and over.");
+
+#define FIXED_POSITION_NAME "Fixed position"
+#define GPX_EXTENSION ".GPX"
+#define CSV_EXTENSION ".CSV"
 
 static const MenuItem modifyMenuItems[5] = {
     MenuItem(UTF8_UPARROW, MenuType::NoChange, nullptr, CB(&ToolGPS::Up)), 
@@ -42,6 +52,15 @@ static const Menu coordsMenu(coordsMenuItems);
 
 extern const Menu toolGPSMenu;
 
+static const MenuItem trackSelectionItems[5] = {
+    MenuItem(UTF8_UPARROW, MenuType::NoChange, nullptr, CB(&ToolGPS::SelectionUp)), 
+    MenuItem(UTF8_DOWNARROW, MenuType::NoChange, nullptr, CB(&ToolGPS::SelectionDown)),
+    MenuItem(),
+    MenuItem("Cancel", MenuType::ParentMenu, nullptr, CB(&ToolGPS::SelectionCancel)), 
+    MenuItem("OK", MenuType::ParentMenu, nullptr, CB(&ToolGPS::SelectionOK))};
+
+static const Menu trackSelectionMenu(trackSelectionItems);
+
 extern const Menu gpsBaud1;
 
 static const MenuItem baud3Items[5] = {
@@ -71,21 +90,48 @@ static const MenuItem baud1Items[5] = {
 
 const Menu gpsBaud1(baud1Items);
 
+static const MenuItem rateItems[5] = {
+    MenuItem("1Hz", MenuType::ParentMenu, nullptr, CB(&ToolGPS::Rate1Selected)), 
+    MenuItem("2Hz", MenuType::ParentMenu, nullptr, CB(&ToolGPS::Rate2Selected)), 
+    MenuItem("4Hz", MenuType::ParentMenu, nullptr, CB(&ToolGPS::Rate4Selected)), 
+    MenuItem("5Hz", MenuType::ParentMenu, nullptr, CB(&ToolGPS::Rate5Selected)), 
+    MenuItem("10Hz", MenuType::ParentMenu, nullptr, CB(&ToolGPS::Rate10Selected))};
+
+static const Menu gpsRate(rateItems);
+
+static const MenuItem formatItems[5] = {
+    MenuItem("NMEA", MenuType::ParentMenu, nullptr, CB(&ToolGPS::NMEASelected)), 
+    MenuItem("UBX", MenuType::ParentMenu, nullptr, CB(&ToolGPS::UBXSelected)), 
+    MenuItem("Both", MenuType::ParentMenu, nullptr, CB(&ToolGPS::BothSelected)), 
+    MenuItem(), 
+    MenuItem()};
+
+static const Menu gpsFormat(formatItems);
+
+static const MenuItem serialItems[5] = {
+    MenuItem("Baud", MenuType::ChildMenu, &gpsBaud1), 
+    MenuItem("Rate", MenuType::ChildMenu, &gpsRate), 
+    MenuItem("Format", MenuType::ChildMenu, &gpsFormat), 
+    MenuItem(), 
+    MenuItem("Done", MenuType::ParentMenu)};
+
+static const Menu serialMenu(serialItems);
+
 static const MenuItem outputItems[5] = {
     MenuItem("Coords", MenuType::ChildMenu, &coordsMenu), 
     MenuItem("Time", MenuType::ChildMenu, &modifyMenu, CB(&ToolGPS::EditTime)), 
-    MenuItem("Baud", MenuType::ChildMenu, &gpsBaud1),
+    MenuItem("Serial", MenuType::ChildMenu, &serialMenu),
     MenuItem("Map", MenuType::SiblingMenu, &toolGPSMenu, CB(&ToolGPS::ShowMap)),
-    MenuItem()};
+    MenuItem("Track", MenuType::ChildMenu, &trackSelectionMenu, CB(&ToolGPS::SelectTrack))};
 
 static const Menu outputMenu(outputItems);
 
 static const MenuItem menuItems[5] = {
     MenuItem("Coords", MenuType::ChildMenu, &coordsMenu), 
     MenuItem("Time", MenuType::ChildMenu, &modifyMenu, CB(&ToolGPS::EditTime)), 
-    MenuItem("Baud", MenuType::ChildMenu, &gpsBaud1),
+    MenuItem("Serial", MenuType::ChildMenu, &serialMenu),
     MenuItem("Output", MenuType::SiblingMenu, &outputMenu, CB(&ToolGPS::ShowOutput)),
-    MenuItem()};
+    MenuItem("Track", MenuType::ChildMenu, &trackSelectionMenu, CB(&ToolGPS::SelectTrack))};
 
 const Menu toolGPSMenu(menuItems);
 
@@ -93,7 +139,38 @@ static int baudRates[] = {2400, 4800, 9600, 19200,38400, 57600, 115200};
 
 ToolGPS::ToolGPS() :
     Tool("GPS Sim", new GPSPane(settings.gpsLatitude, settings.gpsLongitude, settings.gpsTime), toolGPSMenu, help),
-    _nextMessage(GGA), _lastMessageTime(SYS_TIME_CounterGet()),
+    _nextMessage(MaxMessage), _lastMessageTime(SYS_TIME_CounterGet()),
+    // Times are hhmmss.ss so there's room for 10 fixes a second
+    // $GPGGA,hhmmss,llll.llll,a,yyyyy.yyyy,b,t,uu,v.v,w.w,M,x.x,M,y.y,zzzz*hh<CR><LF>
+    // http://aprs.gids.nl/nmea/#gga
+    // Quality 8 (simulated), 4 satellites, HDOP 0.9, altitude 280.2m,
+    // geoidal separation -34.1m, no differential GPS
+    _gga("$GPGGA,000000.00,0000.0000,N,00000.0000,E,8,4,0.9,280.2,M,-34.1,M,,"),
+    // $GPRMC,hhmmss,A,llll.llll,a,yyyyy.yyyy,b,s.s,t.t,ddmmyy,m.m,c*hh<CR><LF>
+    // Speed in knots and true course are fixed width so they can be
+    // patched. No magnetic variation.
+    _rmc("$GPRMC,000000.00,A,0000.0000,N,00000.0000,E,000.00,000.0,010100,,"),
+    // $GPGSA,a,b,cc,...,cc,p.p,h.h,v.v*hh<CR><LF>
+    // Automatic 3D fix from the same four satellites as GSV
+    _gsa("$GPGSA,A,3,04,05,09,12,,,,,,,,,1.8,0.9,1.6"),
+    // $GPGSV,n,m,ss,pp,ee,aaa,cc,...*hh<CR><LF>
+    // One sentence of four satellites: PRN, elevation, azimuth, SNR
+    _gsv("$GPGSV,1,1,04,04,60,045,40,05,45,120,38,09,30,200,35,12,20,300,30"),
+    // $GPVTG,t.t,T,m.m,M,n.n,N,k.k,K*hh<CR><LF>
+    // True course, no magnetic course, speed in knots and km/h
+    _vtg("$GPVTG,000.0,T,,M,000.00,N,0000.00,K"),
+    // $GPZDA,hhmmss,dd,mm,yyyy,xx,yy*hh<CR><LF>
+    // UTC, so no local zone offset
+    _zda("$GPZDA,000000.00,01,01,2000,00,00"),
+    _sentences{&_gga, &_rmc, &_gsa, &_gsv, &_vtg, &_zda}, _patchedTime(-1), _patchedDay(-1),
+    _patchedMs(UINT16_MAX), _patchedLatitude(INT32_MIN), _patchedLongitude(INT32_MIN),
+    _patchedSpeed(UINT32_MAX), _patchedCourse(UINT16_MAX),
+    // The same fix as the sentences describe
+    _fix{settings.gpsTime, 0, 2000, 1, 1, settings.gpsLatitude, settings.gpsLongitude, 
+        280200, -34100, 0, 0, 4, 90, 180},
+    _fixDay(-1),
+    _trackFile(SYS_FS_HANDLE_INVALID), _mount(nullptr), _track(&ToolGPS::ReadTrack, this), _trackMs(0),
+    _plan(0), _sending(nullptr), _sendingLength(0), _fixDue(false),
     _timeOffset(0), _timeRunning(true)
 {
     _uart.RegisterWriteCallback(&ToolGPS::SReadyToWrite, this);
@@ -108,6 +185,8 @@ ToolGPS::ToolGPS() :
 
 ToolGPS::~ToolGPS() 
 {
+    laWidget_SetVisible((laWidget *) ListBox, LA_FALSE);
+    CloseTrack();
     _uart.DisableTXInterrupt();
     _uart.Disable();
     RPD10RPPS = PPSGroup1Outputs::O1OFF;
@@ -125,6 +204,173 @@ void ToolGPS::ShowMap()
     GetPane()->ShowMap();
 }
 
+static bool IsTrackFile(const char *fileName)
+{
+    size_t length = strlen(fileName);
+    return length > 4 && 
+        (strcasecmp(fileName + length - 4, GPX_EXTENSION) == 0 || 
+         strcasecmp(fileName + length - 4, CSV_EXTENSION) == 0);
+}
+
+void ToolGPS::SelectTrack()
+{
+    laListWidget_RemoveAllItems(ListBox);
+    uint32_t item = laListWidget_AppendItem(ListBox);
+    uint32_t selectItem = item;
+    laString str = laString_CreateFromCharBuffer(FIXED_POSITION_NAME, &MonoFont);
+    laListWidget_SetItemText(ListBox, item, str);
+    laString_Destroy(&str);
+    
+    MountDrive mount;
+    SYS_FS_HANDLE dir = SYS_FS_DirOpen(mount.Name());
+    SYS_FS_FSTAT stat;
+    char dummy[10];
+    stat.lfname = dummy;
+    
+    _trackNames.clear();
+    while (SYS_FS_DirRead(dir, &stat) == SYS_FS_RES_SUCCESS && stat.fname[0]) 
+    {
+        if ((stat.fattrib & (SYS_FS_ATTR_HID | SYS_FS_ATTR_SYS | SYS_FS_ATTR_VOL | SYS_FS_ATTR_DIR)) == 0 &&
+            IsTrackFile(stat.fname))
+        {
+            _trackNames.push_back(stat.fname);
+        }
+    }
+    SYS_FS_DirClose(dir);
+    std::sort(_trackNames.begin(), _trackNames.end(),
+        [](const std::string &s1, const std::string &s2) 
+        { 
+           return strcasecmp(s1.c_str(), s2.c_str()) < 0;
+        });
+    
+    for (auto &trackName : _trackNames)
+    {
+        item = laListWidget_AppendItem(ListBox);
+        if (trackName == _trackName)
+            selectItem = item;
+        str = laString_CreateFromCharBuffer(trackName.c_str(), &MonoFont);
+        laListWidget_SetItemText(ListBox, item, str);
+        laString_Destroy(&str);
+    }
+    laListWidget_SetItemSelected(ListBox, selectItem, LA_TRUE);
+    laListWidget_SetItemVisible(ListBox, selectItem);
+    
+    laWidget_SetVisible((laWidget *) ListBox, LA_TRUE);
+}
+
+void ToolGPS::SelectionUp()
+{
+    int32_t sel = (int32_t) laListWidget_GetFirstSelectedItem(ListBox);
+    if (sel > 0)
+    {
+        laListWidget_SetItemSelected(ListBox, sel, LA_FALSE);
+        laListWidget_SetItemSelected(ListBox, --sel, LA_TRUE);
+        laListWidget_SetItemVisible(ListBox, sel);
+    }
+}
+
+void ToolGPS::SelectionDown()
+{
+    int32_t sel = (int32_t) laListWidget_GetFirstSelectedItem(ListBox);
+    if (sel < (int32_t) _trackNames.size())
+    {
+        laListWidget_SetItemSelected(ListBox, sel, LA_FALSE);
+        laListWidget_SetItemSelected(ListBox, ++sel, LA_TRUE);
+        laListWidget_SetItemVisible(ListBox, sel);
+    }
+}
+
+void ToolGPS::SelectionCancel()
+{
+    laScrollBarWidget_SetScrollValue(ListBox->scrollbar, 0);
+    laWidget_SetVisible((laWidget *) ListBox, LA_FALSE);
+}
+
+void ToolGPS::SelectionOK()
+{
+    int32_t sel = (int32_t) laListWidget_GetFirstSelectedItem(ListBox);
+    if (sel > 0)
+        OpenTrack(_trackNames[sel - 1].c_str());
+    else
+        CloseTrack();
+    SelectionCancel();
+}
+
+/******************************************************************************
+FUNCTION OpenTrack -- start playing a track file from the beginning
+RETURNS
+    false if the file can't be opened or has no points in it, in which case
+    we stay where we were
+******************************************************************************/
+bool ToolGPS::OpenTrack(const char *fileName)
+{
+    CloseTrack();
+    _mount = new MountDrive();
+    _trackFile = SYS_FS_FileOpen(fileName, SYS_FS_FILE_OPEN_READ);
+    if (_trackFile == SYS_FS_HANDLE_INVALID || !_track.Start())
+    {
+        CloseTrack();
+        SetStatusText("No track");
+        return false;
+    }
+    _trackName = fileName;
+    _trackMs = 0;
+    return true;
+}
+
+void ToolGPS::CloseTrack()
+{
+    if (_trackFile != SYS_FS_HANDLE_INVALID)
+    {
+        SYS_FS_FileClose(_trackFile);
+        _trackFile = SYS_FS_HANDLE_INVALID;
+    }
+    delete _mount;
+    _mount = nullptr;
+    _trackName.clear();
+}
+
+size_t ToolGPS::ReadTrack(void *context, char *buffer, size_t size)
+{
+    size_t bytes = SYS_FS_FileRead(((ToolGPS *) context)->_trackFile, buffer, size);
+    return bytes == (size_t) -1 ? 0 : bytes;
+}
+
+/******************************************************************************
+FUNCTION UpdatePosition -- work out where we are for the next fix
+DESCRIPTION
+    With no track playing, we're wherever the settings say, standing still.
+    Otherwise we take the track position at the current track time, then
+    move the track time on by the time to the next fix. At the end of the
+    track we go back to the start.
+******************************************************************************/
+void ToolGPS::UpdatePosition(uint32_t ms)
+{
+    if (_trackFile == SYS_FS_HANDLE_INVALID)
+    {
+        _fix.latitude = settings.gpsLatitude;
+        _fix.longitude = settings.gpsLongitude;
+        _fix.speed = 0;
+        return;
+    }
+    
+    TrackFix fix;
+    bool more = _track.At(_trackMs, fix);
+    _trackMs += ms;
+    if (!more)
+    {
+        _trackMs = 0;
+        if (SYS_FS_FileSeek(_trackFile, 0, SYS_FS_SEEK_SET) == -1 || !_track.Start())
+            CloseTrack();
+    }
+    
+    _fix.latitude = fix.latitude;
+    _fix.longitude = fix.longitude;
+    _fix.speed = fix.speed;
+    _fix.course = fix.course;
+    GetPane()->SetLocation(_fix.latitude, _fix.longitude);
+}
+
 void ToolGPS::ReadyToWrite()
 {
     char data;
@@ -135,67 +381,174 @@ void ToolGPS::ReadyToWrite()
         _uart.DisableTXInterrupt();
 }
 
+/******************************************************************************
+FUNCTION OnIdle -- keep the GPS messages going out
+DESCRIPTION
+    For each fix the planned messages are brought up to date and queued one
+    after another. We only ever put in what the transmit queue has room for
+    and carry on from there next time, so the main loop never waits on the
+    UART. If the next fix comes round before the last one's messages are
+    all out, the message being queued is finished and the rest are dropped,
+    so the messages never fall behind the clock.
+******************************************************************************/
 void ToolGPS::OnIdle()
 {
-    // If we're going to send the first NMEA message
-    if (_nextMessage == FirstNMEAType)
+    uint32_t now = SYS_TIME_CounterGet();
+    uint32_t periodMs = 1000 / settings.gpsRate;
+    uint32_t period = SYS_TIME_MSToCount(periodMs);
+    if (now - _lastMessageTime >= period)
     {
-        // Make sure a second has passed since the last time
-        uint32_t now = SYS_TIME_CounterGet();
-        if (now - _lastMessageTime < SYS_TIME_MSToCount(1000))
-            return;
-        // Else (a second has passed since we last started a block of NMEA sentences)
-        else
-        {
+        _lastMessageTime += period;
+        // Don't try to catch up if we've been held up for more than a fix
+        if (now - _lastMessageTime >= period)
             _lastMessageTime = now;
+        _fix.ms += periodMs;
+        if (_fix.ms >= 1000)
+        {
+            _fix.ms -= 1000;
             ++_timeOffset;
             GetPane()->SetTime(settings.gpsTime + _timeOffset);
         }
+        _fixDue = true;
     }
 
-    // Send the next message
-    std::string sentence = NMEASentence(_nextMessage);
-    for (auto ch : sentence)
+    // Don't change a message while it's half queued
+    if (_fixDue && _sending == nullptr)
     {
-        while (_transmitQueue.full()) {}
-        _transmitQueue.write(ch);
+        _fixDue = false;
+        StartFix();
     }
+
+    FillTransmitQueue();
+}
+
+/******************************************************************************
+FUNCTION StartFix -- bring the fix and its messages up to date
+DESCRIPTION
+    The date only changes at midnight, so that's the only time we need
+    gmtime().
+******************************************************************************/
+void ToolGPS::StartFix()
+{
+    UpdatePosition(1000 / settings.gpsRate);
     
-    // Show the sentences in the output window
-    _sentences[(int) _nextMessage] = sentence;
-    std::string outputText = "\r\n";
-    for (auto &s : _sentences)
+    _fix.time = settings.gpsTime + _timeOffset;
+    if (_fix.time / 86400 != _fixDay)
     {
-        outputText += s + "\r\n";
+        _fixDay = _fix.time / 86400;
+        struct tm *t = gmtime(&_fix.time);
+        _fix.year = t->tm_year + 1900;
+        _fix.month = t->tm_mon + 1;
+        _fix.day = t->tm_mday;
     }
-    GetPane()->SetOutputText(outputText);
     
+    if (settings.gpsFormat != GPSFormat::UBX)
+        PatchSentences();
+    if (settings.gpsFormat != GPSFormat::NMEA)
+        _pvt.Encode(_fix);
+    _nextMessage = FirstMessage;
+    
+    // The output window is only for looking at, so it only needs to keep
+    // up with the seconds
+    if (_fix.ms == 0)
+        ShowSentences();
+}
 
-    _nextMessage = NMEA(int(_nextMessage) + 1);
-    if (_nextMessage == MaxNMEAType)
+void ToolGPS::FillTransmitQueue()
+{
+    bool queued = false;
+    for (;;)
     {
-        _nextMessage = FirstNMEAType;
+        if (_sending == nullptr)
+        {
+            // Find the next message in the plan
+            while (_nextMessage != MaxMessage && !(_plan & (1 << (int) _nextMessage)))
+                _nextMessage = Message(int(_nextMessage) + 1);
+            if (_nextMessage == MaxMessage)
+                break;
+            if (_nextMessage == PVT)
+            {
+                _sending = _pvt.Data();
+                _sendingLength = _pvt.Length();
+            }
+            else
+            {
+                const NMEATemplate *sentence = _sentences[(int) _nextMessage - (int) GGA];
+                _sending = sentence->Text();
+                _sendingLength = sentence->Length();
+            }
+            _nextMessage = Message(int(_nextMessage) + 1);
+        }
+
+        // UBX messages are binary, so go by the length rather than a NUL
+        while (_sendingLength && !_transmitQueue.full())
+        {
+            _transmitQueue.write(*_sending++);
+            --_sendingLength;
+            queued = true;
+        }
+        // Queue full: carry on next time round
+        if (_sendingLength)
+            break;
+        _sending = nullptr;
     }
 
     // Kickstart the transmitting
-    ReadyToWrite();
+    if (queued)
+        ReadyToWrite();
+}
+
+// Show the planned messages in the output window
+void ToolGPS::ShowSentences()
+{
+    static const char pvtText[] = "UBX NAV-PVT";
+    char outputText[2 + (int) MaxMessage * (NMEA_MAX_LENGTH + 2)];
+    size_t length = 0;
+    outputText[length++] = '\r';
+    outputText[length++] = '\n';
+    for (int i = FirstMessage; i < MaxMessage; ++i)
+    {
+        if (!(_plan & (1 << i)))
+            continue;
+        if (i == PVT)
+        {
+            memcpy(outputText + length, pvtText, sizeof(pvtText) - 1);
+            length += sizeof(pvtText) - 1;
+        }
+        else
+        {
+            const NMEATemplate *s = _sentences[i - (int) GGA];
+            memcpy(outputText + length, s->Text(), s->Length() - 2);
+            length += s->Length() - 2;
+        }
+        outputText[length++] = '\r';
+        outputText[length++] = '\n';
+    }
+    GetPane()->SetOutputText(outputText, length);
 }
 
 void ToolGPS::Update()
 {
-    settings.gpsLatitude = GetPane()->GetLatitude();
-    settings.gpsLongitude = GetPane()->GetLongitude();
+    // While a track is playing, the pane's position is the track's
+    if (_trackFile == SYS_FS_HANDLE_INVALID)
+    {
+        settings.gpsLatitude = GetPane()->GetLatitude();
+        settings.gpsLongitude = GetPane()->GetLongitude();
+    }
     settings.gpsTime = GetPane()->GetTime();
     SettingsModified();
 }
 
 void ToolGPS::EditLatitude()
 {
+    // Editing the position stops the track where it is
+    CloseTrack();
     GetPane()->EditLatitude();
 }
 
 void ToolGPS::EditLongitude()
 {
+    CloseTrack();
     GetPane()->EditLongitude();
 }
 
@@ -240,9 +593,7 @@ void ToolGPS::SetBaudRate(int baud)
     UARTSerialSetup setup = {settings.gpsBaud, UARTSerialSetup::UART8BitParityNone, 1};
     _uart.SerialSetup(&setup, 0);
     
-    char buf[10];
-    sprintf(buf, "%d", settings.gpsBaud);
-    SetStatusText(buf);
+    Plan();
 }
 
 void ToolGPS::BaudSelected(int baud)
@@ -250,106 +601,154 @@ void ToolGPS::BaudSelected(int baud)
     SetBaudRate(baud);
 }
 
-std::string ToolGPS::NMEASentence(NMEA sentence)
+void ToolGPS::RateSelected(int fixesPerSecond)
+{
+    settings.gpsRate = fixesPerSecond;
+    SettingsModified();
+    // Start the fixes on the second
+    _fix.ms = 0;
+    Plan();
+}
+
+void ToolGPS::FormatSelected(GPSFormat format)
+{
+    settings.gpsFormat = format;
+    SettingsModified();
+    Plan();
+}
+
+/******************************************************************************
+FUNCTION Plan -- work out which messages fit at the baud and fix rates
+DESCRIPTION
+    The status shows the baud rate (and fix rate if it isn't 1Hz), followed
+    by how many of the messages get sent if that isn't all of them.
+******************************************************************************/
+void ToolGPS::Plan()
 {
-    char buf[100], *output = buf;
-    struct tm *t;
-    time_t time = settings.gpsTime + _timeOffset;
-    int32_t lat = settings.gpsLatitude, lng = settings.gpsLongitude;
-    int32_t absLat, absLng, latMinutes, lngMinutes;
-    ldiv_t latDiv, lngDiv, latMinutesDiv, lngMinutesDiv;
+    size_t lengths[(int) MaxMessage] = {};
+    if (settings.gpsFormat != GPSFormat::NMEA)
+        lengths[PVT] = _pvt.Length();
+    if (settings.gpsFormat != GPSFormat::UBX)
+    {
+        for (int i = GGA; i < MaxMessage; ++i)
+            lengths[i] = _sentences[i - (int) GGA]->Length();
+    }
+    _plan = NMEAPlan(settings.gpsBaud, settings.gpsRate, lengths, MaxMessage);
     
-    t = gmtime(&time);
-    absLat = labs(lat);
-    latDiv = ldiv(absLat, 10000);
-    latMinutes = latDiv.rem * 60;
-    latMinutesDiv = ldiv(latMinutes, 10000);
-    absLng = labs(lng);
-    lngDiv = ldiv(absLng, 10000);
-    lngMinutes = lngDiv.rem * 60;
-    lngMinutesDiv = ldiv(lngMinutes, 10000);
+    int wanted = 0;
+    for (auto length : lengths)
+        wanted += length != 0;
+    int planned = __builtin_popcount(_plan);
     
-    switch (sentence)
+    char buf[24];
+    char *p = FormatUnsigned(buf, settings.gpsBaud);
+    if (settings.gpsRate > 1)
     {
-        // $GPGGA,hhmmss.sss,llll.lll,a,nnnnn.nnn,b,t,uu,v.v,w.w,M,x.x,M,y.y,zzzz*hh<CR><LF>
-        // http://aprs.gids.nl/nmea/#gga
-        case GGA :
-            sprintf(output, "$GPGGA,"
-                // hour, minute, second,
-                "%02d%02d%02d,"
-                // latitude degrees, minutes, number of decimals in decimal minutes, decimal minutes, N or S hemisphere
-                "%02d%02d.%04d,%c,"
-                // longitude degrees, minutes, number of decimals in decimal minutes, decimal minutes, E or W hemisphere
-                "%03d%02d.%04d,%c," 
-                // GPS quality, 1 = No GPS, 1 = GPS, 2 = DGPS
-                "%d,"
-                // Number of satellites
-                "5,"
-                // Horizontal Dilution of Precision (HDOP)
-                "0.9,"
-                // Antenna altitude in meters
-                "%d.%01d,M,"
-                // Geoidal Separation in Meters
-                "%d.%01d,M,"
-                // Age of differential GPS data
-                ","
-                // Differential reference station ID (0000-1023)
-                ",",
-                t->tm_hour, t->tm_min, t->tm_sec, // time
-                (int) latDiv.quot, (int) latMinutesDiv.quot, (int) latMinutesDiv.rem, lat >= 0 ? 'N' : 'S', // latitude
-                (int) lngDiv.quot, (int) lngMinutesDiv.quot, (int) lngMinutesDiv.rem, lng < 0 ? 'W' : 'E', // longitude
-                8, // quality - simulated
-                280, 2,  // altitude
-                -34, 1 // separation
-            );
-            break;
-            
-        case RMC :
-            sprintf(output, "$GPRMC,"
-                // hour, minute, second,
-                "%02d%02d%02d,"
-                "A,"
-                // latitude degrees, minutes, number of decimals in decimal minutes, decimal minutes, N or S hemisphere
-                "%02d%02d.%04d,%c,"
-                // longitude degrees, minutes, number of decimals in decimal minutes, decimal minutes, E or W hemisphere
-                "%03d%02d.%04d,%c," 
-                // speed over the ground in knots
-                "%d.%03d,"
-                // track angle in degrees True
-                "%d.%d,"
-                // date DDMMYY
-                "%02d%02d%02d,"
-                // magnetic variation
-                ",", // "%d.%d,%c",
-                t->tm_hour, t->tm_min, t->tm_sec, // time
-                (int) latDiv.quot, (int) latMinutesDiv.quot, (int) latMinutesDiv.rem, lat >= 0 ? 'N' : 'S', // latitude
-                (int) lngDiv.quot, (int) lngMinutesDiv.quot, (int) lngMinutesDiv.rem, lng >= 0 ? 'W' : 'E', // longitude
-                // speed
-                0, 0,
-                // track angle
-                0, 0,
-                // date
-                t->tm_mday, t->tm_mon + 1, t->tm_year % 100
-                // magnetic variation
-            );
-            break;
-            
-        default :
-            *output = '\0';
-            break;
+        p = FormatUnsigned(FormatText(p, " "), settings.gpsRate);
+        p = FormatText(p, "Hz");
+    }
+    if (planned == 0)
+    {
+        // Nothing fits, but send the first message anyway. It just won't be
+        // every fix.
+        _plan = 1 << (settings.gpsFormat == GPSFormat::UBX ? (int) PVT : (int) GGA);
+        FormatText(p, " slow");
+    }
+    else if (planned < wanted)
+    {
+        p = FormatUnsigned(FormatText(p, " "), planned);
+        FormatUnsigned(FormatText(p, "/"), wanted);
+    }
+    SetStatusText(buf);
+}
+
+// Write degrees, whole minutes and decimal minutes into a coordinate field
+static void PatchCoordinate(NMEATemplate &sentence, int field, int32_t value, int degreeDigits)
+{
+    // Coordinates are in 1/10000ths of a degree
+    uint32_t absValue = labs(value);
+    uint32_t minutes = absValue % 10000 * 60;
+    sentence.PatchDigits(field, 0, absValue / 10000, degreeDigits);
+    sentence.PatchDigits(field, degreeDigits, minutes / 10000, 2);
+    sentence.PatchDigits(field, degreeDigits + 3, minutes % 10000, 4);
+}
+
+/******************************************************************************
+FUNCTION PatchSentences -- bring the sentences up to date with the fix
+DESCRIPTION
+    Only rewrites what has changed since last time: normally just the 
+    time.
+******************************************************************************/
+void ToolGPS::PatchSentences()
+{
+    if (_fix.time != _patchedTime)
+    {
+        _patchedTime = _fix.time;
+        uint32_t seconds = _fix.time % 86400;
+        for (auto s : {&_gga, &_rmc, &_zda})
+        {
+            s->PatchDigits(1, 0, seconds / 3600, 2);
+            s->PatchDigits(1, 2, seconds / 60 % 60, 2);
+            s->PatchDigits(1, 4, seconds % 60, 2);
+        }
+        
+        if (_fix.time / 86400 != _patchedDay)
+        {
+            _patchedDay = _fix.time / 86400;
+            _rmc.PatchDigits(9, 0, _fix.day, 2);
+            _rmc.PatchDigits(9, 2, _fix.month, 2);
+            _rmc.PatchDigits(9, 4, _fix.year % 100, 2);
+            _zda.PatchDigits(2, 0, _fix.day, 2);
+            _zda.PatchDigits(3, 0, _fix.month, 2);
+            _zda.PatchDigits(4, 0, _fix.year, 4);
+        }
     }
     
-    // Calculate the checksum
-    int c = 0;
-    char *s = output;
-    if (*s == '$')
+    if (_fix.ms != _patchedMs)
     {
-        ++s;
-        while (*s)
-            c ^= *s++;
-        sprintf(s, "*%02X\r\n", c);
+        _patchedMs = _fix.ms;
+        for (auto s : {&_gga, &_rmc, &_zda})
+            s->PatchDigits(1, 7, _fix.ms / 10, 2);
     }
     
-    return buf;
+    if (_fix.latitude != _patchedLatitude)
+    {
+        _patchedLatitude = _fix.latitude;
+        PatchCoordinate(_gga, 2, _patchedLatitude, 2);
+        _gga.Patch(3, _patchedLatitude >= 0 ? 'N' : 'S');
+        PatchCoordinate(_rmc, 3, _patchedLatitude, 2);
+        _rmc.Patch(4, _patchedLatitude >= 0 ? 'N' : 'S');
+    }
+    
+    if (_fix.longitude != _patchedLongitude)
+    {
+        _patchedLongitude = _fix.longitude;
+        PatchCoordinate(_gga, 4, _patchedLongitude, 3);
+        _gga.Patch(5, _patchedLongitude >= 0 ? 'E' : 'W');
+        PatchCoordinate(_rmc, 5, _patchedLongitude, 3);
+        _rmc.Patch(6, _patchedLongitude >= 0 ? 'E' : 'W');
+    }
+    
+    if (_fix.speed != _patchedSpeed)
+    {
+        _patchedSpeed = _fix.speed;
+        // Hundredths of a knot and of a km/h, limited to what the fields hold
+        uint32_t knots = std::min<uint32_t>((uint64_t) _fix.speed * 360 / 1852, 99999);
+        uint32_t kmh = std::min<uint32_t>((uint64_t) _fix.speed * 36 / 100, 999999);
+        _rmc.PatchDigits(7, 0, knots / 100, 3);
+        _rmc.PatchDigits(7, 4, knots % 100, 2);
+        _vtg.PatchDigits(5, 0, knots / 100, 3);
+        _vtg.PatchDigits(5, 4, knots % 100, 2);
+        _vtg.PatchDigits(7, 0, kmh / 100, 4);
+        _vtg.PatchDigits(7, 5, kmh % 100, 2);
+    }
+    
+    if (_fix.course != _patchedCourse)
+    {
+        _patchedCourse = _fix.course;
+        _rmc.PatchDigits(8, 0, _fix.course / 10, 3);
+        _rmc.PatchDigits(8, 4, _fix.course % 10, 1);
+        _vtg.PatchDigits(1, 0, _fix.course / 10, 3);
+        _vtg.PatchDigits(1, 4, _fix.course % 10, 1);
+    }
 }
-
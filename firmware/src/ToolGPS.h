@@ -11,12 +11,19 @@
 #include <stdint.h>
 #include <time.h>
 #include <string>
+#include <vector>
 #include "Utility.h"
 #include "Tool.h"
 #include "UART.h"
+#include "NMEA.h"
+#include "Track.h"
+#include "UBX.h"
+#include "GPSFix.h"
+#include "Settings.h"
 
 class GPSPane;
 class TerminalPane;
+class MountDrive;
 
 class ToolGPS : public Tool
 {
@@ -52,28 +59,88 @@ public:
     void Baud57600Selected() {BaudSelected(57600);}
     void Baud115200Selected() {BaudSelected(115200);}
     
+    void Rate1Selected() {RateSelected(1);}
+    void Rate2Selected() {RateSelected(2);}
+    void Rate4Selected() {RateSelected(4);}
+    void Rate5Selected() {RateSelected(5);}
+    void Rate10Selected() {RateSelected(10);}
+    
+    void NMEASelected() {FormatSelected(GPSFormat::NMEA);}
+    void UBXSelected() {FormatSelected(GPSFormat::UBX);}
+    void BothSelected() {FormatSelected(GPSFormat::Both);}
+    
     void ShowOutput();
     void ShowMap();
     
+    void SelectTrack();
+    void SelectionUp();
+    void SelectionDown();
+    void SelectionCancel();
+    void SelectionOK();
+    
 private:
 
-    typedef enum {FirstNMEAType, GGA = FirstNMEAType, RMC, MaxNMEAType} NMEA;
-    std::string NMEASentence(NMEA sentence);
-    NMEA _nextMessage;
+    // In priority order: what goes first when the baud rate can't carry them all
+    typedef enum {FirstMessage, PVT = FirstMessage, GGA, RMC, GSA, GSV, VTG, ZDA, MaxMessage} Message;
+    void PatchSentences();
+    void StartFix();
+    void FillTransmitQueue();
+    void ShowSentences();
+    Message _nextMessage;
     uint32_t _lastMessageTime;
-    std::string _sentences[(int) MaxNMEAType - (int) FirstNMEAType];
+    
+    // The sentences, kept ready to send. We patch in whatever has changed
+    // since they were last sent.
+    NMEATemplate _gga, _rmc, _gsa, _gsv, _vtg, _zda;
+    NMEATemplate *_sentences[(int) MaxMessage - (int) GGA];
+    time_t _patchedTime, _patchedDay;
+    uint16_t _patchedMs;
+    int32_t _patchedLatitude, _patchedLongitude;
+    uint32_t _patchedSpeed;
+    uint16_t _patchedCourse;
+    
+    UBXNavPVT _pvt;
+    
+    // Where and when we are now: position from the settings or from the
+    // track being played. Shared by the NMEA and UBX messages.
+    GPSFix _fix;
+    time_t _fixDay;
+    
+    // Track playback. The track file is streamed through the player as
+    // we go, so tracks can be any length.
+    bool OpenTrack(const char *fileName);
+    void CloseTrack();
+    void UpdatePosition(uint32_t ms);
+    static size_t ReadTrack(void *context, char *buffer, size_t size);
+    std::vector<std::string> _trackNames;
+    std::string _trackName;
+    SYS_FS_HANDLE _trackFile;
+    MountDrive *_mount;
+    TrackPlayer _track;
+    uint32_t _trackMs;
+    
+    // Which messages fit in a fix at the current baud and fix rates (bit per
+    // Message)
+    uint32_t _plan;
+    // The rest of the message being queued, or nullptr between messages
+    const char *_sending;
+    size_t _sendingLength;
+    // It's time for a fix but its messages haven't started yet
+    bool _fixDue;
     
     static void SReadyToWrite(void *context) {((ToolGPS *) context)->ReadyToWrite();}
     void ReadyToWrite();
     
     void BaudSelected(int baud);
     void SetBaudRate(int baud);
+    void RateSelected(int fixesPerSecond);
+    void FormatSelected(GPSFormat format);
+    void Plan();
     
     ToolGPS(const ToolGPS& orig);
     
     GPSPane *GetPane() {return (GPSPane *) Tool::GetPane();}
 
-    NMEA _currentNEMAMessage = GGA;
     uint32_t _timeOffset;
     bool _timeRunning;
     
@@ -7,6 +7,7 @@
 
 #include <algorithm>
 #include "fixed.h"
+#include "Format.h"
 #include "ToolLogicAnalyzer.h"
 #include "Menu.h"
 #include "SquareWavePane.h"
@@ -19,6 +20,13 @@ static const Help help("Channel 1", "Channel 3", "Channel 2",
 
 static uint32_t timerEnableBit = 1 << 15;
 
+// The sampling channels have to be set up again before the other one fills
+// its buffer, so they're bound directly, above everything else
+typedef DirectInterrupt<_DMA1_VECTOR, 6, ToolLogicAnalyzer, &ToolLogicAnalyzer::SamplingDMA1Done> SamplingDMA1Interrupt;
+typedef DirectInterrupt<_DMA2_VECTOR, 6, ToolLogicAnalyzer, &ToolLogicAnalyzer::SamplingDMA2Done> SamplingDMA2Interrupt;
+Implement_DirectInterruptHandler(SamplingDMA1Interrupt, _DMA1_VECTOR, 6, DMAInt[1].dma)
+Implement_DirectInterruptHandler(SamplingDMA2Interrupt, _DMA2_VECTOR, 6, DMAInt[2].dma)
+
 static const MenuItem channelMenuItems[5] = {
     MenuItem("CH1", MenuType::NoChange, nullptr, CB(&ToolLogicAnalyzer::ToggleChannel1)), 
     MenuItem("CH2", MenuType::NoChange, nullptr, CB(&ToolLogicAnalyzer::ToggleChannel2)), 
@@ -81,6 +89,7 @@ static int nextSampleBlock;
 ToolLogicAnalyzer::ToolLogicAnalyzer() :
     Tool("Logic", new LogicAnalyzerPane(), menu, help),
     _acquisitionMode(Auto), _completedSamplingDMAIndex(-1), _wasAcquiring(false),
+    _remoteArmPending(false), _remoteArmed(false), _remoteReady(false), _remoteStart(0),
     // Sample values on the second byte of Port D, which includes all three inputs
     // D9 is Aux2, D10 is Aux1, D11 is Primary
     _samplingDMA1(1, 0, DMASource {(uint8_t *) &PORTD, 1, 1}, DMADestination {samples.blocks[0], SAMPLE_BLOCK_SIZE}, _sampleTimer.TimerIRQ()),
@@ -96,16 +105,12 @@ ToolLogicAnalyzer::ToolLogicAnalyzer() :
     SampleFreq(settings.sampleFreq);
     
     // Set up ping-pong DMA for gathering samples
-    _samplingDMA1.SetInterruptPriorities(1, 0);
-    _samplingDMA1.RegisterCallback(DMAComplete, this);
+    SamplingDMA1Interrupt::Bind(this, DMAInt[1].dma);
     _samplingDMA1.SetDMAInterruptTrigger(DMA::DestinationDone);
     _samplingDMA1.EnableInterrupt();
     _samplingDMA1.SetChaining(DMA::ChainMode::FromLowerPriorityChannel);
     
-    // Encode the DMA callback data with our this pointer, and fit the index of 
-    // the DMA object into the low bit of the DMA callback data
-    _samplingDMA2.SetInterruptPriorities(1, 0);
-    _samplingDMA2.RegisterCallback(DMAComplete, (void *) (uint32_t(this) | 1));
+    SamplingDMA2Interrupt::Bind(this, DMAInt[2].dma);
     _samplingDMA2.SetDMAInterruptTrigger(DMA::DestinationDone);
     _samplingDMA2.EnableInterrupt();
     _samplingDMA2.SetChaining(DMA::ChainMode::FromHigherPriorityChannel);
@@ -123,6 +128,10 @@ ToolLogicAnalyzer::ToolLogicAnalyzer() :
 
 ToolLogicAnalyzer::~ToolLogicAnalyzer() 
 {
+    _samplingDMA1.DisableInterrupt();
+    _samplingDMA2.DisableInterrupt();
+    SamplingDMA1Interrupt::Unbind();
+    SamplingDMA2Interrupt::Unbind();
 }
 
 void ToolLogicAnalyzer::OnIdle()
@@ -155,6 +164,13 @@ void ToolLogicAnalyzer::OnIdle()
                 // What was the last sample acquired?
                 uint8_t *samplePtr = (uint8_t *) PA_TO_KVA1(uint32_t(_samplingDMAs[activeDMA]->GetDestinationAddress())) + _samplingDMAs[activeDMA]->GetDestinationPointer();
 
+                // The next one to be overwritten is the oldest
+                if (_remoteArmed)
+                {
+                    _remoteStart = uint32_t(samplePtr - samples.stream);
+                    _remoteReady = true;
+                }
+
                 // Convert the samples into pixels for the trace
                 volatile uint32_t samplesPerPixel = sizeof(samples) / ((LogicAnalyzerPane *) GetPane())->TracePixelWidth();
 
@@ -251,20 +267,64 @@ void ToolLogicAnalyzer::OnIdle()
             
             // Draw the data on the screen
             _wasAcquiring = false;
+            _remoteArmed = false;
         }
         
-        // If we should start another acquisition
-        if (_acquisitionMode == Auto)
+        // If we should start another acquisition. Auto mode waits while a
+        // remote capture's samples are still to be fetched.
+        if ((_acquisitionMode == Auto && !_remoteReady) || _remoteArmPending)
         {
-            nextSampleBlock = 0;
-            _samplingDMAs[0]->SetDMAInterruptTrigger(DMA::DestinationDone);
-            _samplingDMAs[0]->SetDestination(DMADestination {samples.blocks[nextSampleBlock], SAMPLE_BLOCK_SIZE});
-            _samplingDMAs[0]->Enable();
-            RunAcquisition();
+            _remoteArmed = _remoteArmPending;
+            _remoteArmPending = false;
+            StartAcquisition();
         }
     }
 }
 
+void ToolLogicAnalyzer::StartAcquisition()
+{
+    nextSampleBlock = 0;
+    _samplingDMAs[0]->SetDMAInterruptTrigger(DMA::DestinationDone);
+    _samplingDMAs[0]->SetDestination(DMADestination {samples.blocks[nextSampleBlock], SAMPLE_BLOCK_SIZE});
+    _samplingDMAs[0]->Enable();
+    RunAcquisition();
+}
+
+// Start a fresh acquisition once the one that's running (if any) is done.
+// The acquisition mode stays as the user set it.
+bool ToolLogicAnalyzer::RemoteArm()
+{
+    _remoteReady = false;
+    _remoteArmPending = true;
+    return true;
+}
+
+RemoteCapture ToolLogicAnalyzer::RemoteCaptureState(uint32_t &size)
+{
+    size = sizeof(samples);
+    if (_remoteArmPending || _remoteArmed)
+        return RemoteCapture::Armed;
+    return _remoteReady ? RemoteCapture::Ready : RemoteCapture::None;
+}
+
+size_t ToolLogicAnalyzer::RemoteFetch(uint32_t offset, uint8_t *data, size_t length)
+{
+    if (!_remoteReady || offset >= sizeof(samples))
+        return 0;
+    length = std::min(length, size_t(sizeof(samples) - offset));
+    
+    // The samples are a ring that starts at the oldest
+    size_t start = (_remoteStart + offset) % sizeof(samples);
+    size_t first = std::min(length, sizeof(samples) - start);
+    memcpy(data, samples.stream + start, first);
+    memcpy(data + first, samples.stream, length - first);
+    
+    // That's the lot, so the display can have the buffer back
+    if (offset + length == sizeof(samples))
+        _remoteReady = false;
+    return length;
+}
+
 void ToolLogicAnalyzer::Update()
 {
 }
@@ -404,9 +464,9 @@ void ToolLogicAnalyzer::SampleFreq(uint32_t freq)
     
     char buf[20];
     if (freq >= 1000000)
-        sprintf(buf, "%dMHz", freq / 1000000);
+        FormatText(FormatUnsigned(buf, freq / 1000000), "MHz");
     else
-        sprintf(buf, "%dKHz", freq / 1000);
+        FormatText(FormatUnsigned(buf, freq / 1000), "KHz");
     SetStatusText(buf);
     
     Update();
@@ -26,6 +26,17 @@ public:
     
     virtual void Update();
     
+    // A remote capture is a single acquisition of the raw samples, oldest
+    // first: a byte each, with the channels' bits as in PORTD's second byte.
+    // Auto mode holds off until the capture's last byte has been fetched.
+    virtual bool RemoteArm();
+    virtual RemoteCapture RemoteCaptureState(uint32_t &size);
+    virtual size_t RemoteFetch(uint32_t offset, uint8_t *data, size_t length);
+    
+    // The sampling DMA channels' interrupts
+    void SamplingDMA1Done() {DMAComplete(0);}
+    void SamplingDMA2Done() {DMAComplete(1);}
+    
     void ToggleChannel1() {ToggleChannel(1);}
     void ToggleChannel2() {ToggleChannel(2);}
     void ToggleChannel3() {ToggleChannel(3);}
@@ -46,17 +57,10 @@ public:
 private:
     ToolLogicAnalyzer(const ToolLogicAnalyzer& orig);
     
+    void StartAcquisition();
     void RunAcquisition();
     
     void DMAComplete(uint32_t dmaIndex);
-    static void DMAComplete(void *pthis) 
-    {
-        uint32_t ithis = uint32_t(pthis);
-        // The pthis argument is the this pointer for the ToolLogicAnalyzer.
-        // The low bit is 0 or 1 indicating a callback from the first or second
-        // DMA object
-        ((ToolLogicAnalyzer *) (ithis & ~1))->DMAComplete(ithis & 1);
-    }
     
     void ToggleChannel(int ch);
     void SampleFreq(uint32_t freq);
@@ -66,6 +70,11 @@ private:
     bool IsAcquiring() {return _sampleTimer.Regs().TCON.bits.ON;}
     bool _wasAcquiring;
     
+    // A remote capture is waiting to start, is running, or is done, and the
+    // offset of its oldest sample
+    bool _remoteArmPending, _remoteArmed, _remoteReady;
+    uint32_t _remoteStart;
+    
     TimerB<6> _sampleTimer;
     DMA _samplingDMA1, _samplingDMA2;
     DMA *_samplingDMAs[2];
@@ -51,17 +51,6 @@ ToolPWM::~ToolPWM()
 {
 }
 
-fixed ToolPWM::GetPeriod() const
-{
-    // Set the the period
-    fixed period;
-    if (_hertz)
-        period = TMR2_FrequencyGet() / _hertz;
-    else
-        period = 0;
-    return period;
- }
-
 void ToolPWM::OnFreq()
 {
     GetPane()->EnterSetFrequency();
@@ -31,14 +31,12 @@ public:
     void Done();
     
 protected:  
-    fixed GetPeriod() const;
+    fixed GetHertz() const {return _hertz;}
     fixed GetDuty() const {return _duty;}
     
 private:
     ToolPWM(const ToolPWM& orig);
     
-    SquareWavePane *GetPane() const {return (SquareWavePane *) Tool::GetPane();}
-    
     fixed _hertz, _duty;
 };
 
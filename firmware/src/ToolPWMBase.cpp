@@ -10,38 +10,192 @@ extern "C"
 #include "definitions.h"
 }
 #include "ToolPWMBase.h"
+#include "TimerSolver.h"
 #include "PPS.h"
+#include "Interrupts.h"
 
 ToolPWMBase::ToolPWMBase(const char *title, Pane *pane, const Menu &menu, const Help &help)  :
-    Tool(title, pane, menu, help)
+    Tool(title, pane, menu, help), _step(Idle), _running(false)
 {
 }
 
 ToolPWMBase::~ToolPWMBase() 
 {
+    // TMR3 interrupts for the 32-bit TMR2/TMR3 pair
+    TMRInt[2].timer.enable = 0;
+    ClearInterruptHandler(TMRInt[2].timer.irqNumber);
     TMR2_Stop();
     OCMP4_Disable();
     RPD11R = (uint32_t) PPSGroup2Outputs::O2OFF;
     TRISDbits.TRISD11 = 1;
 }
 
+/******************************************************************************
+FUNCTION ToolPWMBase::UpdatePWM -- change the output to the tool's settings
+DESCRIPTION
+    OC4 runs in PWM mode, where OC4RS is copied to OC4R when the timer rolls
+    over, so a new pulse width with the same period just goes in OC4RS and
+    the output changes cleanly at the end of the period.
+    
+    The period register isn't buffered, so a new period takes two roll overs
+    (see PeriodTick): the first loads the new pulse into OC4RS, and the second
+    writes the new period into PR2 just after the timer has restarted from 0,
+    the moment OC4R takes the new pulse. Every period on the output is then
+    either all old or all new, with no runt pulses however fast the settings
+    are changed. That needs the interrupt to come round within a period, so
+    periods of less than a microsecond or so can still see an odd one.
+    
+    While the output is low there's nothing to protect, so it's just
+    restarted.
+******************************************************************************/
 void ToolPWMBase::UpdatePWM()
 {
+    // TMR2 and TMR3 run as a 32-bit timer, so the period can go up to 2^32
+    // counts and any prescaler can be used
+    fixed hertz = GetHertz();
+    PWMSetting setting;
+    setting.timer = SolveTimer(TMR2_FrequencyGet(), hertz, TIMER_MAX_COUNTS_32);
+    
+    // Round the pulse to the nearest count. With no frequency the output
+    // stays low.
+    uint64_t pulse = 0;
+    if (hertz)
+    {
+        fixed counts((long long) setting.timer.counts * fixed::scale, true);
+        fixed width = counts * (GetDuty() / 100);
+        pulse = (width.raw() + fixed::scale / 2) / fixed::scale;
+        if (pulse > setting.timer.counts)
+            pulse = setting.timer.counts;
+        if (pulse > 0xffffffff)
+            pulse = 0xffffffff;
+    }
+    setting.pulse = uint32_t(pulse);
+    GetPane()->SetActual(hertz ? TimerFrequency(TMR2_FrequencyGet(), setting.timer) : fixed(0));
+    
+    if (!_running || (_step == Idle && _current.pulse == 0))
+    {
+        StartPWM(setting);
+        return;
+    }
+    
+    // Keep the interrupt out while the settings are changed
+    TMRInt[2].timer.enable = 0;
+    _pending = setting;
+    if (_step != Idle)
+    {
+        // An update's already under way. It will pick this one up when it's
+        // done.
+        TMRInt[2].timer.enable = 1;
+    }
+    else if (_pending.SamePeriod(_current))
+    {
+        OCMP4_CompareSecondaryValueSet(_pending.pulse);
+        _current = _pending;
+    }
+    else
+    {
+        // Start counting roll overs from the next one
+        _step = WritePulse;
+        TMRInt[2].timer.flag = 0;
+        TMRInt[2].timer.enable = 1;
+    }
+}
+
+void ToolPWMBase::StartPWM(const PWMSetting &setting)
+{
+    TMRInt[2].timer.enable = 0;
+    _step = Idle;
+    
     TMR2_Stop();
     OCMP4_Disable();
     TMR2_Initialize();
     OCMP4_Initialize();
-   
-    fixed period = GetPeriod();
-    TMR2_PeriodSet(int(period) - 1);
-    fixed ratio = GetDuty() / 100;
-    fixed pulse = period * ratio;
-    OCMP4_CompareValueSet(0);
-    OCMP4_CompareSecondaryValueSet(int(pulse));
+    // PWM mode without the fault pin: OC4RS is buffered
+    OC4CONbits.OCM = 6;
+    
+    T2CONbits.TCKPS = setting.timer.prescale;
+    TMR2_PeriodSet(uint32_t(setting.timer.counts - 1));
+    OCMP4_CompareValueSet(setting.pulse);
+    OCMP4_CompareSecondaryValueSet(setting.pulse);
+    _current = _pending = setting;
     
     OCMP4_Enable();
     TMR2_Start();
     
-    RPD11R = (uint32_t) PPSGroup2Outputs::OC4; // OC4 outputs to RPD11
-    TRISDbits.TRISD11 = 0;
-}
\ No newline at end of file
+    if (!_running)
+    {
+        TMRInt[2].timer.priority = 1;
+        TMRInt[2].timer.subpriority = 0;
+        SetInterruptHandler(TMRInt[2].timer.irqNumber, PeriodTick, this);
+        
+        RPD11R = (uint32_t) PPSGroup2Outputs::OC4; // OC4 outputs to RPD11
+        TRISDbits.TRISD11 = 0;
+        _running = true;
+    }
+}
+
+/******************************************************************************
+FUNCTION ToolPWMBase::PeriodTick -- step a period change along at a roll over
+DESCRIPTION
+    This runs from the TMR3 interrupt, just after the timer rolls over. It
+    has until the next roll over to load OC4RS, but only until the timer
+    counts up to the new period to write PR2. If it's already past it (a 
+    period shorter than the interrupt latency), the count is restarted so
+    the period comes out a little long rather than running on to 2^32.
+******************************************************************************/
+void ToolPWMBase::PeriodTick()
+{
+    if (_step == WritePulse)
+    {
+        _applying = _pending;
+        OC4RS = _applying.pulse;
+        _step = WritePeriod;
+        return;
+    }
+    
+    if (_applying.timer.prescale != _current.timer.prescale)
+    {
+        // The prescaler can only be changed with the timer off. The count
+        // carries over into the new scale rather than starting again from
+        // 0, but stays on the same side of OC4R: the output has already
+        // risen for this period, and may have fallen, and going back
+        // across would make a runt pulse.
+        T2CONbits.ON = 0;
+        uint64_t clocks = uint64_t(TMR2) * TimerPrescaleDivisor(_current.timer.prescale);
+        uint32_t count = uint32_t(clocks / TimerPrescaleDivisor(_applying.timer.prescale));
+        if (TMR2 < OC4R)
+        {
+            if (count >= OC4R)
+                count = OC4R - 1;
+        }
+        else if (count < OC4R)
+            count = OC4R;
+        T2CONbits.TCKPS = _applying.timer.prescale;
+        PR2 = uint32_t(_applying.timer.counts - 1);
+        TMR2 = count > PR2 ? 0 : count;
+        T2CONbits.ON = 1;
+    }
+    else
+    {
+        PR2 = uint32_t(_applying.timer.counts - 1);
+        if (TMR2 > PR2)
+            TMR2 = 0;
+    }
+    _current = _applying;
+    
+    if (_pending.SamePeriod(_current))
+    {
+        // Whether or not the pulse changed meanwhile, OC4RS can take it now
+        // for the next roll over
+        OC4RS = _pending.pulse;
+        _current = _pending;
+        _step = Idle;
+        TMRInt[2].timer.enable = 0;
+    }
+    else
+    {
+        // The period changed again: this roll over does for the first step
+        _applying = _pending;
+        OC4RS = _applying.pulse;
+    }
+}
@@ -10,6 +10,8 @@
 
 #include "Tool.h"
 #include "fixed.h"
+#include "SquareWavePane.h"
+#include "TimerSolver.h"
 
 class ToolPWMBase : public Tool
 {
@@ -20,11 +22,31 @@ protected:
     
     void UpdatePWM();
     
-    virtual fixed GetPeriod() const = 0;
+    virtual fixed GetHertz() const = 0;
     virtual fixed GetDuty() const = 0;
     
+    SquareWavePane *GetPane() const {return (SquareWavePane *) Tool::GetPane();}
+    
 private:
-
+    struct PWMSetting
+    {
+        TimerSetting timer;
+        uint32_t pulse;     // Counts high at the start of each period
+        
+        bool SamePeriod(const PWMSetting &rhs) const 
+            {return timer.prescale == rhs.timer.prescale && timer.counts == rhs.timer.counts;}
+        bool operator==(const PWMSetting &rhs) const {return SamePeriod(rhs) && pulse == rhs.pulse;}
+    };
+    
+    void StartPWM(const PWMSetting &setting);
+    void PeriodTick();
+    static void PeriodTick(void *pthis) {((ToolPWMBase *) pthis)->PeriodTick();}
+    
+    // What's on the output, what's on its way there, and the latest asked for
+    PWMSetting _current, _applying, _pending;
+    // Whether the next period interrupt writes the pulse or the period
+    volatile enum {Idle, WritePulse, WritePeriod} _step;
+    bool _running;
 };
 
 #endif	/* TOOLPWMBASE_H */
@@ -13,6 +13,7 @@ extern "C"
 #include "TerminalPane.h"
 #include "Display.h"
 #include "Utility.h"
+#include "Format.h"
 #include "ToolSPI.h"
 #include "SPI.h"
 #include "Menu.h"
@@ -66,14 +67,17 @@ static const MenuItem menuItems[5] = {
 
 static const Menu menu(menuItems);
 
+typedef DirectInterrupt<_SPI4_RX_VECTOR, 5, ToolSPI, &ToolSPI::ReceiveData> SPIReceive;
+Implement_DirectInterruptHandler(SPIReceive, _SPI4_RX_VECTOR, 5, SPIInt[3].receiveDone)
+
 ToolSPI::ToolSPI() :
     Tool("SPI In", new TerminalPane(), menu, help)
 {
-    _spi.RegisterReadCallback(&ToolSPI::DataReceived, this);
     _spi.RegisterFaultCallback(&ToolSPI::SPIFault, this);
 
     _spi.Initialize(false, 0, true);
     _spi.SetInterruptPriorities();
+    SPIReceive::Bind(this, SPIInt[3].receiveDone);
     _spi.SetMode(settings.spiPolarity, settings.spiPhase);
     SDI4R = RPD11;
     SS4R = RPD4;
@@ -92,7 +96,7 @@ ToolSPI::~ToolSPI()
 {
     _spi.Disable();
     _spi.DisableRXInterrupt();
-    _spi.UnregisterReadCallback();
+    SPIReceive::Unbind();
 }
 
 void ToolSPI::OnIdle()
@@ -107,13 +111,12 @@ void ToolSPI::OnIdle()
     GetPane()->Update();
 }
 
-void ToolSPI::DataReceived(void *context) 
+void ToolSPI::ReceiveData() 
 {
-    ToolSPI *spi = ((ToolSPI *) context);
-    while (spi->_spi.RXReady())
+    while (_spi.RXReady())
     {
-        uint32_t data = spi->_spi.RXData();
-        spi->_receiveQueue.writeUnsafe(data);
+        uint32_t data = _spi.RXData();
+        _receiveQueue.writeUnsafe(data);
     }
 }
 
@@ -177,9 +180,10 @@ void ToolSPI::Phase1()
 
 void ToolSPI::DisplayStatus()
 {
-    char buf[20];
-    sprintf(buf, /*"%2db; "*/ "CPOL %d; CPHA %d; ~SS=%c",
-            /*settings.spiWidth,*/ settings.spiPolarity, settings.spiPhase, settings.spiUseSelect ? 'B' : '0');
+    char buf[24];
+    char *p = FormatUnsigned(FormatText(buf, "CPOL "), settings.spiPolarity);
+    p = FormatUnsigned(FormatText(p, "; CPHA "), settings.spiPhase);
+    FormatText(p, settings.spiUseSelect ? "; ~SS=B" : "; ~SS=0");
     SetStatusText(buf);
 }
 
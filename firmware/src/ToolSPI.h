@@ -24,7 +24,8 @@ public:
 
     void OnIdle();
     
-    static void DataReceived(void *context);
+    // The receive interrupt
+    void ReceiveData();
     static void SPIFault(void *context);
     
     void Polarity0();
@@ -51,12 +51,6 @@ ToolServo::~ToolServo()
 {
 }
 
-fixed ToolServo::GetPeriod() const
-{
-    fixed period = TMR2_FrequencyGet() / 50;
-    return period;
-}
-
 void ToolServo::OnPulseWidth()
 {
     GetPane()->EnterSetPulseWidth();
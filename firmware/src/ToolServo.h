@@ -28,14 +28,12 @@ public:
     void Done();
     
 protected:
-  fixed GetPeriod()const;
+  fixed GetHertz() const {return 50;}
   fixed GetDuty() const {return _duty;}
     
 private:
     ToolServo(const ToolServo& orig);
     
-    SquareWavePane *GetPane() const {return (SquareWavePane *) Tool::GetPane();}
-    
     fixed _duty;
 };
 
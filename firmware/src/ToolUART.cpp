@@ -14,6 +14,7 @@ extern "C"
 #include "TerminalPane.h"
 #include "Display.h"
 #include "Utility.h"
+#include "Format.h"
 #include "ToolUART.h"
 #include "Menu.h"
 
@@ -58,12 +59,14 @@ static const MenuItem menuItems[5] = {
 
 static const Menu menu(menuItems);
 
+typedef DirectInterrupt<_UART3_RX_VECTOR, 5, ToolUART, &ToolUART::ReceiveBytes> UARTReceive;
+Implement_DirectInterruptHandler(UARTReceive, _UART3_RX_VECTOR, 5, UARTInt[2].receiveDone)
+
 ToolUART::ToolUART() :
     Tool("UART In", new TerminalPane, menu, help), _lastInputCaptureValid(false)
 {
-    _uart.RegisterReadCallback(&ToolUART::ByteReceived, this);
-
     _uart.SetInterruptPriorities();
+    UARTReceive::Bind(this, UARTInt[2].receiveDone);
     _uart.Initialize();
     UARTSerialSetup uss = {settings.uartBaud, UARTSerialSetup::UART8BitParityNone, 1};
     _uart.SerialSetup(&uss, 0);
@@ -89,7 +92,7 @@ ToolUART::~ToolUART()
     _uart.DisableRXInterrupt();
     /* Turn OFF _uart */
     _uart.Disable();
-    _uart.UnregisterReadCallback();
+    UARTReceive::Unbind();
 }
 
 uint32_t ToolUART::TimerFrequency()
@@ -156,11 +159,10 @@ void ToolUART::Clear()
     GetPane()->Clear();
 }
 
-void ToolUART::ByteReceived(void *context) 
+void ToolUART::ReceiveBytes() 
 {
-    ToolUART *toolUART = (ToolUART *) context;
-    while (toolUART->_uart.RXReady())
-        toolUART->_receiveQueue.write(toolUART->_uart.RXData());
+    while (_uart.RXReady())
+        _receiveQueue.write(_uart.RXData());
 }
 
 void ToolUART::SetBaudRate(int baud)
@@ -171,9 +173,9 @@ void ToolUART::SetBaudRate(int baud)
     _uart.SerialSetup(&setup, 0);
     
     char buf[10];
-    sprintf(buf, "%d", settings.uartBaud);
+    char *p = FormatUnsigned(buf, settings.uartBaud);
     if (settings.uartAutobaud)
-        strcat(buf, "*");
+        FormatText(p, "*");
     SetStatusText(buf);
 }
 
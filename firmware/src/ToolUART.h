@@ -27,7 +27,8 @@ public:
     
     void OnIdle();
     
-    static void ByteReceived(void *context);
+    // The receive interrupt
+    void ReceiveBytes();
     
     void AutoBaudSelected();
     void Baud110Selected() {BaudSelected(110);}
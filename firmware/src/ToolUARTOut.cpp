@@ -13,14 +13,18 @@ extern "C"
 #include <string>
 #include <algorithm>
 #include "Settings.h"
+#include "Format.h"
 #include "ToolUARTOut.h"
 #include "Menu.h"
 #include "PPS.h"
 #include "Display.h"
 #include "TerminalPane.h"
 
+// DMA channel used to feed file blocks to the UART
+#define UART_OUT_DMA_CHANNEL 5
+
 static const Help help(NULL, "UART Out", NULL, 
-    "Outputs UART data.");
+    "Outputs UART data: ASCII characters, a file, or a .PAT pattern script.");
 
 extern const Menu uartOutBaud1;
 
@@ -89,7 +93,7 @@ static const MenuItem menuItems[5] = {
 static const Menu menu(menuItems);
 
 ToolUARTOut::ToolUARTOut() :
-    ToolDataOut("UART Out", menu, help)
+    ToolDataOut("UART Out", menu, help), _txDMA(nullptr)
 {
     _uart.Initialize();
     UARTSerialSetup uss = {settings.gpsBaud, UARTSerialSetup::UART8BitParityNone, 1};
@@ -101,6 +105,8 @@ ToolUARTOut::ToolUARTOut() :
 
 ToolUARTOut::~ToolUARTOut() 
 {
+    // Stop the pattern timer and the DMA while we still have a UART
+    Stop();
     _uart.Disable();
     RPD10RPPS = PPSGroup1Outputs::O1OFF;
     TRISDbits.TRISD10 = 1;
@@ -114,10 +120,49 @@ void ToolUARTOut::SetBaudRate(int baud)
     _uart.SerialSetup(&setup, 0);
     
     char buf[10];
-    sprintf(buf, "%d", settings.uartOutBaud);
+    FormatUnsigned(buf, settings.uartOutBaud);
     SetStatusText(buf);
 }
 
+void ToolUARTOut::TXBlock(const char *data, size_t size)
+{
+    // The UART's TX IRQ moves one byte into the FIFO each time there's room
+    delete _txDMA;
+    _txDMA = new DMA(UART_OUT_DMA_CHANNEL, 0, DMASource {(void *) data, 1, size}, 
+        _uart.TXDMADestination(), _uart.TransferDoneIRQ());
+    _txDMA->Enable();
+}
+
+bool ToolUARTOut::TXBlockBusy() const
+{
+    // Check the block done flag rather than the channel's busy bit so a
+    // suspended channel still counts as busy
+    return _txDMA && !(_txDMA->GetDMAInterruptCause() & DMA::BlockTransferComplete);
+}
+
+void ToolUARTOut::TXBlockSuspend(bool suspend)
+{
+    if (TXBlockBusy())
+    {
+        if (suspend)
+            _txDMA->Disable();
+        else
+            _txDMA->Enable();
+    }
+}
+
+void ToolUARTOut::TXBlockCancel()
+{
+    delete _txDMA;
+    _txDMA = nullptr;
+}
+
+uint32_t ToolUARTOut::CharacterNanoseconds() const
+{
+    // Start bit, 8 data bits, stop bit
+    return uint32_t(10 * 1000000000ULL / settings.uartOutBaud);
+}
+
 void ToolUARTOut::BaudSelected(int baud)
 {
     SetBaudRate(baud);
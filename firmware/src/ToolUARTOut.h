@@ -37,6 +37,11 @@ public:
 protected:
     virtual bool TXReady() const {return _uart.TXReady();}
     virtual void TXData(uint32_t data) {_uart.TXData(data);}
+    virtual void TXBlock(const char *data, size_t size);
+    virtual bool TXBlockBusy() const;
+    virtual void TXBlockSuspend(bool suspend);
+    virtual void TXBlockCancel();
+    virtual uint32_t CharacterNanoseconds() const;
     virtual char *FileName();
     virtual void SetFileName(const char *fileName);
 
@@ -47,6 +52,7 @@ private:
     void SetBaudRate(int baud);
      
     UART<3> _uart;
+    DMA *_txDMA;
 };
 
 #endif	/* TOOLUARTOUT_H */
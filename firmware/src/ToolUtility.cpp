@@ -14,6 +14,9 @@ extern "C"
 #include "ToolUtility.h"
 #include "UtilityPane.h"
 #include "Console.h"
+#include "DisplayStats.h"
+#include "Interrupts.h"
+#include "Malloc.h"
 
 extern "C" int DumpDisk(int start, size_t maxBytes, bool showAscii, bool showHex);
 extern "C" int DiskNonZeroSize();
@@ -22,11 +25,22 @@ extern const DRV_USBHS_INIT drvUSBInit;
 static const Help help(NULL, NULL, NULL, 
         "Utility functions.");
 
-static const MenuItem menuItems[5] = {
+// The heap's counts and peaks run from the last reset, so they can be
+// watched across several tools before starting afresh
+static const MenuItem heapItems[5] = {
+    MenuItem("Dump", MenuType::NoChange, NULL, CB(&ToolUtility::DumpHeapStats)), 
+    MenuItem("Reset", MenuType::NoChange, NULL, CB(&ToolUtility::ResetHeapStats)), 
+    MenuItem(), 
     MenuItem(), 
+    MenuItem("Done", MenuType::ParentMenu)};
+
+static const Menu heapMenu(heapItems);
+
+static const MenuItem menuItems[5] = {
     MenuItem(), 
-    MenuItem(),
-    MenuItem(),
+    MenuItem("Heap", MenuType::ChildMenu, &heapMenu), 
+    MenuItem("ISRs", MenuType::NoChange, NULL, CB(&ToolUtility::DumpInterruptStats)), 
+    MenuItem("Stats", MenuType::NoChange, NULL, CB(&ToolUtility::DumpDisplayStats)), 
 #ifdef __DEBUG
     MenuItem("DskDmp", MenuType::NoChange, NULL, CB(&ToolUtility::DumpDisk)), 
 #else
@@ -36,9 +50,26 @@ static const MenuItem menuItems[5] = {
 
 static const Menu menu(menuItems);
 
+bool ToolUtility::_usbStarted = false;
+
 ToolUtility::ToolUtility() :
-    Tool("Utilities", new UtilityPane, menu, help), _diskOffset(-1)
+    Tool("Utilities", new UtilityPane, menu, help), _diskOffset(-1), _displayStatsProbe(-1),
+    _interruptStatsIndex(-1), _heapStatsIndex(-1)
+{
+    StartUSB();
+}
+
+
+ToolUtility::~ToolUtility() 
+{
+}
+
+void ToolUtility::StartUSB()
 {
+    if (_usbStarted)
+        return;
+    _usbStarted = true;
+    
 	 /* Initialize the USB device layer */
     sysObj.usbDevObject0 = USB_DEVICE_Initialize (USB_DEVICE_INDEX_0 , ( SYS_MODULE_INIT* ) & usbDevInitData);
 	
@@ -48,9 +79,11 @@ ToolUtility::ToolUtility() :
     sysObj.drvUSBHSObject = DRV_USBHS_Initialize(DRV_USBHS_INDEX_0, (SYS_MODULE_INIT *) &drvUSBInit);	
 }
 
-
-ToolUtility::~ToolUtility() 
+void ToolUtility::StopUSB()
 {
+    if (!_usbStarted)
+        return;
+    
     // Harmony doesn't really deinitialize USB. So for now, we just do a reset (!!)
     SYS_INT_Disable();
     /* perform a system unlock sequence ,starting critical sequence*/
@@ -75,8 +108,54 @@ void ToolUtility::DumpDisk()
     }
 }
 
+void ToolUtility::DumpDisplayStats()
+{
+    if (_displayStatsProbe == -1)
+        _displayStatsProbe = 0;
+}
+
+void ToolUtility::DumpInterruptStats()
+{
+    if (_interruptStatsIndex == -1)
+        _interruptStatsIndex = 0;
+}
+
+void ToolUtility::DumpHeapStats()
+{
+    if (_heapStatsIndex == -1)
+        _heapStatsIndex = 0;
+}
+
+void ToolUtility::ResetHeapStats()
+{
+    HeapStatsReset();
+    printf("\r\nHeap stats reset\r\n");
+}
+
 void ToolUtility::OnIdle()
 {
+    // Print the display timing one probe at a time so we don't overflow the
+    // console's write buffer. Start counting afresh once it's all out.
+    if (_displayStatsProbe != -1 && CONSOLE_WriteBufferEmpty())
+    {
+        _displayStatsProbe = DisplayStatsDump(_displayStatsProbe, CORETIMER_FrequencyGet() / 1000000);
+        if (_displayStatsProbe == -1)
+            DisplayStatsReset();
+    }
+    
+    // The same for the interrupt timing, a vector at a time
+    if (_interruptStatsIndex != -1 && CONSOLE_WriteBufferEmpty())
+    {
+        _interruptStatsIndex = InterruptStatsDump(_interruptStatsIndex);
+        if (_interruptStatsIndex == -1)
+            InterruptStatsReset();
+    }
+    
+    // And the heap, a line at a time. Its counts are only reset from the
+    // menu.
+    if (_heapStatsIndex != -1 && CONSOLE_WriteBufferEmpty())
+        _heapStatsIndex = HeapStatsDump(_heapStatsIndex);
+    
     if (_diskOffset != -1 && _diskOffset < _diskSize && CONSOLE_WriteBufferEmpty())
     {
         if ((_diskOffset & 511) == 0)
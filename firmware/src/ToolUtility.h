@@ -19,14 +19,30 @@ public:
     virtual ~ToolUtility();
     
     void DumpDisk();
+    void DumpDisplayStats();
+    void DumpInterruptStats();
+    void DumpHeapStats();
+    void ResetHeapStats();
     
     virtual void OnIdle();
+    
+    // This tool starts USB, which then stays up until StopUSB(), so remote
+    // control can switch tools without losing the connection. Harmony can't
+    // shut USB down, so stopping it resets the chip.
+    static void StartUSB();
+    static void StopUSB();
+    static bool IsUSBStarted() {return _usbStarted;}
 
 private:
     ToolUtility(const ToolUtility& orig);
     
     int _diskOffset;
     int _diskSize;
+    int _displayStatsProbe;
+    int _interruptStatsIndex;
+    int _heapStatsIndex;
+    
+    static bool _usbStarted;
 };
 
 #endif	/* TOOLUTILITY_H */
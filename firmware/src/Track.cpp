@@ -0,0 +1,446 @@
+/*
+ * File:   Track.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 8:50 AM
+ */
+
+#include <string.h>
+#include <math.h>
+#include "Track.h"
+
+// 1/10000ths of a degree
+#define MAX_LATITUDE 900000
+#define MAX_LONGITUDE 1800000
+// Metres per degree on a sphere of the earth's mean radius
+#define METRES_PER_DEGREE 111195.0f
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static inline bool IsDigit(char c) {return c >= '0' && c <= '9';}
+static inline bool IsSpace(char c) {return c == ' ' || c == '\t' || c == '\r' || c == '\n';}
+
+// Parses a decimal number scaled up by 10^places, rounding the rest
+static bool ParseDecimal(const char *&p, int places, int64_t &value)
+{
+    while (*p == ' ' || *p == '\t')
+        ++p;
+    bool negative = *p == '-';
+    if (*p == '-' || *p == '+')
+        ++p;
+
+    int64_t v = 0;
+    bool digits = false;
+    for (; IsDigit(*p); ++p, digits = true)
+    {
+        if (v < INT64_MAX / 100)
+            v = v * 10 + *p - '0';
+    }
+    int scale = places;
+    if (*p == '.')
+    {
+        ++p;
+        for (; IsDigit(*p); ++p, digits = true)
+        {
+            if (scale > 0)
+            {
+                v = v * 10 + *p - '0';
+                --scale;
+            }
+            // Round on the first digit we drop
+            else if (scale == 0)
+            {
+                if (*p >= '5')
+                    ++v;
+                --scale;
+            }
+        }
+    }
+    for (; scale > 0; --scale)
+        v *= 10;
+
+    value = negative ? -v : v;
+    return digits;
+}
+
+static bool ParseDigits(const char *&p, int count, int &value)
+{
+    value = 0;
+    for (int i = 0; i < count; ++i, ++p)
+    {
+        if (!IsDigit(*p))
+            return false;
+        value = value * 10 + *p - '0';
+    }
+    return true;
+}
+
+// Days from 1970-01-01 to a date in the proleptic Gregorian calendar
+static int64_t DaysFromCivil(int y, int m, int d)
+{
+    y -= m <= 2;
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return (int64_t) era * 146097 + doe - 719468;
+}
+
+/******************************************************************************
+FUNCTION ParseISOTime -- read an ISO 8601 date and time
+DESCRIPTION
+    Takes YYYY-MM-DDThh:mm:ss with optional fractions of a second and an
+    optional Z or +hh:mm / -hh:mm. A space will do in place of the T.
+RETURNS
+    false if it's not that form
+******************************************************************************/
+static bool ParseISOTime(const char *p, int64_t &ms)
+{
+    int year, month, day, hour, minute, second;
+    if (!ParseDigits(p, 4, year) || *p++ != '-' || !ParseDigits(p, 2, month) || *p++ != '-' ||
+        !ParseDigits(p, 2, day) || (*p != 'T' && *p != ' '))
+        return false;
+    ++p;
+    if (!ParseDigits(p, 2, hour) || *p++ != ':' || !ParseDigits(p, 2, minute) || *p++ != ':' ||
+        !ParseDigits(p, 2, second))
+        return false;
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60)
+        return false;
+
+    ms = ((DaysFromCivil(year, month, day) * 24 + hour) * 60 + minute) * 60 + second;
+    ms *= 1000;
+    if (*p == '.')
+    {
+        int64_t fraction;
+        const char *q = p;
+        if (!ParseDecimal(q, 3, fraction))
+            return false;
+        ms += fraction;
+        p = q;
+    }
+    if (*p == '+' || *p == '-')
+    {
+        int sign = *p++ == '-' ? -1 : 1;
+        int zoneHours, zoneMinutes = 0;
+        if (!ParseDigits(p, 2, zoneHours))
+            return false;
+        if (*p == ':')
+            ++p;
+        if (IsDigit(*p) && !ParseDigits(p, 2, zoneMinutes))
+            return false;
+        // Local time is ahead of UTC by the offset
+        ms -= sign * (zoneHours * 60 + zoneMinutes) * 60000LL;
+    }
+    return true;
+}
+
+// Finds name="value" (or 'value') in a tag and returns where the value starts
+static const char *Attribute(const char *tag, const char *name)
+{
+    size_t nameLength = strlen(name);
+    for (const char *p = strstr(tag, name); p; p = strstr(p + 1, name))
+    {
+        if (p == tag || !IsSpace(p[-1]))
+            continue;
+        const char *q = p + nameLength;
+        while (IsSpace(*q))
+            ++q;
+        if (*q++ != '=')
+            continue;
+        while (IsSpace(*q))
+            ++q;
+        if (*q == '"' || *q == '\'')
+            return q + 1;
+    }
+    return nullptr;
+}
+
+static bool ParseCoordinate(const char *p, int32_t limit, int32_t &coordinate)
+{
+    int64_t value;
+    if (!p || !ParseDecimal(p, 4, value) || value < -limit || value > limit)
+        return false;
+    coordinate = (int32_t) value;
+    return true;
+}
+
+void TrackParser::Reset()
+{
+    _state = Unknown;
+    _tagLength = _valueLength = 0;
+    _inPoint = _inTime = false;
+    _timed = false;
+    _lastMs = -1000;
+}
+
+bool TrackParser::Emit(TrackPoint &point)
+{
+    point.ms = _timed ? _ms : _lastMs + 1000;
+    point.latitude = _latitude;
+    point.longitude = _longitude;
+    _lastMs = point.ms;
+    _timed = false;
+    return true;
+}
+
+bool TrackParser::Parse(char c, TrackPoint &point)
+{
+    switch (_state)
+    {
+        case Unknown :
+            // The first thing in the file tells us what it is
+            if (IsSpace(c))
+                return false;
+            _state = c == '<' ? GPXTag : CSV;
+            if (_state == CSV)
+                _tag[_tagLength++] = c;
+            return false;
+
+        case GPXText :
+            if (c == '<')
+            {
+                _state = GPXTag;
+                _tagLength = 0;
+            }
+            else if (_inTime && _valueLength < sizeof(_value) - 1)
+            {
+                _value[_valueLength++] = c;
+            }
+            return false;
+
+        case GPXTag :
+            if (c == '>')
+            {
+                _state = GPXText;
+                _tag[_tagLength] = '\0';
+                return ParseTag(point);
+            }
+            // Anything past the end of the buffer is attributes we don't need
+            if (_tagLength < sizeof(_tag) - 1)
+                _tag[_tagLength++] = c;
+            return false;
+
+        case CSV :
+            if (c == '\n')
+            {
+                _tag[_tagLength] = '\0';
+                bool done = ParseLine(point);
+                _tagLength = 0;
+                return done;
+            }
+            if (_tagLength < sizeof(_tag) - 1)
+                _tag[_tagLength++] = c;
+            return false;
+    }
+    return false;
+}
+
+/******************************************************************************
+FUNCTION ParseTag -- deal with a complete GPX tag
+DESCRIPTION
+    The tag is what was between the < and the >. Namespace prefixes on the
+    element names are ignored.
+******************************************************************************/
+bool TrackParser::ParseTag(TrackPoint &point)
+{
+    bool closing = _tag[0] == '/';
+    const char *name = _tag + closing;
+    size_t nameLength = strcspn(name, " \t\r\n/");
+    const char *colon = (const char *) memchr(name, ':', nameLength);
+    if (colon)
+    {
+        nameLength -= colon + 1 - name;
+        name = colon + 1;
+    }
+    bool selfClosing = _tagLength && _tag[_tagLength - 1] == '/';
+
+    if ((nameLength == 5 && (strncmp(name, "trkpt", 5) == 0 || strncmp(name, "rtept", 5) == 0)))
+    {
+        if (closing)
+        {
+            bool done = _inPoint;
+            _inPoint = false;
+            return done && Emit(point);
+        }
+        _inPoint = ParseCoordinate(Attribute(_tag, "lat"), MAX_LATITUDE, _latitude) &&
+            ParseCoordinate(Attribute(_tag, "lon"), MAX_LONGITUDE, _longitude);
+        _timed = false;
+        if (selfClosing)
+        {
+            bool done = _inPoint;
+            _inPoint = false;
+            return done && Emit(point);
+        }
+    }
+    else if (nameLength == 4 && strncmp(name, "time", 4) == 0 && _inPoint)
+    {
+        if (closing)
+        {
+            _value[_valueLength] = '\0';
+            _inTime = false;
+            _timed = ParseISOTime(_value, _ms);
+        }
+        else if (!selfClosing)
+        {
+            _inTime = true;
+            _valueLength = 0;
+        }
+    }
+    return false;
+}
+
+/******************************************************************************
+FUNCTION ParseLine -- deal with a complete CSV line
+******************************************************************************/
+bool TrackParser::ParseLine(TrackPoint &point)
+{
+    const char *fields[3];
+    int fieldCount = 0;
+    for (char *p = _tag; fieldCount < 3; ++p)
+    {
+        fields[fieldCount++] = p;
+        p = strchr(p, ',');
+        if (!p)
+            break;
+        *p = '\0';
+    }
+    if (fieldCount < 2)
+        return false;
+
+    int first = fieldCount - 2;
+    if (!ParseCoordinate(fields[first], MAX_LATITUDE, _latitude) ||
+        !ParseCoordinate(fields[first + 1], MAX_LONGITUDE, _longitude))
+        return false;
+
+    _timed = false;
+    if (fieldCount == 3)
+    {
+        const char *time = fields[0];
+        while (IsSpace(*time))
+            ++time;
+        _timed = ParseISOTime(time, _ms) || ParseDecimal(time, 3, _ms);
+    }
+    return Emit(point);
+}
+
+bool TrackPlayer::NextPoint(TrackPoint &point)
+{
+    for (;;)
+    {
+        if (_bufferPos == _bufferLength)
+        {
+            if (_endOfFile)
+                return false;
+            _bufferLength = _read(_context, _buffer, sizeof(_buffer));
+            _bufferPos = 0;
+            if (_bufferLength == 0)
+            {
+                // Finish off a last line with no line end
+                _endOfFile = true;
+                if (!_parser.Parse('\n', point))
+                    return false;
+                break;
+            }
+        }
+        if (_parser.Parse(_buffer[_bufferPos++], point))
+            break;
+    }
+    point.ms -= _startMs;
+    return true;
+}
+
+// Longitude change from one point to another, the short way round
+static int32_t LongitudeDelta(int32_t from, int32_t to)
+{
+    int32_t delta = to - from;
+    if (delta > MAX_LONGITUDE)
+        delta -= 2 * MAX_LONGITUDE;
+    else if (delta < -MAX_LONGITUDE)
+        delta += 2 * MAX_LONGITUDE;
+    return delta;
+}
+
+/******************************************************************************
+FUNCTION Advance -- move on to the next segment of the track
+DESCRIPTION
+    Points that aren't later than the one before are skipped. Speed and
+    course are worked out once per segment, treating the earth as flat
+    over its length, which is plenty for points seconds apart.
+******************************************************************************/
+void TrackPlayer::Advance()
+{
+    _from = _to;
+    do
+    {
+        if (!NextPoint(_to))
+        {
+            _to = _from;
+            _ended = true;
+            _speed = 0;
+            return;
+        }
+    } while (_to.ms <= _from.ms);
+
+    float north = (_to.latitude - _from.latitude) * (METRES_PER_DEGREE / 10000);
+    float meanLatitude = (_from.latitude + _to.latitude) * (float) (M_PI / 2 / 1800000);
+    float east = LongitudeDelta(_from.longitude, _to.longitude) *
+        (METRES_PER_DEGREE / 10000) * cosf(meanLatitude);
+    float metres = sqrtf(north * north + east * east);
+    _speed = (uint32_t) (metres * 1000000 / (_to.ms - _from.ms) + 0.5f);
+    if (metres > 0)
+    {
+        float degrees = atan2f(east, north) * (float) (180 / M_PI);
+        if (degrees < 0)
+            degrees += 360;
+        _course = (uint16_t) (degrees * 10 + 0.5f) % 3600;
+    }
+}
+
+bool TrackPlayer::Start()
+{
+    _parser.Reset();
+    _bufferLength = _bufferPos = 0;
+    _endOfFile = false;
+    _ended = false;
+    _speed = 0;
+    _course = 0;
+
+    _startMs = 0;
+    if (!NextPoint(_to))
+        return false;
+    _startMs = _to.ms;
+    _to.ms = 0;
+    Advance();
+    return true;
+}
+
+bool TrackPlayer::At(uint32_t ms, TrackFix &fix)
+{
+    while (!_ended && ms >= _to.ms)
+        Advance();
+
+    if (_ended)
+    {
+        fix.latitude = _from.latitude;
+        fix.longitude = _from.longitude;
+        fix.speed = 0;
+        fix.course = _course;
+        return false;
+    }
+
+    int64_t elapsed = ms > _from.ms ? ms - _from.ms : 0;
+    int64_t span = _to.ms - _from.ms;
+    fix.latitude = _from.latitude + (int32_t) ((_to.latitude - _from.latitude) * elapsed / span);
+    int32_t longitude = _from.longitude +
+        (int32_t) (LongitudeDelta(_from.longitude, _to.longitude) * elapsed / span);
+    if (longitude > MAX_LONGITUDE)
+        longitude -= 2 * MAX_LONGITUDE;
+    else if (longitude < -MAX_LONGITUDE)
+        longitude += 2 * MAX_LONGITUDE;
+    fix.longitude = longitude;
+    fix.speed = _speed;
+    fix.course = _course;
+    return true;
+}
+
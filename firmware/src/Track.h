@@ -0,0 +1,112 @@
+/*
+ * File:   Track.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 8:50 AM
+ */
+
+#ifndef TRACK_H
+#define	TRACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/******************************************************************************
+Tracks -- GPS positions over time, read from GPX or CSV files
+DESCRIPTION
+    GPX files are read for <trkpt> and <rtept> elements with lat and lon
+    attributes and an optional <time>. CSV files have a line per point of
+    either time,latitude,longitude or just latitude,longitude, where time is
+    seconds from the start (decimals allowed) or an ISO 8601 date and time.
+    Lines that don't parse, such as a heading, are skipped. A point without
+    a time comes a second after the one before.
+
+    The file is parsed a character at a time as it's read, so a track can be
+    any length: only the two points either side of the current time are
+    kept. Nothing here knows about the PIC32, so it builds on the host.
+
+    Coordinates are in 1/10000ths of a degree, as in the settings.
+******************************************************************************/
+
+#define TRACK_TAG_SIZE 128
+#define TRACK_VALUE_SIZE 40
+
+struct TrackPoint
+{
+    int64_t ms;             // From the epoch for ISO times, else from the start
+    int32_t latitude, longitude;
+};
+
+struct TrackFix
+{
+    int32_t latitude, longitude;
+    uint32_t speed;         // mm/s
+    uint16_t course;        // Tenths of a degree from true north
+};
+
+class TrackParser
+{
+public:
+    TrackParser() {Reset();}
+
+    void Reset();
+    // Parse the next character of the file. Returns true when it completes a
+    // point. Call with '\n' at the end of the file to finish a last CSV line.
+    bool Parse(char c, TrackPoint &point);
+
+private:
+    bool ParseTag(TrackPoint &point);
+    bool ParseLine(TrackPoint &point);
+    bool Emit(TrackPoint &point);
+
+    enum {Unknown, GPXText, GPXTag, CSV} _state;
+    // The tag or CSV line being collected, and the <time> text
+    char _tag[TRACK_TAG_SIZE];
+    size_t _tagLength;
+    char _value[TRACK_VALUE_SIZE];
+    size_t _valueLength;
+    bool _inPoint, _inTime;
+
+    // The point being built, and the time of the last one
+    int32_t _latitude, _longitude;
+    bool _timed;
+    int64_t _ms, _lastMs;
+};
+
+class TrackPlayer
+{
+public:
+    // Reads up to size bytes of the file, returning 0 at the end
+    typedef size_t (*ReadFunction)(void *context, char *buffer, size_t size);
+
+    TrackPlayer(ReadFunction read, void *context) :
+        _read(read), _context(context) {}
+
+    // Read the first point, with the file at its start. Returns false if
+    // there isn't one.
+    bool Start();
+    // Where we are ms after the first point. Returns false once past the
+    // last point, which is where the fix then stays.
+    bool At(uint32_t ms, TrackFix &fix);
+
+private:
+    bool NextPoint(TrackPoint &point);
+    void Advance();
+
+    ReadFunction _read;
+    void *_context;
+    char _buffer[256];
+    size_t _bufferLength, _bufferPos;
+    bool _endOfFile;
+
+    TrackParser _parser;
+    int64_t _startMs;
+    // The points either side of now, with times from the first point
+    TrackPoint _from, _to;
+    bool _ended;
+    uint32_t _speed;
+    uint16_t _course;
+};
+
+#endif	/* TRACK_H */
+
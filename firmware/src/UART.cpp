@@ -19,7 +19,9 @@ Implement_InterruptHandler(_UART##n##_TX_VECTOR, UARTInt[n - 1].transferDone) \
 
 UART_INTS(1)
 UART_INTS(2)
-UART_INTS(3)
+// UART 3's receive interrupt is bound directly to ToolUART
+Implement_InterruptHandler(_UART3_FAULT_VECTOR, UARTInt[2].fault)
+Implement_InterruptHandler(_UART3_TX_VECTOR, UARTInt[2].transferDone)
 UART_INTS(4)
 UART_INTS(5)
 UART_INTS(6)
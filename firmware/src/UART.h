@@ -13,6 +13,7 @@
 #include "Oscillator.h"
 #include "PPS.h"
 #include "PMD.h"
+#include "DMA.h"
 
 struct UARTxRegisters
 {
@@ -163,6 +164,11 @@ public:
     {
         ClearInterruptHandler(UARTInt[index - 1].transferDone.irqNumber);
     } 
+    
+    // With the default TX interrupt mode, the transfer done IRQ is asserted
+    // whenever there's room in the TX FIFO, so it can pace a DMA byte-by-byte
+    ::DMADestination TXDMADestination() {return ::DMADestination {(void *) &_regs.UTXREG.reg, 1};}
+    uint8_t TransferDoneIRQ() const {return UARTInt[index - 1].transferDone.irqNumber;}
       
 private:
     UARTxRegisters &_regs = *(UARTxRegisters *) (&U1MODE + (&U2MODE - &U1MODE) * (index - 1));
@@ -0,0 +1,110 @@
+/*
+ * File:   UBX.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 8:50 AM
+ */
+
+#include <string.h>
+#include <math.h>
+#include "UBX.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define UBX_SYNC_1 0xb5
+#define UBX_SYNC_2 0x62
+#define UBX_CLASS_NAV 0x01
+#define UBX_NAV_PVT 0x07
+
+// NAV-PVT flags
+#define PVT_VALID_DATE 0x01
+#define PVT_VALID_TIME 0x02
+#define PVT_FULLY_RESOLVED 0x04
+#define PVT_FIX_3D 3
+#define PVT_GNSS_FIX_OK 0x01
+
+// UBX is little endian
+static inline void Put16(uint8_t *p, uint16_t value)
+{
+    p[0] = uint8_t(value);
+    p[1] = uint8_t(value >> 8);
+}
+
+static inline void Put32(uint8_t *p, uint32_t value)
+{
+    p[0] = uint8_t(value);
+    p[1] = uint8_t(value >> 8);
+    p[2] = uint8_t(value >> 16);
+    p[3] = uint8_t(value >> 24);
+}
+
+void UBXChecksum(const uint8_t *data, size_t length, uint8_t &a, uint8_t &b)
+{
+    a = b = 0;
+    for (size_t i = 0; i < length; ++i)
+    {
+        a += data[i];
+        b += a;
+    }
+}
+
+UBXNavPVT::UBXNavPVT()
+{
+    memset(_data, 0, sizeof(_data));
+    _data[0] = UBX_SYNC_1;
+    _data[1] = UBX_SYNC_2;
+    _data[2] = UBX_CLASS_NAV;
+    _data[3] = UBX_NAV_PVT;
+    Put16(_data + 4, UBX_NAV_PVT_PAYLOAD);
+}
+
+/******************************************************************************
+FUNCTION Encode -- fill in the message from a fix
+DESCRIPTION
+    The accuracy estimates are made up to go with a good simulated fix. The
+    vertical velocity is always zero.
+******************************************************************************/
+void UBXNavPVT::Encode(const GPSFix &fix)
+{
+    uint8_t *p = _data + 6;
+    
+    uint32_t weekSeconds = uint32_t(fix.time + GPS_LEAP_SECONDS - GPS_EPOCH) % (7 * 86400);
+    uint32_t daySeconds = uint32_t(fix.time % 86400);
+    Put32(p + 0, weekSeconds * 1000 + fix.ms);                 // iTOW
+    Put16(p + 4, fix.year);
+    p[6] = fix.month;
+    p[7] = fix.day;
+    p[8] = uint8_t(daySeconds / 3600);
+    p[9] = uint8_t(daySeconds / 60 % 60);
+    p[10] = uint8_t(daySeconds % 60);
+    p[11] = PVT_VALID_DATE | PVT_VALID_TIME | PVT_FULLY_RESOLVED;
+    Put32(p + 12, 30);                                          // tAcc, ns
+    Put32(p + 16, uint32_t(fix.ms) * 1000000);                  // nano
+    p[20] = PVT_FIX_3D;
+    p[21] = PVT_GNSS_FIX_OK;
+    p[22] = 0;
+    p[23] = fix.satellites;
+    // 1e-7 degrees
+    Put32(p + 24, uint32_t(fix.longitude * 1000));
+    Put32(p + 28, uint32_t(fix.latitude * 1000));
+    Put32(p + 32, uint32_t(fix.altitude + fix.geoidSeparation)); // height
+    Put32(p + 36, uint32_t(fix.altitude));                      // hMSL
+    Put32(p + 40, 2500);                                        // hAcc, mm
+    Put32(p + 44, 4000);                                        // vAcc, mm
+    
+    float radians = fix.course * float(M_PI / 1800);
+    Put32(p + 48, uint32_t(lroundf(fix.speed * cosf(radians))));  // velN
+    Put32(p + 52, uint32_t(lroundf(fix.speed * sinf(radians))));  // velE
+    Put32(p + 56, 0);                                           // velD
+    Put32(p + 60, fix.speed);                                   // gSpeed
+    Put32(p + 64, uint32_t(fix.course) * 10000);                // headMot, 1e-5 degrees
+    Put32(p + 68, 200);                                         // sAcc, mm/s
+    Put32(p + 72, 500000);                                      // headAcc
+    Put16(p + 76, fix.pdop);
+    
+    UBXChecksum(_data + 2, 4 + UBX_NAV_PVT_PAYLOAD, _data[UBX_NAV_PVT_LENGTH - 2], 
+        _data[UBX_NAV_PVT_LENGTH - 1]);
+}
+
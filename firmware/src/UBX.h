@@ -0,0 +1,49 @@
+/*
+ * File:   UBX.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 8:50 AM
+ */
+
+#ifndef UBX_H
+#define	UBX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "GPSFix.h"
+
+// Sync chars, class, ID, length, payload, two checksum bytes
+#define UBX_OVERHEAD 8
+#define UBX_NAV_PVT_PAYLOAD 92
+#define UBX_NAV_PVT_LENGTH (UBX_NAV_PVT_PAYLOAD + UBX_OVERHEAD)
+
+// GPS time was UTC at its 1980-01-06 epoch and hasn't had leap seconds since
+#define GPS_EPOCH 315964800
+#define GPS_LEAP_SECONDS 18
+
+// The 8-bit Fletcher checksum over the class, ID, length and payload
+void UBXChecksum(const uint8_t *data, size_t length, uint8_t &a, uint8_t &b);
+
+/******************************************************************************
+CLASS UBXNavPVT -- a u-blox UBX-NAV-PVT message
+DESCRIPTION
+    Position, velocity and time, laid out as in the u-blox 8 protocol
+    description. The message is built in place in a fixed buffer. It doesn't
+    know about the PIC32, so it builds on the host.
+******************************************************************************/
+class UBXNavPVT
+{
+public:
+    UBXNavPVT();
+    
+    void Encode(const GPSFix &fix);
+    
+    const char *Data() const {return (const char *) _data;}
+    size_t Length() const {return sizeof(_data);}
+    
+private:
+    uint8_t _data[UBX_NAV_PVT_LENGTH];
+};
+
+#endif	/* UBX_H */
+
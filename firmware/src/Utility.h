@@ -49,34 +49,37 @@ std::string eng(double value, int digits, const char *units);
 
 class Tool;
 
+// A menu item's action: a member function of the tool that shows the menu.
+// It's made at compile time, so menus go in flash and nothing's allocated
+// for them. Calling it is a plain function call, through a thunk made for
+// each member function, and the thunk's static_cast doesn't need RTTI. The
+// cast isn't checked when it runs, so a menu must only be shown by the tool
+// it was written for, which is how each tool's static menus are used.
 class Callback
 {
 public:
-    virtual void operator()(Tool *tool) const = 0;
-};
+    typedef void (*Thunk)(Tool *tool);
     
-template<class T>
-class _Callback : public Callback
-{
-public:
-    _Callback(void (T::*fn)()) : _fn(fn) {}
+    constexpr Callback(Thunk thunk = nullptr) : _thunk(thunk) {}
     
-    void operator()(Tool *obj) const 
+    constexpr bool IsSet() const {return _thunk != nullptr;}
+    void operator()(Tool *tool) const {_thunk(tool);}
+    
+    template <class T, void (T::*fn)()>
+    static void Call(Tool *tool)
     {
-        T *t = dynamic_cast<T *>(obj);
-        ASSERT(t);
-        (t->*_fn)();
+        (static_cast<T *>(tool)->*fn)();
     }
     
 private:
-    void (T::*_fn)();
+    Thunk _thunk;
 };
 
-template <class T> 
-Callback *CB(void (T::*fn)()) 
-{
-    return new _Callback<T>(fn);
-}
+template <class F> struct _CallbackClass;
+template <class T> struct _CallbackClass<void (T::*)()> {typedef T Type;};
+
+// CB(&ToolX::Fn) makes the Callback that calls Fn on the current tool
+#define CB(fn) Callback(&Callback::Call<_CallbackClass<decltype(fn)>::Type, fn>)
 
 class DisableInterrupts
 {
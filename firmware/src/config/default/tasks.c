@@ -55,6 +55,7 @@
 
 // BA added
 extern bool IsLCDUpdateBusy();
+#include "DisplayStats.h"
 
 
 
@@ -96,7 +97,16 @@ DRV_MEMORY_Tasks(sysObj.drvMemory0);
 
     // BA don't start repainting the image buffer until it's been sent to the LCD
     if (!IsLCDUpdateBusy())
+    {
+#ifdef DISPLAY_STATS
+        uint32_t start = DisplayStatsNow();
         LibAria_Tasks();
+        DisplayStatsAdd(DisplayProbeFrame, DisplayStatsNow() - start);
+        DisplayStatsEndFrame(CORETIMER_FrequencyGet() / 1000000);
+#else
+        LibAria_Tasks();
+#endif
+    }
 
 
 
@@ -70,6 +70,9 @@ USB_MSD_CSW msdCSW0 USB_ALIGN;
  ***********************************************/
 uint8_t flashRowBackupBuffer [DRV_MEMORY_DEVICE_PROGRAM_SIZE] USB_ALIGN;
 
+// DRV_MEMORY_IsAttached, except that the drive goes away while the firmware
+// reads it in place (FileSystem.cpp)
+bool DiskIsAttached(const DRV_HANDLE handle);
 
 /*******************************************
  * MSD Function Driver initialization
@@ -104,7 +107,7 @@ USB_DEVICE_MSD_MEDIA_INIT_DATA USB_ALIGN  msdMediaInit0[1] =
             }
         },
         {
-            DRV_MEMORY_IsAttached,
+            DiskIsAttached,
             DRV_MEMORY_Open,
             DRV_MEMORY_Close,
             DRV_MEMORY_GeometryGet,
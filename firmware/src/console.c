@@ -54,10 +54,15 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 // *****************************************************************************
 
 #include "console.h"
+#include "ConsoleWriter.h"
 
 extern bool ctrlC;
 bool breakOnControlC = true;
 
+// RemoteProtocol.h's REMOTE_SYNC. A packet starting with it is remote
+// control taking over the console, so Ctrl-C is just another byte from then.
+#define REMOTE_SYNC_BYTE 0xa5
+
 // *****************************************************************************
 /* Application states
 
@@ -99,10 +104,12 @@ typedef enum
     Application strings and buffers are be defined outside this structure.
  */
 
+// Big enough for a whole read on top of the largest remote control frame,
+// so the remote protocol can wait for a frame in place
 typedef struct 
 {
-    char data[1024];
-    size_t head, tail;
+    char data[2048];
+    volatile size_t head, tail;
 } Queue;
 
 static void ResetQueue(Queue *q)
@@ -115,12 +122,9 @@ static bool IsEmptyQueue(Queue *q)
     return q->head == q->tail;
 }
 
-static bool IsFullQueue(Queue *q)
+static size_t QueueSpace(Queue *q)
 {
-    size_t next = q->tail + 1;
-    if (next == sizeof(q->data))
-        next = 0;
-    return q->head == next;
+    return (q->head + sizeof(q->data) - q->tail - 1) % sizeof(q->data);
 }
 
 static size_t AddToQueue(Queue *q, const char *data, size_t length)
@@ -130,8 +134,9 @@ static size_t AddToQueue(Queue *q, const char *data, size_t length)
     while (length)
     {
         size_t toCopy = length;
+        // Keep a byte free, or a full queue would look empty
         if (q->tail >= q->head)
-            freeBlock = sizeof(q->data) - q->tail;
+            freeBlock = sizeof(q->data) - q->tail - (q->head == 0 ? 1 : 0);
         else
             freeBlock = q->head - q->tail - 1;
         if (freeBlock < toCopy)
@@ -180,9 +185,6 @@ typedef struct
     /* Flag indicates that read has completed */
     bool readIsComplete;
 
-    /* Flag indicates that write has complete */
-    bool writeIsComplete;
-
     /* Device layer handle returned by device layer open function */
     USB_DEVICE_HANDLE deviceHandle;
 
@@ -207,10 +209,8 @@ typedef struct
     /* Read transfer handle */
     USB_DEVICE_CDC_TRANSFER_HANDLE readTransferHandle;
 
-    /* Write transfer handle */
-    USB_DEVICE_CDC_TRANSFER_HANDLE writeTransferHandle;
-
-    Queue readQueue, writeQueue;
+    Queue readQueue;
+    ConsoleWriter writer;
     
     OSAL_SEM_DECLARE(semaphore);
     
@@ -223,14 +223,17 @@ typedef struct
 // *****************************************************************************
 
 #define CONSOLE_READ_BUFFER_SIZE 512
+// Each of the two write buffers. While one is going out over USB, the other
+// fills.
+#define CONSOLE_WRITE_BUFFER_SIZE 2048
 #define CONSOLE_MAKE_BUFFER_DMA_READY __attribute__((coherent, aligned(16)))
 
 /*****************************************
  * Buffers required for reading and sending
  * data over CDC
  *****************************************/
-char CONSOLE_MAKE_BUFFER_DMA_READY readBuffer[64];
-char CONSOLE_MAKE_BUFFER_DMA_READY writeBuffer[64];
+char CONSOLE_MAKE_BUFFER_DMA_READY readBuffer[CONSOLE_READ_BUFFER_SIZE];
+char CONSOLE_MAKE_BUFFER_DMA_READY writeBuffers[2][CONSOLE_WRITE_BUFFER_SIZE];
 
 // *****************************************************************************
 /* Application Data
@@ -326,14 +329,18 @@ void CONSOLE_USBDeviceCDCEventHandler
 
             /* This means that the host has sent some data*/
             consoleData.readIsComplete = true;
-            if (breakOnControlC && consoleData.readBuffer[0] == '\x03')
+            data = (USB_DEVICE_CDC_EVENT_DATA_READ_COMPLETE *) pData;
+            if (data->length && (uint8_t) consoleData.readBuffer[0] == REMOTE_SYNC_BYTE)
+                breakOnControlC = false;
+            // A typed Ctrl-C comes in a packet of its own. A 0x03 at the
+            // start of a longer one is data, e.g. part of a remote frame.
+            if (breakOnControlC && data->length == 1 && consoleData.readBuffer[0] == '\x03')
             {
                 ResetQueue(&consoleDataObject->readQueue);
 //                ctrlC = true;
             }
             else
             {
-                data = (USB_DEVICE_CDC_EVENT_DATA_READ_COMPLETE *) pData;
                 AddToQueue(&consoleDataObject->readQueue, consoleData.readBuffer, data->length);
 //                OSAL_SEM_PostISR(consoleDataObject->semaphore);
             }
@@ -357,10 +364,10 @@ void CONSOLE_USBDeviceCDCEventHandler
 
         case USB_DEVICE_CDC_EVENT_WRITE_COMPLETE:
 
-            /* This means that the data write got completed. We can schedule
-             * the next read. */
+            /* This means that the data write got completed. Send the next
+             * buffer from here, so output doesn't wait for CONSOLE_Tasks. */
 
-            consoleData.writeIsComplete = true;
+            ConsoleWriterComplete(&consoleDataObject->writer);
 //            OSAL_SEM_PostISR(consoleDataObject->semaphore);
 
             break;
@@ -443,6 +450,36 @@ void CONSOLE_USBDeviceEventCallBack ( USB_DEVICE_EVENT event, void * eventData,
 // *****************************************************************************
 // *****************************************************************************
 
+/************************************************
+ * The USB side of the console writer
+ ************************************************/
+
+static bool ConsoleSend(const char *buffer, size_t length, void *context)
+{
+    USB_DEVICE_CDC_TRANSFER_HANDLE handle = USB_DEVICE_CDC_TRANSFER_HANDLE_INVALID;
+    if (!consoleData.deviceIsConfigured || !consoleData.controlLineStateData.dtr)
+        return false;
+    return USB_DEVICE_CDC_Write(USB_DEVICE_CDC_INDEX_0, &handle, (void *) buffer, length,
+        USB_DEVICE_CDC_TRANSFER_FLAGS_DATA_COMPLETE) == USB_DEVICE_CDC_RESULT_OK;
+}
+
+// Write completions come from the USB interrupts, so hold them off while the
+// main loop starts a write
+static uint32_t ConsoleLock(void *context)
+{
+    bool usb = SYS_INT_SourceDisable(INT_SOURCE_USB);
+    bool usbDMA = SYS_INT_SourceDisable(INT_SOURCE_USB_DMA);
+    return (usb ? 1 : 0) | (usbDMA ? 2 : 0);
+}
+
+static void ConsoleUnlock(uint32_t state, void *context)
+{
+    SYS_INT_SourceRestore(INT_SOURCE_USB_DMA, (state & 2) != 0);
+    SYS_INT_SourceRestore(INT_SOURCE_USB, (state & 1) != 0);
+}
+
+static const ConsoleTransport consoleTransport = {ConsoleSend, ConsoleLock, ConsoleUnlock, NULL};
+
 /************************************************
  * Application State Reset Function
  ************************************************/
@@ -458,11 +495,9 @@ bool CONSOLE_StateReset(void)
     {
         consoleData.state = CONSOLE_STATE_WAIT_FOR_CONFIGURATION;
         consoleData.readTransferHandle = USB_DEVICE_CDC_TRANSFER_HANDLE_INVALID;
-        consoleData.writeTransferHandle = USB_DEVICE_CDC_TRANSFER_HANDLE_INVALID;
         consoleData.readIsComplete = true;
-        consoleData.writeIsComplete = true;
         ResetQueue(&consoleData.readQueue);
-        ResetQueue(&consoleData.writeQueue);
+        ConsoleWriterReset(&consoleData.writer);
         
         retVal = true;
     }
@@ -505,16 +540,13 @@ void CONSOLE_Initialize ( void )
     /* Read Transfer Handle */
     consoleData.readTransferHandle = USB_DEVICE_CDC_TRANSFER_HANDLE_INVALID;
 
-    /* Write Transfer Handle */
-    consoleData.writeTransferHandle = USB_DEVICE_CDC_TRANSFER_HANDLE_INVALID;
-
     /* Initialize the application flags */
     consoleData.readIsComplete     = true;
-    consoleData.writeIsComplete    = true;
     consoleData.deviceIsConfigured = false;
     consoleData.sofEventHasOccurred = false;
     ResetQueue(&consoleData.readQueue);
-    ResetQueue(&consoleData.writeQueue);
+    ConsoleWriterInit(&consoleData.writer, &consoleTransport, writeBuffers[0], writeBuffers[1],
+        CONSOLE_WRITE_BUFFER_SIZE);
 
     /* Assign the read buffer */
     consoleData.readBuffer = &readBuffer[0];
@@ -579,8 +611,9 @@ void CONSOLE_Tasks (void)
                 break;
             }
            
-            /* If a read is complete, then schedule a read */
-            if(consoleData.readIsComplete)
+            /* If a read is complete, then schedule a read, once there's
+             * room for all of it. Until then the host's writes wait. */
+            if(consoleData.readIsComplete && QueueSpace(&consoleData.readQueue) >= CONSOLE_READ_BUFFER_SIZE)
             {
                 consoleData.readIsComplete = false;
                 consoleData.readTransferHandle = USB_DEVICE_CDC_TRANSFER_HANDLE_INVALID;
@@ -592,20 +625,10 @@ void CONSOLE_Tasks (void)
                 }
             }
 
-            /* If a write is complete and there is more data to write */
-            if (consoleData.writeIsComplete && !IsEmptyQueue(&consoleData.writeQueue) && consoleData.controlLineStateData.dtr)
-            {
-                size_t count;
-                /* Setup the write */
-
-                consoleData.writeTransferHandle = USB_DEVICE_CDC_TRANSFER_HANDLE_INVALID;
-                consoleData.writeIsComplete = false;
-
-                /* Echo the received character + 1*/
-                count = ReadFromQueue(&consoleData.writeQueue, writeBuffer, sizeof(writeBuffer));
-                USB_DEVICE_CDC_Write(USB_DEVICE_CDC_INDEX_0, &consoleData.writeTransferHandle,
-                    &writeBuffer, count, USB_DEVICE_CDC_TRANSFER_FLAGS_DATA_COMPLETE);
-            }
+            /* Writes normally start themselves, but one that couldn't
+             * (say before the host set DTR) goes from here, and writers
+             * waiting for space hear about it */
+            ConsoleWriterPoll(&consoleData.writer);
             
             break;
 
@@ -633,25 +656,75 @@ int CONSOLE_Read()
     return rtn;
 }
 
+size_t CONSOLE_ReadPeek(const char **first, size_t *firstLength, const char **second, size_t *secondLength)
+{
+    Queue *q = &consoleData.readQueue;
+    size_t head = q->head;
+    size_t tail = q->tail;
+    *first = q->data + head;
+    *second = q->data;
+    if (tail >= head)
+    {
+        *firstLength = tail - head;
+        *secondLength = 0;
+    }
+    else
+    {
+        *firstLength = sizeof(q->data) - head;
+        *secondLength = tail;
+    }
+    return *firstLength + *secondLength;
+}
+
+void CONSOLE_ReadConsume(size_t count)
+{
+    Queue *q = &consoleData.readQueue;
+    q->head = (q->head + count) % sizeof(q->data);
+}
+
+void CONSOLE_SetBreakOnControlC(bool on)
+{
+    breakOnControlC = on;
+}
+
 int CONSOLE_Write(char c)
+{
+    return (int) CONSOLE_WriteSpan(&c, 1);
+}
+
+size_t CONSOLE_WriteSpan(const char *data, size_t length)
 {
     size_t written = 0;
-    bool full;
     do
     {
-//        SYS_INT_PROCESSOR_STATUS interruptState = SYS_INT_StatusGetAndDisable();
-        full = IsFullQueue(&consoleData.writeQueue);
-        if (!full)
-            written = AddToQueue(&consoleData.writeQueue, &c, 1);
-//        SYS_INT_StatusRestore(interruptState);
-    } while (full && consoleData.controlLineStateData.dtr);
-//    OSAL_SEM_Post(consoleData.semaphore);
-    return (int) written;
+        written += ConsoleWriterWrite(&consoleData.writer, data + written, length - written);
+    } while (written < length && consoleData.deviceIsConfigured && consoleData.controlLineStateData.dtr);
+    return written;
+}
+
+size_t CONSOLE_TryWrite(const char *data, size_t length)
+{
+    return ConsoleWriterWrite(&consoleData.writer, data, length);
+}
+
+size_t CONSOLE_WriteSpace()
+{
+    return ConsoleWriterSpace(&consoleData.writer);
+}
+
+void CONSOLE_SetWriteSpaceCallback(void (*callback)(size_t space, void *context), void *context, size_t threshold)
+{
+    ConsoleWriterSetSpaceCallback(&consoleData.writer, callback, context, threshold);
 }
 
 bool CONSOLE_WriteBufferEmpty()
 {
-    return IsEmptyQueue(&consoleData.writeQueue);
+    return ConsoleWriterIsEmpty(&consoleData.writer);
+}
+
+bool CONSOLE_IsOpen()
+{
+    return consoleData.deviceIsConfigured && consoleData.controlLineStateData.dtr;
 }
 
 
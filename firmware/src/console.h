@@ -132,9 +132,29 @@ void CONSOLE_Initialize ( void );
 void CONSOLE_Tasks ( void );
 
 int CONSOLE_Read();
+// What's been received, in place and without taking it. The queue is a
+// ring, so it comes in two pieces; the second is empty unless it wrapped.
+// Returns the total length.
+size_t CONSOLE_ReadPeek(const char **first, size_t *firstLength, const char **second, size_t *secondLength);
+// Take count bytes from the front of what CONSOLE_ReadPeek returned
+void CONSOLE_ReadConsume(size_t count);
+// Whether a read starting with Ctrl-C throws away what's been received.
+// Binary data wants it off.
+void CONSOLE_SetBreakOnControlC(bool on);
 int CONSOLE_Write(char c);
+// Writes a span, waiting for room while the host is listening. Returns how
+// much was written, which is short only if the host went away.
+size_t CONSOLE_WriteSpan(const char *data, size_t length);
+// Writes as much of a span as fits without waiting
+size_t CONSOLE_TryWrite(const char *data, size_t length);
+size_t CONSOLE_WriteSpace();
+// After CONSOLE_TryWrite comes up short, callback runs from CONSOLE_Tasks
+// once there are threshold bytes free
+void CONSOLE_SetWriteSpaceCallback(void (*callback)(size_t space, void *context), void *context, size_t threshold);
 
 bool CONSOLE_WriteBufferEmpty();
+// Whether a host has the port open
+bool CONSOLE_IsOpen();
 
 #ifdef __cplusplus
 }
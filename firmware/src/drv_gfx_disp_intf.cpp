@@ -50,16 +50,31 @@ extern "C"
 #include "Utility.h"
 #include "DMA.h"
 #include "TimerB.h"
-
-static bool lcdUpdateBusy = false;
-extern "C" bool IsLCDUpdateBusy()
-{
-    return lcdUpdateBusy;
-}
+#include "DisplayStats.h"
+#include "ScanlineWriter.h"
 
 //#define PMPLCD
 #define SPILCD
 
+#define IMAGE_WIDTH 320
+#define IMAGE_HEIGHT 240
+
+// LCD SPI transport. Commands and their parameters always go out 8 bits at a
+// time, because the ILI9488 samples D/C per byte. Pixel data can go out in
+// 16 or 32 bit SPI words, which cuts the number of DMA transfers per line.
+#define LCD_SPI_CLOCK 50000000      // Requested SCK in Hz; SPIBRG is derived from PBCLK2
+#define LCD_PIXEL_WORD_BITS 16      // 8, 16 or 32
+#define LCD_MAX_BYTE_RATE 4000000   // Never pace the DMA faster than this (bytes/s)
+#define LCD_PACING_MARGIN 10        // Percent slower than the SPI's byte rate
+
+// MEMORY_WRITE pixel data goes out by DMA through the scanline buffers.
+// Image DMA was turned off originally because images got corrupted while the
+// Logic Analyzer was capturing by DMA at the same time. That DMA read straight
+// out of the caller's pixel line, which FastImageDraw refills for the next row
+// as soon as WritePixels returns, and a busy bus only made the DMA slower to
+// get there first. The scanline buffers are a copy, and uncached, so neither
+// the caller nor the cache can change what the DMA reads.
+
 /** SPI_TRANS_STATUS
 
   Summary:
@@ -99,14 +114,25 @@ typedef struct
 #include "SPI.h"
 
 static SPI<2> *spi;
+static int spiWidth = 8;
 
-struct DMACommand
-{
-    void *address;
-    size_t size;
-};
+// Paces the pixel DMA: one SPI word per timer tick
+static TimerB<5> *pacingTimer;
+static uint32_t pacingHz;
 
-CQueue<DMACommand, 10> dmaCommands;
+static void StartLine(const uint8_t *line, size_t bytes, void *);
+
+// Pixel data goes out through a pair of scanline buffers. While DMA drains
+// one of them, the CPU fills the other. The buffers are coherent (uncached)
+// so the DMA never reads stale data out of the cache.
+#define SCANLINE_BYTES (IMAGE_WIDTH * 2)
+static uint8_t __attribute__((coherent, aligned(16))) scanlines[2][SCANLINE_BYTES];
+static ScanlineWriter scanlineWriter(scanlines[0], scanlines[1], SCANLINE_BYTES, StartLine, nullptr);
+
+extern "C" bool IsLCDUpdateBusy()
+{
+    return scanlineWriter.Busy();
+}
 
 #elif defined(PMPLCD)
 
@@ -118,6 +144,50 @@ CQueue<DMACommand, 10> dmaCommands;
 
 /* ************************************************************************** */
 
+#ifdef SPILCD
+
+// Calculate the SPIBRG value for the fastest SCK that doesn't exceed hertz
+static uint32_t SPIBaudRegister(uint32_t hertz)
+{
+    uint32_t pbclk = oscillator.PBCLK(2);
+    uint32_t brg = (pbclk + 2 * hertz - 1) / (2 * hertz);
+    return brg ? brg - 1 : 0;
+}
+
+static void SetSPIWidth(int bits)
+{
+    if (bits == spiWidth)
+        return;
+    
+    // The width can only be changed with the SPI off. And turning it off in the
+    // middle of a word would truncate the word.
+    while (!spi->TXEmpty() || !spi->ShiftRegisterEmpty()) {}
+    spi->Disable();
+    spi->SetWidth(bits);
+    spi->Enable();
+    spiWidth = bits;
+}
+
+// Pace the DMA for pixel words of this many bits. The DMA doesn't check
+// whether SPIBUF is full; if it writes too soon, the word is silently dropped.
+// The SPI sends a byte every 8 SCKs, so there's nothing to measure there. The
+// panel is another matter: it can't be read back over this interface, so
+// nothing here can tell whether it kept up. LCD_MAX_BYTE_RATE is the rate the
+// DMA was paced at when it sent a byte at a time, which the panel is known
+// to take, and the limit is in bytes so wider words don't raise it.
+static void SetPacing(int wordBits)
+{
+    uint32_t sck = oscillator.PBCLK(2) / (2 * (SPIBaudRegister(LCD_SPI_CLOCK) + 1));
+    uint32_t hz = ScanlineWriter::PacingHz(sck, wordBits, LCD_MAX_BYTE_RATE, LCD_PACING_MARGIN);
+    if (hz == pacingHz)
+        return;
+    pacingHz = hz;
+    pacingTimer->Initialize(hz);
+    pacingTimer->Enable();
+}
+
+#endif
+
 extern "C"
 GFX_Disp_Intf GFX_Disp_Intf_Open(GFX_Context * gfx)
 {   
@@ -135,15 +205,18 @@ GFX_Disp_Intf GFX_Disp_Intf_Open(GFX_Context * gfx)
     
 #ifdef SPILCD
     
-    uint32_t rdata;
-    
     spi = new SPI<2>;
-    spi->Initialize(true, 0, false);
+    spi->Initialize(true, SPIBaudRegister(LCD_SPI_CLOCK), false);
+    spiWidth = 8;
     spi->SetMode(0, 0);
     spi->UseSPISelect(true);
     spi->SetTransmitInterruptTrigger(spi->TransmitInterruptTrigger::BufferNotFull);
     spi->Enable();
     
+    pacingTimer = new TimerB<5>;
+    pacingHz = 0;
+    SetPacing(LCD_PIXEL_WORD_BITS);
+    
 #else // PMPLCD
 
     // Don't need to do any more; Harmony already called PMP_Initialize()
@@ -153,68 +226,95 @@ GFX_Disp_Intf GFX_Disp_Intf_Open(GFX_Context * gfx)
     return (GFX_Disp_Intf) intf;
 }
 
+static void WaitForDMA()
+{
+    DisplayStatsTimer timer(DisplayProbeSPIWait);
+    while (scanlineWriter.Busy())
+    {
+    }
+}
+
 extern "C"
 void GFX_Disp_Intf_Close(GFX_Disp_Intf intf)
 {
+    WaitForDMA();
     ((GFX_DISP_INTF_SPI *) intf)->gfx->memory.free(((GFX_DISP_INTF_SPI *) intf));
+    delete pacingTimer;
+    pacingTimer = NULL;
     delete spi;
     spi = NULL;
 }
 
-static void StartDMACommand();
+#ifdef DISPLAY_STATS
+static uint32_t dmaStartTime;
+#endif
 
 static void DMAComplete(void *)
 {
-    // Discard the just-completed command
-    dmaCommands.read(nullptr);
-    // Start the next command
-    StartDMACommand();
+#ifdef DISPLAY_STATS
+    DisplayStatsAdd(DisplayProbeSPIDMA, DisplayStatsNow() - dmaStartTime);
+#endif
+    // Release the line just sent and start the next, if there is one
+    scanlineWriter.Complete();
 }
 
-void StartDMACommand()
+static void StartLine(const uint8_t *line, size_t bytes, void *)
 {
-    static TimerB<5> tmr;
-    static bool firstTime = true;
-    if (firstTime)
-    {
-        firstTime = false;
-        tmr.Initialize(4000000);
-        tmr.Enable();
-    }
     static DMA *dma0 = nullptr;
     delete dma0;
-    dma0 = nullptr;
+
+    // Move one SPI word per pacing timer tick
+    ::DMADestination dest = spi->DMADestination();
+    dma0 = new DMA(0, 0, DMASource {(void *) line, dest.blockSize, bytes}, dest, pacingTimer->TimerIRQ());
+    dma0->SetInterruptPriorities(1, 0);
+    dma0->RegisterCallback(DMAComplete, nullptr);
+    // DMA works, but it goes too fast for the LCD (ILI9341 based). It wants more
+    // time between words. So we trigger the DMA off a timer instead of the
+    // SPI buffer state. SetPacing() picks the timer rate.
+    dma0->SetDMAInterruptTrigger(DMA::SourceDone);
+    dma0->EnableInterrupt();
+#ifdef DISPLAY_STATS
+    dmaStartTime = DisplayStatsNow();
+#endif
+    dma0->Enable();
+}
+
+// Send pixel data (the parameters of a MEMORY_WRITE) through the scanline
+// buffers. Returns as soon as the last line has been queued; IsLCDUpdateBusy()
+// stays true until it's been sent.
+static void WritePixelData(const uint8_t *data, size_t bytes)
+{
+    // The DMA is idle here, since every command waits for it
+    int wordBits = ScanlineWriter::WordBits(bytes, LCD_PIXEL_WORD_BITS);
+    SetSPIWidth(wordBits);
+    SetPacing(wordBits);
     
-    if (!dmaCommands.empty())
+    while (bytes)
     {
-        lcdUpdateBusy = true;
-        DMACommand cmd;
-        dmaCommands.peek(&cmd);
-
-        dma0 = new DMA(0, 0, DMASource {cmd.address, 1, cmd.size}, spi->DMADestination(), tmr.TimerIRQ());
-        dma0->SetInterruptPriorities(1, 0);
-        dma0->RegisterCallback(DMAComplete, nullptr);
-        // DMA works, but it goes too fast for the LCD (ILI9341 based). It wants more
-        // time between bytes. So we trigger the DMA off a timer instead of the
-        // SPI buffer state
-        dma0->SetDMAInterruptTrigger(DMA::SourceDone);
-        dma0->EnableInterrupt();
-        dma0->Enable();
+        size_t lineBytes = bytes > SCANLINE_BYTES ? SCANLINE_BYTES : bytes;
+        
+        // Wait for the DMA to finish draining the line we fill next
+        {
+            DisplayStatsTimer timer(DisplayProbeSPIWait);
+            while (!scanlineWriter.LineFree()) {}
+        }
+        
+        scanlineWriter.WriteLine(data, lineBytes, wordBits);
+        data += lineBytes;
+        bytes -= lineBytes;
     }
-    
-    else
-        lcdUpdateBusy = false;
 }
 
 extern "C"
 GFX_Result GFX_Disp_Intf_WriteCommandParm(GFX_Disp_Intf intf, uint8_t cmd, uint8_t * parm, int num_parms)
 {  
+    DisplayStatsTimer timer(DisplayProbeSPIWrite);
+    
     // Wait for all pending DMAs to complete
-    while (!dmaCommands.empty())
-    {
-    }
+    WaitForDMA();
 
     while (!spi->TXEmpty()) {}
+    SetSPIWidth(8);
     
     GFX_DISP_INTF_PIN_RSDC_Clear();
 
@@ -236,36 +336,19 @@ GFX_Result GFX_Disp_Intf_WriteCommandParm(GFX_Disp_Intf intf, uint8_t cmd, uint8
         
         GFX_DISP_INTF_PIN_RSDC_Set();
 
-        // If we're not writing an image, just output the (small number of) parameters
-        // ****** For some reason, the image data gets corrupted when we're DMAing it at the
-        // same time the Logic Analyzer is capturing samples via DMA. So we've stopped using
-        // DMA image updates until we can figure this out
-        if (true) //cmd != ILI9488_CMD_MEMORY_WRITE)
+        // If we're outputting an image, use DMA to send the image data
+        if (cmd == ILI9488_CMD_MEMORY_WRITE)
         {
-            while (num_parms--)
-            {
-                while (!spi->TXEmpty()) {}
-                spi->TXData(*parm++);
-            }
+            WritePixelData(parm, num_parms);
         }
         
-        // Else (outputting and image) use DMA to send the image data
+        // Else just output the (small number of) parameters
         else
         {
-            // Set up a list of DMA transfers to make
-            while (num_parms)
-            {
-                size_t transferSize = num_parms > 65536 ? 65536 : num_parms;
-                dmaCommands.write((DMACommand) {parm, transferSize});
-                num_parms -= transferSize;
-                parm += transferSize;
-            }
-            
-            // Start the first transfer. When it's done, we'll get an interrupt.
-            // The DMAComplete() function will handle it.
-            if (!dmaCommands.empty())
+            while (num_parms--)
             {
-                StartDMACommand();
+                while (!spi->TXEmpty()) {}
+                spi->TXData(*parm++);
             }
         }
         
@@ -291,9 +374,14 @@ GFX_Result GFX_Disp_Intf_WriteCommandParm(GFX_Disp_Intf intf, uint8_t cmd, uint8
 extern "C"
 GFX_Result GFX_Disp_Intf_Write(GFX_Disp_Intf intf, uint8_t * data, int bytes)
 {
+    DisplayStatsTimer timer(DisplayProbeSPIWrite);
     GFX_DISP_INTF_SPI * spiIntf = (GFX_DISP_INTF_SPI *) intf;
 
-#ifdef PMPLCD
+#ifdef SPILCD
+    // Don't write into the middle of a DMA transfer
+    WaitForDMA();
+    SetSPIWidth(8);
+#else // PMPLCD
     LCDnCS_Clear();
 #endif
     
@@ -354,13 +442,12 @@ GFX_Result GFX_Disp_Intf_Read(GFX_Disp_Intf intf, uint8_t * data, int bytes)
     * GFX_FAILURE       - Operation failed
 
   Remarks:
-    In SPI mode, this function performs multiple full-blocking write calls to
-    the SPI port and won't return until the SPI transaction completes.
+    In SPI mode, the pixel data is copied into scanline buffers and sent by
+    DMA. This function returns once the last line has been queued; use
+    IsLCDUpdateBusy() to find out when the transfer is complete. The caller
+    may reuse the data buffer as soon as this returns.
 
  */
-#define IMAGE_WIDTH 320
-#define IMAGE_HEIGHT 240
-
 GFX_Result ILI9488_Intf_WritePixels(struct ILI9488_DRV *drv,
                                    uint32_t start_x,
                                    uint32_t start_y,
@@ -8,6 +8,8 @@
 #ifndef FIXED_H
 #define	FIXED_H
 
+#include <stdint.h>
+
 /******************************************************************************
 CLASS exp10 -- template helper for computing powers of 10
 ARGUMENTS
@@ -19,6 +21,76 @@ IMPLEMENTATION
 template <typename T, int N> struct exp10 { static const T value = T(10) * exp10<T, N-1>::value; };
 template <typename T> struct exp10<T, 0> { static const T value = 1; };
 
+/******************************************************************************
+FUNCTION fixed_multiply -- 64 x 64 bit unsigned multiply to a 128-bit product
+DESCRIPTION
+	XC32 has no 128-bit type, so this is done in 32-bit halves. The product
+	is returned as its high and low 64 bits.
+******************************************************************************/
+static inline void fixed_multiply(uint64_t a, uint64_t b, uint64_t &hi, uint64_t &lo)
+{
+    uint64_t aLo = uint32_t(a), aHi = a >> 32;
+    uint64_t bLo = uint32_t(b), bHi = b >> 32;
+    
+    uint64_t ll = aLo * bLo;
+    uint64_t lh = aLo * bHi;
+    uint64_t hl = aHi * bLo;
+    uint64_t hh = aHi * bHi;
+    
+    uint64_t middle = (ll >> 32) + uint32_t(lh) + uint32_t(hl);
+    lo = (middle << 32) | uint32_t(ll);
+    hi = hh + (lh >> 32) + (hl >> 32) + (middle >> 32);
+}
+
+/******************************************************************************
+FUNCTION fixed_divide -- 128 by 64 bit unsigned divide
+DESCRIPTION
+	Divides hi:lo by d, truncating. This is the long division in Hacker's
+	Delight (divlu), which works in 32-bit digits and needs just two 64-bit
+	divisions.
+RETURNS
+	The quotient, or all ones if it doesn't fit in 64 bits
+******************************************************************************/
+static inline uint64_t fixed_divide(uint64_t hi, uint64_t lo, uint64_t d)
+{
+    const uint64_t b = 1ULL << 32;
+    if (hi >= d)
+        return ~0ULL;
+    
+    // Normalize so the divisor's top bit is set
+    int s = __builtin_clzll(d);
+    d <<= s;
+    uint64_t dHi = d >> 32, dLo = uint32_t(d);
+    uint64_t n32 = (hi << s) | (s ? lo >> (64 - s) : 0);
+    uint64_t n10 = lo << s;
+    uint64_t n1 = n10 >> 32, n0 = uint32_t(n10);
+    
+    // First 32-bit digit of the quotient. The estimate is at most 2 too big.
+    uint64_t q1 = n32 / dHi;
+    uint64_t rhat = n32 - q1 * dHi;
+    while (q1 >= b || q1 * dLo > (rhat << 32) + n1)
+    {
+        --q1;
+        rhat += dHi;
+        if (rhat >= b)
+            break;
+    }
+    
+    // Second digit, from what's left
+    uint64_t n21 = (n32 << 32) + n1 - q1 * d;
+    uint64_t q0 = n21 / dHi;
+    rhat = n21 - q0 * dHi;
+    while (q0 >= b || q0 * dLo > (rhat << 32) + n0)
+    {
+        --q0;
+        rhat += dHi;
+        if (rhat >= b)
+            break;
+    }
+    
+    return (q1 << 32) + q0;
+}
+
 template <typename T, int N>
 class _fixed 
 {
@@ -43,65 +115,23 @@ public:
 	_fixed &operator-=(const _fixed &rhs)	{ _val -= rhs._val; return *this; }
 	_fixed &operator*=(const _fixed &rhs) 
     {
-        if (_val == 0) return *this;
-        
-        // Make all the numbers positive
-        T lVal, rVal;
-        bool negResult = false;
-        if (rhs._val < 0)
-        {
-            rVal = -rhs._val;
-            negResult = !negResult;
-        }
-        else if (rhs._val > 0)
-            rVal = rhs._val;
-        else
+        if (_val == 0 || rhs._val == 0)
         {
             _val = 0;
             return *this;
         }
-        if (_val < 0)
-        {
-            lVal = -_val;
-            negResult = !negResult;
-        }
-        else
-            lVal = _val;
-
-        // The factors are both multiplied by scale. After the multiplication,
-        // we'll need to rescale the product by a power of 10
-        int rescaleN = -N;
         
-        // To avoid an overflow, shift the rhs right as much as we can before we multiply
-        T rem = rVal % 10;
-        while (rem == 0 && rVal)
-        {
-            rVal /= 10;
-            rem = rVal % 10;
-            ++rescaleN;
-        }
-        
-        // And shift the lhs right
-        rem = lVal % 10;
-        while (rem == 0)
-        {
-            lVal /= 10;
-            rem = lVal % 10;
-            ++rescaleN;
-        }
+        // Make all the numbers positive
+        bool negResult = (_val < 0) != (rhs._val < 0);
+        uint64_t lVal = _val < 0 ? -uint64_t(_val) : uint64_t(_val);
+        uint64_t rVal = rhs._val < 0 ? -uint64_t(rhs._val) : uint64_t(rhs._val);
 
-        _val = (T) (lVal * rVal);
-        
-        while (rescaleN > 0)
-        {
-            _val *= 10;
-            --rescaleN;
-        }
-        while (rescaleN < 0)
-        {
-            _val /= 10;
-            ++rescaleN;
-        }
+        // The factors are both multiplied by scale, so the product is scaled
+        // by scale squared. Take the whole product and divide by scale once,
+        // truncating.
+        uint64_t hi, lo;
+        fixed_multiply(lVal, rVal, hi, lo);
+        _val = (T) (hi == 0 ? lo / uint64_t(scale) : fixed_divide(hi, lo, uint64_t(scale)));
 
         if (negResult)
             _val = -_val;
@@ -113,57 +143,15 @@ public:
         if (_val == 0) return *this;
         
         // Make all the numbers positive
-        T lVal, rVal;
-        bool negResult = false;
-        if (rhs._val < 0)
-        {
-            rVal = -rhs._val;
-            negResult = !negResult;
-        }
-        else
-            rVal = rhs._val;
-        if (_val < 0)
-        {
-            lVal = -_val;
-            negResult = !negResult;
-        }
-        else
-            lVal = _val;
-
-        // The divisor and dividend are both multiplied by scale. After the division,
-        // we'll need to rescale the quotient by a power of 10
-        int rescaleN = N;
-        
-        // To avoid an underflow, shift the divisor right as much as we can before we divide
-        T rem = rVal % 10;
-        while (rem == 0)
-        {
-            rVal /= 10;
-            rem = rVal % 10;
-            --rescaleN;
-        }
-        
-        // And shift the dividend left
-        T bigger = lVal * 10;
-        while (bigger / 10 == lVal)
-        {
-            lVal = bigger;
-            bigger = lVal * 10;
-            --rescaleN;
-        }
-
-        _val = (T) (lVal / rVal);
-        
-        while (rescaleN > 0)
-        {
-            _val *= 10;
-            --rescaleN;
-        }
-        while (rescaleN < 0)
-        {
-            _val /= 10;
-            ++rescaleN;
-        }
+        bool negResult = (_val < 0) != (rhs._val < 0);
+        uint64_t lVal = _val < 0 ? -uint64_t(_val) : uint64_t(_val);
+        uint64_t rVal = rhs._val < 0 ? -uint64_t(rhs._val) : uint64_t(rhs._val);
+
+        // The divisor and dividend are both multiplied by scale, so scale the
+        // dividend up once more and divide, truncating
+        uint64_t hi, lo;
+        fixed_multiply(lVal, uint64_t(scale), hi, lo);
+        _val = (T) (hi == 0 ? lo / rVal : fixed_divide(hi, lo, rVal));
 
         if (negResult)
             _val = -_val;
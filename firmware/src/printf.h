@@ -41,6 +41,15 @@ extern "C" {
 #endif
 
 
+// Has the compiler check each call's arguments against its format string
+// (-Wformat). It's __printf__ because printf is a macro here.
+#ifdef __GNUC__
+#define PRINTF_FORMAT(f, a) __attribute__((__format__(__printf__, f, a)))
+#else
+#define PRINTF_FORMAT(f, a)
+#endif
+
+
 /**
  * Output a character to a custom device like UART, used by the printf() function
  * This function is declared here only. You have to write your custom implementation somewhere
@@ -58,7 +67,7 @@ void _putchar(char character);
  * \return The number of characters that are written into the array, not counting the terminating null character
  */
 #define printf printf_
-int printf_(const char* format, ...);
+int printf_(const char* format, ...) PRINTF_FORMAT(1, 2);
 
 
 /**
@@ -69,7 +78,7 @@ int printf_(const char* format, ...);
  * \return The number of characters that are WRITTEN into the buffer, not counting the terminating null character
  */
 #define sprintf sprintf_
-int sprintf_(char* buffer, const char* format, ...);
+int sprintf_(char* buffer, const char* format, ...) PRINTF_FORMAT(2, 3);
 
 
 /**
@@ -84,8 +93,8 @@ int sprintf_(char* buffer, const char* format, ...);
  */
 #define snprintf  snprintf_
 #define vsnprintf vsnprintf_
-int  snprintf_(char* buffer, size_t count, const char* format, ...);
-int vsnprintf_(char* buffer, size_t count, const char* format, va_list va);
+int  snprintf_(char* buffer, size_t count, const char* format, ...) PRINTF_FORMAT(3, 4);
+int vsnprintf_(char* buffer, size_t count, const char* format, va_list va) PRINTF_FORMAT(3, 0);
 
 
 /**
@@ -95,7 +104,7 @@ int vsnprintf_(char* buffer, size_t count, const char* format, va_list va);
  * \return The number of characters that are WRITTEN into the buffer, not counting the terminating null character
  */
 #define vprintf vprintf_
-int vprintf_(const char* format, va_list va);
+int vprintf_(const char* format, va_list va) PRINTF_FORMAT(1, 0);
 
 
 /**
@@ -106,7 +115,7 @@ int vprintf_(const char* format, va_list va);
  * \param format A string that specifies the format of the output
  * \return The number of characters that are sent to the output function, not counting the terminating null character
  */
-int fctprintf(void (*out)(char character, void* arg), void* arg, const char* format, ...);
+int fctprintf(void (*out)(char character, void* arg), void* arg, const char* format, ...) PRINTF_FORMAT(3, 4);
 
 
 #ifdef __cplusplus
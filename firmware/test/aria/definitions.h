@@ -0,0 +1,16 @@
+/*
+ * File:   definitions.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 10:20 AM
+ */
+
+// Stands in for Harmony's definitions.h in the tests that build Aria code
+// (see ARIA in the Makefile). The real one pulls in every peripheral
+// driver; the graphics code only needs Aria's own headers, which it
+// includes itself.
+
+#ifndef DEFINITIONS_H
+#define	DEFINITIONS_H
+
+#endif	/* DEFINITIONS_H */
@@ -0,0 +1,136 @@
+/*
+ * File:   bench_canvas.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 10:50 AM
+ */
+
+// What the square wave pane's painters cost in bytes, drawn on a Canvas and
+// copied to the frame buffer as SurfacePainter does, against drawing the
+// lines straight into the frame buffer a pixel at a time and erasing the
+// last ones first, as LinesPainter did before. The lines are the ones
+// SquareWavePane::Update() builds, at duty cycles from 0 to 100%. The
+// canvas path is timed too, and the surfaces are checked against the size
+// of the shared canvas buffer.
+
+#include <string.h>
+#include <vector>
+#include "Canvas.h"
+#include "check.h"
+
+// SurfacePainter.cpp's CANVAS_MAX_PIXELS, and the size it was before
+#define CANVAS_MAX_PIXELS (300 * 53)
+#define CANVAS_OLD_PIXELS (320 * 64)
+
+struct Point
+{
+    int32_t x, y;
+};
+
+typedef std::vector<Point> Lines;
+
+// The waveform and the two calipers, as SquareWavePane::Update() makes them
+static void SquareWave(double ratio, int32_t width, int32_t height, int32_t caliperHeight,
+    Lines &wave, Lines &cycle, Lines &pulse)
+{
+    int32_t leader = width / 20;
+    int32_t pulseWidth = int32_t((width - leader * 2) * ratio);
+    wave.clear();
+    if (ratio == 0)
+        wave = {{0, height - 1}, {width - 1, height - 1}};
+    else if (ratio == 1)
+        wave = {{0, 1}, {width - 1, 1}};
+    else
+        wave = {{0, height - 1}, {leader, height - 1}, {leader, 1}, {pulseWidth + leader, 1},
+            {pulseWidth + leader, height - 1}, {width - leader, height - 1}, {width - leader, 1}, {width, 1}};
+    cycle = {{leader, 0}, {leader, caliperHeight}, {leader, caliperHeight / 2},
+        {width - leader, caliperHeight / 2}, {width - leader, 0}, {width - leader, caliperHeight}};
+    pulse = {{leader, 0}, {leader, caliperHeight}, {leader, caliperHeight / 2},
+        {leader + pulseWidth, caliperHeight / 2}, {leader + pulseWidth, 0}, {leader + pulseWidth, caliperHeight}};
+}
+
+static uint16_t canvasPixels[CANVAS_MAX_PIXELS];
+static uint16_t frame[240][320];
+static uint64_t canvasBytes, copyBytes, directBytes;
+
+// Pixels a line sets, which is what a pixel at a time drawing writes
+static int32_t LinePixels(const Point &a, const Point &b)
+{
+    int32_t dx = a.x > b.x ? a.x - b.x : b.x - a.x, dy = a.y > b.y ? a.y - b.y : b.y - a.y;
+    return (dx > dy ? dx : dy) + 1;
+}
+
+// SurfacePainter::BeginCanvas(), LinesPainter::OnDraw() and FlushCanvas()
+static void DrawOnCanvas(const Lines &lines, int32_t x, int32_t y, int32_t width, int32_t height)
+{
+    CHECK(width * height <= CANVAS_MAX_PIXELS);
+    Canvas canvas(canvasPixels, width, height);
+    canvas.Clear(0xffff);
+    canvasBytes += width * height * 2;
+    for (size_t i = 1; i < lines.size(); ++i)
+    {
+        canvas.DrawLine(lines[i - 1].x, lines[i - 1].y, lines[i].x, lines[i].y, 0);
+        canvasBytes += LinePixels(lines[i - 1], lines[i]) * 2;
+    }
+    for (int32_t row = 0; row < height; ++row)
+        memcpy(&frame[y + row][x], canvasPixels + row * width, width * 2);
+    copyBytes += width * height * 2;
+}
+
+// The old LinesPainter: erase what was drawn, then draw
+static void DrawDirect(const Lines &previous, const Lines &lines)
+{
+    for (size_t i = 1; i < previous.size(); ++i)
+        directBytes += LinePixels(previous[i - 1], previous[i]) * 2;
+    for (size_t i = 1; i < lines.size(); ++i)
+        directBytes += LinePixels(lines[i - 1], lines[i]) * 2;
+}
+
+int main()
+{
+    // SquareWave, CycleCaliper and PulseCaliper in the Aria layout
+    const int32_t width = 300, waveHeight = 53, caliperHeight = 20;
+    CHECK(width * waveHeight == CANVAS_MAX_PIXELS);
+    fprintf(stdout, "Canvas buffer %u bytes, was %u; the waveform needs %u, a caliper %u\n",
+        unsigned(sizeof(canvasPixels)), unsigned(CANVAS_OLD_PIXELS * 2), unsigned(width * waveHeight * 2),
+        unsigned(width * caliperHeight * 2));
+
+    Lines wave, cycle, pulse, lastWave, lastCycle, lastPulse;
+    const int steps = 101;
+    for (int i = 0; i < steps; ++i)
+    {
+        SquareWave(i / 100.0, width, waveHeight, caliperHeight, wave, cycle, pulse);
+        DrawOnCanvas(wave, 10, 69, width, waveHeight);
+        DrawOnCanvas(cycle, 10, 45, width, caliperHeight);
+        DrawOnCanvas(pulse, 10, 126, width, caliperHeight);
+        DrawDirect(lastWave, wave);
+        DrawDirect(lastCycle, cycle);
+        DrawDirect(lastPulse, pulse);
+        lastWave = wave;
+        lastCycle = cycle;
+        lastPulse = pulse;
+    }
+    // The canvas moves far more bytes, but in straight runs; the direct
+    // path makes a HAL call for every pixel
+    fprintf(stdout, "Bytes a redraw of all three: canvas %llu written + %llu copied; "
+        "directly %llu, in %llu HAL pixel calls\n",
+        (unsigned long long) canvasBytes / steps, (unsigned long long) copyBytes / steps,
+        (unsigned long long) directBytes / steps, (unsigned long long) directBytes / 2 / steps);
+
+    const int count = 20000;
+    double t = CheckNow();
+    for (int i = 0; i < count; ++i)
+    {
+        SquareWave((i % 101) / 100.0, width, waveHeight, caliperHeight, wave, cycle, pulse);
+        DrawOnCanvas(wave, 10, 69, width, waveHeight);
+        DrawOnCanvas(cycle, 10, 45, width, caliperHeight);
+        DrawOnCanvas(pulse, 10, 126, width, caliperHeight);
+    }
+    fprintf(stdout, "Canvas redraw of all three on the host: %.1f us\n", (CheckNow() - t) / count * 1e6);
+
+    // The waveform reached the frame buffer: low at the left, high at the right
+    CHECK(frame[69 + waveHeight - 1][10] == 0 && frame[69 + 1][10 + width - 1] == 0);
+    CHECK(frame[69 + 20][10 + 100] == 0xffff);
+
+    return CheckResult("bench_canvas");
+}
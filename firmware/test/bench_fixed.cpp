@@ -0,0 +1,48 @@
+/*
+ * File:   bench_fixed.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:50 AM
+ */
+
+// fixed's multiply and divide on values like the PWM tool's, timed
+// against the same thing done with the host's 128-bit integers. XC32 has
+// no 128-bit type, so on the PIC32 the comparison is with what it would
+// have to do instead, but the ratio shows the cost of working in halves.
+
+#include <stdint.h>
+#include <vector>
+#include <random>
+#include "fixed.h"
+#include "check.h"
+
+static volatile long long sink;
+
+template <class F>
+static double Time(const std::vector<long long> &xs, F f)
+{
+    const int rounds = 2000;
+    double t = CheckNow();
+    for (int r = 0; r < rounds; ++r)
+        for (size_t i = 0; i + 1 < xs.size(); ++i)
+            sink += f(xs[i], xs[i + 1]);
+    return (CheckNow() - t) / (rounds * (xs.size() - 1)) * 1e9;
+}
+
+int main()
+{
+    // Frequencies and periods up to 100 MHz, to the microhertz
+    std::mt19937_64 g(1);
+    std::vector<long long> xs;
+    for (int i = 0; i < 1000; ++i)
+        xs.push_back((long long) (g() % 100000000) * 1000000 + (long long) (g() % 1000) * 1000 + 1);
+
+    double mul = Time(xs, [](long long a, long long b) {return (fixed(a, true) * fixed(b, true)).raw();});
+    double mul128 = Time(xs, [](long long a, long long b) {return (long long) ((__int128) a * b / fixed::scale);});
+    double div = Time(xs, [](long long a, long long b) {return (fixed(a, true) / fixed(b, true)).raw();});
+    double div128 = Time(xs, [](long long a, long long b) {return (long long) ((__int128) a * fixed::scale / b);});
+
+    printf("bench_fixed: multiply %.1f ns (__int128 %.1f ns), divide %.1f ns (__int128 %.1f ns)\n",
+        mul, mul128, div, div128);
+    return 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * File:   bench_format.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 10:05 AM
+ */
+
+// The status and spinner texts the tools format, done with the firmware's
+// sprintf (printf.c) and with Format, timed side by side.
+
+#include <string.h>
+#include <math.h>
+#include "check.h"
+#include "printf.h"
+#include "Format.h"
+
+extern "C" void _putchar(char character)
+{
+}
+
+static char buf[64];
+static volatile uint32_t sink;
+
+template <class F>
+static double Time(F f)
+{
+    const int count = 2000000;
+    double t = CheckNow();
+    for (int i = 0; i < count; ++i)
+    {
+        f(uint32_t(i) * 7919u);
+        sink += buf[1];
+    }
+    return (CheckNow() - t) / count * 1e9;
+}
+
+template <class S, class F>
+static void Compare(const char *name, S s, F f)
+{
+    double printf = Time(s), format = Time(f);
+    fprintf(stdout, "%-26s printf.c %6.1f ns, Format %5.1f ns, %4.1fx\n", name, printf, format, printf / format);
+}
+
+int main()
+{
+    Compare("\"%d\" baud",
+        [](uint32_t v) {sprintf_(buf, "%d", int(v % 1000000));},
+        [](uint32_t v) {FormatUnsigned(buf, v % 1000000);});
+    Compare("\"%d %dHz %d/%d\" GPS",
+        [](uint32_t v) {sprintf_(buf, "%d %dHz %d/%d", int(v % 1000000), 10, 3, 5);},
+        [](uint32_t v)
+        {
+            char *p = FormatUnsigned(buf, v % 1000000);
+            p = FormatText(FormatUnsigned(FormatText(p, " "), 10), "Hz");
+            p = FormatUnsigned(FormatText(p, " "), 3);
+            FormatUnsigned(FormatText(p, "/"), 5);
+        });
+    Compare("\"%03u,%03u,%03u.%02u Hz\"",
+        [](uint32_t v) {sprintf_(buf, "%03u,%03u,%03u.%02u Hz", v % 100, v % 1000, (v >> 3) % 1000, v % 100);},
+        [](uint32_t v)
+        {
+            char *p = FormatUnsigned(buf, v % 100, 3);
+            p = FormatUnsigned(FormatText(p, ","), v % 1000, 3);
+            p = FormatUnsigned(FormatText(p, ","), (v >> 3) % 1000, 3);
+            p = FormatUnsigned(FormatText(p, "."), v % 100, 2);
+            FormatText(p, " Hz");
+        });
+    Compare("\"%3d.%02d%%\" duty",
+        [](uint32_t v) {sprintf_(buf, "%3d.%02d%%", int(v % 101), int(v % 100));},
+        [](uint32_t v)
+        {
+            char *p = FormatInt(buf, v % 101, 3);
+            p = FormatInt(FormatText(p, "."), v % 100, 2, '0');
+            FormatText(p, "%");
+        });
+    Compare("\"CPOL %d; CPHA %d; ~SS=%c\"",
+        [](uint32_t v) {sprintf_(buf, "CPOL %d; CPHA %d; ~SS=%c", int(v & 1), int((v >> 1) & 1), v & 4 ? 'B' : '0');},
+        [](uint32_t v)
+        {
+            char *p = FormatUnsigned(FormatText(buf, "CPOL "), v & 1);
+            p = FormatUnsigned(FormatText(p, "; CPHA "), (v >> 1) & 1);
+            FormatText(p, v & 4 ? "; ~SS=B" : "; ~SS=0");
+        });
+    Compare("\"%.1f\" fixed",
+        [](uint32_t v) {sprintf_(buf, "%.1f", double(fixed((long long) v * 1000, true)));},
+        [](uint32_t v) {FormatFixed(buf, fixed((long long) v * 1000, true), 1);});
+    // eng()'s way, as SquareWavePane's actual frequency was shown
+    Compare("eng(hertz, 7, \"Hz\")",
+        [](uint32_t v)
+        {
+            static const char *const prefixes[] = {"", "k", "M"};
+            double value = double(fixed((long long) v * 1000, true));
+            int exponent = value >= 1 ? int(log10(value)) / 3 * 3 : 0;
+            value *= pow(10, -exponent);
+            sprintf_(buf, "%.*f %sHz", 6 - (value >= 100) - (value >= 10), value, prefixes[exponent / 3]);
+        },
+        [](uint32_t v) {FormatEngineering(buf, fixed((long long) v * 1000, true), 7, "Hz");});
+    return 0;
+}
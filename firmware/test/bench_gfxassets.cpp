@@ -0,0 +1,136 @@
+/*
+ * File:   bench_gfxassets.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 10:20 AM
+ */
+
+// Draws the images in gfx_assets.c through FastImageDraw.c's run at a time
+// decoder and through Aria's getRLEDataAtIndex() a pixel at a time, as
+// FastImageDraw.c did before, and times both. The rows the LCD would get
+// must match: the whole image, clipped windows, and a window that runs
+// off the bottom, where both give 0.
+
+#include <string.h>
+#include <vector>
+#include "check.h"
+
+extern "C"
+{
+#include "gfx/hal/inc/gfx_context.h"
+#include "gfx/utils/inc/gfxu_image.h"
+#include "gfx/utils/inc/gfxu_image_utils.h"
+#include "gfx/driver/controller/ili9488/drv_gfx_ili9488_common.h"
+#include "gfx/gfx_assets.h"
+
+GFX_Result __wrap_GFXU_DrawImageRLEInternal(GFXU_ImageAsset* img, int32_t src_x, int32_t src_y,
+    int32_t src_width, int32_t src_height, int32_t dest_x, int32_t dest_y);
+}
+
+// What the LCD got, row by row, as RGB565 bytes high first
+static std::vector<uint8_t> screen;
+static int32_t screenWidth;
+
+// Just what FastImageDraw.c calls
+extern "C"
+{
+static GFX_Context context;
+
+GFX_Context* GFX_ActiveContext(void)
+{
+    return &context;
+}
+
+GFX_Result GFX_Get(GFX_Flag flag, ...)
+{
+    return GFX_SUCCESS;
+}
+
+GFX_Result GFX_Set(GFX_Flag flag, ...)
+{
+    return GFX_SUCCESS;
+}
+
+GFX_Color GFX_ColorConvert(GFX_ColorMode mode_in, GFX_ColorMode mode_out, GFX_Color color)
+{
+    return color;
+}
+
+GFX_Result ILI9488_Intf_WritePixels(struct ILI9488_DRV *drv, uint32_t start_x, uint32_t start_y,
+    uint8_t *data, unsigned int num_pixels)
+{
+    memcpy(&screen[(start_y * screenWidth + start_x) * 2], data, num_pixels * 2);
+    return GFX_SUCCESS;
+}
+
+GFX_Result __real_GFXU_DrawImageRLEInternal(GFXU_ImageAsset* img, int32_t src_x, int32_t src_y,
+    int32_t src_width, int32_t src_height, int32_t dest_x, int32_t dest_y)
+{
+    return GFX_FAILURE;
+}
+}
+
+// FastImageDraw.c's loop before the cursor
+static void DrawByPixel(GFXU_ImageAsset *img, int32_t src_x, int32_t src_y, int32_t src_width, int32_t src_height)
+{
+    uint8_t pixelLine[src_width * 2], *pp;
+    uint32_t lastBlock = 0, lastOffset = 0;
+    for (int32_t row = 0; row < src_height; row++)
+    {
+        pp = pixelLine;
+        for (int32_t col = 0; col < src_width; col++)
+        {
+            uint32_t idx = src_x + col + ((src_y + row) * img->width);
+            uint16_t color = (uint16_t) getRLEDataAtIndex((uint8_t *) img->header.dataAddress,
+                img->width * img->height, idx, &lastBlock, &lastOffset);
+            *pp++ = (uint8_t) (color >> 8);
+            *pp++ = (uint8_t) color;
+        }
+        ILI9488_Intf_WritePixels(NULL, 0, row, pixelLine, src_width);
+    }
+}
+
+static void Compare(GFXU_ImageAsset *img, int32_t x, int32_t y, int32_t width, int32_t height)
+{
+    screenWidth = width;
+    screen.assign(width * height * 2, 0xaa);
+    __wrap_GFXU_DrawImageRLEInternal(img, x, y, width, height, 0, 0);
+    std::vector<uint8_t> fast = screen;
+    screen.assign(width * height * 2, 0x55);
+    DrawByPixel(img, x, y, width, height);
+    CHECK(fast == screen);
+}
+
+template <class F>
+static double Time(GFXU_ImageAsset *img, F f)
+{
+    const int count = 200;
+    double t = CheckNow();
+    for (int i = 0; i < count; ++i)
+        f();
+    return (CheckNow() - t) / count;
+}
+
+int main()
+{
+    GFXU_ImageAsset *images[] = {&RobinsonMap};
+    for (GFXU_ImageAsset *img : images)
+    {
+        int32_t w = img->width, h = img->height;
+        Compare(img, 0, 0, w, h);
+        Compare(img, 37, 20, 100, 50);
+        Compare(img, w - 1, 0, 1, h);
+        Compare(img, 0, h - 10, w, 30);
+        // The padding past the end is 0 in both
+        CHECK(screen[(29 * w + w - 1) * 2] == 0 && screen[(29 * w + w - 1) * 2 + 1] == 0);
+
+        screenWidth = w;
+        screen.assign(w * h * 2, 0);
+        double fast = Time(img, [&]() {__wrap_GFXU_DrawImageRLEInternal(img, 0, 0, w, h, 0, 0);});
+        double byPixel = Time(img, [&]() {DrawByPixel(img, 0, 0, w, h);});
+        fprintf(stdout, "%dx%d, %u bytes of RLE: a run at a time %.1f us (%.1f ns/pixel), "
+            "a pixel at a time %.1f us, %.1fx\n", w, h, img->header.dataSize, fast * 1e6, fast * 1e9 / (w * h),
+            byPixel * 1e6, byPixel / fast);
+    }
+    return CheckResult("bench_gfxassets");
+}
@@ -0,0 +1,250 @@
+/*
+ * File:   bench_nmea.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 11:15 AM
+ */
+
+// GGA and RMC the old way, as ToolGPS::NMEASentence() made them (gmtime(),
+// ldiv()s and the firmware's sprintf into a std::string, then the output
+// window's text concatenated from them), against NMEATemplate patched the
+// way ToolGPS::PatchSentences() does and copied into a fixed buffer for the
+// window. Both queue their sentences a character at a time into a CQueue,
+// as the transmit queue is. Counts sentences a second on the host and
+// allocations, with the position standing still and moving every fix. The
+// patched sentences are checked against the fix and their checksums.
+
+#include <string.h>
+#include <stdlib.h>
+#include <string>
+#include <new>
+#include "NMEA.h"
+#include "Utility.h"
+#include "check.h"
+
+#undef printf
+
+extern "C" void _putchar(char character)
+{
+}
+
+static size_t allocations;
+
+void *operator new(size_t size)
+{
+    ++allocations;
+    void *p = malloc(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+static CQueue<char, 1024> transmitQueue;
+static volatile size_t sink;
+
+static void Drain()
+{
+    char c;
+    while (transmitQueue.read(&c))
+        sink += c;
+}
+
+// The old NMEASentence(), GGA and RMC
+static std::string OldSentence(bool gga, time_t time, int32_t lat, int32_t lng)
+{
+    char buf[100], *output = buf;
+    struct tm *t = gmtime(&time);
+    ldiv_t latDiv = ldiv(labs(lat), 10000);
+    ldiv_t latMinutesDiv = ldiv(latDiv.rem * 60, 10000);
+    ldiv_t lngDiv = ldiv(labs(lng), 10000);
+    ldiv_t lngMinutesDiv = ldiv(lngDiv.rem * 60, 10000);
+    if (gga)
+        sprintf(output, "$GPGGA,%02d%02d%02d,%02d%02d.%04d,%c,%03d%02d.%04d,%c,%d,5,0.9,%d.%01d,M,%d.%01d,M,,,",
+            t->tm_hour, t->tm_min, t->tm_sec,
+            (int) latDiv.quot, (int) latMinutesDiv.quot, (int) latMinutesDiv.rem, lat >= 0 ? 'N' : 'S',
+            (int) lngDiv.quot, (int) lngMinutesDiv.quot, (int) lngMinutesDiv.rem, lng < 0 ? 'W' : 'E',
+            8, 280, 2, -34, 1);
+    else
+        sprintf(output, "$GPRMC,%02d%02d%02d,A,%02d%02d.%04d,%c,%03d%02d.%04d,%c,%d.%03d,%d.%d,%02d%02d%02d,,",
+            t->tm_hour, t->tm_min, t->tm_sec,
+            (int) latDiv.quot, (int) latMinutesDiv.quot, (int) latMinutesDiv.rem, lat >= 0 ? 'N' : 'S',
+            (int) lngDiv.quot, (int) lngMinutesDiv.quot, (int) lngMinutesDiv.rem, lng >= 0 ? 'W' : 'E',
+            0, 0, 0, 0, t->tm_mday, t->tm_mon + 1, t->tm_year % 100);
+    int c = 0;
+    char *s = output + 1;
+    while (*s)
+        c ^= *s++;
+    sprintf(s, "*%02X\r\n", c);
+    return buf;
+}
+
+static std::string oldSentences[2];
+static size_t outputLength;
+
+// The old OnIdle(), once for each sentence
+static void OldFix(time_t time, int32_t lat, int32_t lng)
+{
+    for (int i = 0; i < 2; ++i)
+    {
+        std::string sentence = OldSentence(i == 0, time, lat, lng);
+        for (auto ch : sentence)
+            transmitQueue.write(ch);
+        oldSentences[i] = sentence;
+        std::string outputText = "\r\n";
+        for (auto &s : oldSentences)
+            outputText += s + "\r\n";
+        outputLength += outputText.size();
+        Drain();
+    }
+}
+
+static NMEATemplate gga("$GPGGA,000000.00,0000.0000,N,00000.0000,E,8,4,0.9,280.2,M,-34.1,M,,");
+static NMEATemplate rmc("$GPRMC,000000.00,A,0000.0000,N,00000.0000,E,000.00,000.0,010100,,");
+static time_t patchedTime = -1;
+static int32_t patchedLatitude = INT32_MIN, patchedLongitude = INT32_MIN;
+
+// ToolGPS.cpp's
+static void PatchCoordinate(NMEATemplate &sentence, int field, int32_t value, int degreeDigits)
+{
+    uint32_t absValue = labs(value);
+    uint32_t minutes = absValue % 10000 * 60;
+    sentence.PatchDigits(field, 0, absValue / 10000, degreeDigits);
+    sentence.PatchDigits(field, degreeDigits, minutes / 10000, 2);
+    sentence.PatchDigits(field, degreeDigits + 3, minutes % 10000, 4);
+}
+
+// PatchSentences() for GGA and RMC, the date left out as it changes daily
+static void Patch(time_t time, int32_t lat, int32_t lng)
+{
+    if (time != patchedTime)
+    {
+        patchedTime = time;
+        uint32_t seconds = time % 86400;
+        for (auto s : {&gga, &rmc})
+        {
+            s->PatchDigits(1, 0, seconds / 3600, 2);
+            s->PatchDigits(1, 2, seconds / 60 % 60, 2);
+            s->PatchDigits(1, 4, seconds % 60, 2);
+        }
+    }
+    if (lat != patchedLatitude)
+    {
+        patchedLatitude = lat;
+        PatchCoordinate(gga, 2, lat, 2);
+        gga.Patch(3, lat >= 0 ? 'N' : 'S');
+        PatchCoordinate(rmc, 3, lat, 2);
+        rmc.Patch(4, lat >= 0 ? 'N' : 'S');
+    }
+    if (lng != patchedLongitude)
+    {
+        patchedLongitude = lng;
+        PatchCoordinate(gga, 4, lng, 3);
+        gga.Patch(5, lng >= 0 ? 'E' : 'W');
+        PatchCoordinate(rmc, 5, lng, 3);
+        rmc.Patch(6, lng >= 0 ? 'E' : 'W');
+    }
+}
+
+// StartFix(), FillTransmitQueue() and ShowSentences()
+static void NewFix(time_t time, int32_t lat, int32_t lng)
+{
+    Patch(time, lat, lng);
+    char outputText[2 + 2 * (NMEA_MAX_LENGTH + 2)];
+    size_t length = 0;
+    outputText[length++] = '\r';
+    outputText[length++] = '\n';
+    for (auto s : {&gga, &rmc})
+    {
+        const char *p = s->Text();
+        for (size_t n = s->Length(); n; --n)
+            transmitQueue.write(*p++);
+        memcpy(outputText + length, s->Text(), s->Length() - 2);
+        length += s->Length() - 2;
+        outputText[length++] = '\r';
+        outputText[length++] = '\n';
+        Drain();
+    }
+    outputLength += length;
+}
+
+// The checksum, worked out from scratch, and the fields against the fix
+static void CheckSentence(const NMEATemplate &s, time_t time, int32_t lat, int32_t lng, int latField)
+{
+    const char *text = s.Text();
+    size_t length = s.Length();
+    CHECK(length <= NMEA_MAX_LENGTH && text[0] == '$' && strncmp(text + length - 2, "\r\n", 2) == 0);
+    uint8_t c = 0;
+    const char *p = text + 1;
+    for (; *p != '*'; ++p)
+        c ^= *p;
+    char hex[3];
+    snprintf(hex, sizeof(hex), "%02X", c);
+    CHECK(strncmp(p + 1, hex, 2) == 0);
+
+    char expected[40];
+    uint32_t seconds = time % 86400, absLat = labs(lat), absLng = labs(lng);
+    snprintf(expected, sizeof(expected), ",%02u%02u%02u.", seconds / 3600, seconds / 60 % 60, seconds % 60);
+    CHECK(strncmp(text + 6, expected, strlen(expected)) == 0);
+    snprintf(expected, sizeof(expected), "%02u%02u.%04u,%c,%03u%02u.%04u,%c,",
+        absLat / 10000, absLat % 10000 * 60 / 10000, absLat % 10000 * 60 % 10000, lat >= 0 ? 'N' : 'S',
+        absLng / 10000, absLng % 10000 * 60 / 10000, absLng % 10000 * 60 % 10000, lng >= 0 ? 'E' : 'W');
+    const char *field = text;
+    for (int i = 0; i < latField; ++i)
+        field = strchr(field, ',') + 1;
+    CHECK(strncmp(field, expected, strlen(expected)) == 0);
+}
+
+template <class F>
+static void Run(const char *name, F fix, bool moving)
+{
+    const int count = 200000;
+    time_t time = 1600000000;
+    int32_t lat = 473456, lng = -1223456;
+    allocations = 0;
+    double t = CheckNow();
+    for (int i = 0; i < count; ++i)
+    {
+        if (moving)
+        {
+            lat += 3;
+            lng -= 7;
+        }
+        fix(time + i, lat, lng);
+    }
+    t = CheckNow() - t;
+    fprintf(stdout, "%-9s %-8s %7.0f sentences/s, %.2f allocations a sentence\n", name,
+        moving ? "moving" : "standing", count * 2 / t, double(allocations) / (count * 2));
+}
+
+int main()
+{
+    // The templates follow the fix, including across the equator and the
+    // date line
+    static const int32_t positions[][2] = {{473456, -1223456}, {-1, 1}, {0, 0}, {-899999, 1799999},
+        {123, -1800000}, {473456, -1223456}};
+    time_t time = 1600000000;
+    for (auto &pos : positions)
+    {
+        for (int i = 0; i < 100; ++i, time += 37)
+        {
+            Patch(time, pos[0] + i, pos[1] - i);
+            CheckSentence(gga, time, pos[0] + i, pos[1] - i, 2);
+            CheckSentence(rmc, time, pos[0] + i, pos[1] - i, 3);
+        }
+    }
+
+    Run("sprintf", OldFix, false);
+    Run("templates", NewFix, false);
+    Run("sprintf", OldFix, true);
+    Run("templates", NewFix, true);
+    // Nothing is allocated once the templates are built
+    allocations = 0;
+    NewFix(time, 1, 2);
+    CHECK(allocations == 0);
+    return CheckResult("bench_nmea");
+}
@@ -0,0 +1,130 @@
+/*
+ * File:   bench_poolheap.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 10:00 AM
+ */
+
+// Replays an allocation trace like the firmware's through the old first fit
+// heap (firstfit.c), then through the pools with first fit behind them for
+// what they can't take, as Malloc.c does. The trace is small churn
+// (callbacks, list nodes, strings, DMA objects) around a few big long lived
+// buffers (panes, canvases). Prints the time per operation, how many
+// failed, and how broken up first fit's free list is at the end.
+
+#include <random>
+#include <vector>
+#include "PoolHeap.h"
+#include "firstfit.h"
+#include "check.h"
+
+alignas(8) static uint8_t arena[24 * 1024];
+static uint8_t pageClass[sizeof(arena) / POOL_HEAP_PAGE_SIZE];
+
+struct Op
+{
+    bool alloc;
+    uint32_t id;
+    uint32_t size;
+};
+
+static std::vector<Op> MakeTrace(size_t ops, uint32_t seed)
+{
+    std::mt19937 g(seed);
+    std::vector<Op> trace;
+    std::vector<uint32_t> live;
+    uint32_t next = 0;
+    while (trace.size() < ops)
+    {
+        if (live.size() < 50 || (live.size() < 400 && g() % 2))
+        {
+            uint32_t r = g() % 100, size;
+            if (r < 30)
+                size = 12;                      // _Callback
+            else if (r < 60)
+                size = 12 + g() % 24;           // List nodes, strings
+            else if (r < 85)
+                size = 40 + g() % 90;           // DMA objects, NMEA sentences
+            else if (r < 98)
+                size = 130 + g() % 127;
+            else
+                size = 512 + g() % 4096;        // Panes, buffers
+            trace.push_back({true, next, size});
+            live.push_back(next++);
+        }
+        else
+        {
+            size_t i = g() % live.size();
+            trace.push_back({false, live[i], 0});
+            live[i] = live.back();
+            live.pop_back();
+        }
+    }
+    return trace;
+}
+
+int main()
+{
+    std::vector<Op> trace = MakeTrace(2000000, 42);
+    std::vector<void *> blocks(trace.size());
+
+    size_t firstFitFailed = 0;
+    double t = CheckNow();
+    for (const Op &op : trace)
+    {
+        if (op.alloc)
+        {
+            blocks[op.id] = FirstFitMalloc(op.size);
+            firstFitFailed += blocks[op.id] == nullptr;
+        }
+        else
+            FirstFitFree(blocks[op.id]);
+    }
+    double firstFit = (CheckNow() - t) / trace.size() * 1e9;
+    size_t largest, freeBlocks = FirstFitFreeBlocks(&largest);
+
+    // First fit can't be reset, so free what the first run left
+    std::vector<bool> freed(trace.size());
+    for (const Op &op : trace)
+    {
+        if (!op.alloc)
+            freed[op.id] = true;
+    }
+    for (const Op &op : trace)
+    {
+        if (op.alloc && !freed[op.id])
+            FirstFitFree(blocks[op.id]);
+    }
+
+    PoolHeap heap;
+    PoolHeapInit(&heap, arena, sizeof(arena), pageClass);
+    size_t poolsFailed = 0;
+    t = CheckNow();
+    for (const Op &op : trace)
+    {
+        if (op.alloc)
+        {
+            void *p = PoolHeapAlloc(&heap, op.size);
+            if (!p)
+                p = FirstFitMalloc(op.size);
+            poolsFailed += p == nullptr;
+            blocks[op.id] = p;
+        }
+        else if (PoolHeapOwns(&heap, blocks[op.id]))
+            PoolHeapFree(&heap, blocks[op.id]);
+        else
+            FirstFitFree(blocks[op.id]);
+    }
+    double pools = (CheckNow() - t) / trace.size() * 1e9;
+    size_t largestBehind, freeBlocksBehind = FirstFitFreeBlocks(&largestBehind);
+
+    fprintf(stdout, "First fit: %.1f ns an operation, %zu failed, %zu free blocks at the end\n",
+        firstFit, firstFitFailed, freeBlocks);
+    fprintf(stdout, "Pools: %.1f ns an operation, %zu failed, %zu free blocks behind them, %zu of %zu pages\n",
+        pools, poolsFailed, freeBlocksBehind, heap.nextPage, heap.pageCount);
+    for (const PoolClass &c : heap.classes)
+        fprintf(stdout, "  %3u bytes: %u pages, peak %u, %u allocations, %u failures\n",
+            c.blockSize, c.pages, c.peak, c.allocs, c.failures);
+    CHECK(poolsFailed <= firstFitFailed);
+    return CheckResult("bench_poolheap");
+}
@@ -0,0 +1,63 @@
+/*
+ * File:   bench_remoteprotocol.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 10:00 AM
+ */
+
+// How many 16 byte Pings a second the parser gets through, parsed in place
+// from a ring like the console's receive queue and echoed. The ring's size
+// isn't a multiple of the frame's, so most of the time a frame wraps.
+
+#include <vector>
+#include "RemoteProtocol.h"
+#include "check.h"
+
+class Echo : public RemoteHandler
+{
+public:
+    size_t sent = 0;
+
+    RemoteStatus OnCommand(uint8_t command, const RemoteSpan &payload, RemoteResponse &response)
+    {
+        return response.Put(payload) ? RemoteStatus::OK : RemoteStatus::BadLength;
+    }
+    void Send(const uint8_t *frame, size_t length) {sent += length;}
+};
+
+int main()
+{
+    std::vector<uint8_t> frame = {REMOTE_SYNC, uint8_t(RemoteCommand::Ping), 0, 16, 0};
+    frame.insert(frame.end(), 16, 0x55);
+    uint16_t crc = RemoteCRC(0xffff, frame.data() + 1, frame.size() - 1);
+    frame.push_back(uint8_t(crc));
+    frame.push_back(uint8_t(crc >> 8));
+
+    static uint8_t ring[2048];
+    size_t head = 0, tail = 0;
+    Echo echo;
+    RemoteParser parser;
+    const long requests = 2000000;
+    long done = 0;
+    double t = CheckNow();
+    while (done < requests)
+    {
+        while ((head + sizeof(ring) - tail - 1) % sizeof(ring) >= frame.size())
+        {
+            for (uint8_t b : frame)
+            {
+                ring[tail] = b;
+                tail = (tail + 1) % sizeof(ring);
+            }
+        }
+        RemoteSpan input = tail >= head ? RemoteSpan(ring + head, tail - head, ring, 0) :
+            RemoteSpan(ring + head, sizeof(ring) - head, ring, tail);
+        size_t parsed = parser.Parse(input, echo);
+        done += long(parsed / frame.size());
+        head = (head + parsed) % sizeof(ring);
+    }
+    t = CheckNow() - t;
+    CHECK(parser.Frames() == uint32_t(done) && parser.Errors() == 0);
+    fprintf(stdout, "16 byte Pings: %.2f M/s, %.0f ns each\n", done / t / 1e6, t / done * 1e9);
+    return CheckResult("bench_remoteprotocol");
+}
@@ -0,0 +1,92 @@
+/*
+ * File:   bench_ubx.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 11:30 AM
+ */
+
+// UBX NAV-PVT at 115200 baud. How long Encode() takes on the host, and how
+// much of the line the messages use at each fix rate, alone and with the
+// NMEA sentences the plan fits in beside them. Then a minute of 10 Hz
+// fixes is pushed through a simulated 115200 baud UART, queued a fix at a
+// time as ToolGPS does: every message must be out before the next fix is
+// due.
+
+#include <string.h>
+#include "UBX.h"
+#include "NMEA.h"
+#include "check.h"
+
+#define BAUD 115200
+
+static const char *const sentences[] = {
+    "$GPGGA,000000.00,0000.0000,N,00000.0000,E,8,4,0.9,280.2,M,-34.1,M,,",
+    "$GPRMC,000000.00,A,0000.0000,N,00000.0000,E,000.00,000.0,010100,,",
+    "$GPGSA,A,3,04,05,09,12,,,,,,,,,1.8,0.9,1.6",
+    "$GPGSV,1,1,04,04,60,045,40,05,45,120,38,09,30,200,35,12,20,300,30",
+    "$GPVTG,000.0,T,,M,000.00,N,0000.00,K",
+    "$GPZDA,000000.00,01,01,2000,00,00"};
+
+static volatile uint8_t sink;
+
+int main()
+{
+    UBXNavPVT pvt;
+    GPSFix fix = {1600000000, 0, 2020, 9, 13, 473456, -1223456, 280200, -34100, 11120, 900, 4, 90, 180};
+    const int count = 2000000;
+    double t = CheckNow();
+    for (int i = 0; i < count; ++i)
+    {
+        fix.ms = (i % 10) * 100;
+        fix.longitude += 1;
+        pvt.Encode(fix);
+        sink += pvt.Data()[98];
+    }
+    t = CheckNow() - t;
+    fprintf(stdout, "NAV-PVT Encode: %.1f ns on the host\n", t / count * 1e9);
+
+    // A character is 10 bits (8N1)
+    const double charsPerSecond = BAUD / 10.0;
+    fprintf(stdout, "At %u baud a %u byte NAV-PVT takes %.2f ms; the line carries %.0f a second\n",
+        BAUD, unsigned(pvt.Length()), pvt.Length() / charsPerSecond * 1000, charsPerSecond / pvt.Length());
+
+    size_t lengths[7];
+    lengths[0] = pvt.Length();
+    for (int i = 1; i < 7; ++i)
+        lengths[i] = NMEATemplate(sentences[i - 1]).Length();
+    static const uint32_t rates[] = {1, 2, 4, 5, 10};
+    for (uint32_t rate : rates)
+    {
+        uint32_t mask = NMEAPlan(BAUD, rate, lengths, 7);
+        size_t bytes = 0;
+        for (int i = 0; i < 7; ++i)
+            if (mask & (1 << i))
+                bytes += lengths[i];
+        fprintf(stdout, "  %2u Hz: NAV-PVT alone %4.1f%% of the line; with %d NMEA sentences %4.1f%%\n",
+            rate, 100.0 * pvt.Length() * rate / charsPerSecond, __builtin_popcount(mask) - 1,
+            100.0 * bytes * rate / charsPerSecond);
+        CHECK(mask & 1);
+    }
+
+    // A minute of 10 Hz fixes of everything that fits
+    uint32_t mask = NMEAPlan(BAUD, 10, lengths, 7);
+    size_t fixBytes = 0;
+    for (int i = 0; i < 7; ++i)
+        if (mask & (1 << i))
+            fixBytes += lengths[i];
+    double lineFree = 0, worst = 0;
+    for (int i = 0; i < 600; ++i)
+    {
+        double due = i * 0.1;
+        double start = lineFree > due ? lineFree : due;
+        lineFree = start + fixBytes / charsPerSecond;
+        double latency = lineFree - due;
+        if (latency > worst)
+            worst = latency;
+    }
+    fprintf(stdout, "10 Hz, %u bytes a fix: out within %.1f ms of the fix, %.1f ms spare\n",
+        unsigned(fixBytes), worst * 1000, (0.1 - worst) * 1000);
+    CHECK(worst < 0.1);
+
+    return CheckResult("bench_ubx");
+}
@@ -0,0 +1,36 @@
+/*
+ * File:   check.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:50 AM
+ */
+
+#ifndef CHECK_H
+#define	CHECK_H
+
+#include <stdio.h>
+#include <time.h>
+
+// Counts failed checks, printing the first few. A test's main returns
+// CheckResult(), so make stops at the first test that fails.
+static int checkFailures;
+
+#define CHECK(cond) \
+    do { if (!(cond) && checkFailures++ < 10) \
+        fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); } while (0)
+
+static inline int CheckResult(const char *name)
+{
+    fprintf(stdout, "%s: %s (%d failed)\n", name, checkFailures ? "FAILED" : "passed", checkFailures);
+    return checkFailures != 0;
+}
+
+// Seconds, for the benchmarks
+static inline double CheckNow()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+#endif	/* CHECK_H */
@@ -0,0 +1,16 @@
+/*
+ * File:   device.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 10:45 AM
+ */
+
+// Stands in for the PIC32's device.h in the host tests. Only the core timer
+// is here, for headers with inline timers; the tests pass their own times in.
+
+#ifndef DEVICE_H
+#define	DEVICE_H
+
+#define _CP0_GET_COUNT() 0u
+
+#endif	/* DEVICE_H */
@@ -0,0 +1,26 @@
+/*
+ * File:   definitions.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 11:05 AM
+ */
+
+// Stands in for Harmony's definitions.h when DiskImage.c is built for the
+// tests (see the Makefile), so they read the real disk image. Only the
+// memory driver's size and the address conversion are needed; on the host
+// the image is ordinary data, so KVA1 is the same as KVA0.
+
+#ifndef DEFINITIONS_H
+#define	DEFINITIONS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define DRV_MEMORY_DEVICE_START_ADDRESS      0x9d100000
+#define DRV_MEMORY_DEVICE_MEDIA_SIZE         512UL
+
+#define KVA0_TO_KVA1(v) (v)
+
+#endif	/* DEFINITIONS_H */
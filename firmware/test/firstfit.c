@@ -0,0 +1,147 @@
+/*
+ * File:   firstfit.c
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 10:00 AM
+ */
+
+// The first fit heap Malloc.c had before the pools, for bench_poolheap to
+// compare against. Two fixes so it survives a long trace: freeing a block
+// next to a free one before it keeps that block's header, and a block
+// merged away is unlinked even at the head of the list. A sentinel marks
+// the end of the heap so nothing merges past it.
+
+#include <stdint.h>
+#include <stddef.h>
+#include "firstfit.h"
+
+#define HEAP_SIZE 100000
+
+typedef struct FreeHeader_s
+{
+    size_t sz;
+    int inUse;
+    struct FreeHeader_s *prev, *next;
+} FreeHeader;
+
+typedef struct
+{
+    size_t sz;
+} Tail;
+
+typedef struct
+{
+    size_t sz;
+    int inUse;
+} AllocatedHeader;
+
+static size_t heap[HEAP_SIZE / sizeof(size_t) + 4] = {HEAP_SIZE};
+static FreeHeader *freeList = (FreeHeader *) heap;
+static int ready;
+
+void *FirstFitMalloc(size_t sz)
+{
+    if (!ready)
+    {
+        ((AllocatedHeader *) ((uint8_t *) heap + HEAP_SIZE))->inUse = 1;
+        ready = 1;
+    }
+    sz += sizeof(AllocatedHeader) + sizeof(Tail);
+    sz = (sz + 7) & ~(size_t) 7;
+
+    FreeHeader *freeBlock = freeList;
+    while (freeBlock && freeBlock->sz < sz)
+        freeBlock = freeBlock->next;
+    if (!freeBlock)
+        return NULL;
+
+    // Split the end off if there's enough left over
+    size_t remainderSz = freeBlock->sz - sz;
+    if (remainderSz > sizeof(FreeHeader) + sizeof(Tail))
+    {
+        freeBlock->sz = remainderSz;
+        Tail *freeTail = (Tail *) ((uint8_t *) freeBlock + freeBlock->sz - sizeof(Tail));
+        freeTail->sz = freeBlock->sz;
+        AllocatedHeader *allocated = (AllocatedHeader *) (freeTail + 1);
+        allocated->sz = sz;
+        allocated->inUse = 1;
+        Tail *allocatedTail = (Tail *) ((uint8_t *) allocated + sz - sizeof(Tail));
+        allocatedTail->sz = sz;
+        return allocated + 1;
+    }
+
+    freeBlock->inUse = 1;
+    if (freeBlock->prev)
+        freeBlock->prev->next = freeBlock->next;
+    else
+        freeList = freeBlock->next;
+    if (freeBlock->next)
+        freeBlock->next->prev = freeBlock->prev;
+    return (AllocatedHeader *) freeBlock + 1;
+}
+
+static FreeHeader *AddToFreeList(AllocatedHeader *allocated)
+{
+    FreeHeader *freed = (FreeHeader *) allocated;
+    freed->inUse = 0;
+    freed->prev = NULL;
+    freed->next = freeList;
+    if (freeList)
+        freeList->prev = freed;
+    freeList = freed;
+    return freed;
+}
+
+void FirstFitFree(void *p)
+{
+    if (!p)
+        return;
+    AllocatedHeader *allocated = (AllocatedHeader *) ((uint8_t *) p - sizeof(AllocatedHeader));
+    Tail *allocatedTail = (Tail *) ((uint8_t *) allocated + allocated->sz - sizeof(Tail));
+
+    // Merge with the block before, if it's free
+    FreeHeader *freed;
+    if ((size_t *) allocated != heap)
+    {
+        Tail *prevTail = (Tail *) allocated - 1;
+        FreeHeader *prevBlock = (FreeHeader *) ((uint8_t *) allocated - prevTail->sz);
+        if (!prevBlock->inUse)
+        {
+            prevBlock->sz += allocated->sz;
+            allocatedTail->sz = prevBlock->sz;
+            freed = prevBlock;
+        }
+        else
+            freed = AddToFreeList(allocated);
+    }
+    else
+        freed = AddToFreeList(allocated);
+
+    // And the block after
+    FreeHeader *nextBlock = (FreeHeader *) ((uint8_t *) freed + freed->sz);
+    if (!nextBlock->inUse)
+    {
+        Tail *nextTail = (Tail *) ((uint8_t *) nextBlock + nextBlock->sz - sizeof(Tail));
+        freed->sz += nextBlock->sz;
+        nextTail->sz = freed->sz;
+        if (nextBlock->prev)
+            nextBlock->prev->next = nextBlock->next;
+        else
+            freeList = nextBlock->next;
+        if (nextBlock->next)
+            nextBlock->next->prev = nextBlock->prev;
+    }
+}
+
+size_t FirstFitFreeBlocks(size_t *largestFree)
+{
+    size_t n = 0;
+    *largestFree = 0;
+    for (FreeHeader *f = freeList; f; f = f->next)
+    {
+        ++n;
+        if (f->sz > *largestFree)
+            *largestFree = f->sz;
+    }
+    return n;
+}
@@ -0,0 +1,27 @@
+/*
+ * File:   firstfit.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 10:00 AM
+ */
+
+#ifndef FIRSTFIT_H
+#define	FIRSTFIT_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+void *FirstFitMalloc(size_t sz);
+void FirstFitFree(void *p);
+// How many blocks are on the free list, and the size of the largest
+size_t FirstFitFreeBlocks(size_t *largestFree);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* FIRSTFIT_H */
@@ -0,0 +1,30 @@
+/*
+ * File:   host.h
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:50 AM
+ */
+
+// Included ahead of everything in the host tests (see the Makefile). It
+// stands in for what XC32 and the PIC32 provide, so the firmware sources
+// that don't touch the hardware build unchanged.
+
+#ifndef HOST_H
+#define	HOST_H
+
+#include <stdlib.h>
+
+#define __builtin_software_breakpoint() abort()
+// Nothing interrupts on the host. Status bit 0 says they were on.
+#define __builtin_disable_interrupts() 1u
+#define __builtin_enable_interrupts() ((void) 0)
+
+#ifdef __cplusplus
+// glibc's math.h has an exp10(), which clashes with fixed.h's exp10
+// template. Including it first and renaming what comes after keeps them
+// apart.
+#include <cmath>
+#define exp10 fixed_exp10
+#endif
+
+#endif	/* HOST_H */
@@ -0,0 +1,119 @@
+/*
+ * File:   test_callback.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 10:05 AM
+ */
+
+// Menus and their callbacks, with the real Menu.h and Utility.h:
+//
+//  - static menus allocate nothing while the program starts. The items are
+//    constexpr here, so it won't even compile if they can't be built by the
+//    compiler.
+//  - a callback calls the right member on the right object: one on the
+//    tool's own class, one inherited from a base, and one on a tool whose
+//    Tool part isn't at the start, so the cast has to move the pointer
+//  - an item without a callback does nothing
+//
+// Tool here is a stand-in with just what the callbacks need.
+
+#include <stdlib.h>
+#include <new>
+#include "check.h"
+
+static int news;
+static size_t newBytes;
+
+void *operator new(size_t size)
+{
+    ++news;
+    newBytes += size;
+    void *p = malloc(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+#include "Menu.h"
+#undef printf
+
+class Tool
+{
+public:
+    virtual ~Tool() {}
+    int hits = 0;
+};
+
+class Base : public Tool
+{
+public:
+    void Left() {hits += 1;}
+};
+
+class ToolA : public Base
+{
+public:
+    void Up() {hits += 10;}
+    void Down() {hits += 100;}
+};
+
+class Other
+{
+public:
+    virtual ~Other() {}
+    int pad[3] = {};
+};
+
+// Tool comes second, so it isn't at the start of the object
+class ToolB : public Other, public Tool
+{
+public:
+    void Go() {hits += 1000; pad[0] = 1;}
+};
+
+extern const Menu menuB;
+
+static constexpr MenuItem itemsA[5] = {
+    MenuItem("Up", NoChange, nullptr, CB(&ToolA::Up)),
+    MenuItem("Down", NoChange, nullptr, CB(&ToolA::Down)),
+    MenuItem("Left", NoChange, nullptr, CB(&ToolA::Left)),
+    MenuItem("B", ChildMenu, &menuB),
+    MenuItem()
+};
+static constexpr Menu menuA(itemsA);
+
+static constexpr MenuItem itemsB[5] = {
+    MenuItem("Go", ParentMenu, nullptr, CB(&ToolB::Go)),
+    MenuItem(), MenuItem(), MenuItem(), MenuItem()
+};
+const Menu menuB(itemsB);
+
+int main()
+{
+    int staticNews = news;
+    fprintf(stdout, "Allocated while starting: %d, %zu bytes. A MenuItem is %zu bytes.\n",
+        staticNews, newBytes, sizeof(MenuItem));
+    CHECK(staticNews == 0);
+
+    ToolA a;
+    ToolB b;
+    for (const MenuItem &item : menuA.MenuItems())
+        item.Execute(&a);
+    CHECK(a.hits == 111);
+
+    for (const MenuItem &item : menuB.MenuItems())
+        item.Execute(&b);
+    CHECK(b.hits == 1000 && b.pad[0] == 1);
+
+    CHECK(menuA.MenuItems()[3].NextMenu() == &menuB);
+    CHECK(menuA.MenuItems()[3].NextMenuType() == ChildMenu);
+    CHECK(menuB.MenuItems()[0].NextMenuType() == ParentMenu);
+    CHECK(news == staticNews);
+
+    return CheckResult("test_callback");
+}
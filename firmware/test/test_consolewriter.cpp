@@ -0,0 +1,168 @@
+/*
+ * File:   test_consolewriter.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 10:00 AM
+ */
+
+// ConsoleWriter over a loopback transport standing in for USB CDC. A send
+// completes after a modelled USB time (a microframe, then 40 bytes a
+// microsecond), and the completion runs as the "interrupt" when simulated
+// time reaches it. A blocking writer turns out lines for a simulated
+// second, and what comes out the other end must be exactly what went in.
+// The throughput is printed against the old scheme's: a 64 byte buffer
+// started only from the main loop.
+//
+// Then failed sends, short non-blocking writes and the space callback.
+
+#include <string.h>
+#include <stdlib.h>
+#include "ConsoleWriter.h"
+#include "check.h"
+
+static char buffer0[2048], buffer1[2048];
+static char sent[1 << 24], written[1 << 24];
+static size_t sentLength, writtenLength;
+
+static double now, doneAt = -1;
+static const char *inFlight;
+static size_t inFlightLength;
+static bool locked;
+static int failSends;
+
+static double USBTime(size_t length)
+{
+    return 125.0 + length / 40.0;
+}
+
+static bool Send(const char *buffer, size_t length, void *context)
+{
+    CHECK(doneAt < 0 && length > 0 && (buffer == buffer0 || buffer == buffer1));
+    if (failSends)
+    {
+        --failSends;
+        return false;
+    }
+    inFlight = buffer;
+    inFlightLength = length;
+    doneAt = now + USBTime(length);
+    return true;
+}
+
+static uint32_t Lock(void *context)
+{
+    CHECK(!locked);
+    locked = true;
+    return 7;
+}
+
+static void Unlock(uint32_t state, void *context)
+{
+    CHECK(locked && state == 7);
+    locked = false;
+}
+
+static const ConsoleTransport transport = {Send, Lock, Unlock, nullptr};
+static ConsoleWriter writer;
+
+// Run the completion interrupt for any transfer that's finished by then
+static void Advance(double until)
+{
+    while (doneAt >= 0 && doneAt <= until)
+    {
+        now = doneAt;
+        doneAt = -1;
+        memcpy(sent + sentLength, inFlight, inFlightLength);
+        sentLength += inFlightLength;
+        CHECK(!locked);
+        ConsoleWriterComplete(&writer);
+    }
+    now = until;
+}
+
+static int spaceCalls;
+
+static void Space(size_t space, void *context)
+{
+    ++spaceCalls;
+    CHECK(space >= 1000);
+}
+
+int main()
+{
+    ConsoleWriterInit(&writer, &transport, buffer0, buffer1, sizeof(buffer0));
+    ConsoleWriterSetSpaceCallback(&writer, Space, nullptr, 1000);
+    srand(1);
+
+    // printf-sized lines as fast as the CPU makes them, one a microsecond
+    while (now < 1e6)
+    {
+        char line[100];
+        size_t length = snprintf(line, sizeof(line), "line %zu %d\r\n", writtenLength, rand());
+        size_t done = 0;
+        while (done < length)
+        {
+            done += ConsoleWriterWrite(&writer, line + done, length - done);
+            // The ring's full: wait for the interrupt
+            if (done < length)
+                Advance(doneAt);
+        }
+        memcpy(written + writtenLength, line, length);
+        writtenLength += length;
+        Advance(now + 1);
+    }
+    while (!ConsoleWriterIsEmpty(&writer) || doneAt >= 0)
+    {
+        ConsoleWriterPoll(&writer);
+        Advance(doneAt >= 0 ? doneAt : now + 1);
+    }
+    CHECK(sentLength == writtenLength && !memcmp(written, sent, writtenLength));
+    fprintf(stdout, "Double buffered: %.0f KB/s, %u transfers of %.0f bytes on average\n",
+        sentLength / now * 1e6 / 1024, writer.transfers, double(writer.bytesSent) / writer.transfers);
+    ConsoleWriterPoll(&writer);
+    CHECK(spaceCalls == 1);
+
+    // The old way: 64 bytes a transfer, started from the main loop every
+    // 100us
+    double t = 0, busyUntil = 0;
+    size_t oldSent = 0;
+    for (; t < 1e6; t += 100)
+    {
+        if (t >= busyUntil)
+        {
+            oldSent += 64;
+            busyUntil = t + USBTime(64);
+        }
+    }
+    fprintf(stdout, "One 64 byte buffer from the main loop: %.0f KB/s\n", oldSent / t * 1e6 / 1024);
+
+    // A send that fails is tried again from the next poll
+    ConsoleWriterReset(&writer);
+    sentLength = 0;
+    failSends = 3;
+    CHECK(ConsoleWriterWrite(&writer, "abc", 3) == 3 && doneAt < 0);
+    ConsoleWriterPoll(&writer);
+    ConsoleWriterPoll(&writer);
+    CHECK(doneAt < 0);
+    ConsoleWriterPoll(&writer);
+    CHECK(doneAt >= 0);
+
+    // With a transfer out, a write takes what fits in the ring, and then
+    // nothing, until the space callback says there's room
+    static char big[CONSOLE_WRITER_RING_SIZE * 2];
+    memset(big, 'x', sizeof(big));
+    size_t took = ConsoleWriterWrite(&writer, big, sizeof(big));
+    CHECK(took == CONSOLE_WRITER_RING_SIZE - 1);
+    CHECK(ConsoleWriterWrite(&writer, big, 1) == 0 && writer.starved);
+    spaceCalls = 0;
+    ConsoleWriterPoll(&writer);
+    CHECK(spaceCalls == 0);
+    while (doneAt >= 0)
+    {
+        Advance(doneAt);
+        ConsoleWriterPoll(&writer);
+    }
+    CHECK(spaceCalls == 1 && sentLength == 3 + took && ConsoleWriterIsEmpty(&writer));
+
+    return CheckResult("test_consolewriter");
+}
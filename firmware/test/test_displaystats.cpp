@@ -0,0 +1,78 @@
+/*
+ * File:   test_displaystats.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 10:45 AM
+ */
+
+// DisplayStats with made-up times at 100 ticks a microsecond: what a frame
+// adds to each probe, passes that drew nothing, the histogram's buckets,
+// reset, and the dump's lines as they'd reach the console.
+
+#include <string.h>
+#include <string>
+#include "DisplayStats.h"
+#include "check.h"
+
+static std::string console;
+
+extern "C" void _putchar(char character)
+{
+    console += character;
+}
+
+int main()
+{
+    const uint32_t ticksPerUs = 100;
+
+    CHECK(DisplayStatsBucket(0) == 0);
+    CHECK(DisplayStatsBucket(1) == 1);
+    CHECK(DisplayStatsBucket(3) == 2);
+    CHECK(DisplayStatsBucket(4) == 3);
+    CHECK(DisplayStatsBucket(0xffffffff) == DISPLAY_STATS_BUCKETS - 1);
+
+    // A frame that drew: 1 ms in all, two painters of 100 and 300 us
+    DisplayStatsAdd(DisplayProbePainter, 100 * ticksPerUs);
+    DisplayStatsAdd(DisplayProbePainter, 300 * ticksPerUs);
+    DisplayStatsAdd(DisplayProbeFrame, 1000 * ticksPerUs);
+    DisplayStatsEndFrame(ticksPerUs);
+    const DisplayProbeStats *painter = DisplayStatsGet(DisplayProbePainter);
+    const DisplayProbeStats *frame = DisplayStatsGet(DisplayProbeFrame);
+    CHECK(painter->frames == 1 && painter->calls == 2 && painter->totalTicks == 400 * ticksPerUs);
+    CHECK(painter->maxFrameTicks == 400 * ticksPerUs && painter->frameTicks == 0 && painter->frameCalls == 0);
+    CHECK(painter->histogram[DisplayStatsBucket(400)] == 1);
+    CHECK(frame->frames == 1 && frame->histogram[DisplayStatsBucket(1000)] == 1);
+
+    // A pass through the main loop that drew nothing isn't a frame
+    DisplayStatsAdd(DisplayProbeFrame, 5 * ticksPerUs);
+    DisplayStatsEndFrame(ticksPerUs);
+    CHECK(frame->frames == 1 && frame->frameTicks == 0 && frame->frameCalls == 0);
+
+    // A second frame with just a DMA transfer, as the ISR would add it
+    DisplayStatsAdd(DisplayProbeSPIDMA, 50 * ticksPerUs);
+    DisplayStatsAdd(DisplayProbeFrame, 2000 * ticksPerUs);
+    DisplayStatsEndFrame(ticksPerUs);
+    CHECK(frame->frames == 2 && frame->maxFrameTicks == 2000 * ticksPerUs);
+    CHECK(painter->frames == 1);
+    CHECK(DisplayStatsGet(DisplayProbeSPIDMA)->frames == 1);
+
+    // The dump, a probe at a time. No line ends in a space.
+    int probe = 0, probes = 0;
+    while (probe != -1)
+    {
+        probe = DisplayStatsDump(probe, ticksPerUs);
+        ++probes;
+    }
+    CHECK(probes == DisplayProbeCount);
+    fprintf(stdout, "%s", console.c_str());
+    CHECK(console.find(" \r\n") == std::string::npos);
+    CHECK(console.find("Frame: 2 frames, 2 calls, avg 1500us, max 2000us\r\n <1024us:1 <2048us:1\r\n")
+        != std::string::npos);
+    CHECK(console.find("Painter: 1 frames, 2 calls, avg 400us, max 400us\r\n <512us:1\r\n") != std::string::npos);
+    CHECK(console.find("DrawSurface: no frames\r\n") != std::string::npos);
+
+    DisplayStatsReset();
+    CHECK(frame->frames == 0 && painter->calls == 0 && painter->histogram[DisplayStatsBucket(400)] == 0);
+
+    return CheckResult("test_displaystats");
+}
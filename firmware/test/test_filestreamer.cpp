@@ -0,0 +1,260 @@
+/*
+ * File:   test_filestreamer.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 11:00 AM
+ */
+
+// FileStreamer driven the way ToolDataOut::SendFile() drives it, against a
+// stand-in file system and a simulated UART DMA. A file comes either through
+// the stand-in SYS_FS, which copies into the block buffers and costs a call
+// overhead plus so much a byte, or from flash in place, handed out in spans
+// the way FlashFile does. SendFile() runs once a main loop pass. A block
+// sent by the DMA takes ten bit times a byte and is released on the pass
+// after it's done; what it sent is compared with what it held when it
+// started, so a block refilled under the DMA shows up. Files of awkward
+// sizes, empty files and looping must put exactly the file on the wire.
+//
+// Then the sustained baud: the highest rate at which the wire is busy 95% of
+// the time, for each source and a few main loop pass times, against the old
+// loop that read and sent a byte at a time into the UART's 8 byte FIFO. A
+// block is only replaced on the pass after it finishes, so the pass time
+// sets the limit: with 5 ms passes the wire waits too long between blocks
+// to keep up 115200 baud.
+
+#include <string.h>
+#include <vector>
+#include <random>
+#include "FileStreamer.h"
+#include "check.h"
+
+#define FILE_BLOCK_SIZE 512
+#define FLASH_SPAN 2048
+#define UART_FIFO 8
+
+static char fileBlocks[2][FILE_BLOCK_SIZE];
+static FileStreamer streamer(fileBlocks[0], fileBlocks[1], FILE_BLOCK_SIZE);
+
+// The model's costs, ns. A SYS_FS read through the memory driver is mostly
+// overhead; a byte at a time costs the overhead each byte. The pass time is
+// everything else the main loop does between calls to OnIdle().
+static double fsCallTime = 40000, fsByteTime = 10, paneTime = 2000;
+static double now;
+
+static std::vector<char> file;
+static bool inFlash;
+
+// The stand-in file, open or not, and where we are in it
+static bool open;
+static size_t position;
+
+static size_t Read(const char *&data, char *buffer, size_t bytes, void *context)
+{
+    CHECK(open && bytes == FILE_BLOCK_SIZE);
+    size_t left = file.size() - position;
+    if (inFlash)
+    {
+        // FlashFile's spans end where the clusters stop being consecutive;
+        // pretend that's every FLASH_SPAN bytes
+        size_t span = FLASH_SPAN - position % FLASH_SPAN;
+        if (bytes > span)
+            bytes = span;
+        if (bytes > left)
+            bytes = left;
+        data = file.data() + position;
+    }
+    else
+    {
+        if (bytes > left)
+            bytes = left;
+        CHECK(data == buffer);
+        memcpy(buffer, file.data() + position, bytes);
+        now += fsCallTime + bytes * fsByteTime;
+    }
+    position += bytes;
+    return bytes;
+}
+
+// The UART's DMA
+static uint32_t baud;
+static const char *txData;
+static size_t txSize;
+static std::vector<char> txStarted, wire;
+static double doneAt;
+static double busyTime;
+
+static bool TXBlockBusy()
+{
+    return txData && now < doneAt;
+}
+
+static void TXBlock(const char *data, size_t size)
+{
+    CHECK(!TXBlockBusy() && size <= FILE_BLOCK_SIZE);
+    txData = data;
+    txSize = size;
+    txStarted.assign(data, data + size);
+    doneAt = now + size * 10e9 / baud;
+    busyTime += doneAt - now;
+}
+
+// What the DMA read by the time it was done
+static void TXFinish()
+{
+    if (txData && now >= doneAt)
+    {
+        CHECK(std::vector<char>(txData, txData + txSize) == txStarted);
+        wire.insert(wire.end(), txStarted.begin(), txStarted.end());
+        txData = nullptr;
+    }
+}
+
+// SendFile(), one main loop pass of it. Returns false once it's stopped.
+static bool SendFile(int &loops, bool &endOfFile)
+{
+    TXFinish();
+    if (streamer.Sending() && !TXBlockBusy())
+        streamer.Sent();
+
+    if (!open && !endOfFile)
+    {
+        open = true;
+        position = 0;
+    }
+
+    if (open && !streamer.Fill(Read, nullptr))
+    {
+        open = false;
+        endOfFile = --loops == 0;
+    }
+
+    const char *data;
+    size_t size;
+    if (streamer.Next(data, size))
+    {
+        TXBlock(data, size);
+        now += paneTime;
+    }
+    else if (!streamer.Sending() && endOfFile)
+        return false;
+    return true;
+}
+
+// Send the file loops times, with passTime ns between passes. Returns the
+// fraction of the time the wire was busy.
+static double Send(int loops, uint32_t rate, double passTime)
+{
+    streamer.Reset();
+    open = false;
+    wire.clear();
+    txData = nullptr;
+    baud = rate;
+    now = busyTime = 0;
+    bool endOfFile = false;
+    while (SendFile(loops, endOfFile))
+        now += passTime;
+    CHECK(!TXBlockBusy());
+    return now ? busyTime / now : 1;
+}
+
+// The old OnIdle(): a byte at a time while the FIFO has room
+static double SendBytes(uint32_t rate, double passTime)
+{
+    double byteTime = 10e9 / rate, fifoEmptyAt = 0, busy = 0;
+    size_t sent = 0;
+    now = 0;
+    while (sent < file.size())
+    {
+        while (sent < file.size())
+        {
+            // Bytes still in the FIFO
+            double queued = fifoEmptyAt > now ? (fifoEmptyAt - now) / byteTime : 0;
+            if (queued > UART_FIFO - 1)
+                break;
+            now += fsCallTime + fsByteTime + paneTime;
+            if (fifoEmptyAt < now)
+                fifoEmptyAt = now;
+            fifoEmptyAt += byteTime;
+            busy += byteTime;
+            ++sent;
+        }
+        now += passTime;
+    }
+    if (fifoEmptyAt > now)
+        now = fifoEmptyAt;
+    return busy / now;
+}
+
+// The highest baud that keeps the wire busy 95% of the time
+template <class F>
+static uint32_t Sustained(F send)
+{
+    uint32_t low = 300, high = 20000000;
+    while (high - low > low / 100)
+    {
+        uint32_t mid = low + (high - low) / 2;
+        if (send(mid) >= 0.95)
+            low = mid;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+static std::mt19937 g(1);
+
+static void MakeFile(size_t size)
+{
+    file.resize(size);
+    for (char &c : file)
+        c = char(g());
+}
+
+static void CheckFile(size_t size, int loops)
+{
+    MakeFile(size);
+    for (int flash = 0; flash < 2; ++flash)
+    {
+        inFlash = flash;
+        Send(loops, 115200, 1000000);
+        std::vector<char> expected;
+        for (int i = 0; i < loops; ++i)
+            expected.insert(expected.end(), file.begin(), file.end());
+        CHECK(wire == expected);
+    }
+}
+
+int main()
+{
+    static const size_t sizes[] = {0, 1, 511, 512, 513, 1024, 2047, 2048, 2049, 5000, 65536 + 3};
+    for (size_t size : sizes)
+    {
+        CheckFile(size, 1);
+        CheckFile(size, 3);
+    }
+
+    // A Sent() with nothing sent does nothing
+    streamer.Reset();
+    streamer.Sent();
+    CHECK(!streamer.Sending());
+
+    MakeFile(256 * 1024);
+    static const double passTimes[] = {100000, 1000000, 5000000};
+    for (double passTime : passTimes)
+    {
+        inFlash = false;
+        uint32_t fs = Sustained([=](uint32_t b) {return Send(1, b, passTime);});
+        inFlash = true;
+        uint32_t flash = Sustained([=](uint32_t b) {return Send(1, b, passTime);});
+        uint32_t bytes = Sustained([=](uint32_t b) {return SendBytes(b, passTime);});
+        fprintf(stdout, "Main loop pass %.1f ms: sustained baud %u from SYS_FS, %u from flash, "
+            "%u a byte at a time\n", passTime / 1e6, fs, flash, bytes);
+        CHECK(fs >= bytes * 4 && flash >= fs);
+        // The fastest rate the tool offers keeps up as long as the main loop
+        // gets round in a millisecond
+        if (passTime <= 1000000)
+            CHECK(fs > 115200);
+    }
+
+    return CheckResult("test_filestreamer");
+}
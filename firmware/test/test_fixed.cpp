@@ -0,0 +1,94 @@
+/*
+ * File:   test_fixed.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:50 AM
+ */
+
+// fixed's multiply and divide against 128-bit integer arithmetic. Both
+// truncate toward zero, so wherever the exact result fits in 64 bits they
+// have to match it exactly.
+
+#include <stdint.h>
+#include <random>
+#include "fixed.h"
+#include "check.h"
+
+typedef __int128 int128;
+typedef unsigned __int128 uint128;
+
+// Random raw values with random magnitudes, so small, large and
+// whole-number values all turn up
+static long long RandomRaw(std::mt19937_64 &g)
+{
+    int bits = int(g() % 63) + 1;
+    long long v = (long long) (g() & ((1ULL << bits) - 1));
+    if (g() % 16 == 0)
+        v = v / fixed::scale * fixed::scale;
+    return g() & 1 ? -v : v;
+}
+
+static bool Fits(int128 v)
+{
+    return v <= INT64_MAX && v >= INT64_MIN;
+}
+
+int main()
+{
+    std::mt19937_64 g(1234);
+    // The 64-bit helpers on their own
+    for (int i = 0; i < 1000000; ++i)
+    {
+        uint64_t a = g() >> (g() % 64), b = g() >> (g() % 64);
+        uint64_t hi, lo;
+        fixed_multiply(a, b, hi, lo);
+        uint128 product = (uint128) a * b;
+        CHECK(hi == uint64_t(product >> 64) && lo == uint64_t(product));
+
+        uint64_t d = (g() >> (g() % 64)) | 1;
+        uint128 n = ((uint128) (g() >> (g() % 64)) << 64 | g()) >> (g() % 128);
+        uint64_t q = fixed_divide(uint64_t(n >> 64), uint64_t(n), d);
+        if (uint64_t(n >> 64) >= d)
+            CHECK(q == ~0ULL);
+        else
+            CHECK(q == uint64_t(n / d));
+    }
+    CHECK(fixed_divide(0, 0, 1) == 0);
+    CHECK(fixed_divide(0, ~0ULL, ~0ULL) == 1);
+    CHECK(fixed_divide(~0ULL - 1, ~0ULL, ~0ULL) == ~0ULL);
+
+    // The operators, against the exact result
+    long inRange = 0;
+    for (int i = 0; i < 5000000; ++i)
+    {
+        long long a = RandomRaw(g), b = RandomRaw(g);
+        if (b == 0)
+            b = 1;
+
+        int128 product = (int128) a * b / fixed::scale;
+        if (Fits(product))
+        {
+            ++inRange;
+            CHECK((fixed(a, true) * fixed(b, true)).raw() == (long long) product);
+        }
+        int128 quotient = (int128) a * fixed::scale / b;
+        if (Fits(quotient))
+        {
+            ++inRange;
+            CHECK((fixed(a, true) / fixed(b, true)).raw() == (long long) quotient);
+        }
+    }
+
+    // A few by hand
+    CHECK(fixed(1.5) * fixed(2) == fixed(3));
+    CHECK(-fixed(1.5) * fixed(2) == fixed(-3));
+    CHECK(fixed(1) / fixed(3) == fixed((long long) 333333333, true));
+    CHECK(fixed(-1) / fixed(3) == fixed((long long) -333333333, true));
+    CHECK(fixed(0) * fixed(12345) == fixed(0));
+    // PWM sized numbers: 80 MHz / 1 kHz, and a period times a duty cycle
+    CHECK(fixed(80000000) / fixed(1000) == fixed(80000));
+    CHECK(fixed(80000) * fixed(0.25) == fixed(20000));
+
+    printf("%ld results in range checked\n", inRange);
+    return CheckResult("test_fixed");
+}
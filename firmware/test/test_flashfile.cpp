@@ -0,0 +1,178 @@
+/*
+ * File:   test_flashfile.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 11:05 AM
+ */
+
+// FlashFile against the real disk image from DiskImage.c, which is FAT12:
+//
+//  - the boot sector says what we expect, and the volume label and the
+//    System Volume Information directory can't be opened as files
+//  - files written into a copy of the image, with chains that run on, jump
+//    about and cross the FAT12 byte boundaries at odd and even clusters,
+//    read back exactly and in as few spans as the clusters allow
+//  - empty files open with nothing in them; deleted entries, bad names and
+//    chains that loop or end early don't open
+
+#include <string.h>
+#include <vector>
+#include <random>
+#include "FlashFile.h"
+#include "check.h"
+
+extern "C" const uint8_t diskImage[];
+extern "C" int DiskNonZeroSize();
+
+#define IMAGE_SIZE (512 * 1024)
+#define SECTOR 512
+#define FAT_OFFSET (2 * SECTOR)
+#define FAT_SECTORS 3
+#define ROOT_OFFSET (FAT_OFFSET + 2 * FAT_SECTORS * SECTOR)
+#define DATA_OFFSET (ROOT_OFFSET + 512 * 32)
+
+static std::vector<uint8_t> image;
+static int nextEntry;
+
+static uint32_t Get16(const uint8_t *p) {return p[0] | (p[1] << 8);}
+
+// Both copies of the FAT, though FlashFile only reads the first
+static void SetFAT(uint32_t cluster, uint32_t next)
+{
+    for (int fat = 0; fat < 2; ++fat)
+    {
+        uint8_t *p = &image[FAT_OFFSET + fat * FAT_SECTORS * SECTOR + cluster + cluster / 2];
+        if (cluster & 1)
+        {
+            p[0] = (p[0] & 0x0f) | (next << 4);
+            p[1] = next >> 4;
+        }
+        else
+        {
+            p[0] = next;
+            p[1] = (p[1] & 0xf0) | (next >> 8);
+        }
+    }
+}
+
+static uint8_t *AddEntry(const char shortName[11], uint32_t firstCluster, uint32_t size)
+{
+    uint8_t *entry = &image[ROOT_OFFSET + nextEntry++ * 32];
+    memset(entry, 0, 32);
+    memcpy(entry, shortName, 11);
+    entry[11] = 0x20;
+    entry[26] = firstCluster;
+    entry[27] = firstCluster >> 8;
+    for (int i = 0; i < 4; ++i)
+        entry[28 + i] = size >> (i * 8);
+    return entry;
+}
+
+static std::mt19937 g(1);
+
+// Write a file over the clusters given, linking them in order. Returns what
+// it holds.
+static std::vector<uint8_t> AddFile(const char shortName[11], const std::vector<uint32_t> &clusters, uint32_t size)
+{
+    std::vector<uint8_t> data(size);
+    for (uint8_t &b : data)
+        b = uint8_t(g());
+    for (size_t i = 0; i < clusters.size(); ++i)
+    {
+        size_t offset = i * SECTOR;
+        if (offset < size)
+            memcpy(&image[DATA_OFFSET + (clusters[i] - 2) * SECTOR], &data[offset],
+                size - offset < SECTOR ? size - offset : SECTOR);
+        SetFAT(clusters[i], i + 1 < clusters.size() ? clusters[i + 1] : 0xfff);
+    }
+    AddEntry(shortName, clusters.empty() ? 0 : clusters[0], size);
+    return data;
+}
+
+static void CheckFile(const char *name, const std::vector<uint8_t> &expected, size_t spans)
+{
+    FlashFile file(image.data(), image.size());
+    CHECK(file.Open(name));
+    CHECK(file.Size() == expected.size());
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        std::vector<uint8_t> read;
+        FlashSpan span;
+        size_t count = 0;
+        while (file.NextSpan(span))
+        {
+            CHECK(span.data >= image.data() && span.data + span.size <= image.data() + image.size());
+            read.insert(read.end(), span.data, span.data + span.size);
+            ++count;
+        }
+        CHECK(read == expected);
+        CHECK(count == spans);
+        file.Rewind();
+    }
+    file.Close();
+    CHECK(!file.IsOpen());
+}
+
+int main()
+{
+    // The real image
+    const uint8_t *boot = diskImage;
+    CHECK(Get16(boot + 11) == SECTOR && boot[13] == 1 && Get16(boot + 14) == FAT_OFFSET / SECTOR);
+    CHECK(boot[16] == 2 && Get16(boot + 17) == 512 && Get16(boot + 22) == FAT_SECTORS);
+    CHECK(Get16(boot + 19) * SECTOR == IMAGE_SIZE);
+    CHECK(boot[510] == 0x55 && boot[511] == 0xaa);
+    CHECK(DiskNonZeroSize() > ROOT_OFFSET && DiskNonZeroSize() < IMAGE_SIZE);
+
+    FlashFile real(diskImage, IMAGE_SIZE);
+    CHECK(!real.Open("LOGICMET.ER") && !real.Open("SYSTEM~1") && !real.Open("README.TXT"));
+    CHECK(!real.IsOpen());
+
+    // A copy to write files into, after what's in the root directory now
+    image.assign(diskImage, diskImage + IMAGE_SIZE);
+    while (image[ROOT_OFFSET + nextEntry * 32] != 0)
+        ++nextEntry;
+    CHECK(nextEntry == 4);
+
+    // One run of clusters
+    std::vector<uint8_t> hello = AddFile("HELLO   TXT", {20, 21, 22}, 1300);
+    // Jumping about, over odd and even clusters and back down the disk
+    std::vector<uint8_t> frag = AddFile("FRAG    PAT", {31, 32, 7, 300, 301, 302, 40}, 6 * SECTOR + 17);
+    // Exactly filling its clusters, ending on the last cluster there is
+    std::vector<uint8_t> full = AddFile("FULL    BIN", {984, 985}, 2 * SECTOR);
+    std::vector<uint8_t> empty = AddFile("EMPTY   TXT", {}, 0);
+    CheckFile("HELLO.TXT", hello, 1);
+    CheckFile("hello.txt", hello, 1);
+    CheckFile("FRAG.PAT", frag, 4);
+    CheckFile("FULL.BIN", full, 1);
+    CheckFile("EMPTY.TXT", empty, 0);
+    FlashFile file(image.data(), image.size());
+    CHECK(file.Open("EMPTY.TXT") && file.IsOpen() && file.Size() == 0);
+
+    // A deleted entry ahead of a live one with the same name is skipped
+    uint8_t *deleted = AddEntry("SAME    TXT", 50, 10);
+    deleted[0] = 0xe5;
+    std::vector<uint8_t> same = AddFile("SAME    TXT", {60}, 10);
+    CheckFile("SAME.TXT", same, 1);
+
+    // Chains that loop, end early or run off the disk
+    AddFile("LOOP    TXT", {70, 71}, 10 * SECTOR);
+    SetFAT(71, 70);
+    AddFile("LOOPBACKTXT", {72, 73, 74}, 4 * SECTOR);
+    SetFAT(74, 73);
+    AddFile("SHORT   TXT", {80, 81}, 3 * SECTOR);
+    AddFile("OFF     TXT", {90}, 2 * SECTOR);
+    SetFAT(90, 986);
+    CHECK(!file.Open("LOOP.TXT") && !file.IsOpen());
+    CHECK(!file.Open("LOOPBACK.TXT") && !file.IsOpen());
+    CHECK(!file.Open("SHORT.TXT") && !file.IsOpen());
+    CHECK(!file.Open("OFF.TXT") && !file.IsOpen());
+
+    // Names that can't be 8.3
+    CHECK(!file.Open("TOOLONGNAME.TXT") && !file.Open("HELLO.TEXT") && !file.Open(".TXT"));
+
+    // Nothing after the end of the directory is looked at
+    image[ROOT_OFFSET + 4 * 32] = 0;
+    CHECK(!file.Open("FRAG.PAT"));
+
+    return CheckResult("test_flashfile");
+}
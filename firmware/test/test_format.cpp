@@ -0,0 +1,202 @@
+/*
+ * File:   test_format.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 10:05 AM
+ */
+
+// Format's functions against the firmware's own sprintf (printf.c) with the
+// format each one stands in for, over every width the tools use and
+// numbers around each power of ten, the ends of the ranges and lots of
+// random ones. FormatFixed is checked against rounding done exactly in
+// integers, at every number of decimals. FormatEngineering is checked
+// against eng()'s way of doing it in floating point, away from the halfway
+// points where that can round the other way.
+
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <random>
+#include "check.h"
+#include "printf.h"
+#include "Format.h"
+
+// printf.c's output for printf itself, which isn't used here
+extern "C" void _putchar(char character)
+{
+}
+
+#define SAME(call, ...) \
+    do { char a[64], b[64]; call; sprintf_(b, __VA_ARGS__); \
+        if (strcmp(a, b)) {CHECK(!#call); fprintf(stderr, "  \"%s\" != \"%s\"\n", a, b);} } while (0)
+
+static std::mt19937 g(1);
+
+static void CheckIntegers(uint32_t u)
+{
+    int32_t s = int32_t(u);
+    // printf.c gets INT32_MIN wrong where long is 64 bits, as on the host,
+    // so that's checked on its own
+    bool signedToo = s != INT32_MIN;
+    for (int w = 0; w < 12; ++w)
+    {
+        SAME(FormatUnsigned(a, u, w), "%0*u", w, u);
+        SAME(FormatUnsigned(a, u, w, ' '), "%*u", w, u);
+        if (signedToo)
+        {
+            SAME(FormatInt(a, s, w), "%*d", w, s);
+            SAME(FormatInt(a, s, w, '0'), "%0*d", w, s);
+        }
+    }
+    SAME(FormatUnsigned(a, u), "%u", u);
+    if (signedToo)
+        SAME(FormatInt(a, s), "%d", s);
+}
+
+// Rounding half away from zero at the last place kept, as %.*f does
+static void CheckFixed(long long raw)
+{
+    for (int decimals = 0; decimals <= fixed::fraction_digits; ++decimals)
+    {
+        char a[64], b[64];
+        char *end = FormatFixed(a, fixed(raw, true), decimals);
+        CHECK(*end == 0 && end == a + strlen(a));
+
+        unsigned long long magnitude = raw < 0 ? -(unsigned long long) raw : raw;
+        unsigned long long step = 1;
+        for (int k = decimals; k < fixed::fraction_digits; ++k)
+            step *= 10;
+        magnitude += step / 2;
+        unsigned long long whole = magnitude / fixed::scale, fraction = magnitude % fixed::scale / step;
+        if (decimals)
+            snprintf_(b, sizeof(b), "%s%llu.%0*llu", raw < 0 ? "-" : "", whole, decimals, fraction);
+        else
+            snprintf_(b, sizeof(b), "%s%llu", raw < 0 ? "-" : "", whole);
+        if (strcmp(a, b))
+        {
+            CHECK(!"FormatFixed");
+            fprintf(stderr, "  %lld to %d places: \"%s\" != \"%s\"\n", raw, decimals, a, b);
+        }
+    }
+}
+
+// Utility.cpp's eng(), in long double, which holds a fixed's raw value
+// exactly. Returns false where it can't be trusted to round the same way.
+static bool Engineering(char *b, long long raw, int digits, const char *units)
+{
+    static const char *const prefixes[] = {"n", "\xCE\xBC", "m", "", "k", "M", "G"};
+    if (raw == 0)
+        return false;
+    unsigned long long magnitude = raw < 0 ? -(unsigned long long) raw : raw;
+    long double value = (long double) magnitude / fixed::scale;
+    // log10l(0.01) can come out a hair under -2, so count the digits
+    int exponent = -fixed::fraction_digits;
+    for (unsigned long long t = magnitude; t >= 10; t /= 10)
+        ++exponent;
+    int group = exponent >= 0 ? exponent / 3 * 3 : -((2 - exponent) / 3 * 3);
+    long double mantissa = value / powl(10, group);
+    int decimals = digits - 1 - (mantissa >= 100) - (mantissa >= 10);
+    long double last = mantissa * powl(10, decimals);
+    if (fabsl(last - floorl(last) - 0.5L) < 1e-6L)
+        return false;
+    // printf.c has no %Lf, so the rounded figures are split at the point
+    unsigned long long figures = (unsigned long long) roundl(last), scale = 1;
+    for (int i = 0; i < decimals; ++i)
+        scale *= 10;
+    // A carry gives eng() an extra figure, and 1000.000 with the smaller
+    // prefix
+    unsigned long long limit = 1;
+    for (int i = 0; i < digits; ++i)
+        limit *= 10;
+    if (figures >= limit)
+        return false;
+    const char *sign = raw < 0 ? "-" : "";
+    if (decimals)
+        snprintf_(b, 64, "%s%llu.%0*llu %s%s", sign, figures / scale, decimals, figures % scale,
+            prefixes[group / 3 + 3], units);
+    else
+        snprintf_(b, 64, "%s%llu %s%s", sign, figures, prefixes[group / 3 + 3], units);
+    return true;
+}
+
+static void CheckEngineering(long long raw, int digits)
+{
+    char a[64], b[64];
+    char *end = FormatEngineering(a, fixed(raw, true), digits, "Hz");
+    CHECK(*end == 0 && end == a + strlen(a));
+    if (Engineering(b, raw, digits, "Hz") && strcmp(a, b))
+    {
+        CHECK(!"FormatEngineering");
+        fprintf(stderr, "  %lld to %d figures: \"%s\" != \"%s\"\n", raw, digits, a, b);
+    }
+}
+
+int main()
+{
+    uint32_t power = 1;
+    for (int i = 0; i < 10; ++i, power *= 10)
+    {
+        CheckIntegers(power - 1);
+        CheckIntegers(power);
+        CheckIntegers(power + 1);
+    }
+    static const uint32_t ends[] = {0, 0x7fffffff, 0x80000000, 0x80000001, 0xffffffff};
+    for (uint32_t u : ends)
+        CheckIntegers(u);
+    for (int i = 0; i < 100000; ++i)
+        CheckIntegers(uint32_t(g()) >> (g() % 32));
+
+    static const long long fixedEnds[] = {0, 1, -1, 499999999, 500000000, -500000000, 999999999,
+        1000000000, -1000000000, 1000000000000000000LL, -1000000000000000000LL, 0x7fffffffffffffffLL,
+        -0x7fffffffffffffffLL};
+    for (long long raw : fixedEnds)
+        CheckFixed(raw);
+    for (int i = 0; i < 100000; ++i)
+        CheckFixed((long long) ((uint64_t(g()) << 32) | g()) >> (g() % 64));
+
+    for (int digits = 3; digits <= 9; ++digits)
+    {
+        // Around each power of ten up to 10^18
+        long long power = 1;
+        for (int i = 0; i <= 18; ++i)
+        {
+            CheckEngineering(power - 1, digits);
+            CheckEngineering(power, digits);
+            CheckEngineering(-power - 1, digits);
+            if (i < 18)
+                power *= 10;
+        }
+        for (int i = 0; i < 20000; ++i)
+            CheckEngineering((long long) ((uint64_t(g()) << 32) | g()) >> (g() % 64), digits);
+    }
+
+    char buf[32];
+    FormatInt(buf, INT32_MIN);
+    CHECK(!strcmp(buf, "-2147483648"));
+    FormatInt(buf, INT32_MIN, 13, '0');
+    CHECK(!strcmp(buf, "-002147483648"));
+    FormatInt(buf, INT32_MIN, 13);
+    CHECK(!strcmp(buf, "  -2147483648"));
+
+    // What SquareWavePane shows
+    FormatFixed(buf, fixed(3.14159), 2);
+    CHECK(!strcmp(buf, "3.14"));
+    FormatFixed(buf, -fixed(0.5), 0);
+    CHECK(!strcmp(buf, "-1"));
+    FormatFixed(buf, -fixed(0.04), 1);
+    CHECK(!strcmp(buf, "-0.0"));
+    FormatEngineering(buf, fixed(1000), 7, "Hz");
+    CHECK(!strcmp(buf, "1.000000 kHz"));
+    FormatEngineering(buf, fixed(999.99996), 7, "Hz");
+    CHECK(!strcmp(buf, "1.000000 kHz"));
+    FormatEngineering(buf, fixed(99.999996), 7, "Hz");
+    CHECK(!strcmp(buf, "100.0000 Hz"));
+    FormatEngineering(buf, fixed(0.25), 7, "Hz");
+    CHECK(!strcmp(buf, "250.0000 mHz"));
+    FormatEngineering(buf, fixed(12345678.5), 7, "Hz");
+    CHECK(!strcmp(buf, "12.34568 MHz"));
+    FormatEngineering(buf, fixed(0), 7, "Hz");
+    CHECK(!strcmp(buf, "0 Hz"));
+
+    return CheckResult("test_format");
+}
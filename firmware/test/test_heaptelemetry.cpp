@@ -0,0 +1,281 @@
+/*
+ * File:   test_heaptelemetry.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 11:40 AM
+ */
+
+// Heap telemetry against a model of what each site should show:
+//
+//  - an address keeps its slot, and slot 0 takes what doesn't fit, however
+//    many sites there are, with nothing lost from the totals
+//  - random churn across many sites: counts, live bytes, peaks and the
+//    block bytes match the model
+//  - frees of headers that aren't live are counted and change nothing
+//  - a checkpoint shows what changed since the last one, and a reset
+//    zeroes the counts and brings the peaks down to what's live
+//  - sites with nothing to show print nothing
+
+#include <string.h>
+#include <unistd.h>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "HeapTelemetry.h"
+#include "check.h"
+
+static std::mt19937 g(11);
+
+// Code addresses in the PIC32's program flash
+static uintptr_t Site(int k) {return 0x9d001000 + 4 * k;}
+
+struct Block
+{
+    HeapTelemetryHeader h;
+    size_t size, blockSize;
+};
+
+struct ModelSite
+{
+    uint32_t allocs, frees, liveCount, liveBytes, peakBytes;
+};
+
+static void Alloc(HeapTelemetry *t, ModelSite *model, std::vector<Block> &live, uintptr_t site, size_t size)
+{
+    Block b;
+    b.size = size;
+    b.blockSize = size + sizeof(HeapTelemetryHeader) + g() % 8;
+    HeapTelemetryAlloc(t, &b.h, size, site, b.blockSize);
+    CHECK(b.h.site < HEAP_TELEMETRY_SITES && b.h.size == size);
+    ModelSite &m = model[b.h.site];
+    ++m.allocs;
+    ++m.liveCount;
+    m.liveBytes += size;
+    if (m.liveBytes > m.peakBytes)
+        m.peakBytes = m.liveBytes;
+    live.push_back(b);
+}
+
+static void Free(HeapTelemetry *t, ModelSite *model, std::vector<Block> &live, size_t k)
+{
+    Block &b = live[k];
+    ModelSite &m = model[b.h.site];
+    CHECK(HeapTelemetryFree(t, &b.h, b.blockSize));
+    ++m.frees;
+    --m.liveCount;
+    m.liveBytes -= b.size;
+    live[k] = live.back();
+    live.pop_back();
+}
+
+static void CheckModel(const HeapTelemetry *t, const ModelSite *model, const std::vector<Block> &live)
+{
+    uint32_t liveBytes = 0, blockBytes = 0;
+    for (const Block &b : live)
+    {
+        liveBytes += b.size;
+        blockBytes += b.blockSize;
+    }
+    CHECK(t->liveCount == live.size() && t->liveBytes == liveBytes && t->blockBytes == blockBytes);
+    for (int i = 0; i < HEAP_TELEMETRY_SITES; ++i)
+    {
+        const HeapSite &s = t->sites[i];
+        const ModelSite &m = model[i];
+        CHECK(s.allocs == m.allocs && s.frees == m.frees);
+        CHECK(s.liveCount == m.liveCount && s.liveBytes == m.liveBytes && s.peakBytes == m.peakBytes);
+    }
+}
+
+static void CheckSlots()
+{
+    static HeapTelemetry t;
+    HeapTelemetryInit(&t);
+    std::map<uintptr_t, int> slots;
+    std::vector<Block> live;
+    static ModelSite model[HEAP_TELEMETRY_SITES];
+    memset(model, 0, sizeof(model));
+
+    // Twice as many sites as slots, each allocating a few times
+    for (int round = 0; round < 3; ++round)
+        for (int k = 0; k < HEAP_TELEMETRY_SITES * 2; ++k)
+        {
+            Alloc(&t, model, live, Site(k), 16);
+            int slot = live.back().h.site;
+            auto found = slots.find(Site(k));
+            if (found == slots.end())
+                slots[Site(k)] = slot;
+            else
+                CHECK(found->second == slot);
+            CHECK(slot == 0 || t.sites[slot].address == Site(k));
+        }
+    CHECK(t.sites[0].address == 0 && t.sites[0].allocs > 0);
+
+    int used = 0;
+    uint32_t allocs = 0;
+    for (const HeapSite &s : t.sites)
+    {
+        used += s.address != 0;
+        allocs += s.allocs;
+    }
+    CHECK(used <= HEAP_TELEMETRY_SITES - 1 && used > HEAP_TELEMETRY_SITES / 2);
+    CHECK(allocs == live.size() && t.liveCount == live.size());
+    CheckModel(&t, model, live);
+}
+
+static void CheckChurn()
+{
+    static HeapTelemetry t;
+    HeapTelemetryInit(&t);
+    static ModelSite model[HEAP_TELEMETRY_SITES];
+    memset(model, 0, sizeof(model));
+    std::vector<Block> live;
+    for (int i = 0; i < 200000; ++i)
+    {
+        if (live.size() < 20 || (live.size() < 500 && g() % 2))
+            Alloc(&t, model, live, Site(g() % 40), 1 + g() % 300);
+        else
+            Free(&t, model, live, g() % live.size());
+        if (i % 10000 == 0)
+            CheckModel(&t, model, live);
+    }
+    CheckModel(&t, model, live);
+    uint32_t peak = 0, liveBytes = 0;
+    for (const Block &b : live)
+        liveBytes += b.size;
+    for (const ModelSite &m : model)
+        peak = m.peakBytes > peak ? m.peakBytes : peak;
+    CHECK(t.peakBytes >= liveBytes && t.peakBytes >= peak);
+
+    // Frees of what isn't live count as bad, and leave everything alone
+    Block block = live.back();
+    live.pop_back();
+    ModelSite &m = model[block.h.site];
+    ++m.frees;
+    --m.liveCount;
+    m.liveBytes -= block.size;
+    CHECK(HeapTelemetryFree(&t, &block.h, block.blockSize));
+    HeapTelemetry before = t;
+    CHECK(!HeapTelemetryFree(&t, &block.h, block.blockSize));
+    HeapTelemetryHeader garbage = {123, 7, 0x1234};
+    CHECK(!HeapTelemetryFree(&t, &garbage, 200));
+    HeapTelemetryHeader outOfRange = live.front().h;
+    outOfRange.site = HEAP_TELEMETRY_SITES;
+    CHECK(!HeapTelemetryFree(&t, &outOfRange, 200));
+    CHECK(t.badFrees == before.badFrees + 3);
+    CHECK(t.liveCount == before.liveCount && t.liveBytes == before.liveBytes);
+    CheckModel(&t, model, live);
+
+    // A reset keeps what's live, and brings the peaks down to it
+    HeapTelemetryReset(&t);
+    CHECK(t.badFrees == 0 && t.peakBytes == t.liveBytes && t.liveCount == live.size());
+    for (const HeapSite &s : t.sites)
+        CHECK(s.allocs == 0 && s.frees == 0 && s.peakBytes == s.liveBytes);
+    for (ModelSite &m : model)
+    {
+        m.allocs = m.frees = 0;
+        m.peakBytes = m.liveBytes;
+    }
+    CheckModel(&t, model, live);
+    while (!live.empty())
+        Free(&t, model, live, g() % live.size());
+    CheckModel(&t, model, live);
+    CHECK(t.liveBytes == 0 && t.blockBytes == 0);
+}
+
+static void CheckCheckpoints()
+{
+    static HeapTelemetry t;
+    HeapTelemetryInit(&t);
+    static ModelSite model[HEAP_TELEMETRY_SITES];
+    memset(model, 0, sizeof(model));
+    std::vector<Block> live;
+
+    // Start up leaves two blocks behind at one site
+    Alloc(&t, model, live, Site(1), 100);
+    Alloc(&t, model, live, Site(1), 50);
+    HeapTelemetryCheckpoint(&t);
+    int one = live[0].h.site;
+    CHECK(t.checkpoints == 1 && t.changes[one].count == 2 && t.changes[one].bytes == 150);
+
+    // A tool allocates at two sites and frees all but one block
+    Alloc(&t, model, live, Site(2), 40);
+    Alloc(&t, model, live, Site(3), 24);
+    Alloc(&t, model, live, Site(3), 24);
+    int two = live[2].h.site, three = live[3].h.site;
+    Free(&t, model, live, 4);
+    Free(&t, model, live, 3);
+    HeapTelemetryCheckpoint(&t);
+    CHECK(t.changes[one].count == 0 && t.changes[one].bytes == 0);
+    CHECK(t.changes[two].count == 1 && t.changes[two].bytes == 40);
+    CHECK(t.changes[three].count == 0 && t.changes[three].bytes == 0);
+
+    // The next frees what the last left, and one of start up's
+    Free(&t, model, live, 2);
+    Free(&t, model, live, 1);
+    HeapTelemetryCheckpoint(&t);
+    CHECK(t.checkpoints == 3);
+    CHECK(t.changes[one].count == -1 && t.changes[one].bytes == -50);
+    CHECK(t.changes[two].count == -1 && t.changes[two].bytes == -40);
+    int changed = 0;
+    for (const HeapSiteChange &c : t.changes)
+        changed += c.count != 0 || c.bytes != 0;
+    CHECK(changed == 2);
+    CheckModel(&t, model, live);
+}
+
+// What a print function writes to stdout
+template <typename Print>
+static std::string Capture(Print print)
+{
+    fflush(stdout);
+    int saved = dup(1);
+    FILE *f = tmpfile();
+    dup2(fileno(f), 1);
+    print();
+    fflush(stdout);
+    dup2(saved, 1);
+    close(saved);
+    std::string out;
+    rewind(f);
+    char buffer[256];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+        out.append(buffer, n);
+    fclose(f);
+    return out;
+}
+
+static void CheckPrint()
+{
+    static HeapTelemetry t;
+    HeapTelemetryInit(&t);
+    HeapTelemetryHeader h;
+    HeapTelemetryAlloc(&t, &h, 100, Site(5), 128);
+    HeapTelemetryCheckpoint(&t);
+    int slot = h.site;
+    int empty = slot == 1 ? 2 : 1;
+
+    std::string totals = Capture([&] {HeapTelemetryPrintTotals(&t);});
+    CHECK(totals.find("Live 100 bytes in 1 blocks, peak 100; blocks hold 128 (21.8% waste)") != std::string::npos);
+    std::string site = Capture([&] {HeapTelemetryPrintSite(&t, slot);});
+    CHECK(site == "0x9d001014           1         0       1       100       100\r\n");
+    CHECK(Capture([&] {HeapTelemetryPrintSite(&t, empty);}).empty());
+    CHECK(Capture([&] {HeapTelemetryPrintSite(&t, 0);}).empty());
+    CHECK(Capture([&] {HeapTelemetryPrintChange(&t, slot);}) == "0x9d001014 +1 blocks, +100 bytes\r\n");
+    CHECK(Capture([&] {HeapTelemetryPrintChange(&t, empty);}).empty());
+
+    // A live block at a reset still shows, with no allocations
+    HeapTelemetryReset(&t);
+    CHECK(Capture([&] {HeapTelemetryPrintSite(&t, slot);}) ==
+        "0x9d001014           0         0       1       100       100\r\n");
+}
+
+int main()
+{
+    CheckSlots();
+    CheckChurn();
+    CheckCheckpoints();
+    CheckPrint();
+    return CheckResult("test_heaptelemetry");
+}
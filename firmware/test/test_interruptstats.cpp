@@ -0,0 +1,85 @@
+/*
+ * File:   test_interruptstats.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:55 AM
+ */
+
+// InterruptStats with made-up timestamps: times and intervals, nesting,
+// the core timer wrapping, running out of slots and of stack, and vectors
+// out of range.
+
+#include "InterruptStats.h"
+#include "check.h"
+
+static InterruptStats stats;
+
+int main()
+{
+    // Vector 10 takes 100 ticks, then 50 a thousand ticks later
+    stats.Enter(10, 1000);
+    stats.Exit(1100);
+    stats.Enter(10, 2000);
+    stats.Exit(2050);
+    const InterruptVectorStats *v = stats.Get(0);
+    CHECK(v && v->vector == 10 && v->count == 2);
+    CHECK(v->minTicks == 50 && v->maxTicks == 100 && v->totalTicks == 150);
+    CHECK(v->minInterval == 1000 && v->maxInterval == 1000);
+    CHECK(v->histogram[InterruptStats::Bucket(100)] == 1);
+
+    CHECK(InterruptStats::Bucket(0) == 0);
+    CHECK(InterruptStats::Bucket(1) == 1);
+    CHECK(InterruptStats::Bucket(63) == 6);
+    CHECK(InterruptStats::Bucket(64) == 7);
+    CHECK(InterruptStats::Bucket(100) == 7);
+    CHECK(InterruptStats::Bucket(0xffffffff) == INTERRUPT_STATS_BUCKETS - 1);
+
+    // 20 is interrupted by 30, which is interrupted by 40
+    stats.Enter(20, 5000);
+    stats.Enter(30, 5010);
+    stats.Enter(40, 5020);
+    stats.Exit(5025);
+    stats.Exit(5040);
+    stats.Exit(5100);
+    CHECK(stats.Depth() == 0);
+    const InterruptVectorStats *a = stats.Get(1), *b = stats.Get(2), *c = stats.Get(3);
+    CHECK(a && a->vector == 20 && a->maxTicks == 100 - 30 && a->preempted == 1);
+    CHECK(b && b->vector == 30 && b->maxTicks == 30 - 5 && b->preempted == 1);
+    CHECK(c && c->vector == 40 && c->maxTicks == 5 && c->preempted == 0);
+    CHECK(!stats.Get(4));
+
+    // The core timer wraps
+    stats.Enter(40, 0xfffffff0);
+    stats.Exit(0x10);
+    CHECK(c->maxTicks == 0x20 && c->count == 2 && c->minInterval == 0xfffffff0u - 5020);
+
+    // The slots run out
+    for (int i = 0; i < 20; ++i)
+    {
+        stats.Enter(100 + i, 1);
+        stats.Exit(2);
+    }
+    CHECK(stats.Get(INTERRUPT_STATS_SLOTS - 1) && !stats.Get(INTERRUPT_STATS_SLOTS));
+    CHECK(stats.Overflow() == 20 - (INTERRUPT_STATS_SLOTS - 4));
+    CHECK(stats.Depth() == 0);
+
+    // Nesting deeper than the stack stays balanced
+    stats.Reset();
+    for (int i = 0; i < INTERRUPT_STATS_DEPTH + 2; ++i)
+        stats.Enter(i, i * 10);
+    for (int i = 0; i < INTERRUPT_STATS_DEPTH + 2; ++i)
+        stats.Exit(1000);
+    CHECK(stats.Depth() == 0 && stats.Overflow() == 2);
+    stats.Enter(0, 2000);
+    stats.Exit(2010);
+    CHECK(stats.Get(0)->count == 2 && stats.Get(0)->minTicks == 10);
+
+    // Vectors out of range are left out, and don't upset the stack
+    stats.Enter(-1, 0);
+    stats.Enter(INTERRUPT_STATS_VECTORS, 0);
+    stats.Exit(1);
+    stats.Exit(2);
+    CHECK(stats.Depth() == 0 && stats.Get(0)->count == 2);
+
+    return CheckResult("test_interruptstats");
+}
@@ -0,0 +1,110 @@
+/*
+ * File:   test_nmeaplan.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 11:20 AM
+ */
+
+// NMEAPlan() with the messages ToolGPS sends, for every baud rate on its
+// menu, every fix rate and each output format:
+//
+//  - what's planned fits in 90% of a fix's worth of characters
+//  - messages are taken in priority order, and one is only left out if it
+//    doesn't fit in what the ones before it left
+//  - messages that aren't wanted are never planned
+//
+// Prints what fits at each baud rate, which is what the status line says.
+
+#include <string.h>
+#include "NMEA.h"
+#include "UBX.h"
+#include "check.h"
+
+// ToolGPS.cpp's baudRates, and the fix rates on its menu
+static const uint32_t baudRates[] = {2400, 4800, 9600, 19200, 38400, 57600, 115200};
+static const uint32_t fixRates[] = {1, 2, 4, 5, 10};
+
+// ToolGPS's messages in priority order: PVT, then the sentences
+static const char *const sentences[] = {
+    "$GPGGA,000000.00,0000.0000,N,00000.0000,E,8,4,0.9,280.2,M,-34.1,M,,",
+    "$GPRMC,000000.00,A,0000.0000,N,00000.0000,E,000.00,000.0,010100,,",
+    "$GPGSA,A,3,04,05,09,12,,,,,,,,,1.8,0.9,1.6",
+    "$GPGSV,1,1,04,04,60,045,40,05,45,120,38,09,30,200,35,12,20,300,30",
+    "$GPVTG,000.0,T,,M,000.00,N,0000.00,K",
+    "$GPZDA,000000.00,01,01,2000,00,00"};
+#define MESSAGES 7
+
+enum Format {NMEA, UBX, Both};
+static const char *const formatNames[] = {"NMEA", "UBX", "Both"};
+
+static void CheckPlan(uint32_t baud, uint32_t rate, const size_t *lengths, uint32_t mask)
+{
+    size_t budget = baud / 10 * 9 / 10 / rate;
+    size_t used = 0;
+    for (int i = 0; i < MESSAGES; ++i)
+    {
+        if (mask & (1u << i))
+        {
+            CHECK(lengths[i] != 0);
+            used += lengths[i];
+        }
+        // Left out, so it didn't fit after the ones before it
+        else if (lengths[i])
+            CHECK(used + lengths[i] > budget);
+    }
+    CHECK(used <= budget);
+    CHECK(uint64_t(used) * 10 * rate <= uint64_t(baud) * 9 / 10);
+    CHECK(mask >> MESSAGES == 0);
+}
+
+int main()
+{
+    size_t all[MESSAGES];
+    all[0] = UBXNavPVT().Length();
+    CHECK(all[0] == UBX_NAV_PVT_LENGTH);
+    for (int i = 1; i < MESSAGES; ++i)
+    {
+        NMEATemplate sentence(sentences[i - 1]);
+        all[i] = sentence.Length();
+        CHECK(all[i] == strlen(sentences[i - 1]) + 5 && all[i] <= NMEA_MAX_LENGTH);
+    }
+
+    for (int format = NMEA; format <= Both; ++format)
+    {
+        size_t lengths[MESSAGES];
+        int wanted = 0;
+        for (int i = 0; i < MESSAGES; ++i)
+        {
+            bool ubx = i == 0;
+            lengths[i] = (format == Both || (format == UBX) == ubx) ? all[i] : 0;
+            wanted += lengths[i] != 0;
+        }
+
+        fprintf(stdout, "%s, messages that fit of %d:\n  baud    ", formatNames[format], wanted);
+        for (uint32_t rate : fixRates)
+            fprintf(stdout, "%3uHz", rate);
+        fprintf(stdout, "\n");
+        for (uint32_t baud : baudRates)
+        {
+            fprintf(stdout, "  %-7u ", baud);
+            for (uint32_t rate : fixRates)
+            {
+                uint32_t mask = NMEAPlan(baud, rate, lengths, MESSAGES);
+                CheckPlan(baud, rate, lengths, mask);
+                fprintf(stdout, "%5d", __builtin_popcount(mask));
+            }
+            fprintf(stdout, "\n");
+        }
+    }
+
+    // The fastest baud carries everything once a second, and the slowest
+    // can't carry a sentence ten times a second, which the status line
+    // calls slow
+    CHECK(NMEAPlan(115200, 1, all, MESSAGES) == (1u << MESSAGES) - 1);
+    CHECK(NMEAPlan(2400, 10, all, MESSAGES) == 0);
+    // Nothing wanted, nothing planned
+    size_t none[MESSAGES] = {};
+    CHECK(NMEAPlan(115200, 1, none, MESSAGES) == 0);
+
+    return CheckResult("test_nmeaplan");
+}
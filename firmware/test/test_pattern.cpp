@@ -0,0 +1,188 @@
+/*
+ * File:   test_pattern.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 11:10 AM
+ */
+
+// Pattern scripts, compiled and run:
+//
+//  - each item sends what it should, with the idle time before each byte
+//  - nested repeats, checksums and looping back to the start
+//  - errors come with the right line, and a repeat that sends nothing,
+//    however it's nested, doesn't compile: the runner would go round it
+//    forever inside the timer interrupt
+//  - on a simulated timer run the way ToolDataOut runs it (a 16 bit period,
+//    long waits split up, the next byte's time counted from the end of this
+//    one), every byte starts when the script says, to the tick
+
+#include <string.h>
+#include <string>
+#include <vector>
+#include "Pattern.h"
+#include "check.h"
+
+struct Sent
+{
+    std::string bytes;
+    std::vector<uint32_t> idle;
+};
+
+static PatternCompiler compiler;
+
+static bool Compile(const char *script)
+{
+    return compiler.Compile(script, strlen(script));
+}
+
+static Sent Run(const char *script, size_t limit = 100000)
+{
+    Sent sent;
+    CHECK(Compile(script));
+    PatternRunner runner;
+    runner.Start(compiler.Code().data());
+    uint8_t byte;
+    uint32_t idle;
+    while (sent.bytes.size() < limit && runner.Next(byte, idle))
+    {
+        sent.bytes += char(byte);
+        sent.idle.push_back(idle);
+    }
+    return sent;
+}
+
+static void CheckError(const char *script, int line, const char *error)
+{
+    CHECK(!Compile(script));
+    CHECK(compiler.ErrorLine() == line);
+    CHECK(compiler.Error() && strcmp(compiler.Error(), error) == 0);
+}
+
+// ToolDataOut's timer, counting PBCLK3 / 8 at 100 MHz
+#define TICKS_PER_SECOND 12500000
+
+// LoadPatternTimer()
+static uint32_t LoadTimer(uint32_t &ticks)
+{
+    uint32_t period = ticks;
+    if (period > 0x18000)
+        period = 0x10000;
+    else if (period > 0x10000)
+        period /= 2;
+    ticks -= period;
+    return period;
+}
+
+static uint64_t Ticks(uint32_t microseconds)
+{
+    return uint64_t(microseconds) * TICKS_PER_SECOND / 1000000;
+}
+
+int main()
+{
+    Sent s = Run("\"AB\" <0d 0a> 65, 0x42 # comment\n \"\\x01\\\\\\\"\"");
+    CHECK(s.bytes == "AB\r\nAB\x01\\\"");
+    for (uint32_t idle : s.idle)
+        CHECK(idle == 0);
+
+    // The gap goes before every byte but the first; waits add up and go
+    // before the next byte only
+    s = Run("\"a\" gap 100us \"bc\" wait 2ms wait 1ms \"d\" gap 0us wait 1s \"e\"");
+    CHECK(s.bytes == "abcde");
+    CHECK(s.idle == std::vector<uint32_t>({0, 100, 100, 3100, 1000000}));
+
+    s = Run("repeat 3 { \"x\" repeat 2 { \"yz\" } }");
+    CHECK(s.bytes == "xyzyzxyzyzxyzyz");
+
+    // An NMEA sentence's checksum covers what's between $ and *
+    s = Run("\"$\" begin \"GPTXT,01,01,02,Hello\" end \"*\" xorhex \"\\r\\n\"");
+    uint8_t x = 0;
+    for (const char *p = "GPTXT,01,01,02,Hello"; *p; ++p)
+        x ^= *p;
+    char hex[3];
+    snprintf(hex, sizeof(hex), "%02X", x);
+    CHECK(s.bytes == std::string("$GPTXT,01,01,02,Hello*") + hex + "\r\n");
+    // Without a begin everything is summed, and checksums aren't
+    s = Run("<01 02 03> sum8 sum8 begin 5 xor8");
+    CHECK(s.bytes == std::string("\x01\x02\x03\x06\x06\x05\x05", 7));
+
+    // A repeat of just a checksum is sending something
+    s = Run("\"a\" repeat 3 { sum8 }");
+    CHECK(s.bytes == "aaaa");
+
+    // Looping goes back to the start; a wait at the end carries over
+    CHECK(Compile("\"a\" gap 5us \"b\" wait 7us"));
+    PatternRunner runner;
+    runner.Start(compiler.Code().data());
+    uint8_t byte;
+    uint32_t idle;
+    CHECK(runner.Next(byte, idle) && byte == 'a' && idle == 0);
+    CHECK(runner.Next(byte, idle) && byte == 'b' && idle == 5);
+    CHECK(!runner.Next(byte, idle) && !runner.Next(byte, idle));
+    runner.Restart();
+    CHECK(runner.Next(byte, idle) && byte == 'a' && idle == 7);
+
+    // Errors
+    CheckError("\"a\"\n\n 256", 3, "Byte value too big");
+    CheckError("\"abc", 1, "Unterminated string");
+    CheckError("<0d 0>", 1, "Odd number of hex digits");
+    CheckError("gap 10", 1, "Time needs us, ms or s");
+    CheckError("gap 5000s", 1, "Time too long");
+    CheckError("repeat 0 { \"a\" }", 1, "Repeat count must be 1 to 65535");
+    CheckError("repeat 65536 { \"a\" }", 1, "Repeat count must be 1 to 65535");
+    CheckError("repeat 2 \"a\" }", 1, "Missing {");
+    CheckError("\"a\" }", 1, "Unmatched }");
+    CheckError("repeat 2 {\n\"a\"\n", 3, "Missing }");
+    CheckError("repeat 2 { repeat 2 { repeat 2 { repeat 2 { repeat 2 { 1 } } } } }", 1,
+        "Repeats nested too deeply");
+    CheckError("bogus", 1, "Unknown item");
+
+    // Repeats that send nothing
+    CheckError("repeat 65535 { }", 1, "Repeat has nothing to send");
+    CheckError("\"a\" repeat 2 {\n wait 1ms gap 5us begin end\n}", 3, "Repeat has nothing to send");
+    CheckError("repeat 65535 { repeat 65535 { } }", 1, "Repeat has nothing to send");
+    CheckError("repeat 2 { \"a\" repeat 3 { } }", 1, "Repeat has nothing to send");
+    CheckError("repeat 2 { repeat 3 { \"a\" } repeat 3 { # nothing\n } }", 2, "Repeat has nothing to send");
+    CheckError("repeat 2 { \"\" }", 1, "Repeat has nothing to send");
+    CHECK(Compile("repeat 2 { repeat 3 { \"a\" } }"));
+    CHECK(Compile("repeat 2 { repeat 3 { 1 } wait 1ms }"));
+
+    // The simulated timer. Each byte starts when the period it's sent in
+    // ends; the next is due a character time plus its idle time later.
+    const uint32_t baud = 9600;
+    const uint64_t characterTicks = uint64_t(10) * TICKS_PER_SECOND / baud;
+    CHECK(Compile("gap 250us \"abc\" wait 40ms \"d\" wait 1s \"e\" gap 3ms repeat 20 { 0x55 wait 5237us }"));
+    runner.Start(compiler.Code().data());
+    uint64_t now = 0, due;
+    CHECK(runner.Next(byte, idle));
+    uint32_t ticks = uint32_t(Ticks(idle)) + 100;
+    due = ticks;
+    int bytes = 0;
+    uint32_t shortest = UINT32_MAX;
+    for (;;)
+    {
+        // Periods until the wait is up
+        bool split = ticks > 0x10000;
+        do
+        {
+            uint32_t period = LoadTimer(ticks);
+            CHECK(period >= 1 && period <= 0x10000);
+            if (split && period < shortest)
+                shortest = period;
+            now += period;
+        } while (ticks);
+        CHECK(now == due);
+        ++bytes;
+        if (!runner.Next(byte, idle))
+            break;
+        ticks = uint32_t(characterTicks + Ticks(idle));
+        due = now + ticks;
+    }
+    CHECK(bytes == 25);
+    // No period of a long wait is left short
+    CHECK(shortest >= 0x8000);
+    fprintf(stdout, "Pattern timing: %d bytes over %.3f s, shortest period of a long wait %u ticks\n",
+        bytes, double(now) / TICKS_PER_SECOND, shortest);
+
+    return CheckResult("test_pattern");
+}
@@ -0,0 +1,140 @@
+/*
+ * File:   test_poolheap.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 10:00 AM
+ */
+
+// The pool heap on the firmware's arena size:
+//
+//  - every size up to the largest class gets an aligned block at least as
+//    big, and not much bigger
+//  - a freed block is the next one handed out, without taking a page
+//  - filled with random sizes until it says no, no two blocks overlap,
+//    nothing written is lost, and it fails once with all the pages used
+//  - random churn against a model of what should be live
+
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "PoolHeap.h"
+#include "check.h"
+
+alignas(8) static uint8_t arena[24 * 1024];
+static uint8_t pageClass[sizeof(arena) / POOL_HEAP_PAGE_SIZE];
+
+static std::mt19937 g(7);
+
+static void CheckSizes()
+{
+    PoolHeap heap;
+    PoolHeapInit(&heap, arena, sizeof(arena), pageClass);
+    for (size_t size = 0; size <= POOL_HEAP_MAX_BLOCK; ++size)
+    {
+        void *p = PoolHeapAlloc(&heap, size);
+        CHECK(p && PoolHeapOwns(&heap, p));
+        CHECK(((uintptr_t) p & (POOL_HEAP_ALIGN - 1)) == 0);
+        size_t blockSize = PoolHeapBlockSize(&heap, p);
+        CHECK(blockSize >= size && blockSize <= std::max<size_t>(8, size * 3 / 2 + 8));
+        memset(p, 0xa5, size);
+        PoolHeapFree(&heap, p);
+    }
+    CHECK(PoolHeapAlloc(&heap, POOL_HEAP_MAX_BLOCK + 1) == nullptr);
+    int x;
+    CHECK(!PoolHeapOwns(&heap, &x));
+
+    // Freed blocks come back first, with no new pages
+    size_t pages = heap.nextPage;
+    void *a = PoolHeapAlloc(&heap, 20), *b = PoolHeapAlloc(&heap, 20);
+    PoolHeapFree(&heap, a);
+    CHECK(PoolHeapAlloc(&heap, 17) == a);
+    PoolHeapFree(&heap, a);
+    PoolHeapFree(&heap, b);
+    CHECK(heap.nextPage == pages);
+    for (const PoolClass &c : heap.classes)
+        CHECK(c.inUse == 0 && c.allocs == c.frees);
+}
+
+static void CheckFill()
+{
+    PoolHeap heap;
+    PoolHeapInit(&heap, arena, sizeof(arena), pageClass);
+    std::vector<std::pair<uint8_t *, size_t>> live;
+    for (;;)
+    {
+        size_t size = g() % (POOL_HEAP_MAX_BLOCK + 1);
+        uint8_t *p = (uint8_t *) PoolHeapAlloc(&heap, size);
+        if (!p)
+            break;
+        memset(p, uint8_t(live.size()), size);
+        live.push_back(std::make_pair(p, size));
+    }
+    uint32_t failures = 0;
+    for (const PoolClass &c : heap.classes)
+        failures += c.failures;
+    CHECK(failures == 1);
+    CHECK(heap.nextPage == heap.pageCount);
+
+    for (size_t i = 0; i < live.size(); ++i)
+    {
+        for (size_t j = 0; j < live[i].second; ++j)
+            CHECK(live[i].first[j] == uint8_t(i));
+    }
+    std::sort(live.begin(), live.end());
+    for (size_t i = 1; i < live.size(); ++i)
+        CHECK(live[i - 1].first + PoolHeapBlockSize(&heap, live[i - 1].first) <= live[i].first);
+    for (auto &block : live)
+        PoolHeapFree(&heap, block.first);
+    for (const PoolClass &c : heap.classes)
+        CHECK(c.inUse == 0);
+}
+
+static void CheckChurn()
+{
+    PoolHeap heap;
+    PoolHeapInit(&heap, arena, sizeof(arena), pageClass);
+    struct Block
+    {
+        uint8_t *p;
+        size_t size;
+        uint8_t fill;
+    };
+    std::vector<Block> live;
+    for (int i = 0; i < 200000; ++i)
+    {
+        if (live.size() < 20 || (live.size() < 200 && g() % 2))
+        {
+            size_t size = g() % 4 ? 4 + g() % 40 : g() % (POOL_HEAP_MAX_BLOCK + 1);
+            uint8_t *p = (uint8_t *) PoolHeapAlloc(&heap, size);
+            CHECK(p != nullptr);
+            if (!p)
+                continue;
+            Block block = {p, size, uint8_t(g())};
+            memset(p, block.fill, size);
+            live.push_back(block);
+        }
+        else
+        {
+            size_t k = g() % live.size();
+            Block &block = live[k];
+            for (size_t j = 0; j < block.size; ++j)
+                CHECK(block.p[j] == block.fill);
+            PoolHeapFree(&heap, block.p);
+            live[k] = live.back();
+            live.pop_back();
+        }
+    }
+    uint32_t inUse = 0;
+    for (const PoolClass &c : heap.classes)
+        inUse += c.inUse;
+    CHECK(inUse == live.size());
+}
+
+int main()
+{
+    CheckSizes();
+    CheckFill();
+    CheckChurn();
+    return CheckResult("test_poolheap");
+}
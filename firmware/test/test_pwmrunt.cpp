@@ -0,0 +1,295 @@
+/*
+ * File:   test_pwmrunt.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:55 AM
+ */
+
+// Simulates ToolPWMBase's period changes against a model of TMR2/TMR3 and
+// OC4 in PWM mode, clock by clock, to show there are no runt pulses however
+// the settings change. ToolPWMBase needs the Harmony headers, so
+// UpdatePWM, StartPWM and PeriodTick are copied here with the registers
+// swapped for the model's: keep them in step with ToolPWMBase.cpp.
+//
+// Every period the output makes is checked against the settings asked for,
+// in the order asked for. The only period allowed to differ is the one
+// where the prescaler changes: until PeriodTick runs, the new period and
+// pulse count at the old prescaler, so that period can be out by the
+// latency's worth of clocks, scaled. The firmware only changes prescaler
+// for periods of tens of seconds, where that's nothing. The periods here
+// are kept short so the simulation is quick. That's all when the periods
+// are longer than the interrupt latency, as the firmware promises. With
+// shorter ones the output only has to settle on the last setting.
+
+#include <stdint.h>
+#include <random>
+#include <vector>
+#include "TimerSolver.h"
+#include "check.h"
+
+// The peripheral model: TMR2 counts every divisor clocks while on. At the
+// end of a period OC4R takes OC4RS and the interrupt flag is set. The
+// output is high while TMR2 is below OC4R.
+static struct
+{
+    bool on;
+    uint8_t tckps;
+    uint32_t prescaleCount, tmr, pr, ocr, ocrs;
+    bool flag, enable;
+} hw;
+
+static void WriteTMR2(uint32_t value)
+{
+    hw.tmr = value;
+    hw.prescaleCount = 0;
+}
+
+// Returns whether the period ended on this clock
+static bool Clock()
+{
+    if (!hw.on || ++hw.prescaleCount < TimerPrescaleDivisor(hw.tckps))
+        return false;
+    hw.prescaleCount = 0;
+    if (hw.tmr != hw.pr)
+    {
+        ++hw.tmr;
+        return false;
+    }
+    hw.tmr = 0;
+    hw.ocr = hw.ocrs;
+    hw.flag = true;
+    return true;
+}
+
+static bool Output()
+{
+    return hw.tmr < hw.ocr;
+}
+
+// ToolPWMBase, on the model
+struct PWMSetting
+{
+    TimerSetting timer;
+    uint32_t pulse;
+
+    bool SamePeriod(const PWMSetting &rhs) const
+        {return timer.prescale == rhs.timer.prescale && timer.counts == rhs.timer.counts;}
+    bool operator==(const PWMSetting &rhs) const {return SamePeriod(rhs) && pulse == rhs.pulse;}
+};
+
+static PWMSetting _current, _applying, _pending;
+static enum {Idle, WritePulse, WritePeriod} _step;
+static bool _running;
+
+static void StartPWM(const PWMSetting &setting)
+{
+    hw.enable = false;
+    _step = Idle;
+    hw.on = false;
+    WriteTMR2(0);
+    hw.tckps = setting.timer.prescale;
+    hw.pr = uint32_t(setting.timer.counts - 1);
+    hw.ocr = hw.ocrs = setting.pulse;
+    _current = _pending = setting;
+    hw.on = true;
+    _running = true;
+}
+
+static void UpdatePWM(const PWMSetting &setting)
+{
+    if (!_running || (_step == Idle && _current.pulse == 0))
+    {
+        StartPWM(setting);
+        return;
+    }
+    hw.enable = false;
+    _pending = setting;
+    if (_step != Idle)
+        hw.enable = true;
+    else if (_pending.SamePeriod(_current))
+    {
+        hw.ocrs = _pending.pulse;
+        _current = _pending;
+    }
+    else
+    {
+        _step = WritePulse;
+        hw.flag = false;
+        hw.enable = true;
+    }
+}
+
+static void PeriodTick()
+{
+    if (_step == WritePulse)
+    {
+        _applying = _pending;
+        hw.ocrs = _applying.pulse;
+        _step = WritePeriod;
+        return;
+    }
+
+    if (_applying.timer.prescale != _current.timer.prescale)
+    {
+        hw.on = false;
+        uint64_t clocks = uint64_t(hw.tmr) * TimerPrescaleDivisor(_current.timer.prescale);
+        uint32_t count = uint32_t(clocks / TimerPrescaleDivisor(_applying.timer.prescale));
+        if (hw.tmr < hw.ocr)
+        {
+            if (count >= hw.ocr)
+                count = hw.ocr - 1;
+        }
+        else if (count < hw.ocr)
+            count = hw.ocr;
+        hw.tckps = _applying.timer.prescale;
+        hw.pr = uint32_t(_applying.timer.counts - 1);
+        WriteTMR2(count > hw.pr ? 0 : count);
+        hw.on = true;
+    }
+    else
+    {
+        hw.pr = uint32_t(_applying.timer.counts - 1);
+        if (hw.tmr > hw.pr)
+            WriteTMR2(0);
+    }
+    _current = _applying;
+
+    if (_pending.SamePeriod(_current))
+    {
+        hw.ocrs = _pending.pulse;
+        _current = _pending;
+        _step = Idle;
+        hw.enable = false;
+    }
+    else
+    {
+        _applying = _pending;
+        hw.ocrs = _applying.pulse;
+    }
+}
+
+// Clocks from the flag being set to PeriodTick running
+static const int minLatency = 5, maxLatency = 60;
+
+static std::mt19937 g(7);
+
+static PWMSetting RandomSetting(bool shortPeriods, const std::vector<PWMSetting> &asked)
+{
+    PWMSetting s;
+    s.timer.prescale = g() % 4;
+    s.timer.counts = shortPeriods ? 2 + g() % 40 : 80 + g() % 400;
+    // Often keep the period, to go down the pulse-only path
+    if (!asked.empty() && g() % 2)
+        s.timer = asked.back().timer;
+    s.pulse = g() % (s.timer.counts + 1);
+    if (g() % 10 == 0)
+        s.pulse = 0;
+    else if (g() % 10 == 0)
+        s.pulse = s.timer.counts;
+    return s;
+}
+
+static void Run(bool shortPeriods)
+{
+    hw = {};
+    _running = false;
+    std::vector<PWMSetting> asked;
+    asked.push_back(RandomSetting(shortPeriods, asked));
+    asked[0].pulse |= 1;
+    UpdatePWM(asked[0]);
+
+    // Where the output has got to in the list asked for
+    size_t matched = 0;
+    long periodClocks = 0, highClocks = 0;
+    // The output only rises at the start of a period. Rising anywhere else
+    // is a runt pulse.
+    bool wasHigh = false, runt = false;
+    bool prescaleChanged = false;
+    uint8_t prescaleBefore = 0;
+    long nextAsk = g() % 5000, interruptAt = -1;
+    for (long t = 0; t < 300000; ++t)
+    {
+        if (t == nextAsk && t < 250000)
+        {
+            asked.push_back(RandomSetting(shortPeriods, asked));
+            // While the output's low UpdatePWM just starts again, so the
+            // measuring does too
+            bool restart = _step == Idle && _current.pulse == 0;
+            UpdatePWM(asked.back());
+            if (restart)
+            {
+                matched = asked.size() - 1;
+                periodClocks = highClocks = 0;
+                prescaleChanged = false;
+            }
+            nextAsk = t + 1 + (g() % 3 ? g() % 5000 : g() % 50);
+        }
+
+        if (hw.flag && hw.enable && interruptAt < 0)
+            interruptAt = t + minLatency + g() % (maxLatency - minLatency + 1);
+        if (interruptAt >= 0 && t >= interruptAt)
+        {
+            if (hw.flag && hw.enable)
+            {
+                hw.flag = false;
+                uint8_t before = hw.tckps;
+                PeriodTick();
+                if (hw.tckps != before)
+                {
+                    prescaleChanged = true;
+                    prescaleBefore = before;
+                }
+            }
+            interruptAt = -1;
+        }
+
+        ++periodClocks;
+        bool high = Output();
+        if (high && !wasHigh && periodClocks > 1)
+            runt = true;
+        wasHigh = high;
+        highClocks += high;
+        if (!Clock())
+            continue;
+
+        // A whole period has gone out
+        bool found = false;
+        for (size_t i = matched; i < asked.size() && !found; ++i)
+        {
+            long divisor = TimerPrescaleDivisor(asked[i].timer.prescale);
+            long period = divisor * long(asked[i].timer.counts);
+            long high = divisor * long(std::min<uint64_t>(asked[i].pulse, asked[i].timer.counts));
+            long slack = 0;
+            if (prescaleChanged)
+            {
+                // Until PeriodTick runs, the new period and pulse count at
+                // the old prescaler
+                long before = TimerPrescaleDivisor(prescaleBefore);
+                slack = maxLatency * std::max(before, divisor) / std::min(before, divisor) + before + divisor;
+            }
+            if (labs(periodClocks - period) <= slack && labs(highClocks - high) <= slack &&
+                labs((periodClocks - highClocks) - (period - high)) <= slack)
+            {
+                found = true;
+                matched = i;
+            }
+        }
+        if (!shortPeriods)
+        {
+            CHECK(found);
+            CHECK(!runt);
+        }
+        runt = false;
+        periodClocks = highClocks = 0;
+        prescaleChanged = false;
+    }
+    CHECK(_step == Idle);
+    CHECK(_current == asked.back());
+}
+
+int main()
+{
+    for (int run = 0; run < 400; ++run)
+        Run(run % 4 == 3);
+    return CheckResult("test_pwmrunt");
+}
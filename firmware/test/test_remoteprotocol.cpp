@@ -0,0 +1,244 @@
+/*
+ * File:   test_remoteprotocol.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 10:00 AM
+ */
+
+// The remote protocol's parser, fed through a ring like the console's
+// receive queue in random sized pieces, so frames wrap and arrive a bit at
+// a time. The streams are frames of every length up to the biggest, with
+// garbage and stray sync bytes between them, some frames corrupted, and
+// now and then nothing but random bytes. Every intact frame has to come
+// through once, in order, and nothing else may; a frame that's stuck is
+// dropped with Skip() as Remote.cpp does after its timeout.
+//
+// Every response has to parse too, and the biggest command, a Ping, has to
+// be echoed whole.
+
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "RemoteProtocol.h"
+#include "check.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+static std::mt19937 g(1234);
+
+static Bytes Frame(uint8_t command, uint8_t sequence, const Bytes &payload)
+{
+    // Sized for the whole frame up front, header, payload and CRC
+    size_t length = payload.size();
+    Bytes frame(5 + length + 2);
+    frame[0] = REMOTE_SYNC;
+    frame[1] = command;
+    frame[2] = sequence;
+    frame[3] = uint8_t(length);
+    frame[4] = uint8_t(length >> 8);
+    std::copy(payload.begin(), payload.end(), frame.begin() + 5);
+    uint16_t crc = RemoteCRC(0xffff, frame.data() + 1, 4 + length);
+    frame[5 + length] = uint8_t(crc);
+    frame[6 + length] = uint8_t(crc >> 8);
+    return frame;
+}
+
+// Echoes every command, like a Ping
+class Echo : public RemoteHandler
+{
+public:
+    std::vector<std::pair<uint8_t, Bytes>> got;
+    Bytes sent;
+
+    RemoteStatus OnCommand(uint8_t command, const RemoteSpan &payload, RemoteResponse &response)
+    {
+        Bytes copy(payload.Size());
+        payload.CopyTo(copy.data());
+        for (size_t i = 0; i < payload.Size(); ++i)
+            CHECK(payload[i] == copy[i]);
+        got.push_back(std::make_pair(command, copy));
+        return response.Put(payload) ? RemoteStatus::OK : RemoteStatus::BadLength;
+    }
+    void Send(const uint8_t *frame, size_t length) {sent.insert(sent.end(), frame, frame + length);}
+};
+
+// What the host sees of the responses
+class Responses : public RemoteHandler
+{
+public:
+    std::vector<std::pair<uint8_t, Bytes>> got;
+
+    RemoteStatus OnCommand(uint8_t command, const RemoteSpan &payload, RemoteResponse &response)
+    {
+        Bytes copy(payload.Size());
+        payload.CopyTo(copy.data());
+        got.push_back(std::make_pair(command, copy));
+        return RemoteStatus::OK;
+    }
+    void Send(const uint8_t *frame, size_t length) {}
+};
+
+// The console's receive queue
+class Ring
+{
+public:
+    Ring() : _head(0), _tail(0) {}
+
+    size_t Space() const {return (_head + sizeof(_data) - _tail - 1) % sizeof(_data);}
+    void Add(const uint8_t *p, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            _data[_tail] = p[i];
+            _tail = (_tail + 1) % sizeof(_data);
+        }
+    }
+    RemoteSpan Peek() const
+    {
+        if (_tail >= _head)
+            return RemoteSpan(_data + _head, _tail - _head, _data, 0);
+        return RemoteSpan(_data + _head, sizeof(_data) - _head, _data, _tail);
+    }
+    void Consume(size_t n) {_head = (_head + n) % sizeof(_data);}
+
+private:
+    uint8_t _data[2048];
+    size_t _head, _tail;
+};
+
+static void CheckCRC()
+{
+    // CRC-16/CCITT-FALSE's check value
+    CHECK(RemoteCRC(0xffff, (const uint8_t *) "123456789", 9) == 0x29b1);
+
+    // Split anywhere, a span's CRC is the same
+    uint8_t data[100];
+    for (size_t i = 0; i < sizeof(data); ++i)
+        data[i] = uint8_t(g());
+    uint16_t whole = RemoteCRC(0xffff, data, sizeof(data));
+    for (size_t split = 0; split <= sizeof(data); ++split)
+        CHECK(RemoteSpan(data, split, data + split, sizeof(data) - split).CRC(0xffff) == whole);
+}
+
+static void CheckLimits()
+{
+    // The biggest command echoes whole
+    Bytes payload(REMOTE_MAX_PAYLOAD);
+    for (uint8_t &b : payload)
+        b = uint8_t(g());
+    Bytes frame = Frame(uint8_t(RemoteCommand::Ping), 9, payload);
+    CHECK(frame.size() == REMOTE_MAX_FRAME);
+    Echo echo;
+    RemoteParser parser;
+    CHECK(parser.Parse(RemoteSpan(frame.data(), frame.size(), nullptr, 0), echo) == frame.size());
+    CHECK(echo.got.size() == 1 && echo.sent.size() == REMOTE_MAX_RESPONSE_FRAME);
+
+    Responses host;
+    RemoteParser hostParser;
+    CHECK(hostParser.Parse(RemoteSpan(echo.sent.data(), echo.sent.size(), nullptr, 0), host) == echo.sent.size());
+    CHECK(host.got.size() == 1 && hostParser.Errors() == 0);
+    if (host.got.size() == 1)
+    {
+        Bytes &response = host.got[0].second;
+        CHECK(host.got[0].first == (uint8_t(RemoteCommand::Ping) | REMOTE_RESPONSE));
+        CHECK(response.size() == REMOTE_MAX_PAYLOAD + 1 && response[0] == uint8_t(RemoteStatus::OK));
+        CHECK(!memcmp(response.data() + 1, payload.data(), payload.size()));
+    }
+
+    // One more than that is a bad length, for commands and responses both
+    payload.push_back(0);
+    frame = Frame(uint8_t(RemoteCommand::Ping), 9, payload);
+    Echo tooLong;
+    RemoteParser tooLongParser;
+    tooLongParser.Parse(RemoteSpan(frame.data(), frame.size(), nullptr, 0), tooLong);
+    CHECK(tooLong.got.empty() && tooLongParser.Errors() >= 1);
+    payload.push_back(0);
+    frame = Frame(uint8_t(RemoteCommand::Ping) | REMOTE_RESPONSE, 9, payload);
+    Responses tooLongHost;
+    RemoteParser tooLongHostParser;
+    tooLongHostParser.Parse(RemoteSpan(frame.data(), frame.size(), nullptr, 0), tooLongHost);
+    CHECK(tooLongHost.got.empty() && tooLongHostParser.Errors() >= 1);
+}
+
+static void Fuzz()
+{
+    size_t total = 0, lost = 0, spurious = 0;
+    for (int trial = 0; trial < 20000; ++trial)
+    {
+        Bytes stream;
+        std::vector<std::pair<uint8_t, Bytes>> expected;
+        for (int frames = 1 + g() % 8, i = 0; i < frames; ++i)
+        {
+            // Garbage with some sync bytes in it
+            size_t garbage = g() % 3 == 0 ? g() % 40 : 0;
+            for (size_t j = 0; j < garbage; ++j)
+                stream.push_back(g() % 4 == 0 ? REMOTE_SYNC : uint8_t(g()));
+
+            Bytes payload(g() % 3 == 0 ? g() % (REMOTE_MAX_PAYLOAD + 1) : g() % 16);
+            for (uint8_t &b : payload)
+                b = uint8_t(g());
+            uint8_t command = uint8_t(g() & 0x7f);
+            Bytes frame = Frame(command, uint8_t(i), payload);
+            if (g() % 10 == 0)
+                frame[g() % frame.size()] ^= uint8_t(1 << (g() % 8));
+            else
+                expected.push_back(std::make_pair(command, payload));
+            stream.insert(stream.end(), frame.begin(), frame.end());
+        }
+        if (g() % 20 == 0)
+        {
+            stream.resize(g() % 3000);
+            for (uint8_t &b : stream)
+                b = uint8_t(g());
+            expected.clear();
+        }
+
+        Ring ring;
+        Echo echo;
+        RemoteParser parser;
+        size_t position = 0;
+        while (position < stream.size() || ring.Peek().Size())
+        {
+            size_t n = std::min(std::min(size_t(1 + g() % 700), stream.size() - position), ring.Space());
+            ring.Add(stream.data() + position, n);
+            position += n;
+            RemoteSpan input = ring.Peek();
+            size_t done = parser.Parse(input, echo);
+            CHECK(done <= input.Size());
+            // Nothing more is coming, or can come: the timeout
+            if (done == 0 && (position == stream.size() || ring.Space() == 0))
+                done = RemoteParser::Skip();
+            ring.Consume(done);
+        }
+
+        // The intact frames came through in order. A corrupted one can only
+        // look whole if it has the CRC of what it became.
+        size_t k = 0;
+        for (auto &got : echo.got)
+        {
+            if (k < expected.size() && got == expected[k])
+                ++k;
+            else
+                ++spurious;
+        }
+        lost += expected.size() - k;
+        total += expected.size();
+
+        Responses host;
+        RemoteParser hostParser;
+        CHECK(hostParser.Parse(RemoteSpan(echo.sent.data(), echo.sent.size(), nullptr, 0), host) == echo.sent.size());
+        CHECK(host.got.size() == echo.got.size());
+    }
+    fprintf(stdout, "%zu frames, %zu lost, %zu spurious\n", total, lost, spurious);
+    CHECK(lost == 0);
+    CHECK(spurious <= total / 10000);
+}
+
+int main()
+{
+    CheckCRC();
+    CheckLimits();
+    Fuzz();
+    return CheckResult("test_remoteprotocol");
+}
@@ -0,0 +1,241 @@
+/*
+ * File:   test_settingsjournal.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:55 AM
+ */
+
+// The settings journal against power loss. Random histories of saves are
+// run on a simulated flash that's cut off before each flash operation in
+// turn, including part way through an erase, and after every cut:
+//
+//  - each field loads as a value that was actually saved, and no older than
+//    the last save that finished
+//  - saving and loading again afterwards works
+//  - until there's a journal, the first page, which holds the settings from
+//    before the journal, hasn't been touched
+//
+// The pages are small so blocks and pages fill up often.
+
+#include <string.h>
+#include <random>
+#include <vector>
+#include "SettingsJournal.h"
+#include "check.h"
+
+struct Data
+{
+    uint32_t a;
+    uint8_t b;
+    int64_t c;
+    char name[40];
+    uint16_t d;
+};
+
+static const JournalField fields[] = {
+    {1, JournalType::Unsigned, offsetof(Data, a), sizeof(Data::a)},
+    {2, JournalType::Unsigned, offsetof(Data, b), sizeof(Data::b)},
+    {3, JournalType::Signed, offsetof(Data, c), sizeof(Data::c)},
+    {4, JournalType::String, offsetof(Data, name), sizeof(Data::name)},
+    {5, JournalType::Unsigned, offsetof(Data, d), sizeof(Data::d)}
+};
+static const int fieldCount = sizeof(fields) / sizeof(fields[0]);
+
+static const size_t pageWords = 128, blockWords = 32;
+static const uint32_t legacyFill = 0x01020304;
+
+static std::mt19937 g(3);
+
+// Flash that loses power after a number of operations. Writing a word
+// that isn't erased, or anything while busy, is a bug in the journal.
+class SimFlash : public JournalFlash
+{
+public:
+    uint32_t words[2][pageWords];
+    long operations = 0, limit = -1;
+    bool dead = false;
+    int busy = 0;
+
+    SimFlash()
+    {
+        // Page 0 as the firmware before the journal left it
+        for (size_t i = 0; i < pageWords; ++i)
+        {
+            words[0][i] = legacyFill;
+            words[1][i] = 0;
+        }
+    }
+    uint32_t Read(int page, size_t word) const {return words[page][word];}
+    bool IsBusy() const {return busy > 0;}
+    void Write(int page, size_t word, uint32_t value)
+    {
+        if (!Start())
+            return;
+        CHECK(words[page][word] == 0xffffffff);
+        words[page][word] = value;
+    }
+    void Erase(int page)
+    {
+        if (limit >= 0 && operations == limit)
+        {
+            // The power went mid-erase: some words got erased
+            for (size_t i = 0; i < pageWords; ++i)
+            {
+                if (g() % 2)
+                    words[page][i] = 0xffffffff;
+            }
+        }
+        if (!Start())
+            return;
+        for (size_t i = 0; i < pageWords; ++i)
+            words[page][i] = 0xffffffff;
+    }
+    bool LegacyIntact() const
+    {
+        for (size_t i = 0; i < pageWords; ++i)
+        {
+            if (words[0][i] != legacyFill)
+                return false;
+        }
+        return true;
+    }
+
+private:
+    bool Start()
+    {
+        CHECK(busy == 0);
+        if (limit >= 0 && operations >= limit)
+        {
+            dead = true;
+            return false;
+        }
+        ++operations;
+        busy = g() % 3;
+        return true;
+    }
+};
+
+static void Drain(SimFlash &flash, SettingsJournal &journal)
+{
+    for (int i = 0; i < 100000 && !flash.dead; ++i)
+    {
+        if (flash.busy)
+            --flash.busy;
+        if (!journal.Step())
+            break;
+    }
+}
+
+static SettingsJournal *NewJournal(SimFlash &flash)
+{
+    return new SettingsJournal(flash, pageWords, blockWords, fields, fieldCount, sizeof(Data), 1, nullptr);
+}
+
+// Saves the history until the power goes. Returns the last save that
+// finished, or -1.
+static int Replay(SimFlash &flash, const std::vector<Data> &history)
+{
+    Data loaded = {};
+    SettingsJournal *journal = NewJournal(flash);
+    journal->Load(&loaded);
+    int done = -1;
+    for (size_t i = 0; i < history.size() && !flash.dead; ++i)
+    {
+        journal->Save(&history[i]);
+        Drain(flash, *journal);
+        if (!flash.dead)
+            done = int(i);
+    }
+    delete journal;
+    return done;
+}
+
+static std::vector<Data> RandomHistory()
+{
+    std::vector<Data> history;
+    Data d = {};
+    d.a = 1;
+    strcpy(d.name, "x");
+    history.push_back(d);
+    for (int saves = 1 + g() % 40; saves > 0; --saves)
+    {
+        for (int changes = 1 + g() % 5; changes > 0; --changes)
+        {
+            switch (g() % 5)
+            {
+            case 0: d.a = g(); break;
+            case 1: d.b = g(); break;
+            case 2: d.c = int64_t(int32_t(g())) << 8; break;
+            case 3: snprintf(d.name, sizeof(d.name), "f%u", unsigned(g())); break;
+            case 4: d.d = g(); break;
+            }
+        }
+        history.push_back(d);
+    }
+    return history;
+}
+
+static bool SameField(const Data &x, const Data &y, const JournalField &field)
+{
+    return !memcmp((const uint8_t *) &x + field.offset, (const uint8_t *) &y + field.offset, field.size);
+}
+
+int main()
+{
+    long cuts = 0;
+    for (int trial = 0; trial < 200; ++trial)
+    {
+        std::vector<Data> history = RandomHistory();
+
+        SimFlash whole;
+        CHECK(Replay(whole, history) == int(history.size()) - 1);
+        long operations = whole.operations;
+        {
+            Data loaded = {};
+            SettingsJournal *journal = NewJournal(whole);
+            CHECK(journal->Load(&loaded));
+            CHECK(!memcmp(&loaded, &history.back(), sizeof(loaded)));
+            delete journal;
+        }
+
+        for (long limit = 0; limit <= operations; ++limit, ++cuts)
+        {
+            SimFlash flash;
+            flash.limit = limit;
+            int done = Replay(flash, history);
+            flash.limit = -1;
+            flash.dead = false;
+            flash.busy = 0;
+
+            Data loaded = {};
+            SettingsJournal *journal = NewJournal(flash);
+            bool found = journal->Load(&loaded);
+            if (!found)
+                CHECK(flash.LegacyIntact());
+            for (const JournalField &field : fields)
+            {
+                bool saved = false;
+                for (size_t i = done < 0 ? 0 : done; i < history.size() && !saved; ++i)
+                    saved = SameField(loaded, history[i], field);
+                if (!found && done < 0)
+                    saved |= SameField(loaded, Data(), field);
+                CHECK(saved);
+            }
+
+            // The journal carries on from wherever it was cut off
+            Data next = loaded;
+            next.a ^= 0x1234;
+            next.d += 7;
+            journal->Save(&next);
+            Drain(flash, *journal);
+            delete journal;
+            Data reloaded = {};
+            journal = NewJournal(flash);
+            CHECK(journal->Load(&reloaded));
+            CHECK(!memcmp(&reloaded, &next, sizeof(next)));
+            delete journal;
+        }
+    }
+    fprintf(stdout, "%ld power cuts checked\n", cuts);
+    return CheckResult("test_settingsjournal");
+}
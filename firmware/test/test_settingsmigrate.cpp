@@ -0,0 +1,294 @@
+/*
+ * File:   test_settingsmigrate.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:55 AM
+ */
+
+// The settings journal's records, layouts and block search:
+//
+//  - the CRC is the usual CRC-32, against a bit at a time one
+//  - snapshots and field records decode to what was encoded
+//  - FindLastBlock agrees with looking at every block
+//  - a load only reads the last block or two, however full the page is
+//  - settings saved with one layout load into another, with fields resized,
+//    moved, dropped and added, and the migration runs once
+//  - a page with the marker but no snapshot, such as one in the journal's
+//    first layout, isn't loaded, and the next save starts a good journal
+
+#include <string.h>
+#include <random>
+#include <vector>
+#include "SettingsJournal.h"
+#include "check.h"
+
+struct Data
+{
+    uint32_t a;
+    uint8_t b;
+    int64_t c;
+    char name[40];
+    uint16_t d;
+};
+
+static const JournalField fields[] = {
+    {1, JournalType::Unsigned, offsetof(Data, a), sizeof(Data::a)},
+    {2, JournalType::Unsigned, offsetof(Data, b), sizeof(Data::b)},
+    {3, JournalType::Signed, offsetof(Data, c), sizeof(Data::c)},
+    {4, JournalType::String, offsetof(Data, name), sizeof(Data::name)},
+    {5, JournalType::Unsigned, offsetof(Data, d), sizeof(Data::d)}
+};
+static const int fieldCount = sizeof(fields) / sizeof(fields[0]);
+
+// Version 2: c shrinks and moves to the front, name shrinks, d goes and e
+// is new
+struct Data2
+{
+    int32_t c;
+    uint32_t a;
+    char name[8];
+    uint8_t b;
+    uint64_t e;
+};
+
+static const JournalField fields2[] = {
+    {3, JournalType::Signed, offsetof(Data2, c), sizeof(Data2::c)},
+    {1, JournalType::Unsigned, offsetof(Data2, a), sizeof(Data2::a)},
+    {4, JournalType::String, offsetof(Data2, name), sizeof(Data2::name)},
+    {2, JournalType::Unsigned, offsetof(Data2, b), sizeof(Data2::b)},
+    {6, JournalType::Unsigned, offsetof(Data2, e), sizeof(Data2::e)}
+};
+static const int fieldCount2 = sizeof(fields2) / sizeof(fields2[0]);
+
+static int migrations;
+static uint32_t migratedFrom;
+
+static void Migrate(uint32_t version, void *data)
+{
+    ++migrations;
+    migratedFrom = version;
+    ((Data2 *) data)->e = 42;
+}
+
+static const size_t pageWords = 256, blockWords = 64;
+
+static std::mt19937 g(5);
+
+class SimFlash : public JournalFlash
+{
+public:
+    uint32_t words[2][pageWords];
+    mutable long reads = 0;
+
+    SimFlash() {memset(words, 0, sizeof(words));}
+    uint32_t Read(int page, size_t word) const {++reads; return words[page][word];}
+    bool IsBusy() const {return false;}
+    void Write(int page, size_t word, uint32_t value)
+    {
+        CHECK(words[page][word] == 0xffffffff);
+        words[page][word] = value;
+    }
+    void Erase(int page) {memset(words[page], 0xff, sizeof(words[page]));}
+};
+
+static void Drain(SettingsJournal &journal)
+{
+    for (int i = 0; i < 100000 && journal.Step(); ++i)
+    {
+    }
+}
+
+static uint32_t ReferenceCRC(const uint32_t *words, size_t count)
+{
+    const uint8_t *bytes = (const uint8_t *) words;
+    uint32_t crc = 0xffffffff;
+    for (size_t i = 0; i < count * 4; ++i)
+    {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+    }
+    crc = ~crc;
+    return crc == 0xffffffff ? 0 : crc;
+}
+
+static Data RandomData()
+{
+    Data d = {};
+    d.a = g();
+    d.b = g();
+    d.c = int64_t(int32_t(g())) << (g() % 32);
+    snprintf(d.name, sizeof(d.name), "name%u", unsigned(g()));
+    d.d = g();
+    return d;
+}
+
+static void CheckRecords()
+{
+    for (int i = 0; i < 1000; ++i)
+    {
+        uint32_t words[20];
+        size_t count = g() % 20;
+        for (size_t w = 0; w < count; ++w)
+            words[w] = g();
+        CHECK(SettingsJournal::CRC(words, count) == ReferenceCRC(words, count));
+    }
+
+    SimFlash flash;
+    SettingsJournal journal(flash, pageWords, blockWords, fields, fieldCount, sizeof(Data), 1, nullptr);
+    uint32_t record[blockWords];
+    for (int i = 0; i < 1000; ++i)
+    {
+        Data d = RandomData(), decoded = {};
+        size_t count = journal.EncodeSnapshot(&d, record);
+        uint32_t version = 0;
+        CHECK(journal.DecodeSnapshot(record, count, &decoded, version));
+        CHECK(version == 1);
+        CHECK(!memcmp(&d, &decoded, sizeof(d)));
+        // Any corruption fails the CRC
+        record[g() % count] ^= 1 << (g() % 32);
+        CHECK(!journal.DecodeSnapshot(record, count, &decoded, version));
+
+        int field = g() % fieldCount;
+        count = journal.EncodeField(field, &d, record);
+        CHECK(record[count - 1] == SettingsJournal::CRC(record, count - 1));
+        CHECK(((record[0] >> 16) & 0xff) == fields[field].tag);
+        Data one = {};
+        journal.DecodeField(fields[field].tag, (const uint8_t *) (record + 1), record[0] & 0xffff, &one);
+        CHECK(!memcmp((uint8_t *) &one + fields[field].offset, (uint8_t *) &d + fields[field].offset,
+            fields[field].size));
+    }
+}
+
+static void CheckHistories()
+{
+    long mostReads = 0;
+    for (int trial = 0; trial < 300; ++trial)
+    {
+        SimFlash flash;
+        Data d = {}, last = {};
+        {
+            SettingsJournal journal(flash, pageWords, blockWords, fields, fieldCount, sizeof(Data), 1, nullptr);
+            journal.Load(&d);
+            for (int saves = 1 + g() % 80; saves > 0; --saves)
+            {
+                Data next = RandomData();
+                // Mostly change a field or two
+                if (g() % 4)
+                {
+                    next = d;
+                    next.a = g();
+                    if (g() % 2)
+                        next.d = g();
+                }
+                d = next;
+                journal.Save(&d);
+                Drain(journal);
+            }
+            last = d;
+
+            for (int page = 0; page < 2; ++page)
+            {
+                if (flash.words[page][0] == 0xffffffff)
+                    continue;
+                int linear = 0;
+                for (size_t block = 1; block < pageWords / blockWords; ++block)
+                {
+                    if (flash.words[page][block * blockWords] == 0xffffffff)
+                        break;
+                    linear = int(block);
+                }
+                CHECK(journal.FindLastBlock(page) == linear);
+            }
+        }
+
+        // Load it back, counting the reads
+        Data loaded = {};
+        flash.reads = 0;
+        SettingsJournal journal(flash, pageWords, blockWords, fields, fieldCount, sizeof(Data), 1, nullptr);
+        CHECK(journal.Load(&loaded));
+        CHECK(!memcmp(&loaded, &last, sizeof(last)));
+        mostReads = std::max(mostReads, flash.reads);
+
+        // Into version 2
+        Data2 moved = {};
+        moved.e = 7;
+        migrations = 0;
+        SettingsJournal journal2(flash, pageWords, blockWords, fields2, fieldCount2, sizeof(Data2), 2, Migrate);
+        CHECK(journal2.Load(&moved));
+        char name[8];
+        strncpy(name, last.name, sizeof(name));
+        name[sizeof(name) - 1] = '\0';
+        CHECK(moved.a == last.a && moved.b == last.b && moved.c == int32_t(last.c));
+        CHECK(!strcmp(moved.name, name));
+        CHECK(moved.e == 42);
+        CHECK(migrations == 1 && migratedFrom == 1);
+
+        // Saving writes a version 2 snapshot, so it doesn't migrate again
+        moved.b ^= 1;
+        journal2.Save(&moved);
+        Drain(journal2);
+        Data2 reloaded = {};
+        migrations = 0;
+        SettingsJournal journal3(flash, pageWords, blockWords, fields2, fieldCount2, sizeof(Data2), 2, Migrate);
+        CHECK(journal3.Load(&reloaded));
+        CHECK(!memcmp(&reloaded, &moved, sizeof(moved)));
+        CHECK(migrations == 0);
+    }
+    fprintf(stdout, "A load read at most %ld words\n", mostReads);
+    CHECK(mostReads <= long(2 * blockWords + 8));
+}
+
+// A page with a header, then records with no snapshot before them
+static void CheckForeignPage()
+{
+    for (int trial = 0; trial < 100; ++trial)
+    {
+        SimFlash flash;
+        int page = g() % 2;
+        flash.Erase(page);
+        flash.words[page][0] = 0x4c4d534a;
+        flash.words[page][1] = g();
+
+        SettingsJournal writer(flash, pageWords, blockWords, fields, fieldCount, sizeof(Data), 1, nullptr);
+        Data d = RandomData();
+        uint32_t record[blockWords];
+        size_t word = 2;
+        for (int i = g() % 8; i >= 0; --i)
+        {
+            d.a = g();
+            size_t count = writer.EncodeField(0, &d, record);
+            memcpy(flash.words[page] + word, record, count * 4);
+            word += count;
+        }
+
+        Data2 loaded = {};
+        loaded.e = 7;
+        Data2 before = loaded;
+        migrations = 0;
+        {
+            SettingsJournal journal(flash, pageWords, blockWords, fields2, fieldCount2, sizeof(Data2), 2, Migrate);
+            CHECK(!journal.Load(&loaded));
+            CHECK(!memcmp(&loaded, &before, sizeof(loaded)));
+            CHECK(migrations == 0);
+
+            loaded.a = g();
+            journal.Save(&loaded);
+            Drain(journal);
+        }
+
+        Data2 reloaded = {};
+        SettingsJournal journal(flash, pageWords, blockWords, fields2, fieldCount2, sizeof(Data2), 2, Migrate);
+        CHECK(journal.Load(&reloaded));
+        CHECK(!memcmp(&reloaded, &loaded, sizeof(loaded)));
+        CHECK(migrations == 0);
+    }
+}
+
+int main()
+{
+    CheckRecords();
+    CheckHistories();
+    CheckForeignPage();
+    return CheckResult("test_settingsmigrate");
+}
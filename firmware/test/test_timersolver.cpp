@@ -0,0 +1,158 @@
+/*
+ * File:   test_timersolver.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 9:50 AM
+ */
+
+// The timer solver against brute force. For 16-bit timers every prescaler
+// and every count is tried. For 32-bit timers that's too many, but the error
+// only grows moving away from the ideal divisor, so trying a few counts
+// either side of it for each prescaler, and both ends of the range, finds
+// the same best.
+//
+// The counts are what the timer divides by, so the period register gets one
+// less. The frequencies here are clock / (prescaler * counts), which a
+// setting that was out by one would fail.
+
+#include <stdint.h>
+#include <random>
+#include "TimerSolver.h"
+#include "check.h"
+
+typedef unsigned __int128 uint128;
+
+static const uint32_t timerClock = 100000000;
+
+// a * b as 256 bits, for comparing errors as fractions exactly
+static void Multiply(uint128 a, uint64_t b, uint128 &hi, uint128 &lo)
+{
+    uint128 p0 = (uint128) (uint64_t) a * b, p1 = (a >> 64) * b;
+    lo = p0 + (p1 << 64);
+    hi = (p1 >> 64) + (lo < p0);
+}
+
+// Is C / d1 nearer T than C / d2? The errors are |C - T d| / d. Ties go to
+// the most counts.
+static bool Nearer(uint128 c, uint128 t, uint64_t d1, uint64_t counts1, uint64_t d2, uint64_t counts2)
+{
+    uint128 e1 = c > t * d1 ? c - t * d1 : t * d1 - c;
+    uint128 e2 = c > t * d2 ? c - t * d2 : t * d2 - c;
+    uint128 hi1, lo1, hi2, lo2;
+    Multiply(e1, d2, hi1, lo1);
+    Multiply(e2, d1, hi2, lo2);
+    if (hi1 != hi2)
+        return hi1 < hi2;
+    if (lo1 != lo2)
+        return lo1 < lo2;
+    return counts1 > counts2;
+}
+
+static TimerSetting BruteForce(uint64_t nanohertz, uint64_t maxCounts, bool everyCount)
+{
+    uint128 c = (uint128) timerClock * fixed::scale;
+    TimerSetting best = {0, 0};
+    uint64_t bestDivisor = 0;
+    for (uint8_t prescale = 0; prescale < 8; ++prescale)
+    {
+        uint64_t divisor = TimerPrescaleDivisor(prescale);
+        uint64_t ideal = uint64_t(c / nanohertz) / divisor;
+        uint64_t from = 2, to = maxCounts;
+        if (!everyCount)
+        {
+            from = ideal > 8 ? ideal - 6 : 2;
+            to = ideal + 6 < maxCounts ? ideal + 6 : maxCounts;
+            if (from > to)
+                from = to;
+        }
+        for (uint64_t counts = from; counts <= to + 2; ++counts)
+        {
+            // The two extra are the ends of the range
+            uint64_t n = counts <= to ? counts : counts == to + 1 ? 2 : maxCounts;
+            if (!bestDivisor || Nearer(c, nanohertz, n * divisor, n, bestDivisor, best.counts))
+            {
+                best = {prescale, n};
+                bestDivisor = n * divisor;
+            }
+        }
+    }
+    return best;
+}
+
+static void CheckSolve(uint64_t nanohertz, uint64_t maxCounts, bool everyCount)
+{
+    TimerSetting got = SolveTimer(timerClock, fixed((long long) nanohertz, true), maxCounts);
+    TimerSetting want = BruteForce(nanohertz, maxCounts, everyCount);
+    CHECK(got.counts == want.counts);
+    CHECK(TimerPrescaleDivisor(got.prescale) == TimerPrescaleDivisor(want.prescale));
+    CHECK(got.counts >= 2 && got.counts <= maxCounts);
+}
+
+int main()
+{
+    std::mt19937_64 g(1);
+
+    // Every prescaler and count, at frequencies from 10 mHz to 100 MHz
+    for (int i = 0; i < 200; ++i)
+    {
+        double hertz = pow(10, -2 + 10.0 * (g() % 1000000) / 1e6);
+        CheckSolve(uint64_t(hertz * 1e9) + g() % 1000, TIMER_MAX_COUNTS_16, true);
+    }
+
+    // Around the ideal, at random frequencies and at every whole hertz
+    // from 1 Hz to 100 kHz
+    for (int i = 0; i < 300000; ++i)
+    {
+        double hertz = pow(10, -3 + 11.0 * (g() % 1000000) / 1e6);
+        uint64_t nanohertz = uint64_t(hertz * 1e9) + g() % 1000 + 1;
+        CheckSolve(nanohertz, i & 1 ? TIMER_MAX_COUNTS_16 : TIMER_MAX_COUNTS_32, false);
+    }
+    for (uint64_t hertz = 1; hertz <= 100000; ++hertz)
+    {
+        CheckSolve(hertz * fixed::scale, TIMER_MAX_COUNTS_32, false);
+        CheckSolve(hertz * fixed::scale, TIMER_MAX_COUNTS_16, false);
+    }
+
+    // Durations: the error is just the difference in clocks
+    for (int i = 0; i < 1000000; ++i)
+    {
+        uint64_t clocks = g() >> (g() % 64);
+        uint64_t maxCounts = i & 1 ? TIMER_MAX_COUNTS_16 : TIMER_MAX_COUNTS_32;
+        TimerSetting got = SolveTimerCounts(clocks, maxCounts);
+        uint64_t gotDivisor = TimerPrescaleDivisor(got.prescale) * got.counts;
+        uint64_t bestError = ~0ULL, bestCounts = 0;
+        for (uint8_t prescale = 0; prescale < 8; ++prescale)
+        {
+            uint64_t divisor = TimerPrescaleDivisor(prescale);
+            for (uint64_t counts : {clocks / divisor, clocks / divisor + 1, (uint64_t) 2, maxCounts})
+            {
+                counts = counts < 2 ? 2 : counts > maxCounts ? maxCounts : counts;
+                uint64_t d = counts * divisor;
+                uint64_t error = d > clocks ? d - clocks : clocks - d;
+                if (error < bestError || (error == bestError && counts > bestCounts))
+                {
+                    bestError = error;
+                    bestCounts = counts;
+                }
+            }
+        }
+        CHECK((gotDivisor > clocks ? gotDivisor - clocks : clocks - gotDivisor) == bestError);
+        CHECK(got.counts == bestCounts);
+    }
+
+    // Exact divisors come out exact, with the most counts
+    TimerSetting s = SolveTimer(timerClock, fixed(1000), TIMER_MAX_COUNTS_32);
+    CHECK(s.prescale == 0 && s.counts == 100000);
+    CHECK(TimerFrequency(timerClock, s) == fixed(1000));
+    s = SolveTimer(timerClock, fixed(1000), TIMER_MAX_COUNTS_16);
+    CHECK(TimerPrescaleDivisor(s.prescale) * s.counts == 100000);
+    CHECK(s.prescale == 1 && s.counts == 50000);
+    s = SolveTimer(timerClock, fixed(3000000), TIMER_MAX_COUNTS_32);
+    CHECK(s.counts == 33);
+    CHECK(TimerFrequency(timerClock, s) == fixed((long long) 3030303030303030LL, true));
+    // 0 Hz is the slowest there is
+    s = SolveTimer(timerClock, fixed(0), TIMER_MAX_COUNTS_16);
+    CHECK(s.prescale == 7 && s.counts == TIMER_MAX_COUNTS_16);
+
+    return CheckResult("test_timersolver");
+}
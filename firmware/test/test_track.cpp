@@ -0,0 +1,241 @@
+/*
+ * File:   test_track.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 11:25 AM
+ */
+
+// Track parsing and playback:
+//
+//  - small GPX and CSV files: headings skipped, points with and without
+//    times, ISO times with zones, self-closing and namespaced GPX points,
+//    points that go back in time dropped
+//  - a large track, a million points as CSV and as GPX, made up as it's
+//    read so only the player holds any of it. It heads east along the
+//    equator at a steady speed, round the world and across the date line,
+//    and is played at 1 to 10 fixes a second; every fix must be where and
+//    as fast as the track says. Nothing may be allocated along the way, and
+//    the player's size is all the memory it needs.
+//
+// Prints how fast the large tracks parse and play on the host.
+
+#include <string.h>
+#include <stdlib.h>
+#include <string>
+#include <new>
+#include "Track.h"
+#include "check.h"
+
+static size_t allocations;
+
+void *operator new(size_t size)
+{
+    ++allocations;
+    void *p = malloc(size);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+// A file held in memory, read in odd sized pieces
+struct TextFile
+{
+    const char *text;
+    size_t size, position;
+};
+
+static size_t ReadText(void *context, char *buffer, size_t size)
+{
+    TextFile *file = (TextFile *) context;
+    size_t bytes = file->size - file->position;
+    if (bytes > size)
+        bytes = size;
+    if (bytes > 37)
+        bytes = 37;
+    memcpy(buffer, file->text + file->position, bytes);
+    file->position += bytes;
+    return bytes;
+}
+
+// Play a small file, one fix a second, and collect where it goes
+static std::string Play(const char *text)
+{
+    TextFile file = {text, strlen(text), 0};
+    TrackPlayer player(ReadText, &file);
+    std::string positions;
+    if (!player.Start())
+        return "none";
+    TrackFix fix;
+    for (uint32_t ms = 0; ; ms += 1000)
+    {
+        bool more = player.At(ms, fix);
+        char buf[40];
+        snprintf(buf, sizeof(buf), "%d,%d ", fix.latitude, fix.longitude);
+        positions += buf;
+        if (!more)
+            break;
+    }
+    return positions;
+}
+
+// The large track: due east along the equator, 0.001 degrees a second
+#define STEP 10
+#define START_LONGITUDE 1790000
+#define MAX_LONGITUDE 1800000
+
+static int32_t Longitude(int64_t e4)
+{
+    e4 = (e4 + MAX_LONGITUDE) % (2 * MAX_LONGITUDE);
+    if (e4 < 0)
+        e4 += 2 * MAX_LONGITUDE;
+    return int32_t(e4 - MAX_LONGITUDE);
+}
+
+struct Generator
+{
+    bool gpx;
+    uint32_t points, next;
+    char line[160];
+    size_t lineLength, linePosition;
+    uint64_t bytes;
+    uint32_t largestRead;
+};
+
+static size_t FormatCoordinate(char *p, int32_t e4)
+{
+    uint32_t a = e4 < 0 ? -e4 : e4;
+    return sprintf(p, "%s%u.%04u", e4 < 0 ? "-" : "", a / 10000, a % 10000);
+}
+
+static void MakeLine(Generator &g)
+{
+    char *p = g.line;
+    uint32_t i = g.next++;
+    if (g.gpx)
+    {
+        if (i == 0)
+            p += sprintf(p, "<?xml version=\"1.0\"?>\n<gpx><trk><trkseg>\n");
+        p += sprintf(p, "  <trkpt lat=\"0.0000\" lon=\"");
+        p += FormatCoordinate(p, Longitude(START_LONGITUDE + int64_t(i) * STEP));
+        p += sprintf(p, "\"><ele>12.5</ele><time>2020-01-%02uT%02u:%02u:%02uZ</time></trkpt>\n",
+            1 + i / 86400, i / 3600 % 24, i / 60 % 60, i % 60);
+        if (i + 1 == g.points)
+            p += sprintf(p, "</trkseg></trk></gpx>\n");
+    }
+    else
+    {
+        if (i == 0)
+            p += sprintf(p, "time,lat,lon\r\n");
+        p += sprintf(p, "%u,0.0000,", i);
+        p += FormatCoordinate(p, Longitude(START_LONGITUDE + int64_t(i) * STEP));
+        p += sprintf(p, "\r\n");
+    }
+    g.lineLength = p - g.line;
+    g.linePosition = 0;
+}
+
+static size_t Generate(void *context, char *buffer, size_t size)
+{
+    Generator &g = *(Generator *) context;
+    if (size > g.largestRead)
+        g.largestRead = size;
+    size_t bytes = 0;
+    while (bytes < size)
+    {
+        if (g.linePosition == g.lineLength)
+        {
+            if (g.next == g.points)
+                break;
+            MakeLine(g);
+        }
+        size_t n = g.lineLength - g.linePosition;
+        if (n > size - bytes)
+            n = size - bytes;
+        memcpy(buffer + bytes, g.line + g.linePosition, n);
+        g.linePosition += n;
+        bytes += n;
+    }
+    g.bytes += bytes;
+    return bytes;
+}
+
+static void PlayLarge(bool gpx, uint32_t points, uint32_t fixesPerSecond)
+{
+    Generator g = {};
+    g.gpx = gpx;
+    g.points = points;
+    TrackPlayer player(Generate, &g);
+    allocations = 0;
+    double t = CheckNow();
+    CHECK(player.Start());
+    TrackFix fix;
+    uint32_t fixes = 0, bad = 0;
+    uint32_t step = 1000 / fixesPerSecond;
+    uint32_t end = (points - 1) * 1000;
+    for (uint32_t ms = 0; ms < end; ms += step, ++fixes)
+    {
+        CHECK(player.At(ms, fix));
+        int32_t expected = Longitude(START_LONGITUDE + int64_t(ms) * STEP / 1000);
+        // The date line is the same place either way
+        bool same = fix.longitude == expected ||
+            (abs(fix.longitude) == MAX_LONGITUDE && abs(expected) == MAX_LONGITUDE);
+        if (fix.latitude != 0 || !same || fix.course != 900 || fix.speed < 111193 || fix.speed > 111197)
+            ++bad;
+    }
+    CHECK(bad == 0);
+    CHECK(!player.At(end, fix) && fix.speed == 0);
+    t = CheckNow() - t;
+    CHECK(allocations == 0);
+    CHECK(g.largestRead <= 256);
+    fprintf(stdout, "%s, %u points, %.1f MB at %u Hz: %.2f s, %.0f points/s, %.1f MB/s, %u fixes\n",
+        gpx ? "GPX" : "CSV", points, g.bytes / 1e6, fixesPerSecond, t, points / t, g.bytes / 1e6 / t, fixes);
+}
+
+int main()
+{
+    // CSV: a heading, a blank line, points without times a second apart
+    CHECK(Play("lat,lon\n\n1.0,2.0\n1.0001,2.0002\n1.0002,2.0004") ==
+        "10000,20000 10001,20002 10002,20004 ");
+    // Decimal seconds, with a point going back in time dropped
+    CHECK(Play("0,0,0\r\n2,0.0002,0\r\n1,5,5\r\n4.0,0.0004,0\r\n") ==
+        "0,0 1,0 2,0 3,0 4,0 ");
+    // ISO times across a zone change, the same instant
+    CHECK(Play("2020-01-01T00:00:00Z,0,0\n2020-01-01T01:00:02+01:00,0,0.0002\n") ==
+        "0,0 0,1 0,2 ");
+    // GPX, namespaced and self-closing, with and without times
+    CHECK(Play("<?xml version='1.0'?>\n<gpx:gpx><gpx:trk><gpx:trkseg>"
+        "<gpx:trkpt lat='10.5' lon='-20.25'><time>2021-06-01T12:00:00Z</time></gpx:trkpt>"
+        "<gpx:trkpt lat=\"10.5002\" lon=\"-20.2502\"><time>2021-06-01T12:00:02Z</time></gpx:trkpt>"
+        "</gpx:trkseg></gpx:trk></gpx:gpx>") ==
+        "105000,-202500 105001,-202501 105002,-202502 ");
+    CHECK(Play("<gpx><rte><rtept lat=\"1\" lon=\"1\"/><rtept lat=\"1\" lon=\"1.0001\"/></rte></gpx>") ==
+        "10000,10000 10000,10001 ");
+    // Points off the earth aren't points
+    CHECK(Play("91,0\n0,181\n") == "none");
+    CHECK(Play("") == "none");
+
+    // Speed and course: a second north at the equator is 0.0001 degrees
+    // north, 11.1 m
+    TextFile file = {"0,0\n0.0001,0\n0.0001,0.0001\n0,0.0001\n", 0, 0};
+    file.size = strlen(file.text);
+    TrackPlayer player(ReadText, &file);
+    CHECK(player.Start());
+    TrackFix fix;
+    CHECK(player.At(500, fix) && fix.course == 0 && fix.speed == 11120);
+    CHECK(player.At(1500, fix) && fix.course == 900 && fix.speed == 11120);
+    CHECK(player.At(2500, fix) && fix.course == 1800 && fix.speed == 11120);
+    CHECK(!player.At(3000, fix) && fix.speed == 0 && fix.course == 1800);
+
+    fprintf(stdout, "A TrackPlayer is %u bytes, with nothing else allocated\n", unsigned(sizeof(TrackPlayer)));
+    PlayLarge(false, 1000000, 1);
+    PlayLarge(false, 1000000, 10);
+    PlayLarge(true, 1000000, 1);
+    PlayLarge(true, 1000000, 10);
+
+    return CheckResult("test_track");
+}
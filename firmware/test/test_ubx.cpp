@@ -0,0 +1,124 @@
+/*
+ * File:   test_ubx.cpp
+ * Author: Bob
+ *
+ * Created on October 19, 2026, 11:30 AM
+ */
+
+// UBX messages:
+//
+//  - UBXChecksum() against polls whose checksums are in the u-blox
+//    documents, and against a plain Fletcher sum over random data
+//  - NAV-PVT from fixes north and south, east and west, moving and still:
+//    the header, every field we fill in read back as the u-blox 8 protocol
+//    description lays them out, and the checksum
+
+#include <string.h>
+#include <math.h>
+#include <random>
+#include "UBX.h"
+#include "check.h"
+
+static uint32_t Get16(const uint8_t *p) {return p[0] | (p[1] << 8);}
+static uint32_t Get32(const uint8_t *p) {return Get16(p) | (Get16(p + 2) << 16);}
+
+// A message's own checksum, worked out a byte at a time with ints
+static bool ChecksumOK(const uint8_t *message, size_t length)
+{
+    unsigned a = 0, b = 0;
+    for (size_t i = 2; i < length - 2; ++i)
+    {
+        a = (a + message[i]) & 0xff;
+        b = (b + a) & 0xff;
+    }
+    return message[length - 2] == a && message[length - 1] == b;
+}
+
+static void CheckPoll(const uint8_t *poll)
+{
+    uint8_t a, b;
+    UBXChecksum(poll + 2, 4, a, b);
+    CHECK(a == poll[6] && b == poll[7]);
+}
+
+static void CheckPVT(const GPSFix &fix)
+{
+    UBXNavPVT pvt;
+    pvt.Encode(fix);
+    const uint8_t *m = (const uint8_t *) pvt.Data();
+    CHECK(pvt.Length() == 100);
+    CHECK(m[0] == 0xb5 && m[1] == 0x62 && m[2] == 0x01 && m[3] == 0x07 && Get16(m + 4) == 92);
+    CHECK(ChecksumOK(m, pvt.Length()));
+
+    const uint8_t *p = m + 6;
+    uint32_t gpsSeconds = uint32_t(fix.time - GPS_EPOCH + GPS_LEAP_SECONDS);
+    CHECK(Get32(p) == gpsSeconds % 604800 * 1000 + fix.ms);
+    CHECK(Get16(p + 4) == fix.year && p[6] == fix.month && p[7] == fix.day);
+    CHECK(p[8] == fix.time % 86400 / 3600 && p[9] == fix.time % 3600 / 60 && p[10] == fix.time % 60);
+    CHECK((p[11] & 7) == 7);
+    CHECK(Get32(p + 16) == fix.ms * 1000000u);
+    CHECK(p[20] == 3 && (p[21] & 1) && p[23] == fix.satellites);
+    CHECK(int32_t(Get32(p + 24)) == fix.longitude * 1000);
+    CHECK(int32_t(Get32(p + 28)) == fix.latitude * 1000);
+    CHECK(int32_t(Get32(p + 32)) == fix.altitude + fix.geoidSeparation);
+    CHECK(int32_t(Get32(p + 36)) == fix.altitude);
+    // The velocity's north and east parts make up the ground speed
+    double north = int32_t(Get32(p + 48)), east = int32_t(Get32(p + 52));
+    CHECK(fabs(sqrt(north * north + east * east) - fix.speed) <= 1.5);
+    if (fix.speed > 1000)
+    {
+        double course = atan2(east, north) * 180 / M_PI;
+        if (course < 0)
+            course += 360;
+        CHECK(fabs(course - fix.course / 10.0) < 0.1 || fabs(course - fix.course / 10.0) > 359.9);
+    }
+    CHECK(Get32(p + 56) == 0 && Get32(p + 60) == fix.speed);
+    CHECK(Get32(p + 64) == fix.course * 10000u);
+    CHECK(Get16(p + 76) == fix.pdop);
+}
+
+int main()
+{
+    // Polls (empty messages) from the u-blox documents: NAV-PVT, CFG-PRT
+    // and MON-VER
+    static const uint8_t navPVT[] = {0xb5, 0x62, 0x01, 0x07, 0x00, 0x00, 0x08, 0x19};
+    static const uint8_t cfgPRT[] = {0xb5, 0x62, 0x06, 0x00, 0x00, 0x00, 0x06, 0x18};
+    static const uint8_t monVER[] = {0xb5, 0x62, 0x0a, 0x04, 0x00, 0x00, 0x0e, 0x34};
+    CheckPoll(navPVT);
+    CheckPoll(cfgPRT);
+    CheckPoll(monVER);
+
+    std::mt19937 g(1);
+    for (int i = 0; i < 1000; ++i)
+    {
+        uint8_t data[300];
+        size_t length = UBX_OVERHEAD + g() % (sizeof(data) - UBX_OVERHEAD);
+        for (size_t j = 0; j < length - 2; ++j)
+            data[j] = uint8_t(g());
+        UBXChecksum(data + 2, length - 4, data[length - 2], data[length - 1]);
+        CHECK(ChecksumOK(data, length));
+    }
+
+    // 2020-09-13 12:26:40 UTC, and fixes around the world
+    GPSFix fix = {1600000000, 0, 2020, 9, 13, 473456, -1223456, 280200, -34100, 0, 0, 4, 90, 180};
+    CheckPVT(fix);
+    static const int32_t positions[][2] = {{-338688, 1512093}, {0, 0}, {899999, -1799999}, {-1, 1}};
+    for (auto &pos : positions)
+    {
+        fix.latitude = pos[0];
+        fix.longitude = pos[1];
+        for (int i = 0; i < 50; ++i)
+        {
+            fix.time += 86399;
+            fix.ms = (i % 10) * 100;
+            fix.speed = g() % 100000;
+            fix.course = g() % 3600;
+            fix.year = 2020 + i / 12;
+            fix.month = 1 + i % 12;
+            fix.day = 1 + i % 28;
+            CheckPVT(fix);
+        }
+    }
+
+    return CheckResult("test_ubx");
+}